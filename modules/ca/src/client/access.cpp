@@ -354,6 +354,129 @@ int epicsShareAPI ca_create_channel (
     return ECA_NORMAL;
 }
 
+/*
+ *  ca_create_channels ()
+ *
+ *  the context is found, its lock taken, and its channel table
+ *  enlarged, only once for all of the channels
+ */
+// extern "C"
+int epicsShareAPI ca_create_channels (
+     unsigned count, const char * const * pNames, caChBatch * conn_func,
+     void * puser, capri priority, chid * pChanIDs )
+{
+    if ( ! conn_func ) {
+        return ECA_BADFUNCPTR;
+    }
+    if ( count == 0u ) {
+        return ECA_NORMAL;
+    }
+
+    ca_client_context * pcac;
+    int caStatus = fetchClientContext ( & pcac );
+    if ( caStatus != ECA_NORMAL ) {
+        return caStatus;
+    }
+
+    {
+        CAFDHANDLER * pFunc = 0;
+        void * pArg = 0;
+        {
+            epicsGuard < epicsMutex >
+                guard ( pcac->mutex );
+            if ( pcac->fdRegFuncNeedsToBeCalled ) {
+                pFunc = pcac->fdRegFunc;
+                pArg = pcac->fdRegArg;
+                pcac->fdRegFuncNeedsToBeCalled = false;
+            }
+        }
+        if ( pFunc ) {
+            ( *pFunc ) ( pArg, pcac->sock, true );
+        }
+    }
+
+    oldChannelBatch * pBatch;
+    try {
+        pBatch = new oldChannelBatch ( *pcac, conn_func, puser, count );
+    }
+    catch ( std::bad_alloc & ) {
+        return ECA_ALLOCMEM;
+    }
+
+    unsigned nCreated = 0u;
+    bool flushNeeded = false;
+    try {
+        epicsGuard < epicsMutex > guard ( pcac->mutex );
+        pcac->reserveChannels ( guard, count );
+        while ( nCreated < count ) {
+            oldChannelNotify * pChanNotify =
+                new ( pcac->oldChannelNotifyFreeList )
+                    oldChannelNotify ( guard, *pcac, pNames[nCreated],
+                        0, puser, priority, pBatch );
+            pChanIDs[nCreated++] = pChanNotify;
+            // connects are only queued on the batch, so their chan
+            // pointers are all set before the callback sees them
+            pChanNotify->initiateConnect ( guard );
+        }
+        flushNeeded = pcac->batchFlushPend.count () > 0u;
+    }
+    catch ( cacChannel::badString & ) {
+        caStatus = ECA_BADSTR;
+    }
+    catch ( std::bad_alloc & ) {
+        caStatus = ECA_ALLOCMEM;
+    }
+    catch ( cacChannel::badPriority & ) {
+        caStatus = ECA_BADPRIORITY;
+    }
+    catch ( cacChannel::unsupportedByService & ) {
+        caStatus = ECA_UNAVAILINSERV;
+    }
+    catch ( std :: exception & except ) {
+        pcac->printFormated (
+            "ca_create_channels: "
+            "unexpected exception was \"%s\"",
+            except.what () );
+        caStatus = ECA_INTERNAL;
+    }
+    catch ( ... ) {
+        caStatus = ECA_INTERNAL;
+    }
+
+    if ( caStatus != ECA_NORMAL ) {
+        if ( nCreated == 0u ) {
+            delete pBatch;
+            return caStatus;
+        }
+        flushNeeded = false;
+    }
+
+    if ( caStatus != ECA_NORMAL || flushNeeded ) {
+        // channels of an in-memory service connect immediately,
+        // and destroying them needs the callback lock
+        std::auto_ptr < CallbackGuard > pCBGuard;
+        if ( ! pcac->pCallbackGuard.get() ||
+                pcac->createdByThread != epicsThreadGetIdSelf () ) {
+            pCBGuard.reset ( new CallbackGuard ( pcac->cbMutex ) );
+        }
+        CallbackGuard & cbGuard = pCBGuard.get () ?
+            *pCBGuard : *pcac->pCallbackGuard;
+        if ( caStatus != ECA_NORMAL ) {
+            // the batch is deleted with its last channel
+            epicsGuard < epicsMutex > guard ( pcac->mutex );
+            for ( unsigned i = 0u; i < nCreated; i++ ) {
+                pChanIDs[i]->destructor ( cbGuard, guard );
+                pcac->oldChannelNotifyFreeList.release ( pChanIDs[i] );
+            }
+        }
+        else {
+            pcac->callbackBatchFlush ( cbGuard );
+        }
+    }
+
+    return caStatus;
+}
+
 /*
  *  ca_clear_channel ()
  *
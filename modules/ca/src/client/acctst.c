@@ -3191,6 +3191,83 @@ void verifyConnectWithDisconnectedChannels (
     showProgressEnd ( interestLevel );
 }
 
+struct channelBatchState {
+    unsigned nConnected;
+    unsigned nCallbacks;
+};
+
+void channelBatchConnHandler ( struct connection_batch_handler_args args )
+{
+    struct channelBatchState * pState =
+        ( struct channelBatchState * ) args.usr;
+    unsigned i;
+
+    verify ( args.count > 0u );
+    for ( i = 0u; i < args.count; i++ ) {
+        verify ( ca_puser ( args.chids[i] ) == pState );
+        if ( args.ops[i] == CA_OP_CONN_UP ) {
+            verify ( ca_state ( args.chids[i] ) == cs_conn );
+            pState->nConnected++;
+        }
+        else {
+            verify ( args.ops[i] == CA_OP_CONN_DOWN );
+            pState->nConnected--;
+        }
+    }
+    pState->nCallbacks++;
+}
+
+void verifyChannelBatch ( const char *pName, unsigned interestLevel )
+{
+    static const unsigned nChans = 100u;
+    struct channelBatchState state;
+    const char * names[100];
+    chid chans[100];
+    unsigned i;
+    int status;
+
+    showProgressBegin ( "verifyChannelBatch", interestLevel );
+
+    state.nConnected = 0u;
+    state.nCallbacks = 0u;
+
+    /* none are created if one of them can't be */
+    for ( i = 0u; i < nChans; i++ ) {
+        names[i] = pName;
+    }
+    names[nChans / 2u] = "";
+    status = ca_create_channels ( nChans, names, channelBatchConnHandler,
+        & state, CA_PRIORITY_DEFAULT, chans );
+    verify ( status == ECA_BADSTR );
+    names[nChans / 2u] = pName;
+
+    status = ca_create_channels ( nChans, names, channelBatchConnHandler,
+        & state, CA_PRIORITY_DEFAULT, chans );
+    SEVCHK ( status, NULL );
+    for ( i = 0u; i < 1000u && state.nConnected < nChans; i++ ) {
+        ca_pend_event ( 0.01 );
+    }
+    verify ( state.nConnected == nChans );
+    verify ( state.nCallbacks <= nChans );
+    for ( i = 0u; i < nChans; i++ ) {
+        verify ( ca_state ( chans[i] ) == cs_conn );
+    }
+
+    /* leaves the batch */
+    status = ca_change_connection_event ( chans[0], 0 );
+    SEVCHK ( status, NULL );
+    status = ca_clear_channel ( chans[0] );
+    SEVCHK ( status, NULL );
+
+    for ( i = 1u; i < nChans; i++ ) {
+        status = ca_clear_channel ( chans[i] );
+        SEVCHK ( status, NULL );
+    }
+    verify ( state.nConnected == nChans );
+
+    showProgressEnd ( interestLevel );
+}
+
 void verifyClearChannelOnDisconnectCallback (
     struct connection_handler_args args )
 {
@@ -3458,6 +3535,7 @@ int acctst ( const char * pName, unsigned interestLevel, unsigned channelCount,
 
     verifyName ( pName, interestLevel );
     verifyConnectWithDisconnectedChannels ( pName, interestLevel );
+    verifyChannelBatch ( pName, interestLevel );
     grEnumTest ( chan, interestLevel );
     test_sync_groups ( chan, interestLevel );
     verifyChannelPriorities ( pName, interestLevel );
@@ -659,6 +659,29 @@ void ca_client_context::callbackProcessingCompleteNotify ()
     }
 }
 
+//
+// run the connection callbacks of the channel batches which
+// had state changes while callbacks were processed
+//
+void ca_client_context::callbackBatchFlush (
+    epicsGuard < epicsMutex > & cbGuard )
+{
+    cbGuard.assertIdenticalMutex ( this->cbMutex );
+    epicsGuard < epicsMutex > guard ( this->mutex );
+    while ( oldChannelBatch * pBatch = this->batchFlushPend.get () ) {
+        if ( pBatch->flush ( guard ) ) {
+            delete pBatch;
+        }
+    }
+}
+
+void ca_client_context::reserveChannels (
+    epicsGuard < epicsMutex > & guard, unsigned nChannels )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->pServiceContext->reserveChannels ( guard, nChannels );
+}
+
 cacChannel & ca_client_context::createChannel (
     epicsGuard < epicsMutex > & guard, const char * pChannelName,
     cacChannelNotify & chan, cacChannel::priLev pri )
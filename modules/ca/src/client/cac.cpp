@@ -146,6 +146,7 @@ cac::cac (
     initializingThreadsPriority ( epicsThreadGetPrioritySelf() ),
     maxRecvBytesTCP ( MAX_TCP ),
     maxContigFrames ( contiguousMsgCountWhichTriggersFlowControl ),
+    tcpIOBufCount ( 4u ),
     beaconAnomalyCount ( 0u ),
     iiuExistenceCount ( 0u ),
     cacShutdownInProgress ( false )
@@ -229,6 +230,20 @@ cac::cac (
                 throw std::bad_alloc ();
             }
         }
+        long ioBufsAsALong;
+        status = envGetLongConfigParam ( &EPICS_CA_TCP_IO_BUFS, &ioBufsAsALong );
+        if ( status || ioBufsAsALong < 1 ) {
+            errlogPrintf ( "cac: EPICS_CA_TCP_IO_BUFS was not a positive integer\n" );
+        }
+        else if ( ioBufsAsALong > static_cast < long > ( comBufMaxVector ) ) {
+            errlogPrintf ( "cac: EPICS_CA_TCP_IO_BUFS was rounded down to %u\n",
+                comBufMaxVector );
+            this->tcpIOBufCount = comBufMaxVector;
+        }
+        else {
+            this->tcpIOBufCount = static_cast < unsigned > ( ioBufsAsALong );
+        }
+
         unsigned bufsPerArray = this->maxRecvBytesTCP / comBuf::capacityBytes ();
         if ( bufsPerArray > 1u ) {
             maxContigFrames = bufsPerArray *
@@ -533,6 +548,16 @@ cacChannel & cac::createChannel (
     return *pNetChan;
 }
 
+// grow the channel table once, rather than one bucket
+// at a time while the channels are installed
+void cac::reserveChannels (
+    epicsGuard < epicsMutex > & guard, unsigned nChannels )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->chanTable.setTableSize (
+        this->chanTable.numEntriesInstalled () + nChannels );
+}
+
 bool cac::findOrCreateVirtCircuit (
     epicsGuard < epicsMutex > & guard, const osiSockAddr & addr,
     unsigned priority, tcpiiu *& piiu, unsigned minorVersionNumber,
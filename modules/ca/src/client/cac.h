@@ -89,8 +89,9 @@ class notifyGuard {
 public:
     notifyGuard ( cacContextNotify & );
     ~notifyGuard ();
-private:
+protected:
     cacContextNotify & notify;
+private:
     notifyGuard ( const notifyGuard & );
     notifyGuard & operator = ( const notifyGuard & );
 };
@@ -100,6 +101,7 @@ public:
     callbackManager (
         cacContextNotify &,
         epicsMutex & callbackControl );
+    ~callbackManager ();
     epicsGuard < epicsMutex > cbGuard;
 };
 
@@ -186,6 +188,7 @@ public:
     // diagnostics
     unsigned circuitCount ( epicsGuard < epicsMutex > & ) const;
     void show ( epicsGuard < epicsMutex > &, unsigned level ) const;
+    void reserveChannels ( epicsGuard < epicsMutex > &, unsigned nChannels );
     int printFormated (
         epicsGuard < epicsMutex > & callbackControl,
         const char *pformat, ... ) const;
@@ -195,6 +198,7 @@ public:
     double connectionTimeout ( epicsGuard < epicsMutex > & );
 
     unsigned maxContiguousFrames ( epicsGuard < epicsMutex > & ) const;
+    unsigned tcpIOBufs () const;
 
     // misc
     const char * userNamePointer () const;
@@ -272,6 +276,7 @@ private:
     unsigned initializingThreadsPriority;
     unsigned maxRecvBytesTCP;
     unsigned maxContigFrames;
+    unsigned tcpIOBufCount;
     unsigned beaconAnomalyCount;
     unsigned short _serverPort;
     unsigned iiuExistenceCount;
@@ -406,6 +411,11 @@ inline callbackManager::callbackManager (
 {
 }
 
+inline callbackManager::~callbackManager ()
+{
+    this->notify.callbackBatchFlush ( this->cbGuard );
+}
+
 inline nciu * cac::lookupChannel (
     epicsGuard < epicsMutex > & guard,
     const cacChannel::ioid & idIn )
@@ -425,6 +435,11 @@ inline unsigned cac ::
     return maxContigFrames;
 }
 
+inline unsigned cac :: tcpIOBufs () const
+{
+    return this->tcpIOBufCount;
+}
+
 inline double cac ::
     connectionTimeout ( epicsGuard < epicsMutex > & guard )
 {
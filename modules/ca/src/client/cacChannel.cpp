@@ -140,6 +140,11 @@ const char * cacChannel::pHostName (
 
 cacContext::~cacContext () {}
 
+void cacContext::reserveChannels (
+    epicsGuard < epicsMutex > &, unsigned )
+{
+}
+
 cacService::~cacService () {}
 
 
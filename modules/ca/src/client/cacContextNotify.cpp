@@ -39,5 +39,10 @@ void cacContextNotify::callbackProcessingCompleteNotify ()
 {
 }
 
+void cacContextNotify::callbackBatchFlush ( 
+    epicsGuard < epicsMutex > & )
+{
+}
+
 
 
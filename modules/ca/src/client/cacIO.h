@@ -294,6 +294,9 @@ public:
         epicsGuard < epicsMutex > & ) const = 0;
     virtual void show (
         epicsGuard < epicsMutex > &, unsigned level ) const = 0;
+    // room for this many more channels, before they are created
+    virtual void reserveChannels (
+        epicsGuard < epicsMutex > &, unsigned nChannels );
 };
 
 class epicsShareClass cacContextNotify {
@@ -307,6 +310,10 @@ public:
         const char * pFileName, unsigned lineNo ) = 0;
 // perhaps this should be phased out in deference to the exception mechanism
     virtual int varArgsPrintFormated ( const char * pformat, va_list args ) const = 0;
+// calls the callbacks deferred while callbacks were processed, with the
+// callback lock still held
+    virtual void callbackBatchFlush (
+        epicsGuard < epicsMutex > & callbackControl );
 // backwards compatibility (from here down)
     virtual void attachToClientCtx () = 0;
     virtual void callbackProcessingInitiateNotify () = 0;
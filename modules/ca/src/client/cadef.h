@@ -67,6 +67,16 @@ struct  connection_handler_args {
 
 typedef void caCh (struct connection_handler_args args);
 
+/* arguments passed to user connection handlers of a channel batch */
+struct  connection_batch_handler_args {
+    void        *usr;   /* user argument given to ca_create_channels() */
+    unsigned    count;  /* number of connection state changes */
+    const chanId *chids; /* the channels that changed state */
+    const long  *ops;   /* CA_OP_CONN_UP or CA_OP_CONN_DOWN for each */
+};
+
+typedef void caChBatch (struct connection_batch_handler_args args);
+
 typedef struct ca_access_rights {
     unsigned    read_access:1;
     unsigned    write_access:1;
@@ -227,6 +237,36 @@ epicsShareFunc int epicsShareAPI ca_create_channel
      chid           *pChanID
 );
 
+/*
+ * ca_create_channels ()
+ *
+ * Creates many channels with one call. The connection state changes
+ * of all of them are passed to one connection handler, several at a
+ * time, which is called once for each batch of server responses
+ * processed. If the handler is replaced for one of the channels with
+ * ca_change_connection_event() then that channel leaves the batch.
+ *
+ * count                R   number of channels
+ * pChanNames           R   array of count channel name strings
+ * pConnStateCallback   R   address of connection state change
+ *                          callback function for the channel batch
+ * pUserPrivate         R   placed in the user private field of each
+ *                          channel, and passed to *pConnStateCallback
+ * priority             R   priority level in the server 0 - 100
+ * pChanIDs             RW  array of count channel ids written here
+ *
+ * If a channel can't be created then none of the channels are.
+ */
+epicsShareFunc int epicsShareAPI ca_create_channels
+(
+     unsigned           count,
+     const char * const *pChanNames,
+     caChBatch          *pConnStateCallback,
+     void               *pUserPrivate,
+     capri              priority,
+     chid               *pChanIDs
+);
+
 /*
  * ca_change_connection_event()
  *
@@ -28,21 +28,60 @@
 #include "comBuf.h"
 #include "errlog.h"
 
-bool comBuf::flushToWire ( wireSendAdapter & wire, const epicsTime & currentTime )
+// sends the occupied bytes of all of the buffers, several 
+// buffers at a time when the wire supports that
+bool comBuf::flushToWire ( comBuf * const * ppBufs, unsigned nBufs,
+    wireSendAdapter & wire, const epicsTime & currentTime )
 {
-    unsigned index = this->nextReadIndex;
-    unsigned finalIndex = this->commitIndex;
-    while ( index < finalIndex ) {
-        unsigned nBytes = wire.sendBytes ( 
-            &this->buf[index], finalIndex - index, currentTime );
+    wireBuf wb [ comBufMaxVector ];
+    unsigned first = 0u;
+
+    assert ( nBufs <= comBufMaxVector );
+    while ( true ) {
+        while ( first < nBufs && ppBufs[first]->occupiedBytes () == 0u ) {
+            first++;
+        }
+        if ( first >= nBufs ) {
+            return true;
+        }
+        unsigned n = 0u;
+        for ( unsigned i = first; i < nBufs; i++ ) {
+            comBuf & cb = *ppBufs[i];
+            wb[n].pBuf = & cb.buf[cb.nextReadIndex];
+            wb[n].nBytes = cb.commitIndex - cb.nextReadIndex;
+            n++;
+        }
+        unsigned nBytes = wire.sendBytes ( wb, n, currentTime );
         if ( nBytes == 0u ) {
-            this->nextReadIndex = index;
             return false;
         }
-        index += nBytes;
+        for ( unsigned i = first; i < nBufs && nBytes; i++ ) {
+            nBytes -= ppBufs[i]->removeBytes ( nBytes );
+        }
+    }
+}
+
+// receives into the unoccupied space of the buffers, in order
+void comBuf::fillFromWire ( comBuf * const * ppBufs, unsigned nBufs,
+    wireRecvAdapter & wire, statusWireIO & stat )
+{
+    wireBuf wb [ comBufMaxVector ] = {};
+
+    assert ( nBufs >= 1u && nBufs <= comBufMaxVector );
+    for ( unsigned i = 0u; i < nBufs; i++ ) {
+        comBuf & cb = *ppBufs[i];
+        wb[i].pBuf = & cb.buf[cb.nextWriteIndex];
+        wb[i].nBytes = sizeof ( cb.buf ) - cb.nextWriteIndex;
+    }
+    wire.recvBytes ( wb, nBufs, stat );
+    if ( stat.circuitState == swioConnected ) {
+        unsigned nBytes = stat.bytesCopied;
+        for ( unsigned i = 0u; i < nBufs && nBytes; i++ ) {
+            unsigned nThisBuf = nBytes < wb[i].nBytes ? nBytes : wb[i].nBytes;
+            ppBufs[i]->nextWriteIndex += nThisBuf;
+            nBytes -= nThisBuf;
+        }
     }
-    this->nextReadIndex = index;
-    return true;
 }
 
 // throwing the exception from a function that isnt inline 
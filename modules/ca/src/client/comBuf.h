@@ -36,6 +36,9 @@
 
 static const unsigned comBufSize = 0x4000;
 
+// most buffers moved by one vectored send or receive
+static const unsigned comBufMaxVector = 64u;
+
 // this wrapper avoids Tornado 2.0.1 compiler bugs
 class comBufMemoryManager {
 public:
@@ -44,10 +47,16 @@ public:
     virtual void release ( void * ) = 0; 
 };
 
+// one of the blocks of a vectored send or receive
+struct wireBuf {
+    void * pBuf;
+    unsigned nBytes;
+};
+
 class wireSendAdapter {
 public:
-    virtual unsigned sendBytes ( const void * pBuf, 
-        unsigned nBytesInBuf, 
+    virtual unsigned sendBytes ( const wireBuf * pBufs, 
+        unsigned nBufs, 
         const class epicsTime & currentTime ) = 0;
 protected:
     virtual ~wireSendAdapter() {}
@@ -67,8 +76,8 @@ struct statusWireIO {
 
 class wireRecvAdapter {
 public:
-    virtual void recvBytes ( void * pBuf, 
-        unsigned nBytesInBuf, statusWireIO & ) = 0;
+    virtual void recvBytes ( const wireBuf * pBufs, 
+        unsigned nBufs, statusWireIO & ) = 0;
 protected:
     virtual ~wireRecvAdapter() {}
 };
@@ -97,8 +106,10 @@ public:
     unsigned copyOutBytes ( void *pBuf, unsigned nBytes );
     bool copyOutAllBytes ( void *pBuf, unsigned nBytes );
     unsigned removeBytes ( unsigned nBytes );
-    bool flushToWire ( wireSendAdapter &, const epicsTime & currentTime );
-    void fillFromWire ( wireRecvAdapter &, statusWireIO & );
+    static bool flushToWire ( comBuf * const * ppBufs, unsigned nBufs,
+        wireSendAdapter &, const epicsTime & currentTime );
+    static void fillFromWire ( comBuf * const * ppBufs, unsigned nBufs,
+        wireRecvAdapter &, statusWireIO & );
     struct popStatus {
         bool success;
         bool nowEmpty;
@@ -174,17 +185,6 @@ inline unsigned comBuf :: capacityBytes ()
     return comBufSize;
 }
 
-inline void comBuf :: fillFromWire ( 
-    wireRecvAdapter & wire, statusWireIO & stat )
-{
-    wire.recvBytes ( 
-        & this->buf[this->nextWriteIndex], 
-        sizeof ( this->buf ) - this->nextWriteIndex, stat );
-    if ( stat.circuitState == swioConnected ) {
-        this->nextWriteIndex += stat.bytesCopied;
-    }
-}
-
 template < class T >
 inline bool comBuf :: push ( const T & value )
 {
@@ -25,7 +25,16 @@
 
 #include <string.h>
 
+#if defined ( __AVX2__ )
+#   include <immintrin.h>
+#elif defined ( __SSSE3__ )
+#   include <tmmintrin.h>
+#elif defined ( __SSE2__ ) || defined ( _M_X64 )
+#   include <emmintrin.h>
+#endif
+
 #include "dbDefs.h"
+#include "epicsEndian.h"
 #include "osiSock.h"
 #include "osiWireFormat.h"
 
@@ -98,6 +107,176 @@ inline epicsUInt32 dbr_htonl ( const epicsUInt32 & host )
     return tmp;
 }
 
+/*
+ * When the host is little endian with IEEE floating point in the same
+ * byte order, converting an array in either direction only reverses the
+ * bytes of each element, so the arrays are converted in bulk, with
+ * vector instructions when the compiler has them.  They are SSE2 on all
+ * x86_64 targets, and SSSE3 or AVX2 when building for a CPU that has them,
+ * for example with -march=native.
+ */
+#if EPICS_BYTE_ORDER == EPICS_ENDIAN_LITTLE && \
+        EPICS_FLOAT_WORD_ORDER == EPICS_ENDIAN_LITTLE
+#   define BULK_BYTE_SWAP
+#endif
+
+#ifdef BULK_BYTE_SWAP
+
+#if defined ( __SSE2__ ) || defined ( _M_X64 )
+
+inline __m128i swap16x8 ( __m128i v )
+{
+#   ifdef __SSSE3__
+        return _mm_shuffle_epi8 ( v, _mm_setr_epi8 (
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 ) );
+#   else
+        return _mm_or_si128 ( _mm_slli_epi16 ( v, 8 ),
+            _mm_srli_epi16 ( v, 8 ) );
+#   endif
+}
+
+inline __m128i swap32x4 ( __m128i v )
+{
+#   ifdef __SSSE3__
+        return _mm_shuffle_epi8 ( v, _mm_setr_epi8 (
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 ) );
+#   else
+        v = _mm_shufflelo_epi16 ( v, _MM_SHUFFLE ( 2, 3, 0, 1 ) );
+        v = _mm_shufflehi_epi16 ( v, _MM_SHUFFLE ( 2, 3, 0, 1 ) );
+        return swap16x8 ( v );
+#   endif
+}
+
+inline __m128i swap64x2 ( __m128i v )
+{
+#   ifdef __SSSE3__
+        return _mm_shuffle_epi8 ( v, _mm_setr_epi8 (
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 ) );
+#   else
+        v = _mm_shufflelo_epi16 ( v, _MM_SHUFFLE ( 0, 1, 2, 3 ) );
+        v = _mm_shufflehi_epi16 ( v, _MM_SHUFFLE ( 0, 1, 2, 3 ) );
+        return swap16x8 ( v );
+#   endif
+}
+
+#endif /* SSE2 */
+
+#ifdef __AVX2__
+
+inline __m256i swap16x16 ( __m256i v )
+{
+    return _mm256_shuffle_epi8 ( v, _mm256_setr_epi8 (
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 ) );
+}
+
+inline __m256i swap32x8 ( __m256i v )
+{
+    return _mm256_shuffle_epi8 ( v, _mm256_setr_epi8 (
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 ) );
+}
+
+inline __m256i swap64x4 ( __m256i v )
+{
+    return _mm256_shuffle_epi8 ( v, _mm256_setr_epi8 (
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 ) );
+}
+
+#endif /* __AVX2__ */
+
+//
+// swapBytesNN() reverse the bytes of each of the num NN bit elements at s,
+// and store them at d, which may be the same as s. Neither needs to be
+// aligned. Each vector is loaded before it is stored, and the vectors are
+// processed in order, so converting in place is safe.
+//
+#if defined ( __AVX2__ )
+#   define SWAP_VEC256( pS, pD, swap ) \
+        _mm256_storeu_si256 ( reinterpret_cast < __m256i * > ( pD ), \
+            swap ( _mm256_loadu_si256 ( \
+                reinterpret_cast < const __m256i * > ( pS ) ) ) )
+#endif
+#if defined ( __SSE2__ ) || defined ( _M_X64 )
+#   define SWAP_VEC128( pS, pD, swap ) \
+        _mm_storeu_si128 ( reinterpret_cast < __m128i * > ( pD ), \
+            swap ( _mm_loadu_si128 ( \
+                reinterpret_cast < const __m128i * > ( pS ) ) ) )
+#endif
+
+static void swapBytes16 ( const void * s, void * d, arrayElementCount num )
+{
+    const epicsUInt8 * pSrc = static_cast < const epicsUInt8 * > ( s );
+    epicsUInt8 * pDest = static_cast < epicsUInt8 * > ( d );
+    arrayElementCount i = 0u;
+#   ifdef SWAP_VEC256
+        for ( ; i + 16u <= num; i += 16u ) {
+            SWAP_VEC256 ( pSrc + 2u * i, pDest + 2u * i, swap16x16 );
+        }
+#   endif
+#   ifdef SWAP_VEC128
+        for ( ; i + 8u <= num; i += 8u ) {
+            SWAP_VEC128 ( pSrc + 2u * i, pDest + 2u * i, swap16x8 );
+        }
+#   endif
+    for ( ; i < num; i++ ) {
+        epicsUInt8 b0 = pSrc[2u * i];
+        pDest[2u * i] = pSrc[2u * i + 1u];
+        pDest[2u * i + 1u] = b0;
+    }
+}
+
+static void swapBytes32 ( const void * s, void * d, arrayElementCount num )
+{
+    const epicsUInt8 * pSrc = static_cast < const epicsUInt8 * > ( s );
+    epicsUInt8 * pDest = static_cast < epicsUInt8 * > ( d );
+    arrayElementCount i = 0u;
+#   ifdef SWAP_VEC256
+        for ( ; i + 8u <= num; i += 8u ) {
+            SWAP_VEC256 ( pSrc + 4u * i, pDest + 4u * i, swap32x8 );
+        }
+#   endif
+#   ifdef SWAP_VEC128
+        for ( ; i + 4u <= num; i += 4u ) {
+            SWAP_VEC128 ( pSrc + 4u * i, pDest + 4u * i, swap32x4 );
+        }
+#   endif
+    for ( ; i < num; i++ ) {
+        epicsUInt32 tmp;
+        memcpy ( & tmp, pSrc + 4u * i, 4u );
+        tmp = byteSwap ( tmp );
+        memcpy ( pDest + 4u * i, & tmp, 4u );
+    }
+}
+
+static void swapBytes64 ( const void * s, void * d, arrayElementCount num )
+{
+    const epicsUInt8 * pSrc = static_cast < const epicsUInt8 * > ( s );
+    epicsUInt8 * pDest = static_cast < epicsUInt8 * > ( d );
+    arrayElementCount i = 0u;
+#   ifdef SWAP_VEC256
+        for ( ; i + 4u <= num; i += 4u ) {
+            SWAP_VEC256 ( pSrc + 8u * i, pDest + 8u * i, swap64x4 );
+        }
+#   endif
+#   ifdef SWAP_VEC128
+        for ( ; i + 2u <= num; i += 2u ) {
+            SWAP_VEC128 ( pSrc + 8u * i, pDest + 8u * i, swap64x2 );
+        }
+#   endif
+    for ( ; i < num; i++ ) {
+        epicsUInt32 tmp[2];
+        memcpy ( tmp, pSrc + 8u * i, 8u );
+        epicsUInt32 lo = byteSwap ( tmp[0] );
+        tmp[0] = byteSwap ( tmp[1] );
+        tmp[1] = lo;
+        memcpy ( pDest + 8u * i, tmp, 8u );
+    }
+}
+
+#endif /* BULK_BYTE_SWAP */
+
 /*
  * if hton is true then it is a host to network conversion
  * otherwise vise-versa
@@ -138,6 +317,9 @@ arrayElementCount   num         /* number of values     */
     dbr_short_t         *pSrc = (dbr_short_t *) s;
     dbr_short_t         *pDest = (dbr_short_t *) d;
 
+#   ifdef BULK_BYTE_SWAP
+        swapBytes16 ( pSrc, pDest, num );
+#   else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htons( pSrc[i] );
@@ -148,6 +330,7 @@ arrayElementCount   num         /* number of values     */
             pDest[i] = dbr_ntohs( pSrc[i] );
         }
     }
+#   endif
 }
 
 /*
@@ -188,6 +371,9 @@ arrayElementCount   num         /* number of values     */
     dbr_long_t          *pSrc = (dbr_long_t *) s;
     dbr_long_t          *pDest = (dbr_long_t *) d;
 
+#   ifdef BULK_BYTE_SWAP
+        swapBytes32 ( pSrc, pDest, num );
+#   else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htonl( pSrc[i] );
@@ -198,6 +384,7 @@ arrayElementCount   num         /* number of values     */
             pDest[i] = dbr_ntohl( pSrc[i] );
         }
     }
+#   endif
 }
 
 /*
@@ -217,6 +404,9 @@ arrayElementCount   num         /* number of values     */
     dbr_enum_t          *pSrc = (dbr_enum_t *) s;
     dbr_enum_t          *pDest = (dbr_enum_t *) d;
 
+#   ifdef BULK_BYTE_SWAP
+        swapBytes16 ( pSrc, pDest, num );
+#   else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htons ( pSrc[i] );
@@ -227,6 +417,7 @@ arrayElementCount   num         /* number of values     */
             pDest[i] = dbr_ntohs ( pSrc[i] );
         }
     }
+#   endif
 }
 
 /*
@@ -248,6 +439,9 @@ arrayElementCount   num         /* number of values     */
     const dbr_float_t   *pSrc = (const dbr_float_t *) s;
     dbr_float_t         *pDest = (dbr_float_t *) d;
 
+#   ifdef BULK_BYTE_SWAP
+        swapBytes32 ( pSrc, pDest, num );
+#   else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             dbr_htonf ( &pSrc[i], &pDest[i] );
@@ -258,6 +452,7 @@ arrayElementCount   num         /* number of values     */
             dbr_ntohf ( &pSrc[i], &pDest[i] );
         }
     }
+#   endif
 }
 
 /*
@@ -273,6 +468,9 @@ arrayElementCount   num         /* number of values     */
     dbr_double_t        *pSrc = (dbr_double_t *) s;
     dbr_double_t        *pDest = (dbr_double_t *) d;
 
+#   ifdef BULK_BYTE_SWAP
+        swapBytes64 ( pSrc, pDest, num );
+#   else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             dbr_htond ( &pSrc[i], &pDest[i] );
@@ -283,6 +481,7 @@ arrayElementCount   num         /* number of values     */
             dbr_ntohd( &pSrc[i], &pDest[i] );
         }
     }
+#   endif
 }
 
 /****************************************************************************
@@ -1081,7 +1280,7 @@ arrayElementCount   num         /* number of values     */
         pDest->value = dbr_ntohl(pSrc->value);
     else        /* array chan-- multiple pts */
     {
-        cvrt_long(&pDest->value, &pSrc->value, encode, num);
+        cvrt_long(&pSrc->value, &pDest->value, encode, num);
     }
 }
 
@@ -1301,7 +1500,7 @@ arrayElementCount   num         /* number of values     */
         pDest->value = dbr_ntohl(pSrc->value);
     else        /* array chan-- multiple pts */
     {
-        cvrt_long(&pDest->value, &pSrc->value, encode, num);
+        cvrt_long(&pSrc->value, &pDest->value, encode, num);
     }
 }
 
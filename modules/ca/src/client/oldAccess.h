@@ -34,6 +34,7 @@
 #endif
 
 #include "tsFreeList.h"
+#include "tsDLList.h"
 #include "compilerDependencies.h"
 #include "osiSock.h"
 
@@ -47,12 +48,16 @@
 #include "cadef.h"
 #include "syncGroup.h"
 
-struct oldChannelNotify : private cacChannelNotify {
+class oldChannelBatch;
+
+struct oldChannelNotify : private cacChannelNotify,
+        public tsDLNode < oldChannelNotify > {
 public:
     oldChannelNotify (
         epicsGuard < epicsMutex > &, struct ca_client_context &,
         const char * pName, caCh * pConnCallBackIn,
-        void * pPrivateIn, capri priority );
+        void * pPrivateIn, capri priority,
+        oldChannelBatch * pBatchIn = 0 );
     void destructor (
         CallbackGuard & cbGuard,
         epicsGuard < epicsMutex > & mutexGuard );
@@ -106,6 +111,7 @@ public:
         chid pChan );
     friend double epicsShareAPI ca_receive_watchdog_delay (
         chid pChan );
+    friend class oldChannelBatch;
 
     unsigned getName (
         epicsGuard < epicsMutex > &,
@@ -144,11 +150,15 @@ private:
     ca_client_context & cacCtx;
     cacChannel & io;
     caCh * pConnCallBack;
+    oldChannelBatch * pBatch;
     void * pPrivate;
     caArh * pAccessRightsFunc;
     unsigned ioSeqNo;
     bool currentlyConnected;
     bool prevConnected;
+    bool batchPending;
+    bool batchConnected; // last state passed to the batch callback
+    void detachFromBatch ( epicsGuard < epicsMutex > & );
     void connectNotify ( epicsGuard < epicsMutex > & );
     void disconnectNotify ( epicsGuard < epicsMutex > & );
     void serviceShutdownNotify (
@@ -168,6 +178,35 @@ private:
     void operator delete ( void * );
 };
 
+//
+// the channels created together by ca_create_channels(), which share
+// one connection callback that is called with all of the connection
+// state changes found in one round of callback processing
+//
+class oldChannelBatch : public tsDLNode < oldChannelBatch > {
+public:
+    oldChannelBatch ( ca_client_context &, caChBatch * pFunc,
+        void * pPrivate, unsigned nChannels );
+    ~oldChannelBatch ();
+    void install ( epicsGuard < epicsMutex > & );
+    bool uninstall ( epicsGuard < epicsMutex > &, oldChannelNotify & );
+    void stateChange ( epicsGuard < epicsMutex > &, oldChannelNotify & );
+    bool flush ( epicsGuard < epicsMutex > & );
+private:
+    tsDLList < oldChannelNotify > pending;
+    ca_client_context & cacCtx;
+    chid * pChids;
+    long * pOps;
+    caChBatch * pFunc;
+    void * pPrivate;
+    unsigned capacity;
+    unsigned nChannels;
+    bool flushPending;
+    bool flushing;
+    oldChannelBatch ( const oldChannelBatch & );
+    oldChannelBatch & operator = ( const oldChannelBatch & );
+};
+
 class getCopy : public cacReadNotify {
 public:
     getCopy (
@@ -311,6 +350,7 @@ public:
     int pendEvent ( const double & timeout );
     bool ioComplete () const;
     void show ( unsigned level ) const;
+    void reserveChannels ( epicsGuard < epicsMutex > &, unsigned nChannels );
     unsigned circuitCount () const;
     unsigned sequenceNumberOfOutstandingIO (
         epicsGuard < epicsMutex > & ) const;
@@ -354,7 +394,11 @@ public:
     friend int epicsShareAPI ca_create_channel (
         const char * name_str, caCh * conn_func, void * puser,
         capri priority, chid * chanptr );
+    friend int epicsShareAPI ca_create_channels (
+        unsigned count, const char * const * pNames, caChBatch * conn_func,
+        void * puser, capri priority, chid * pChanIDs );
     friend int epicsShareAPI ca_clear_channel ( chid pChan );
+    friend class oldChannelBatch;
     friend int epicsShareAPI ca_array_get ( chtype type,
         arrayElementCount count, chid pChan, void * pValue );
     friend int epicsShareAPI ca_array_get_callback ( chtype type,
@@ -398,6 +442,7 @@ private:
     tsFreeList < class putCallback, 1024, epicsMutexNOOP > putCallbackFreeList;
     tsFreeList < struct oldSubscription, 1024, epicsMutexNOOP > subscriptionFreeList;
     tsFreeList < struct CASG, 128, epicsMutexNOOP > casgFreeList;
+    tsDLList < oldChannelBatch > batchFlushPend;
     mutable epicsMutex mutex;
     mutable epicsMutex cbMutex;
     epicsEvent ioDone;
@@ -421,6 +466,7 @@ private:
     void attachToClientCtx ();
     void callbackProcessingInitiateNotify ();
     void callbackProcessingCompleteNotify ();
+    void callbackBatchFlush ( epicsGuard < epicsMutex > & callbackControl );
     cacContext & createNetworkContext (
         epicsMutex & mutualExclusion, epicsMutex & callbackControl );
     void _sendWakeupMsg ();
@@ -0,0 +1,125 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Channels created by ca_create_channels() which share one connection
+ *  callback
+ */
+
+#include <string>
+#include <stdexcept>
+
+#include "errlog.h"
+
+#define epicsExportSharedSymbols
+#include "iocinf.h"
+#include "oldAccess.h"
+
+oldChannelBatch::oldChannelBatch ( ca_client_context & cacIn,
+        caChBatch * pFuncIn, void * pPrivateIn, unsigned nChannelsIn ) :
+    cacCtx ( cacIn ), pChids ( 0 ), pOps ( 0 ),
+    pFunc ( pFuncIn ), pPrivate ( pPrivateIn ),
+    capacity ( nChannelsIn ), nChannels ( 0u ),
+    flushPending ( false ), flushing ( false )
+{
+    // a channel is pending at most once, so these never grow
+    this->pChids = new chid [ nChannelsIn ];
+    try {
+        this->pOps = new long [ nChannelsIn ];
+    }
+    catch ( ... ) {
+        delete [] this->pChids;
+        throw;
+    }
+}
+
+oldChannelBatch::~oldChannelBatch ()
+{
+    delete [] this->pChids;
+    delete [] this->pOps;
+}
+
+void oldChannelBatch::install ( epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    this->nChannels++;
+}
+
+//
+// returns true if the batch should be deleted by the caller
+//
+bool oldChannelBatch::uninstall (
+    epicsGuard < epicsMutex > & guard, oldChannelNotify & chan )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    if ( chan.batchPending ) {
+        this->pending.remove ( chan );
+        chan.batchPending = false;
+        if ( this->flushPending && this->pending.count () == 0u ) {
+            this->cacCtx.batchFlushPend.remove ( *this );
+            this->flushPending = false;
+        }
+    }
+    this->nChannels--;
+    // flush() deletes it when the callback returns
+    return this->nChannels == 0u && ! this->flushing;
+}
+
+void oldChannelBatch::stateChange (
+    epicsGuard < epicsMutex > & guard, oldChannelNotify & chan )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    if ( ! chan.batchPending ) {
+        this->pending.add ( chan );
+        chan.batchPending = true;
+        if ( ! this->flushPending ) {
+            this->cacCtx.batchFlushPend.add ( *this );
+            this->flushPending = true;
+        }
+    }
+}
+
+//
+// called by the context, with the callback lock held, after it has
+// removed the batch from its list, returns true if the batch should
+// be deleted by the caller
+//
+bool oldChannelBatch::flush ( epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    this->flushPending = false;
+
+    // a channel that connected and disconnected again since
+    // the last callback isn't reported
+    unsigned n = 0u;
+    while ( oldChannelNotify * pChan = this->pending.get () ) {
+        pChan->batchPending = false;
+        if ( pChan->batchConnected != pChan->currentlyConnected ) {
+            pChan->batchConnected = pChan->currentlyConnected;
+            assert ( n < this->capacity );
+            this->pChids[n] = pChan;
+            this->pOps[n] = pChan->currentlyConnected ?
+                CA_OP_CONN_UP : CA_OP_CONN_DOWN;
+            n++;
+        }
+    }
+
+    if ( n > 0u ) {
+        struct connection_batch_handler_args args;
+        args.usr = this->pPrivate;
+        args.count = n;
+        args.chids = this->pChids;
+        args.ops = this->pOps;
+        caChBatch * pFuncCopy = this->pFunc;
+        this->flushing = true;
+        {
+            epicsGuardRelease < epicsMutex > unguard ( guard );
+            ( *pFuncCopy ) ( args );
+        }
+        this->flushing = false;
+    }
+
+    return this->nChannels == 0u;
+}
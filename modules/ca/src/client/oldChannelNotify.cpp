@@ -46,16 +46,20 @@ extern "C" void cacNoopAccesRightsHandler ( struct access_rights_handler_args )
 oldChannelNotify::oldChannelNotify (
         epicsGuard < epicsMutex > & guard, ca_client_context & cacIn,
         const char *pName, caCh * pConnCallBackIn,
-        void * pPrivateIn, capri priority ) :
+        void * pPrivateIn, capri priority, oldChannelBatch * pBatchIn ) :
     cacCtx ( cacIn ),
     io ( cacIn.createChannel ( guard, pName, *this, priority ) ),
-    pConnCallBack ( pConnCallBackIn ),
+    pConnCallBack ( pConnCallBackIn ), pBatch ( pBatchIn ),
     pPrivate ( pPrivateIn ), pAccessRightsFunc ( cacNoopAccesRightsHandler ),
-    ioSeqNo ( 0 ), currentlyConnected ( false ), prevConnected ( false )
+    ioSeqNo ( 0 ), currentlyConnected ( false ), prevConnected ( false ),
+    batchPending ( false ), batchConnected ( false )
 {
     guard.assertIdenticalMutex ( cacIn.mutexRef () );
     this->ioSeqNo = cacIn.sequenceNumberOfOutstandingIO ( guard );
-    if ( pConnCallBackIn == 0 ) {
+    if ( pBatchIn ) {
+        pBatchIn->install ( guard );
+    }
+    else if ( pConnCallBackIn == 0 ) {
         cacIn.incrementOutstandingIO ( guard, this->ioSeqNo );
     }
 }
@@ -72,12 +76,24 @@ void  oldChannelNotify::destructor (
     this->io.destroy ( cbGuard, mutexGuard );
     // no need to worry about a connect preempting here because
     // the io (the nciu) has been destroyed above
-    if ( this->pConnCallBack == 0 && ! this->currentlyConnected ) {
+    if ( this->pBatch ) {
+        this->detachFromBatch ( mutexGuard );
+    }
+    else if ( this->pConnCallBack == 0 && ! this->currentlyConnected ) {
         this->cacCtx.decrementOutstandingIO ( mutexGuard, this->ioSeqNo );
     }
     this->~oldChannelNotify ();
 }
 
+void oldChannelNotify::detachFromBatch (
+    epicsGuard < epicsMutex > & guard )
+{
+    if ( this->pBatch->uninstall ( guard, *this ) ) {
+        delete this->pBatch;
+    }
+    this->pBatch = 0;
+}
+
 void oldChannelNotify::connectNotify (
     epicsGuard < epicsMutex > & guard )
 {
@@ -93,6 +109,9 @@ void oldChannelNotify::connectNotify (
             ( *pFunc ) ( args );
         }
     }
+    else if ( this->pBatch ) {
+        this->pBatch->stateChange ( guard, *this );
+    }
     else {
         this->cacCtx.decrementOutstandingIO ( guard, this->ioSeqNo );
     }
@@ -112,6 +131,9 @@ void oldChannelNotify::disconnectNotify (
             ( *pFunc ) ( args );
         }
     }
+    else if ( this->pBatch ) {
+        this->pBatch->stateChange ( guard, *this );
+    }
     else {
         this->cacCtx.incrementOutstandingIO (
             guard, this->ioSeqNo );
@@ -220,7 +242,14 @@ void * epicsShareAPI ca_puser (
 int epicsShareAPI ca_change_connection_event ( chid pChan, caCh * pfunc )
 {
     epicsGuard < epicsMutex > guard ( pChan->cacCtx.mutexRef () );
-    if ( ! pChan->currentlyConnected ) {
+    if ( pChan->pBatch ) {
+        // it now has its own handler, as if it always had one
+        pChan->detachFromBatch ( guard );
+        if ( ! pfunc && ! pChan->currentlyConnected ) {
+            pChan->cacCtx.incrementOutstandingIO ( guard, pChan->ioSeqNo );
+        }
+    }
+    else if ( ! pChan->currentlyConnected ) {
          if ( pfunc ) {
             if ( ! pChan->pConnCallBack ) {
                 pChan->cacCtx.decrementOutstandingIO ( guard, pChan->ioSeqNo );
@@ -31,9 +31,6 @@
 #include "udpiiu.h"
 #include "nciu.h"
 
-static const unsigned initialTriesPerFrame = 1u; // initial UDP frames per search try
-static const unsigned maxTriesPerFrame = 64u; // max UDP frames per search try 
-
 //
 // searchTimer::searchTimer ()
 //
@@ -47,11 +44,11 @@ searchTimer::searchTimer (
     timer ( queueIn.createTimer () ),
     iiu ( iiuIn ),
     mutex ( mutexIn ),
-    framesPerTry ( initialTriesPerFrame ),
-    framesPerTryCongestThresh ( DBL_MAX ),
+    searchRespRTT ( 0.0 ),
     retry ( 0 ),
     searchAttempts ( 0u ),
     searchResponses ( 0u ),
+    framesSent ( 0u ),
     index ( indexIn ),
     dgSeqNoAtTimerExpireBegin ( 0u ),
     dgSeqNoAtTimerExpireEnd ( 0u ),
@@ -146,85 +143,29 @@ epicsTimerNotify::expireStatus searchTimer::expire (
         }
     }
 
-    if ( this->searchAttempts ) {
-#if 0
-        //
-        // dynamically adjust the number of UDP frames per 
-        // try depending how many search requests are not 
-        // replied to
-        //
-        // The variable this->framesPerTry
-        // determines the number of UDP frames to be sent
-        // each time that expire() is called.
-        // If this value is too high we will waste some
-        // network bandwidth. If it is too low we will
-        // use very little of the incoming UDP message
-        // buffer associated with the server's port and
-        // will therefore take longer to connect. We 
-        // initialize this->framesPerTry to a prime number 
-        // so that it is less likely that the
-        // same channel is in the last UDP frame
-        // sent every time that this is called (and
-        // potentially discarded by a CA server with
-        // a small UDP input queue). 
-        //
-        // increase frames per try only if we see better than
-        // a 93.75% success rate for one pass through the list
-        //
-        if ( this->searchResponses >
-            ( this->searchAttempts - (this->searchAttempts/16u) ) ) {
-            // increase UDP frames per try if we have a good score
-            if ( this->framesPerTry < maxTriesPerFrame ) {
-                // a congestion avoidance threshold similar to TCP is now used
-                if ( this->framesPerTry < this->framesPerTryCongestThresh ) {
-                    this->framesPerTry += this->framesPerTry;
-                }
-                else {
-                    this->framesPerTry += (this->framesPerTry/8) + 1;
-                }
-                debugPrintf ( ("Increasing frame count to %u t=%u r=%u\n", 
-                    this->framesPerTry, this->searchAttempts, this->searchResponses) );
-            }
-        }
-        // if we detect congestion because we have less than a 87.5% success 
-        // rate then gradually reduce the frames per try
-        else if ( this->searchResponses < 
-            ( this->searchAttempts - (this->searchAttempts/8u) ) ) {
-            if ( this->framesPerTry > 1 ) {
-                this->framesPerTry--;
-            }
-            this->framesPerTryCongestThresh = this->framesPerTry/2 + 1;
-            debugPrintf ( ("Congestion detected - set frames per try to %f t=%u r=%u\n", 
-                this->framesPerTry, this->searchAttempts, this->searchResponses) );
-        }
-#else
-        if ( this->searchResponses == this->searchAttempts ) {
-            // increase UDP frames per try if we have a good score
-            if ( this->framesPerTry < maxTriesPerFrame ) {
-                // a congestion avoidance threshold similar to TCP is now used
-                if ( this->framesPerTry < this->framesPerTryCongestThresh ) {
-                    double doubled = 2 * this->framesPerTry;
-                    if ( doubled > this->framesPerTryCongestThresh ) {
-                        this->framesPerTry = this->framesPerTryCongestThresh;
-                    }
-                    else {
-                        this->framesPerTry = doubled;
-                    }
-                }
-                else {
-                    this->framesPerTry += 1.0 / this->framesPerTry;
-                }
-                debugPrintf ( ("Increasing frame count to %g t=%u r=%u\n", 
-                    this->framesPerTry, this->searchAttempts, this->searchResponses) );
-            }
+    //
+    // dynamically adjust the number of UDP frames per 
+    // try depending how many search requests were 
+    // replied to, and how long that took
+    //
+    // If this value is too high we will waste some
+    // network bandwidth, and overflow the UDP input
+    // queue of the CA servers. If it is too low we will
+    // use very little of that queue and will therefore
+    // take longer to connect.
+    //
+    {
+        double meanRTT = 0.0;
+        if ( this->searchResponses ) {
+            meanRTT = this->searchRespRTT / this->searchResponses;
         }
-        else  {
-            this->framesPerTryCongestThresh = this->framesPerTry / 2.0;
-            this->framesPerTry = 1u;
-            debugPrintf ( ("Congestion detected - set frames per try to %g t=%u r=%u\n", 
-                this->framesPerTry, this->searchAttempts, this->searchResponses) );
+        this->window.roundComplete ( this->framesSent, 
+            this->searchAttempts, this->searchResponses, meanRTT );
+        if ( this->searchAttempts ) {
+            debugPrintf ( ("Search frames per try %g t=%u r=%u\n", 
+                this->window.framesPerTry (), this->searchAttempts, 
+                this->searchResponses) );
         }
-#endif
     }
 
     this->dgSeqNoAtTimerExpireBegin = 
@@ -232,6 +173,7 @@ epicsTimerNotify::expireStatus searchTimer::expire (
 
     this->searchAttempts = 0;
     this->searchResponses = 0;
+    this->searchRespRTT = 0.0;
 
     unsigned nFrameSent = 0u;
     while ( true ) {
@@ -247,7 +189,7 @@ epicsTimerNotify::expireStatus searchTimer::expire (
         if ( ! success ) {
             if ( this->iiu.datagramFlush ( guard, currentTime ) ) {
                 nFrameSent++;
-                if ( nFrameSent < this->framesPerTry ) {
+                if ( nFrameSent < this->window.framesPerTry () ) {
                     success = pChan->searchMsg ( guard );
                 }
             }
@@ -275,6 +217,7 @@ epicsTimerNotify::expireStatus searchTimer::expire (
 
     this->dgSeqNoAtTimerExpireEnd = 
         this->iiu.datagramSeqNumber ( guard ) - 1u;
+    this->framesSent = nFrameSent;
 
 #   ifdef DEBUG
         if ( this->searchAttempts ) {
@@ -292,6 +235,7 @@ void searchTimer :: show ( unsigned level ) const
 {
     epicsGuard < epicsMutex > guard ( this->mutex );
     ::printf ( "searchTimer with period %f\n", this->period ( guard ) );
+    this->window.show ( level );
     if ( level > 0 ) {
         ::printf ( "channels with search request pending = %u\n", 
             this->chanListReqPending.count () );
@@ -316,6 +260,22 @@ void searchTimer :: show ( unsigned level ) const
     }
 }
 
+//
+// summary of the search window, if this timer is in use
+//
+void searchTimer :: showWindow ( 
+    epicsGuard < epicsMutex > & guard, unsigned level ) const
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    unsigned nChan = this->chanListReqPending.count () + 
+        this->chanListRespPending.count ();
+    if ( nChan ) {
+        ::printf ( "\tsearch timer %u: %u channels, period %f, ", 
+            this->index, nChan, this->period ( guard ) );
+        this->window.show ( level );
+    }
+}
+
 //
 // Reset the delay to the next search request if we get
 // at least one response. However, dont reset this delay if we
@@ -348,6 +308,7 @@ void searchTimer::uninstallChanDueToSuccessfulSearchResponse (
 
         if ( this->searchResponses < UINT_MAX ) {
             this->searchResponses++;
+            this->searchRespRTT += measured;
             if ( this->searchResponses == this->searchAttempts ) {
                 if ( this->chanListReqPending.count () ) {
                     //
@@ -42,6 +42,7 @@
 
 #include "caProto.h"
 #include "netiiu.h"
+#include "searchWindow.h"
 
 class searchTimerNotify {
 public:
@@ -81,6 +82,7 @@ public:
         ca_uint32_t respDatagramSeqNo, bool seqNumberIsValid, 
         const epicsTime & currentTime );
     void show ( unsigned level ) const;
+    void showWindow ( epicsGuard < epicsMutex > &, unsigned level ) const;
 private:
     tsDLList < nciu > chanListReqPending;
     tsDLList < nciu > chanListRespPending;
@@ -88,11 +90,12 @@ private:
     epicsTimer & timer;
     searchTimerNotify & iiu;
     epicsMutex & mutex;
-    double framesPerTry; /* # of UDP frames per search try */
-    double framesPerTryCongestThresh; /* one half N tries w congest */
+    searchWindow window;
+    double searchRespRTT; /* sum of search resp RTT after last timer experation */
     unsigned retry;
     unsigned searchAttempts; /* num search tries after last timer experation */
     unsigned searchResponses; /* num search resp after last timer experation */
+    unsigned framesSent; /* num UDP frames sent by last timer experation */
     const unsigned index;
     ca_uint32_t dgSeqNoAtTimerExpireBegin; 
     ca_uint32_t dgSeqNoAtTimerExpireEnd;
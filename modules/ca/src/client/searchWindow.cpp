@@ -0,0 +1,111 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+//
+// UDP search congestion window
+//
+
+#include <stdio.h>
+#include <float.h>
+
+#define epicsExportSharedSymbols
+#include "searchWindow.h"
+
+const double searchWindow::initialFramesPerTry = 1.0;
+const double searchWindow::maxFramesPerTry = 64.0;
+
+// the round trip time may grow by this much, plus the least
+// round trip time seen, before we assume that requests are
+// queued (the shortest search period)
+static const double queuingSlack = 32e-3; // seconds
+
+searchWindow::searchWindow () :
+    frames ( initialFramesPerTry ),
+    thresh ( DBL_MAX ),
+    minRTT ( DBL_MAX ),
+    lastRTT ( 0.0 ),
+    lastAttempts ( 0u ),
+    lastResponses ( 0u ),
+    nBackoff ( 0u )
+{
+}
+
+//
+// called by the search timer before it sends the next try with
+// the results of the last one
+//
+void searchWindow::roundComplete ( unsigned framesSent,
+    unsigned attempts, unsigned responses, double meanRTT )
+{
+    if ( attempts == 0u ) {
+        return;
+    }
+    this->lastAttempts = attempts;
+    this->lastResponses = responses;
+
+    bool queuing = false;
+    if ( responses > 0u ) {
+        this->lastRTT = meanRTT;
+        if ( meanRTT < this->minRTT ) {
+            this->minRTT = meanRTT;
+        }
+        queuing = meanRTT > 2.0 * this->minRTT + queuingSlack;
+    }
+
+    //
+    // a few unanswered requests are expected, channels that
+    // don't exist yet or that a server was slow to answer, so
+    // back off only if less than 87.5% were answered, and
+    // grow only if more than 93.75% were
+    //
+    if ( responses < attempts - attempts / 8u ) {
+        this->thresh = this->frames / 2.0;
+        if ( this->thresh < initialFramesPerTry ) {
+            this->thresh = initialFramesPerTry;
+        }
+        this->frames = this->thresh;
+        this->nBackoff++;
+    }
+    else if ( responses >= attempts - attempts / 16u ) {
+        if ( queuing ) {
+            // stop slow start, but keep the window
+            if ( this->thresh > this->frames ) {
+                this->thresh = this->frames;
+            }
+        }
+        else if ( framesSent >= this->frames ) {
+            // grow only if the window was used
+            if ( this->frames < this->thresh ) {
+                this->frames += this->frames;
+                if ( this->frames > this->thresh ) {
+                    this->frames = this->thresh;
+                }
+            }
+            else {
+                this->frames += 1.0;
+            }
+            if ( this->frames > maxFramesPerTry ) {
+                this->frames = maxFramesPerTry;
+            }
+        }
+    }
+}
+
+void searchWindow::show ( unsigned level ) const
+{
+    ::printf ( "search window %g frames", this->frames );
+    if ( this->thresh < DBL_MAX ) {
+        ::printf ( ", threshold %g", this->thresh );
+    }
+    ::printf ( ", last try %u of %u answered\n",
+        this->lastResponses, this->lastAttempts );
+    if ( level > 0u ) {
+        ::printf ( "\tsearch RTT %f sec", this->lastRTT );
+        if ( this->minRTT < DBL_MAX ) {
+            ::printf ( ", least %f sec", this->minRTT );
+        }
+        ::printf ( ", %u back offs\n", this->nBackoff );
+    }
+}
@@ -0,0 +1,50 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+//
+// UDP search congestion window
+//
+// The number of UDP frames that a search timer sends each time that
+// it expires. Similar to TCP, the window grows exponentially (slow
+// start) until the congestion threshold, and linearly after that. It is
+// halved when too many search requests aren't answered, and stops
+// growing while the round trip time of the responses shows that
+// requests are queuing somewhere on the way.
+//
+
+#ifndef searchWindowh
+#define searchWindowh
+
+class searchWindow {
+public:
+    searchWindow ();
+    void roundComplete ( unsigned framesSent, unsigned attempts,
+        unsigned responses, double meanRTT );
+    double framesPerTry () const;
+    double congestThresh () const;
+    void show ( unsigned level ) const;
+    static const double initialFramesPerTry;
+    static const double maxFramesPerTry;
+private:
+    double frames; // # of UDP frames per search try
+    double thresh; // end of slow start
+    double minRTT; // least round mean RTT, nothing queued
+    double lastRTT;
+    unsigned lastAttempts;
+    unsigned lastResponses;
+    unsigned nBackoff;
+};
+
+inline double searchWindow::framesPerTry () const
+{
+    return this->frames;
+}
+
+inline double searchWindow::congestThresh () const
+{
+    return this->thresh;
+}
+
+#endif // ifdef searchWindowh
@@ -29,6 +29,11 @@
 
 #include <stdlib.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#   define CA_USE_IOVEC // vectored socket IO with writev() and readv()
+#   include <sys/uio.h>
+#endif
+
 #include "errlog.h"
 
 #define epicsExportSharedSymbols
@@ -229,17 +234,58 @@ void tcpSendThread::run ()
     this->iiu.cacRef.destroyIIU ( this->iiu );
 }
 
-unsigned tcpiiu::sendBytes ( const void *pBuf, 
-    unsigned nBytesInBuf, const epicsTime & currentTime )
+//
+// One system call moving as many of the blocks as the socket 
+// library allows. Where there is no vectored IO that is only 
+// the first block, and the caller comes back for the rest.
+//
+static int sendWireBufs ( SOCKET sock, 
+    const wireBuf * pBufs, unsigned nBufs )
+{
+#ifdef CA_USE_IOVEC
+    struct iovec iov [ comBufMaxVector ];
+    assert ( nBufs <= comBufMaxVector );
+    for ( unsigned i = 0u; i < nBufs; i++ ) {
+        iov[i].iov_base = pBufs[i].pBuf;
+        iov[i].iov_len = pBufs[i].nBytes;
+    }
+    return static_cast < int > ( 
+        ::writev ( sock, iov, static_cast < int > ( nBufs ) ) );
+#else
+    assert ( nBufs > 0u && pBufs[0].nBytes <= INT_MAX );
+    return ::send ( sock, static_cast < const char * > ( pBufs[0].pBuf ), 
+        static_cast < int > ( pBufs[0].nBytes ), 0 );
+#endif
+}
+
+static int recvWireBufs ( SOCKET sock, 
+    const wireBuf * pBufs, unsigned nBufs )
+{
+#ifdef CA_USE_IOVEC
+    struct iovec iov [ comBufMaxVector ];
+    assert ( nBufs <= comBufMaxVector );
+    for ( unsigned i = 0u; i < nBufs; i++ ) {
+        iov[i].iov_base = pBufs[i].pBuf;
+        iov[i].iov_len = pBufs[i].nBytes;
+    }
+    return static_cast < int > ( 
+        ::readv ( sock, iov, static_cast < int > ( nBufs ) ) );
+#else
+    assert ( nBufs > 0u && pBufs[0].nBytes <= INT_MAX );
+    return ::recv ( sock, static_cast < char * > ( pBufs[0].pBuf ), 
+        static_cast < int > ( pBufs[0].nBytes ), 0 );
+#endif
+}
+
+unsigned tcpiiu::sendBytes ( const wireBuf * pBufs, 
+    unsigned nBufs, const epicsTime & currentTime )
 {
     unsigned nBytes = 0u;
-    assert ( nBytesInBuf <= INT_MAX );
 
     this->sendDog.start ( currentTime );
 
     while ( true ) {
-        int status = ::send ( this->sock, 
-            static_cast < const char * > (pBuf), (int) nBytesInBuf, 0 );
+        int status = sendWireBufs ( this->sock, pBufs, nBufs );
         if ( status > 0 ) {
             nBytes = static_cast <unsigned> ( status );
             // printf("SEND: %u\n", nBytes );
@@ -298,17 +344,13 @@ unsigned tcpiiu::sendBytes ( const void *pBuf,
 }
 
 void tcpiiu::recvBytes ( 
-        void * pBuf, unsigned nBytesInBuf, statusWireIO & stat )
+        const wireBuf * pBufs, unsigned nBufs, statusWireIO & stat )
 {
-    assert ( nBytesInBuf <= INT_MAX );
-
     while ( true ) {
-        int status = ::recv ( this->sock, static_cast <char *> ( pBuf ), 
-            static_cast <int> ( nBytesInBuf ), 0 );
+        int status = recvWireBufs ( this->sock, pBufs, nBufs );
 
         if ( status > 0 ) {
             stat.bytesCopied = static_cast <unsigned> ( status );
-            assert ( stat.bytesCopied <= nBytesInBuf );
             stat.circuitState = swioConnected;
             return;
         }
@@ -459,7 +501,10 @@ void tcpRecvThread::run ()
         epicsThreadPrivateSet ( caClientCallbackThreadId, &this->iiu );
         this->iiu.cacRef.attachToClientCtx ();
 
-        comBuf * pComBuf = 0;
+        // empty buffers waiting to be filled by the next receive
+        comBuf * pComBufs [ comBufMaxVector ];
+        unsigned nComBufs = 0u;
+        unsigned nBufsFilled = 0u;
         while ( true ) {
 
             //
@@ -469,12 +514,13 @@ void tcpRecvThread::run ()
             // file manager call backs works correctly. This does not 
             // appear to impact performance.
             //
-            if ( ! pComBuf ) {
-                pComBuf = new ( this->iiu.comBufMemMgr ) comBuf;
+            while ( nComBufs < this->iiu.ioBufCount ) {
+                pComBufs[nComBufs] = new ( this->iiu.comBufMemMgr ) comBuf;
+                nComBufs++;
             }
 
             statusWireIO stat;
-            pComBuf->fillFromWire ( this->iiu, stat );
+            comBuf::fillFromWire ( pComBufs, nComBufs, this->iiu, stat );
 
             epicsTime currentTime = epicsTime::getCurrent ();
 
@@ -488,8 +534,18 @@ void tcpRecvThread::run ()
                     continue;
                 }
 
-                this->iiu.recvQue.pushLastComBufReceived ( *pComBuf );
-                pComBuf = 0;
+                // the buffers are filled in order, keep the empty ones
+                nBufsFilled = 0u;
+                while ( nBufsFilled < nComBufs && 
+                        pComBufs[nBufsFilled]->uncommittedBytes () ) {
+                    this->iiu.recvQue.pushLastComBufReceived ( 
+                        *pComBufs[nBufsFilled] );
+                    nBufsFilled++;
+                }
+                for ( unsigned i = nBufsFilled; i < nComBufs; i++ ) {
+                    pComBufs[i - nBufsFilled] = pComBufs[i];
+                }
+                nComBufs -= nBufsFilled;
 
                 this->iiu._receiveThreadIsBusy = true;
             }
@@ -547,7 +603,8 @@ void tcpRecvThread::run ()
                 epicsGuard < epicsMutex > guard ( this->iiu.mutex );
                 if ( bytesArePending ) {
                     if ( ! this->iiu.busyStateDetected ) {
-                        this->iiu.contigRecvMsgCount++;
+                        // count buffers, not calls, as before vectored IO
+                        this->iiu.contigRecvMsgCount += nBufsFilled;
                         if ( this->iiu.contigRecvMsgCount >= 
                             this->iiu.cacRef.maxContiguousFrames ( guard ) ) {
                             this->iiu.busyStateDetected = true;
@@ -572,9 +629,9 @@ void tcpRecvThread::run ()
             }
         }
 
-        if ( pComBuf ) {
-            pComBuf->~comBuf ();
-            this->iiu.comBufMemMgr.release ( pComBuf );
+        for ( unsigned i = 0u; i < nComBufs; i++ ) {
+            pComBufs[i]->~comBuf ();
+            this->iiu.comBufMemMgr.release ( pComBufs[i] );
         }
     }
     catch ( std::bad_alloc & ) {
@@ -702,6 +759,7 @@ tcpiiu::tcpiiu (
     socketLibrarySendBufferSize ( 0x1000 ),
     unacknowledgedSendBytes ( 0u ),
     channelCountTot ( 0u ),
+    ioBufCount ( cac.tcpIOBufs () ),
     _receiveThreadIsBusy ( false ),
     busyStateDetected ( false ),
     flowControlActive ( false ),
@@ -1668,20 +1726,38 @@ bool tcpiiu::sendThreadFlush ( epicsGuard < epicsMutex > & guard )
     guard.assertIdenticalMutex ( this->mutex );
 
     if ( this->sendQue.occupiedBytes() > 0 ) {
-        while ( comBuf * pBuf = this->sendQue.popNextComBufToSend () ) {
+        comBuf * pBufs [ comBufMaxVector ];
+        while ( true ) {
+            // gather up to ioBufCount buffers for each system call
+            unsigned nBufs = 0u;
+            unsigned bytesToBeSent = 0u;
+            while ( nBufs < this->ioBufCount ) {
+                comBuf * pBuf = this->sendQue.popNextComBufToSend ();
+                if ( ! pBuf ) {
+                    break;
+                }
+                bytesToBeSent += pBuf->occupiedBytes ();
+                pBufs[nBufs++] = pBuf;
+            }
+            if ( nBufs == 0u ) {
+                break;
+            }
+
             epicsTime current = epicsTime::getCurrent ();
 
-            unsigned bytesToBeSent = pBuf->occupiedBytes ();
             bool success = false;
             {
                 // no lock while blocking to send
                 epicsGuardRelease < epicsMutex > unguard ( guard );
-                success = pBuf->flushToWire ( *this, current );
-                pBuf->~comBuf ();
-                this->comBufMemMgr.release ( pBuf );
+                success = comBuf::flushToWire ( pBufs, nBufs, *this, current );
+                for ( unsigned i = 0u; i < nBufs; i++ ) {
+                    pBufs[i]->~comBuf ();
+                    this->comBufMemMgr.release ( pBufs[i] );
+                }
             }
 
             if ( ! success ) {
+                comBuf * pBuf;
                 while ( ( pBuf = this->sendQue.popNextComBufToSend () ) ) {
                     pBuf->~comBuf ();
                     this->comBufMemMgr.release ( pBuf );
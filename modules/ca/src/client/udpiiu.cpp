@@ -1135,6 +1135,11 @@ void udpiiu :: show ( unsigned level ) const
     epicsGuard < epicsMutex > guard ( this->cacMutex );
 
     ::printf ( "Datagram IO circuit (and disconnected channel repository)\n");
+    ::printf ( "\tsearch round trip estimate %f sec\n",
+        this->getRTTE ( guard ) );
+    for ( unsigned i =0; i < this->nTimers; i++ ) {
+        this->ppSearchTmr[i]->showWindow ( guard, level );
+    }
     if ( level > 1u ) {
         ::printf ("\trepeater port %u\n", this->repeaterPort );
         ::printf ("\tdefault server port %u\n", this->serverPort );
@@ -245,6 +245,7 @@ private:
     unsigned socketLibrarySendBufferSize;
     unsigned unacknowledgedSendBytes;
     unsigned channelCountTot;
+    unsigned ioBufCount; // comBufs per send or receive call
     bool _receiveThreadIsBusy;
     bool busyStateDetected; // only modified by the recv thread
     bool flowControlActive; // only modified by the send process thread
@@ -259,10 +260,10 @@ private:
 
     bool processIncoming ( 
         const epicsTime & currentTime, callbackManager & );
-    unsigned sendBytes ( const void *pBuf, 
-        unsigned nBytesInBuf, const epicsTime & currentTime );
+    unsigned sendBytes ( const wireBuf * pBufs, 
+        unsigned nBufs, const epicsTime & currentTime );
     void recvBytes ( 
-        void * pBuf, unsigned nBytesInBuf, statusWireIO & );
+        const wireBuf * pBufs, unsigned nBufs, statusWireIO & );
     const char * pHostName (
         epicsGuard < epicsMutex > & ) const throw ();
     double receiveWatchdogDelay (
@@ -0,0 +1,93 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure the speed of caNetConvert() for the array payloads of the
+ * plain, sts and time DBR types, in both directions. caConvertTest
+ * checks the results.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "epicsEndian.h"
+#include "epicsTime.h"
+#include "net_convert.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static const struct {
+    unsigned type;
+    const char *name;
+} types[] = {
+    {DBR_SHORT, "DBR_SHORT"},
+    {DBR_ENUM, "DBR_ENUM"},
+    {DBR_LONG, "DBR_LONG"},
+    {DBR_FLOAT, "DBR_FLOAT"},
+    {DBR_DOUBLE, "DBR_DOUBLE"},
+    {DBR_STS_SHORT, "DBR_STS_SHORT"},
+    {DBR_STS_LONG, "DBR_STS_LONG"},
+    {DBR_STS_FLOAT, "DBR_STS_FLOAT"},
+    {DBR_STS_DOUBLE, "DBR_STS_DOUBLE"},
+    {DBR_TIME_SHORT, "DBR_TIME_SHORT"},
+    {DBR_TIME_ENUM, "DBR_TIME_ENUM"},
+    {DBR_TIME_LONG, "DBR_TIME_LONG"},
+    {DBR_TIME_FLOAT, "DBR_TIME_FLOAT"},
+    {DBR_TIME_DOUBLE, "DBR_TIME_DOUBLE"},
+};
+
+static void benchType(unsigned type, const char *name, size_t count,
+    size_t niter)
+{
+    size_t nBytes = dbr_size_n(type, count);
+    void *pSrc = callocMustSucceed(1, nBytes, "benchType");
+    void *pDest = callocMustSucceed(1, nBytes, "benchType");
+    int hton;
+
+    for (hton = 0; hton <= 1; hton++) {
+        double best = 0.0;
+        unsigned rep;
+
+        /* the best of several, to reduce the effect of other work */
+        for (rep = 0; rep < 5; rep++) {
+            epicsTimeStamp start, stop;
+            double secs;
+            size_t i;
+
+            epicsTimeGetCurrent(&start);
+            for (i = 0; i < niter; i++)
+                caNetConvert(type, pSrc, pDest, hton, count);
+            epicsTimeGetCurrent(&stop);
+
+            secs = epicsTimeDiffInSeconds(&stop, &start);
+            if (rep == 0 || secs < best)
+                best = secs;
+        }
+        testDiag("%-16s %s %8lu elements %7.2f GB/s", name,
+                 hton ? "hton" : "ntoh", (unsigned long)count,
+                 (double)nBytes * niter / best / 1e9);
+    }
+
+    free(pSrc);
+    free(pDest);
+}
+
+MAIN(benchcaConvert)
+{
+    unsigned i;
+
+    testPlan(0);
+
+    /* in cache, and much larger than the cache */
+    for (i = 0; i < NELEMENTS(types); i++)
+        benchType(types[i].type, types[i].name, 4096, 5000);
+    for (i = 0; i < NELEMENTS(types); i++)
+        benchType(types[i].type, types[i].name, 4000000, 5);
+
+    return testDone();
+}
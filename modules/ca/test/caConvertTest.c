@@ -0,0 +1,126 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Check that caNetConvert() converts the array payloads of the plain,
+ * sts and time DBR types correctly in both directions, at every length
+ * that reaches the vector loops and their tails.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "epicsEndian.h"
+#include "net_convert.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static const struct {
+    unsigned type;
+    const char *name;
+} types[] = {
+    {DBR_SHORT, "DBR_SHORT"},
+    {DBR_ENUM, "DBR_ENUM"},
+    {DBR_LONG, "DBR_LONG"},
+    {DBR_FLOAT, "DBR_FLOAT"},
+    {DBR_DOUBLE, "DBR_DOUBLE"},
+    {DBR_STS_SHORT, "DBR_STS_SHORT"},
+    {DBR_STS_LONG, "DBR_STS_LONG"},
+    {DBR_STS_FLOAT, "DBR_STS_FLOAT"},
+    {DBR_STS_DOUBLE, "DBR_STS_DOUBLE"},
+    {DBR_TIME_SHORT, "DBR_TIME_SHORT"},
+    {DBR_TIME_ENUM, "DBR_TIME_ENUM"},
+    {DBR_TIME_LONG, "DBR_TIME_LONG"},
+    {DBR_TIME_FLOAT, "DBR_TIME_FLOAT"},
+    {DBR_TIME_DOUBLE, "DBR_TIME_DOUBLE"},
+};
+
+/* network order byte i of element j of the reference values */
+static unsigned char refByte(size_t j, unsigned i)
+{
+    return (unsigned char)(j * 7u + i * 31u + 1u);
+}
+
+static void fillNet(unsigned char *pValue, size_t elemSize, size_t count)
+{
+    size_t j;
+    unsigned i;
+
+    for (j = 0; j < count; j++)
+        for (i = 0; i < elemSize; i++)
+            pValue[j * elemSize + i] = refByte(j, i);
+}
+
+static int checkHost(const unsigned char *pValue, size_t elemSize,
+    size_t count)
+{
+    size_t j;
+    unsigned i;
+
+    for (j = 0; j < count; j++) {
+        for (i = 0; i < elemSize; i++) {
+#if EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG
+            unsigned k = i;
+#else
+            unsigned k = (unsigned)elemSize - 1u - i;
+#endif
+            if (pValue[j * elemSize + k] != refByte(j, i))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* every count from 1 to 70 covers the vector loops and their tails */
+static void testType(unsigned type, const char *name)
+{
+    size_t elemSize = dbr_value_size[type];
+    size_t offset = dbr_value_offset[type];
+    size_t maxBytes = dbr_size_n(type, 70);
+    unsigned char *pNet = callocMustSucceed(1, maxBytes, "testType");
+    unsigned char *pHost = callocMustSucceed(1, maxBytes, "testType");
+    unsigned char *pBack = callocMustSucceed(1, maxBytes, "testType");
+    int toHost = 1, inPlace = 1, toNet = 1;
+    unsigned count;
+
+    for (count = 1; count <= 70; count++) {
+        size_t nBytes = dbr_size_n(type, count);
+
+        memset(pNet, 0, maxBytes);
+        fillNet(pNet + offset, elemSize, count);
+
+        caNetConvert(type, pNet, pHost, 0, count);
+        toHost &= checkHost(pHost + offset, elemSize, count);
+
+        caNetConvert(type, pHost, pBack, 1, count);
+        toNet &= !memcmp(pNet + offset, pBack + offset, elemSize * count);
+
+        caNetConvert(type, pBack, pBack, 0, count);
+        inPlace &= !memcmp(pHost + offset, pBack + offset,
+                           nBytes - offset);
+    }
+    testOk(toHost, "%s network to host", name);
+    testOk(toNet, "%s host to network", name);
+    testOk(inPlace, "%s in place", name);
+
+    free(pNet);
+    free(pHost);
+    free(pBack);
+}
+
+MAIN(caConvertTest)
+{
+    unsigned i;
+
+    testPlan(3 * NELEMENTS(types));
+
+    for (i = 0; i < NELEMENTS(types); i++)
+        testType(types[i].type, types[i].name);
+
+    return testDone();
+}
@@ -0,0 +1,118 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+// searchWindowTest.cpp
+//  Exercise the UDP search congestion window
+
+#include <float.h>
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#include "searchWindow.h"
+
+static const double rtt = 1e-3;
+
+// one try that uses the whole window, all answered
+static void fullTry ( searchWindow & win, double meanRTT = rtt )
+{
+    unsigned frames = static_cast < unsigned > ( win.framesPerTry () + 0.999 );
+    win.roundComplete ( frames, 50u * frames, 50u * frames, meanRTT );
+}
+
+static void testSlowStart ()
+{
+    searchWindow win;
+
+    testDiag ( "slow start" );
+    testOk ( win.framesPerTry () == searchWindow::initialFramesPerTry,
+        "starts with %g frame", win.framesPerTry () );
+    testOk1 ( win.congestThresh () == DBL_MAX );
+
+    win.roundComplete ( 1u, 0u, 0u, 0.0 );
+    testOk ( win.framesPerTry () == 1.0, "unchanged by an empty try" );
+
+    fullTry ( win );
+    testOk ( win.framesPerTry () == 2.0, "doubled to %g", win.framesPerTry () );
+    fullTry ( win );
+    fullTry ( win );
+    testOk ( win.framesPerTry () == 8.0, "doubled to %g", win.framesPerTry () );
+
+    win.roundComplete ( 1u, 10u, 10u, rtt );
+    testOk ( win.framesPerTry () == 8.0,
+        "unchanged if the window wasn't used (%g)", win.framesPerTry () );
+
+    for ( unsigned i = 0u; i < 10u; i++ ) {
+        fullTry ( win );
+    }
+    testOk ( win.framesPerTry () == searchWindow::maxFramesPerTry,
+        "limited to %g", win.framesPerTry () );
+}
+
+static void testBackoff ()
+{
+    searchWindow win;
+
+    testDiag ( "congestion" );
+    for ( unsigned i = 0u; i < 4u; i++ ) {
+        fullTry ( win );
+    }
+    testOk1 ( win.framesPerTry () == 16.0 );
+
+    // 80% answered
+    win.roundComplete ( 16u, 800u, 640u, rtt );
+    testOk ( win.framesPerTry () == 8.0, "halved to %g", win.framesPerTry () );
+    testOk ( win.congestThresh () == 8.0, "threshold %g",
+        win.congestThresh () );
+
+    fullTry ( win );
+    testOk ( win.framesPerTry () == 9.0, "linear growth to %g",
+        win.framesPerTry () );
+
+    // 90% answered
+    win.roundComplete ( 9u, 450u, 405u, rtt );
+    testOk ( win.framesPerTry () == 9.0, "held at %g", win.framesPerTry () );
+
+    // 95% answered, some channels don't exist
+    win.roundComplete ( 9u, 450u, 428u, rtt );
+    testOk ( win.framesPerTry () == 10.0, "grew to %g", win.framesPerTry () );
+
+    for ( unsigned i = 0u; i < 8u; i++ ) {
+        win.roundComplete ( 10u, 500u, 0u, 0.0 );
+    }
+    testOk ( win.framesPerTry () == searchWindow::initialFramesPerTry,
+        "no less than %g", win.framesPerTry () );
+    testOk ( win.congestThresh () == searchWindow::initialFramesPerTry,
+        "threshold %g", win.congestThresh () );
+}
+
+static void testQueuing ()
+{
+    searchWindow win;
+
+    testDiag ( "queuing" );
+    fullTry ( win );
+    fullTry ( win );
+    testOk1 ( win.framesPerTry () == 4.0 );
+
+    fullTry ( win, 2.0 * rtt + 40e-3 );
+    testOk ( win.framesPerTry () == 4.0,
+        "held at %g by a longer RTT", win.framesPerTry () );
+    testOk ( win.congestThresh () == 4.0, "slow start ended at %g",
+        win.congestThresh () );
+
+    fullTry ( win, 2.0 * rtt );
+    testOk ( win.framesPerTry () == 5.0,
+        "linear growth to %g with a small increase in RTT",
+        win.framesPerTry () );
+}
+
+MAIN ( searchWindowTest )
+{
+    testPlan ( 19 );
+    testSlowStart ();
+    testBackoff ();
+    testQueuing ();
+    return testDone ();
+}
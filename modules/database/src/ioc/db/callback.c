@@ -25,9 +25,10 @@
 #include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsInterrupt.h"
-#include "epicsRingPointer.h"
+#include "epicsRingBytes.h"
 #include "epicsString.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "epicsTimer.h"
 #include "errlog.h"
 #include "errMdef.h"
@@ -50,13 +51,34 @@
 
 static int callbackQueueSize = 2000;
 
-typedef struct cbQueueSet {
+/* Each callback thread has its own queue.  Requests with the same user
+ * argument go to the same queue, and idle threads take requests from the
+ * queues of busy ones.
+ */
+typedef struct cbEntry {
+    CALLBACK *pcallback;
+    epicsUInt64 queued;     /* epicsMonotonicGet(), 0 if not known */
+} cbEntry;
+
+typedef struct cbWorker {
+    struct cbQueueSet *set;
+    int index;
     epicsEventId semWakeUp;
-    epicsRingPointerId queue;
+    epicsRingBytesId queue;
+    int idle;               /* waiting, or about to wait */
+    /* the counters are updated by other threads, use epicsAtomic */
+    int highWaterMark;      /* entries */
+    size_t nStolen;         /* entries run by other threads */
+    double maxLatency;      /* seconds from request to run */
+} cbWorker;
+
+typedef struct cbQueueSet {
+    cbWorker *workers;
     int queueOverflow;
     int shutdown;
     int threadsConfigured;
     int threadsRunning;
+    size_t nOverflow;       /* epicsAtomic */
 } cbQueueSet;
 
 static cbQueueSet callbackQueue[NUM_CALLBACK_PRIORITIES];
@@ -90,7 +112,6 @@ static unsigned int threadPriority[NUM_CALLBACK_PRIORITIES] = {
     epicsThreadPriorityScanLow + 4,
     epicsThreadPriorityScanHigh + 1
 };
-static int priorityValue[NUM_CALLBACK_PRIORITIES] = {0, 1, 2};
 
 
 int callbackSetQueueSize(int size)
@@ -153,26 +174,78 @@ found:
     return 0;
 }
 
+/* Wake an idle thread other than skip, if there is one */
+static void callbackWakeIdle(cbQueueSet *mySet, int skip)
+{
+    int n = mySet->threadsConfigured;
+    int i;
+
+    for (i = 1; i < n; i++) {
+        cbWorker *pw = &mySet->workers[(skip + i) % n];
+
+        if (epicsAtomicGetIntT(&pw->idle)) {
+            epicsEventSignal(pw->semWakeUp);
+            return;
+        }
+    }
+}
+
+/* Take the next entry for worker pw, from its own queue if possible */
+static int callbackTake(cbWorker *pw, cbEntry *pent)
+{
+    cbQueueSet *mySet = pw->set;
+    int n = mySet->threadsConfigured;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        cbWorker *pvictim = &mySet->workers[(pw->index + i) % n];
+
+        if (epicsRingBytesGet(pvictim->queue, (char *)pent, sizeof(cbEntry))
+            == sizeof(cbEntry)) {
+            if (i > 0)
+                epicsAtomicIncrSizeT(&pvictim->nStolen);
+            /* let another thread help with what is left */
+            if (n > 1 && !epicsRingBytesIsEmpty(pvictim->queue))
+                callbackWakeIdle(mySet, pw->index);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static void callbackTask(void *arg)
 {
-    int prio = *(int*)arg;
-    cbQueueSet *mySet = &callbackQueue[prio];
+    cbWorker *pw = (cbWorker *)arg;
+    cbQueueSet *mySet = pw->set;
 
     taskwdInsert(0, NULL, NULL);
     epicsEventSignal(startStopEvent);
 
     while(!mySet->shutdown) {
-        void *ptr;
-        if (epicsRingPointerIsEmpty(mySet->queue))
-            epicsEventMustWait(mySet->semWakeUp);
-
-        while ((ptr = epicsRingPointerPop(mySet->queue))) {
-            CALLBACK *pcallback = (CALLBACK *)ptr;
-            if(!epicsRingPointerIsEmpty(mySet->queue))
-                epicsEventMustTrigger(mySet->semWakeUp);
-            mySet->queueOverflow = FALSE;
-            (*pcallback->callback)(pcallback);
+        cbEntry ent;
+
+        if (!callbackTake(pw, &ent)) {
+            /* Look again after becoming idle.  With the barriers of
+             * the compare-and-swap here and of the add in
+             * callbackRequest() either the request is found, or the
+             * producer sees this thread idle and wakes it.
+             */
+            epicsAtomicCmpAndSwapIntT(&pw->idle, 0, 1);
+            if (!callbackTake(pw, &ent)) {
+                epicsEventMustWait(pw->semWakeUp);
+                epicsAtomicSetIntT(&pw->idle, 0);
+                continue;
+            }
+            epicsAtomicSetIntT(&pw->idle, 0);
         }
+        mySet->queueOverflow = FALSE;
+        if (ent.queued) {
+            double latency = (epicsMonotonicGet() - ent.queued) * 1e-9;
+
+            if (latency > pw->maxLatency)
+                pw->maxLatency = latency;
+        }
+        (*ent.pcallback->callback)(ent.pcallback);
     }
 
     if(!epicsAtomicDecrIntT(&mySet->threadsRunning))
@@ -180,6 +253,14 @@ static void callbackTask(void *arg)
     taskwdRemove(0);
 }
 
+static void callbackWakeAll(cbQueueSet *mySet)
+{
+    int j;
+
+    for (j = 0; j < mySet->threadsConfigured; j++)
+        epicsEventSignal(mySet->workers[j].semWakeUp);
+}
+
 void callbackStop(void)
 {
     int i;
@@ -189,14 +270,14 @@ void callbackStop(void)
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         callbackQueue[i].shutdown = 1;
-        epicsEventSignal(callbackQueue[i].semWakeUp);
+        callbackWakeAll(&callbackQueue[i]);
     }
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         cbQueueSet *mySet = &callbackQueue[i];
 
         while (epicsAtomicGetIntT(&mySet->threadsRunning)) {
-            epicsEventSignal(mySet->semWakeUp);
+            callbackWakeAll(mySet);
             epicsEventWaitWithTimeout(startStopEvent, 0.1);
         }
     }
@@ -208,10 +289,14 @@ void callbackCleanup(void)
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         cbQueueSet *mySet = &callbackQueue[i];
+        int j;
 
         assert(epicsAtomicGetIntT(&mySet->threadsRunning)==0);
-        epicsEventDestroy(mySet->semWakeUp);
-        epicsRingPointerDelete(mySet->queue);
+        for (j = 0; j < mySet->threadsConfigured; j++) {
+            epicsEventDestroy(mySet->workers[j].semWakeUp);
+            epicsRingBytesDelete(mySet->workers[j].queue);
+        }
+        free(mySet->workers);
     }
 
     epicsTimerQueueRelease(timerQueue);
@@ -237,41 +322,80 @@ void callbackInit(void)
     timerQueue = epicsTimerQueueAllocate(0, epicsThreadPriorityScanHigh);
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        cbQueueSet *mySet = &callbackQueue[i];
         epicsThreadId tid;
 
-        callbackQueue[i].semWakeUp = epicsEventMustCreate(epicsEventEmpty);
-        callbackQueue[i].queue = epicsRingPointerLockedCreate(callbackQueueSize);
-        if (callbackQueue[i].queue == 0)
-            cantProceed("epicsRingPointerLockedCreate failed for %s\n",
-                threadNamePrefix[i]);
-        callbackQueue[i].queueOverflow = FALSE;
-        if (callbackQueue[i].threadsConfigured == 0)
-            callbackQueue[i].threadsConfigured = callbackThreadsDefault;
-
-        for (j = 0; j < callbackQueue[i].threadsConfigured; j++) {
-            if (callbackQueue[i].threadsConfigured > 1 )
+        mySet->queueOverflow = FALSE;
+        if (mySet->threadsConfigured == 0)
+            mySet->threadsConfigured = callbackThreadsDefault;
+        mySet->workers = callocMustSucceed(mySet->threadsConfigured,
+            sizeof(cbWorker), "callbackInit");
+
+        for (j = 0; j < mySet->threadsConfigured; j++) {
+            cbWorker *pw = &mySet->workers[j];
+
+            pw->set = mySet;
+            pw->index = j;
+            pw->semWakeUp = epicsEventMustCreate(epicsEventEmpty);
+            pw->queue = epicsRingBytesLockedCreate(
+                callbackQueueSize * sizeof(cbEntry));
+            if (pw->queue == 0)
+                cantProceed("epicsRingBytesLockedCreate failed for %s\n",
+                    threadNamePrefix[i]);
+        }
+
+        for (j = 0; j < mySet->threadsConfigured; j++) {
+            if (mySet->threadsConfigured > 1 )
                 sprintf(threadName, "%s-%d", threadNamePrefix[i], j);
             else
                 strcpy(threadName, threadNamePrefix[i]);
             tid = epicsThreadCreate(threadName, threadPriority[i],
                 epicsThreadGetStackSize(epicsThreadStackBig),
-                (EPICSTHREADFUNC)callbackTask, &priorityValue[i]);
+                (EPICSTHREADFUNC)callbackTask, &mySet->workers[j]);
             if (tid == 0) {
                 cantProceed("Failed to spawn callback thread %s\n", threadName);
             } else {
                 epicsEventWait(startStopEvent);
-                epicsAtomicIncrIntT(&callbackQueue[i].threadsRunning);
+                epicsAtomicIncrIntT(&mySet->threadsRunning);
             }
         }
     }
 }
 
+/* Raise the high water mark of pw's queue to used entries */
+static void callbackHighWater(cbWorker *pw, int used)
+{
+    int mark = epicsAtomicGetIntT(&pw->highWaterMark);
+
+    while (used > mark) {
+        int prev = epicsAtomicCmpAndSwapIntT(&pw->highWaterMark, mark, used);
+
+        if (prev == mark)
+            break;
+        mark = prev;
+    }
+}
+
+/* The queue for requests with this user argument */
+static int callbackAffinity(CALLBACK *pcallback, int n)
+{
+    size_t key = (size_t)(pcallback->user ? pcallback->user : pcallback);
+
+    if (n == 1)
+        return 0;
+    key ^= key >> 16;
+    key *= 0x45d9f3b;
+    key ^= key >> 16;
+    return (int)(key % n);
+}
+
 /* This routine can be called from interrupt context */
 int callbackRequest(CALLBACK *pcallback)
 {
     int priority;
-    int pushOK;
     cbQueueSet *mySet;
+    cbEntry ent;
+    int n, first, i;
 
     if (!pcallback) {
         epicsInterruptContextMessage("callbackRequest: pcallback was NULL\n");
@@ -285,15 +409,72 @@ int callbackRequest(CALLBACK *pcallback)
     mySet = &callbackQueue[priority];
     if (mySet->queueOverflow) return S_db_bufFull;
 
-    pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    ent.pcallback = pcallback;
+    ent.queued = epicsInterruptIsInterruptContext() ? 0 : epicsMonotonicGet();
+
+    /* A full queue spills over to the other threads' queues */
+    n = mySet->threadsConfigured;
+    first = callbackAffinity(pcallback, n);
+    for (i = 0; i < n; i++) {
+        cbWorker *pw = &mySet->workers[(first + i) % n];
+        int used;
+
+        if (!epicsRingBytesPut(pw->queue, (char *)&ent, sizeof(cbEntry)))
+            continue;
+
+        used = epicsRingBytesUsedBytes(pw->queue) / sizeof(cbEntry);
+        callbackHighWater(pw, used);
+        epicsEventSignal(pw->semWakeUp);
+        /* If that thread is busy let an idle one take this request */
+        if (n > 1 && !epicsAtomicAddIntT(&pw->idle, 0))
+            callbackWakeIdle(mySet, pw->index);
+        return 0;
+    }
 
-    if (!pushOK) {
-        epicsInterruptContextMessage(fullMessage[priority]);
-        mySet->queueOverflow = TRUE;
-        return S_db_bufFull;
+    epicsInterruptContextMessage(fullMessage[priority]);
+    mySet->queueOverflow = TRUE;
+    epicsAtomicIncrSizeT(&mySet->nOverflow);
+    return S_db_bufFull;
+}
+
+void callbackQueueShow(const int reset)
+{
+    int i;
+
+    if (!callbackIsInit) {
+        printf("Callback system not initialized\n");
+        return;
+    }
+
+    printf("PRIORITY  THREAD  QUEUED   MAX  SIZE  STOLEN  MAX LATENCY\n");
+    for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        cbQueueSet *mySet = &callbackQueue[i];
+        size_t nOverflow = epicsAtomicGetSizeT(&mySet->nOverflow);
+        int j;
+
+        for (j = 0; j < mySet->threadsConfigured; j++) {
+            cbWorker *pw = &mySet->workers[j];
+            size_t nStolen = epicsAtomicGetSizeT(&pw->nStolen);
+
+            printf("%-8s  %6d  %6d  %4d  %4d  %6lu  %8.3f ms\n",
+                threadNamePrefix[i] + 2, j,
+                (int)(epicsRingBytesUsedBytes(pw->queue) / sizeof(cbEntry)),
+                epicsAtomicGetIntT(&pw->highWaterMark),
+                (int)(epicsRingBytesSize(pw->queue) / sizeof(cbEntry)),
+                (unsigned long)nStolen, pw->maxLatency * 1e3);
+            if (reset) {
+                /* don't lose what was counted since */
+                epicsAtomicSetIntT(&pw->highWaterMark, 0);
+                epicsAtomicSubSizeT(&pw->nStolen, nStolen);
+                pw->maxLatency = 0.0;
+            }
+        }
+        if (nOverflow)
+            printf("%-8s  %lu requests failed, all queues full\n",
+                threadNamePrefix[i] + 2, (unsigned long)nOverflow);
+        if (reset)
+            epicsAtomicSubSizeT(&mySet->nOverflow, nOverflow);
     }
-    epicsEventSignal(mySet->semWakeUp);
-    return 0;
 }
 
 static void ProcessCallback(CALLBACK *pcallback)
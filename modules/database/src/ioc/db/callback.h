@@ -74,6 +74,7 @@ epicsShareFunc void callbackRequestProcessCallbackDelayed(
     CALLBACK *pCallback, int Priority, void *pRec, double seconds);
 epicsShareFunc int callbackSetQueueSize(int size);
 epicsShareFunc int callbackParallelThreads(int count, const char *prio);
+epicsShareFunc void callbackQueueShow(const int reset);
 
 #ifdef __cplusplus
 }
@@ -484,6 +484,8 @@ long dbProcess(dbCommon *precord)
     int callNotifyCompletion = FALSE;
 
     ptrace = dbLockSetAddrTrace(precord);
+    /* Shared array copies may not match what processing leaves */
+    dbArrayCopyDrop(precord);
     /*
      *  Note that it is likely that if any changes are made
      *   to dbProcess() corresponding changes will have to
@@ -1314,6 +1316,8 @@ long dbPut(DBADDR *paddr, short dbrType,
         status = dbPutConvertRoutine[dbrType][field_type](paddr, pbuffer,
             nRequest, no_elements, offset);
     }
+    /* Even if it isn't posted, don't share copies of the old value */
+    dbArrayCopyDrop(precord);
 
     /* update array info */
     if (!status &&
@@ -58,16 +58,37 @@
 extern void dbServiceIOInit();
 extern int dbServiceIsolate;
 
-static ELLLIST workList = ELLLIST_INIT;    /* Work list for dbCaTask */
-static epicsMutexId workListLock; /*Mutual exclusions semaphores for workList*/
-static epicsEventId workListEvent; /*wakeup event for dbCaTask*/
-static int removesOutstanding = 0;
+/* Links are shared out between dbCaLinkThreads() shards by a hash of the
+ * target PV name. Each shard has its own dbCaTask thread and CA client
+ * context, so its CA callbacks are also delivered by separate threads.
+ */
+typedef struct dbCaShard {
+    ELLLIST workList;           /* Work list for dbCaTask */
+    epicsMutexId workListLock;  /*Mutual exclusions semaphores for workList*/
+    epicsEventId workListEvent; /*wakeup event for dbCaTask*/
+    epicsEventId startStopEvent;
+    struct ca_client_context *context;
+    unsigned index;
+    int removesOutstanding;
+    int chanCount;
+    /* The following are for dbcar, guarded by workListLock */
+    int maxQueued;              /* most links on workList at once */
+    unsigned long nActions;     /* links taken off workList */
+    double sumLatency;          /* seconds on workList, all actions */
+    double maxLatency;          /* seconds on workList, longest */
+    size_t nUpdate;             /* monitor updates, atomic */
+} dbCaShard;
+
+static dbCaShard **shards;
+static unsigned nShards;        /* in use since dbCaLinkInit() */
+static unsigned nShardsAlloc;   /* ever created */
+static unsigned nShardsConfig = 1;  /* set by dbCaLinkThreads() */
 #define removesOutstandingWarning 10000
 
 static volatile enum dbCaCtl_t {
     ctlInit, ctlRun, ctlPause, ctlExit
 } dbCaCtl;
-static epicsEventId startStopEvent;
+static epicsTimeStamp dbCaRunTime;  /* actions queued earlier waited from here */
 
 struct ca_client_context * dbCaClientContext;
 
@@ -80,15 +101,13 @@ static lset dbCa_lset;
     errlogPrintf("%s has DB CA link to %s\n",\
         pcaLink->plink->precord->name, pcaLink->pvname)
 
-static int dbca_chan_count;
-
 /* caLink locking
  *
  * Lock ordering:
  *  dbScanLock -> caLink.lock -> workListLock
  *
  * workListLock:
- *   Guards access to workList.
+ *   Guards access to the workList of one shard.
  *
  * dbScanLock:
  *   All dbCa* functions operating on a single link may only be called when
@@ -108,6 +127,9 @@ static int dbca_chan_count;
  *
  * The dbCaTask only locks caLink, and must not lock the record (a violation of lock order).
  *
+ * A caLink belongs to the same shard for its whole life, so all of its
+ * actions are taken in order by one dbCaTask.
+ *
  * During link modification or IOC shutdown the pca->plink pointer (guarded by caLink.lock)
  * is used as a flag to indicate that a link is no longer active.
  *
@@ -126,9 +148,10 @@ static int dbca_chan_count;
 
 static void addAction(caLink *pca, short link_action)
 {
+    dbCaShard *pshard = pca->shard;
     int callAdd;
 
-    epicsMutexMustLock(workListLock);
+    epicsMutexMustLock(pshard->workListLock);
     callAdd = (pca->link_action == 0);
     if (pca->link_action & CA_CLEAR_CHANNEL) {
         errlogPrintf("dbCa::addAction %d with CA_CLEAR_CHANNEL set\n",
@@ -137,22 +160,34 @@ static void addAction(caLink *pca, short link_action)
         link_action = 0;
     }
     if (link_action & CA_CLEAR_CHANNEL) {
-        if (++removesOutstanding >= removesOutstandingWarning) {
+        if (++pshard->removesOutstanding >= removesOutstandingWarning) {
             errlogPrintf("dbCa::addAction pausing, %d channels to clear\n",
-                removesOutstanding);
+                pshard->removesOutstanding);
         }
-        while (removesOutstanding >= removesOutstandingWarning) {
-            epicsMutexUnlock(workListLock);
+        while (pshard->removesOutstanding >= removesOutstandingWarning) {
+            epicsMutexUnlock(pshard->workListLock);
             epicsThreadSleep(1.0);
-            epicsMutexMustLock(workListLock);
+            epicsMutexMustLock(pshard->workListLock);
         }
     }
     pca->link_action |= link_action;
+    if (callAdd) {
+        int queued;
+
+        epicsTimeGetCurrent(&pca->queued);
+        ellAdd(&pshard->workList, &pca->node);
+        queued = ellCount(&pshard->workList);
+        if (queued > pshard->maxQueued)
+            pshard->maxQueued = queued;
+    }
+    epicsMutexUnlock(pshard->workListLock);
     if (callAdd)
-        ellAdd(&workList, &pca->node);
-    epicsMutexUnlock(workListLock);
-    if (callAdd)
-        epicsEventSignal(workListEvent);
+        epicsEventSignal(pshard->workListEvent);
+}
+
+static dbCaShard *findShard(const char *pvname)
+{
+    return shards[epicsStrHash(pvname, 0) % nShards];
 }
 
 static void caLinkInc(caLink *pca)
@@ -174,7 +209,7 @@ static void caLinkDec(caLink *pca)
 
     if (pca->chid) {
         ca_clear_channel(pca->chid);
-        --dbca_chan_count;
+        epicsAtomicDecrIntT(&pca->shard->chanCount);
     }
     callback = pca->putCallback;
     if (callback) {
@@ -192,10 +227,10 @@ static void caLinkDec(caLink *pca)
     if (callback) callback(userPvt);
 }
 
-/* Block until worker thread has processed all previously queued actions.
+/* Block until a worker thread has processed all previously queued actions.
  * Does not prevent additional actions from being queued.
  */
-void dbCaSync(void)
+static void syncShard(dbCaShard *pshard)
 {
     epicsEventId wake;
     caLink templink;
@@ -209,6 +244,7 @@ void dbCaSync(void)
 
     wake = epicsEventMustCreate(epicsEventEmpty);
     templink.lock = epicsMutexMustCreate();
+    templink.shard = pshard;
 
     templink.userPvt = wake;
 
@@ -219,8 +255,8 @@ void dbCaSync(void)
      * we cycle through workListLock to ensure worker call to
      * epicsEventMustTrigger() returns before we destroy the event.
      */
-    epicsMutexMustLock(workListLock);
-    epicsMutexUnlock(workListLock);
+    epicsMutexMustLock(pshard->workListLock);
+    epicsMutexUnlock(pshard->workListLock);
 
     assert(templink.refcount==1);
 
@@ -228,6 +264,17 @@ void dbCaSync(void)
     epicsEventDestroy(wake);
 }
 
+/* Block until all worker threads have processed all previously queued
+ * actions.
+ */
+void dbCaSync(void)
+{
+    unsigned i;
+
+    for (i = 0; i < nShards; i++)
+        syncShard(shards[i]);
+}
+
 epicsShareFunc unsigned long dbCaGetUpdateCount(struct link *plink)
 {
     caLink *pca = (caLink *)plink->value.pv_link.pvt;
@@ -251,33 +298,83 @@ void dbCaCallbackProcess(void *userPvt)
     dbLinkAsyncComplete(plink);
 }
 
+static void signalShards(void)
+{
+    unsigned i;
+
+    for (i = 0; i < nShards; i++)
+        epicsEventSignal(shards[i]->workListEvent);
+}
+
 void dbCaShutdown(void)
 {
     enum dbCaCtl_t cur = dbCaCtl;
+    unsigned i;
+
     assert(cur == ctlRun || cur == ctlPause);
     dbCaCtl = ctlExit;
-    epicsEventSignal(workListEvent);
-    epicsEventMustWait(startStopEvent);
+    signalShards();
+    for (i = 0; i < nShards; i++)
+        epicsEventMustWait(shards[i]->startStopEvent);
+}
+
+int dbCaLinkThreads(int count)
+{
+    if (dbCaCtl == ctlRun || dbCaCtl == ctlPause) {
+        fprintf(stderr, "dbCaLinkThreads: dbCa already initialized\n");
+        return -1;
+    }
+
+    if (count < 0)
+        count = epicsThreadGetCPUs() + count;
+    else if (count == 0)
+        count = epicsThreadGetCPUs();
+    if (count < 1) count = 1;
+
+    nShardsConfig = count;
+    return 0;
 }
 
 static void dbCaLinkInitImpl(int isolate)
 {
+    unsigned i;
+
     dbServiceIsolate = isolate;
     dbServiceIOInit();
 
-    if (!workListLock)
-        workListLock = epicsMutexMustCreate();
-    if (!workListEvent)
-        workListEvent = epicsEventMustCreate(epicsEventEmpty);
-
-    if(!startStopEvent)
-        startStopEvent = epicsEventMustCreate(epicsEventEmpty);
+    /* Shards are kept for the next dbCaLinkInit() after a shutdown */
+    if (nShardsConfig > nShardsAlloc) {
+        shards = realloc(shards, nShardsConfig * sizeof(dbCaShard *));
+        if (!shards)
+            cantProceed("dbCaLinkInit: no memory for shards\n");
+        for (i = nShardsAlloc; i < nShardsConfig; i++) {
+            dbCaShard *pshard = dbCalloc(1, sizeof(dbCaShard));
+
+            ellInit(&pshard->workList);
+            pshard->workListLock = epicsMutexMustCreate();
+            pshard->workListEvent = epicsEventMustCreate(epicsEventEmpty);
+            pshard->startStopEvent = epicsEventMustCreate(epicsEventEmpty);
+            pshard->index = i;
+            shards[i] = pshard;
+        }
+        nShardsAlloc = nShardsConfig;
+    }
+    nShards = nShardsConfig;
     dbCaCtl = ctlPause;
 
-    epicsThreadCreate("dbCaLink", epicsThreadPriorityMedium,
-        epicsThreadGetStackSize(epicsThreadStackBig),
-        dbCaTask, NULL);
-    epicsEventMustWait(startStopEvent);
+    for (i = 0; i < nShards; i++) {
+        char name[20];
+
+        if (nShards == 1)
+            strcpy(name, "dbCaLink");
+        else
+            sprintf(name, "dbCaLink%u", i);
+        epicsThreadCreate(name, epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackBig),
+            dbCaTask, shards[i]);
+        epicsEventMustWait(shards[i]->startStopEvent);
+    }
+    dbCaClientContext = shards[0]->context;
 }
 
 void dbCaLinkInitIsolated(void)
@@ -293,8 +390,9 @@ void dbCaLinkInit(void)
 void dbCaRun(void)
 {
     if (dbCaCtl == ctlPause) {
+        epicsTimeGetCurrent(&dbCaRunTime);
         dbCaCtl = ctlRun;
-        epicsEventSignal(workListEvent);
+        signalShards();
     }
 }
 
@@ -302,7 +400,47 @@ void dbCaPause(void)
 {
     if (dbCaCtl == ctlRun) {
         dbCaCtl = ctlPause;
-        epicsEventSignal(workListEvent);
+        signalShards();
+    }
+}
+
+void dbCaShardReport(int level)
+{
+    unsigned i;
+
+    if (!nShards) {
+        printf("dbCa not initialized\n");
+        return;
+    }
+    printf("%u dbCa link thread%s\n", nShards, nShards != 1 ? "s" : "");
+    printf("%7s %8s %7s %7s %10s %10s %12s %12s\n", "thread", "channels",
+        "queued", "max", "actions", "updates", "mean delay", "max delay");
+    for (i = 0; i < nShards; i++) {
+        dbCaShard *pshard = shards[i];
+        int queued, maxQueued;
+        unsigned long nActions;
+        double sumLatency, maxLatency;
+
+        epicsMutexMustLock(pshard->workListLock);
+        queued = ellCount(&pshard->workList);
+        maxQueued = pshard->maxQueued;
+        nActions = pshard->nActions;
+        sumLatency = pshard->sumLatency;
+        maxLatency = pshard->maxLatency;
+        epicsMutexUnlock(pshard->workListLock);
+
+        printf("%7u %8d %7d %7d %10lu %10lu %9.3f ms %9.3f ms\n",
+            i, epicsAtomicGetIntT(&pshard->chanCount), queued, maxQueued,
+            nActions, (unsigned long)epicsAtomicGetSizeT(&pshard->nUpdate),
+            nActions ? sumLatency * 1e3 / nActions : 0.0,
+            maxLatency * 1e3);
+    }
+    if (level > 0) {
+        for (i = 0; i < nShards; i++) {
+            if (!shards[i]->context) continue;
+            printf("\ndbCa link thread %u CA client context:\n", i);
+            ca_context_status(shards[i]->context, level);
+        }
     }
 }
 
@@ -318,6 +456,7 @@ void dbCaAddLinkCallback(struct link *plink,
     pca->lock = epicsMutexMustCreate();
     pca->plink = plink;
     pca->pvname = epicsStrDup(plink->value.pv_link.pvname);
+    pca->shard = findShard(pca->pvname);
     pca->connect = connect;
     pca->monitor = monitor;
     pca->userPvt = userPvt;
@@ -848,6 +987,7 @@ static void eventCallback(struct event_handler_args arg)
     plink = pca->plink;
     if (!plink) goto done;
     pca->nUpdate++;
+    epicsAtomicIncrSizeT(&pca->shard->nUpdate);
     monitor = pca->monitor;
     userPvt = pca->userPvt;
     precord = plink->precord;
@@ -1029,27 +1169,31 @@ static void getAttribEventCallback(struct event_handler_args arg)
 
 static void dbCaTask(void *arg)
 {
+    dbCaShard *pshard = (dbCaShard *)arg;
+
     taskwdInsert(0, NULL, NULL);
     SEVCHK(ca_context_create(ca_enable_preemptive_callback),
         "dbCaTask calling ca_context_create");
-    dbCaClientContext = ca_current_context ();
+    pshard->context = ca_current_context ();
     SEVCHK(ca_add_exception_event(exceptionCallback,NULL),
         "ca_add_exception_event");
-    epicsEventSignal(startStopEvent);
+    epicsEventSignal(pshard->startStopEvent);
 
     /* channel access event loop */
     while (TRUE){
         do {
-            epicsEventMustWait(workListEvent);
+            epicsEventMustWait(pshard->workListEvent);
         } while (dbCaCtl == ctlPause);
         while (TRUE) { /* process all requests in workList*/
             caLink *pca;
             short  link_action;
             int    status;
+            epicsTimeStamp now;
+            double latency;
 
-            epicsMutexMustLock(workListLock);
-            if (!(pca = (caLink *)ellGet(&workList))){  /* Take off list head */
-                epicsMutexUnlock(workListLock);
+            epicsMutexMustLock(pshard->workListLock);
+            if (!(pca = (caLink *)ellGet(&pshard->workList))){  /* Take off list head */
+                epicsMutexUnlock(pshard->workListLock);
                 if (dbCaCtl == ctlExit) goto shutdown;
                 break; /* workList is empty */
             }
@@ -1057,8 +1201,16 @@ static void dbCaTask(void *arg)
             if (link_action&CA_SYNC)
                 epicsEventMustTrigger((epicsEventId)pca->userPvt); /* dbCaSync() requires workListLock to be held here */
             pca->link_action = 0;
-            if (link_action & CA_CLEAR_CHANNEL) --removesOutstanding;
-            epicsMutexUnlock(workListLock);         /* Give back immediately */
+            if (link_action & CA_CLEAR_CHANNEL) --pshard->removesOutstanding;
+            epicsTimeGetCurrent(&now);
+            latency = epicsTimeDiffInSeconds(&now,
+                epicsTimeLessThan(&pca->queued, &dbCaRunTime) ?
+                    &dbCaRunTime : &pca->queued);
+            pshard->nActions++;
+            pshard->sumLatency += latency;
+            if (latency > pshard->maxLatency)
+                pshard->maxLatency = latency;
+            epicsMutexUnlock(pshard->workListLock);         /* Give back immediately */
             if (link_action&CA_SYNC)
                 continue;
             if (link_action & CA_CLEAR_CHANNEL) {   /* This must be first */
@@ -1076,7 +1228,7 @@ static void dbCaTask(void *arg)
                     printLinks(pca);
                     continue;
                 }
-                dbca_chan_count++;
+                epicsAtomicIncrIntT(&pshard->chanCount);
                 status = ca_replace_access_rights_event(pca->chid,
                     accessRightsCallback);
                 if (status != ECA_NORMAL) {
@@ -1180,9 +1332,12 @@ static void dbCaTask(void *arg)
     }
 shutdown:
     taskwdRemove(0);
-    if (dbca_chan_count == 0)
+    if (epicsAtomicGetIntT(&pshard->chanCount) == 0) {
         ca_context_destroy();
+        pshard->context = NULL;
+    }
     else
-        fprintf(stderr, "dbCa: chan_count = %d at shutdown\n", dbca_chan_count);
-    epicsEventSignal(startStopEvent);
+        fprintf(stderr, "dbCa: chan_count = %d at shutdown\n",
+            epicsAtomicGetIntT(&pshard->chanCount));
+    epicsEventSignal(pshard->startStopEvent);
 }
@@ -25,6 +25,7 @@ epicsShareFunc void dbCaLinkInitIsolated(void); /* internal initialization for i
 epicsShareFunc void dbCaRun(void);
 epicsShareFunc void dbCaPause(void);
 epicsShareFunc void dbCaShutdown(void);
+epicsShareFunc int dbCaLinkThreads(int count);
 
 struct dbLocker;
 epicsShareFunc void dbCaAddLinkCallback(struct link *plink,
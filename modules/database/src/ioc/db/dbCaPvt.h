@@ -34,11 +34,15 @@
 #define CA_PUT          0x1
 #define CA_PUT_CALLBACK 0x2
 
+struct dbCaShard;
+
 typedef struct caLink
 {
     ELLNODE		node;
     int         refcount;
     epicsMutexId	lock;
+    struct dbCaShard *shard; /* worker thread and CA context of this link */
+    epicsTimeStamp	queued; /* when last added to the shard's workList */
     struct link	*plink;
     char		*pvname;
     chid 		chid;
@@ -95,4 +99,7 @@ typedef struct caLink
     unsigned long   nUpdate;
 }caLink;
 
+/* Report the dbCa worker threads, for dbcar */
+epicsShareFunc void dbCaShardReport(int level);
+
 #endif /* INC_dbCaPvt_H */
@@ -156,8 +156,8 @@ done:
            nDisconnect, nNoWrite);
     dbFinishEntry(pdbentry);
     
-    if ( level > 2  && dbCaClientContext != 0 ) {
-        ca_context_status ( dbCaClientContext, level - 2 );
+    if ( level > 0 ) {
+        dbCaShardReport ( level - 2 );
     }
 
     return(0);
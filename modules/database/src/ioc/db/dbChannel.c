@@ -15,10 +15,12 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "cantProceed.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsString.h"
 #include "errlog.h"
 #include "freeList.h"
@@ -30,6 +32,7 @@
 #include "dbBase.h"
 #include "dbChannel.h"
 #include "dbCommon.h"
+#include "dbCommonPvt.h"
 #include "dbEvent.h"
 #include "dbLock.h"
 #include "dbStaticLib.h"
@@ -751,17 +754,71 @@ void dbChannelDelete(dbChannel *chan)
 }
 
 static void freeArray(db_field_log *pfl) {
-    if (pfl->field_type == DBF_STRING && pfl->no_elements == 1) {
-        freeListFree(dbchStringFreeList, pfl->u.r.field);
-    } else {
-        free(pfl->u.r.field);
+    freeListFree(dbchStringFreeList, pfl->u.r.field);
+}
+
+/* Array copies are reference counted and read-only once made. The last
+ * copy made for an event is cached in the record's dbCommonPvt, so all
+ * the subscriptions that copy the same field for the same update share
+ * one buffer. The cache is dropped whenever the record may have changed:
+ * when it is processed, when dbPut() writes to it, and when anything in
+ * it is posted. Device support that changes an array at any other time
+ * must post it with db_post_events(), as monitors need anyway.
+ */
+struct dbArrayCopy {
+    int refs;
+    void *pfield;           /* field that was copied */
+    short field_type;
+    long no_elements;       /* elements in the copy */
+    union {
+        epicsFloat64 align;
+        char data[1];       /* actually no_elements * field_size */
+    } u;
+};
+
+void dbArrayCopyRelease(struct dbArrayCopy *pcopy)
+{
+    if (pcopy && epicsAtomicDecrIntT(&pcopy->refs) == 0)
+        free(pcopy);
+}
+
+/* Called with the record locked */
+void dbArrayCopyDrop(struct dbCommon *prec)
+{
+    dbCommonPvt *ppvt = CONTAINER(prec, dbCommonPvt, common);
+
+    if (ppvt->arrayCopy) {
+        dbArrayCopyRelease(ppvt->arrayCopy);
+        ppvt->arrayCopy = NULL;
     }
 }
 
+static void releaseArray(db_field_log *pfl) {
+    dbArrayCopyRelease(pfl->u.r.pvt);
+}
+
+static struct dbArrayCopy * makeArrayCopy(dbChannel *chan)
+{
+    struct dbArrayCopy *pcopy = malloc(offsetof(struct dbArrayCopy, u.data) +
+        chan->addr.no_elements * chan->addr.field_size);
+
+    if (!pcopy) return NULL;
+    pcopy->refs = 1;
+    pcopy->pfield = chan->addr.pfield;
+    pcopy->field_type = chan->addr.field_type;
+    pcopy->no_elements = chan->addr.no_elements;
+    if (dbGet(&chan->addr, mapDBFToDBR[pcopy->field_type], pcopy->u.data,
+            NULL, &pcopy->no_elements, NULL))
+        pcopy->no_elements = 0;
+    return pcopy;
+}
+
+/* Called with the record locked */
 void dbChannelMakeArrayCopy(void *pvt, db_field_log *pfl, dbChannel *chan)
 {
-    void *p;
     struct dbCommon *prec = dbChannelRecord(chan);
+    dbCommonPvt *ppvt = CONTAINER(prec, dbCommonPvt, common);
+    struct dbArrayCopy *pcopy;
 
     if (pfl->type != dbfl_type_rec) return;
 
@@ -772,15 +829,53 @@ void dbChannelMakeArrayCopy(void *pvt, db_field_log *pfl, dbChannel *chan)
     pfl->field_type  = chan->addr.field_type;
     pfl->no_elements = chan->addr.no_elements;
     pfl->field_size  = chan->addr.field_size;
-    pfl->u.r.dtor = freeArray;
-    pfl->u.r.pvt = pvt;
     if (pfl->field_type == DBF_STRING && pfl->no_elements == 1) {
-        p = freeListCalloc(dbchStringFreeList);
-    } else {
-        p = calloc(pfl->no_elements, pfl->field_size);
+        void *p = freeListCalloc(dbchStringFreeList);
+
+        pfl->u.r.dtor = freeArray;
+        pfl->u.r.pvt = pvt;
+        if (p) dbGet(&chan->addr, DBR_STRING, p, NULL, &pfl->no_elements, NULL);
+        pfl->u.r.field = p;
+        return;
+    }
+
+    pcopy = ppvt->arrayCopy;
+    if (pfl->ctx == dbfl_context_event && pcopy &&
+        pcopy->pfield == chan->addr.pfield &&
+        pcopy->field_type == chan->addr.field_type) {
+        epicsAtomicIncrIntT(&pcopy->refs);
+    }
+    else {
+        pcopy = makeArrayCopy(chan);
+        if (pcopy && pfl->ctx == dbfl_context_event) {
+            dbArrayCopyRelease(ppvt->arrayCopy);
+            epicsAtomicIncrIntT(&pcopy->refs);
+            ppvt->arrayCopy = pcopy;
+        }
     }
-    if (p) dbGet(&chan->addr, mapDBFToDBR[pfl->field_type], p, NULL, &pfl->no_elements, NULL);
-    pfl->u.r.field = p;
+
+    if (pcopy) {
+        pfl->no_elements = pcopy->no_elements;
+        pfl->u.r.dtor = releaseArray;
+        pfl->u.r.pvt = pcopy;
+        pfl->u.r.field = pcopy->u.data;
+    }
+    else {
+        pfl->no_elements = 0;
+        pfl->u.r.dtor = NULL;
+        pfl->u.r.field = NULL;
+    }
+}
+
+int dbChannelArraySlice(db_field_log *pfl, long start, long nelem)
+{
+    if (pfl->type != dbfl_type_ref || pfl->u.r.dtor != releaseArray ||
+        start < 0 || nelem < 0 || start + nelem > pfl->no_elements)
+        return -1;
+
+    pfl->u.r.field = (char *) pfl->u.r.field + start * pfl->field_size;
+    pfl->no_elements = nelem;
+    return 0;
 }
 
 /* FIXME: Do these belong in a different file? */
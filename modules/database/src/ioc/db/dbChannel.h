@@ -38,13 +38,21 @@ typedef struct evSubscrip {
     EVENTFUNC               *user_sub;
     void                    *user_arg;
     struct event_que        *ev_que;
-    db_field_log            **pLastLog;
-    unsigned long           npend;  /* n times this event is on the queue */
+    struct evSubscrip       *nextReady; /* link in the event que ready list */
+    void                    **ring; /* db_field_log pointers */
+    char                    *ringDup; /* entry counted as duplicate */
+    unsigned                ringSize;
+    unsigned                npendMax; /* high water mark of the ring */
+    db_field_log            *pLastLog; /* last entry put on the ring */
+    size_t                  putix;  /* only changed by the posting thread */
+    size_t                  getix;  /* only changed by the event task */
     unsigned long           nreplace;  /* n times replacing event on the queue */
+    int                     queued; /* on the ready list or being drained */
     unsigned char           select;
     char                    useValque;
     char                    callBackInProgress;
     char                    enabled;
+    char                    lastLogIsRec; /* pLastLog is dbfl_type_rec */
 } evSubscrip;
 
 typedef struct chFilter chFilter;
@@ -224,7 +232,18 @@ epicsShareFunc void dbRegisterFilter(const char *key, const chFilterIf *fif, voi
 epicsShareFunc db_field_log* dbChannelRunPreChain(dbChannel *chan, db_field_log *pLogIn);
 epicsShareFunc db_field_log* dbChannelRunPostChain(dbChannel *chan, db_field_log *pLogIn);
 epicsShareFunc const chFilterPlugin * dbFindFilter(const char *key, size_t len);
+/* Turn a dbfl_type_rec field log into a dbfl_type_ref holding a copy of
+ * the channel's array, call with the record locked. Subscription updates
+ * share one read-only copy until the record posts again, so the data must
+ * not be modified in place. The pvt argument is only used for single
+ * strings.
+ */
 epicsShareFunc void dbChannelMakeArrayCopy(void *pvt, db_field_log *pfl, dbChannel *chan);
+/* Narrow a field log made by dbChannelMakeArrayCopy() to nelem elements
+ * starting at start, without copying. Returns 0 on success, non-zero if
+ * pfl doesn't hold such a copy or the range is outside it.
+ */
+epicsShareFunc int dbChannelArraySlice(db_field_log *pfl, long start, long nelem);
 
 #ifdef __cplusplus
 }
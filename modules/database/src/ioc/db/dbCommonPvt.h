@@ -8,7 +8,15 @@
 typedef struct dbCommonPvt {
     struct dbRecordNode *recnode;
 
+    /* Array copy shared by the subscriptions of the current update,
+     * protected by the record lock. See dbChannelMakeArrayCopy().
+     */
+    struct dbArrayCopy *arrayCopy;
+
     struct dbCommon common;
 } dbCommonPvt;
 
+void dbArrayCopyRelease(struct dbArrayCopy *pcopy);
+void dbArrayCopyDrop(struct dbCommon *prec);
+
 #endif // DBCOMMONPVT_H
@@ -56,28 +56,49 @@ static lset dbDb_lset;
 
 long dbDbInitLink(struct link *plink, short dbfType)
 {
-    DBADDR dbaddr;
-    long status;
-    DBADDR *pdbAddr;
+    DBADDR *pdbAddr = (DBADDR *) plink->value.pv_link.pvt;
 
-    status = dbNameToAddr(plink->value.pv_link.pvname, &dbaddr);
-    if (status)
-        return status;
+    /* Unless dbDbLookupLink() found the target already */
+    if (!pdbAddr) {
+        DBADDR dbaddr;
+        long status = dbNameToAddr(plink->value.pv_link.pvname, &dbaddr);
+
+        if (status)
+            return status;
+
+        pdbAddr = dbCalloc(1, sizeof(struct dbAddr));
+        *pdbAddr = dbaddr; /* structure copy */
+        plink->value.pv_link.pvt = pdbAddr;
+    }
 
     plink->lset = &dbDb_lset;
     plink->type = DB_LINK;
-    pdbAddr = dbCalloc(1, sizeof(struct dbAddr));
-    *pdbAddr = dbaddr; /* structure copy */
-    plink->value.pv_link.pvt = pdbAddr;
-    ellAdd(&dbaddr.precord->bklnk, &plink->value.pv_link.backlinknode);
+    ellAdd(&pdbAddr->precord->bklnk, &plink->value.pv_link.backlinknode);
     /* merging into the same lockset is deferred to the caller.
      * cf. initPVLinks()
      */
-    dbLockSetMerge(NULL, plink->precord, dbaddr.precord);
-    assert(plink->precord->lset->plockSet == dbaddr.precord->lset->plockSet);
+    dbLockSetMerge(NULL, plink->precord, pdbAddr->precord);
+    assert(plink->precord->lset->plockSet == pdbAddr->precord->lset->plockSet);
     return 0;
 }
 
+/*
+ * Find the target record of a PV_LINK for dbDbInitLink(), which does
+ * the rest. This only reads the database, so iocInit can do it for
+ * many records at once.
+ */
+void dbDbLookupLink(struct link *plink)
+{
+    DBADDR dbaddr;
+
+    if (plink->value.pv_link.pvt ||
+        dbNameToAddr(plink->value.pv_link.pvname, &dbaddr))
+        return;
+
+    plink->value.pv_link.pvt = dbCalloc(1, sizeof(struct dbAddr));
+    *(DBADDR *) plink->value.pv_link.pvt = dbaddr; /* structure copy */
+}
+
 void dbDbAddLink(struct dbLocker *locker, struct link *plink, short dbfType,
     DBADDR *ptarget)
 {
@@ -25,6 +25,7 @@ struct link;
 struct dbLocker;
 
 epicsShareFunc long dbDbInitLink(struct link *plink, short dbfType);
+epicsShareFunc void dbDbLookupLink(struct link *plink);
 epicsShareFunc void dbDbAddLink(struct dbLocker *locker, struct link *plink,
     short dbfType, DBADDR *ptarget);
 
@@ -27,6 +27,7 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsThread.h"
@@ -42,6 +43,7 @@
 #include "dbBase.h"
 #include "dbChannel.h"
 #include "dbCommon.h"
+#include "dbCommonPvt.h"
 #include "dbEvent.h"
 #include "db_field_log.h"
 #include "dbFldTypes.h"
@@ -49,31 +51,29 @@
 #include "link.h"
 #include "special.h"
 
-#define EVENTSPERQUE    32
-#define EVENTENTRIES    4      /* the number of que entries for each event */
-#define EVENTQUESIZE    (EVENTENTRIES  * EVENTSPERQUE)
-#define EVENTQEMPTY     ((struct evSubscrip *)NULL)
+#define EVENTENTRIES    4      /* default que entries for each event */
 
 /*
- * really a ring buffer
+ * Each event user has one event que. Every subscription owns a ring of
+ * field logs (evSubscrip::ring) sized by dbEventSetQueueSize() when it
+ * is added, so the que grows with the number of subscriptions.
+ * The ring has a single producer, the thread posting to the record,
+ * which holds the record's mlok, and a single consumer, the event task.
+ * Subscriptions with entries pending are pushed onto a lock free list
+ * of the event que, so posting threads never take a lock shared with
+ * other records. The event que lock only serializes the event task
+ * against db_cancel_event() and dbel().
  */
 struct event_que {
-    /* lock writers to the ring buffer only */
-    /* readers must never slow up writers */
-    epicsMutexId            writelock;
-    db_field_log            *valque[EVENTQUESIZE];
-    struct evSubscrip       *evque[EVENTQUESIZE];
-    struct event_que        *nextque;       /* in case que quota exceeded */
+    epicsMutexId            lock;
+    void                    *readyList;     /* struct evSubscrip * */
     struct event_user       *evUser;        /* event user parent struct */
-    unsigned short          putix;
-    unsigned short          getix;
-    unsigned short          quota;          /* the number of assigned entries*/
-    unsigned short          nDuplicates;    /* N events duplicated on this q */
-    unsigned short          nCanceled;      /* the number of canceled entries */
+    size_t                  nDuplicates;    /* N events duplicated on this q */
+    unsigned                nReadyMax;      /* most events ready at once */
 };
 
 struct event_user {
-    struct event_que    firstque;       /* the first event que */
+    struct event_que    que;            /* the event que */
 
     epicsMutexId        lock;
     epicsEventId        ppendsem;       /* Wait while empty */
@@ -84,6 +84,8 @@ struct event_user {
     void                *extralabor_arg;/* parameter to above */
 
     epicsThreadId       taskid;         /* event handler task id */
+    void                (*wakeup)(void *); /* replaces ppendsem if polled */
+    void                *wakeup_arg;
     struct evSubscrip   *pSuicideEvent; /* event that is deleteing itself */
     unsigned            queovr;         /* event que overflow count */
     unsigned char       pendexit;       /* exit pend task */
@@ -100,36 +102,109 @@ struct event_user {
  * into only 10 or 20 total steps part of the time.
  */
 
-#define RNGINC(OLD)\
-( (unsigned short) ( (OLD) >= (EVENTQUESIZE-1) ? 0 : (OLD)+1 ) )
+#define RINGSLOT(PEVENT, IX) ( (unsigned) ( (IX) % (PEVENT)->ringSize ) )
 
-#define LOCKEVQUE(EV_QUE)   epicsMutexMustLock((EV_QUE)->writelock)
-#define UNLOCKEVQUE(EV_QUE) epicsMutexUnlock((EV_QUE)->writelock)
+#define LOCKEVQUE(EV_QUE)   epicsMutexMustLock((EV_QUE)->lock)
+#define UNLOCKEVQUE(EV_QUE) epicsMutexUnlock((EV_QUE)->lock)
 #define LOCKREC(RECPTR)     epicsMutexMustLock((RECPTR)->mlok)
 #define UNLOCKREC(RECPTR)   epicsMutexUnlock((RECPTR)->mlok)
 
 static void *dbevEventUserFreeList;
-static void *dbevEventQueueFreeList;
 static void *dbevEventSubscriptionFreeList;
 static void *dbevFieldLogFreeList;
 
 static char *EVENT_PEND_NAME = "eventTask";
 
-static struct evSubscrip canceledEvent;
-
 static epicsMutexId stopSync;
 
-static unsigned short ringSpace ( const struct event_que *pevq )
+static unsigned eventQueueSize = EVENTENTRIES;
+
+/*
+ * tell the event task, or the thread polling for it, there is work
+ */
+static void event_wakeup (struct event_user *evUser)
+{
+    if (evUser->wakeup)
+        (*evUser->wakeup)(evUser->wakeup_arg);
+    else
+        epicsEventSignal(evUser->ppendsem);
+}
+
+/*
+ * number of entries on the ring of a subscription
+ */
+static size_t ringCount ( const struct evSubscrip *pevent )
+{
+    return epicsAtomicGetSizeT ( &pevent->putix ) -
+        epicsAtomicGetSizeT ( &pevent->getix );
+}
+
+/*
+ * readyPush()
+ * called by posting threads, returns true if the ready list was empty
+ */
+static int readyPush ( struct event_que *ev_que, struct evSubscrip *pevent )
+{
+    EpicsAtomicPtrT head;
+
+    do {
+        head = epicsAtomicGetPtrT ( &ev_que->readyList );
+        pevent->nextReady = (struct evSubscrip *) head;
+    } while ( epicsAtomicCmpAndSwapPtrT ( &ev_que->readyList,
+                head, pevent ) != head );
+
+    return head == NULL;
+}
+
+/*
+ * readyTakeAll()
+ * called by the event task, returns the ready list in posting order
+ */
+static struct evSubscrip * readyTakeAll ( struct event_que *ev_que )
+{
+    EpicsAtomicPtrT head;
+    struct evSubscrip *pevent, *pFirst = NULL;
+
+    do {
+        head = epicsAtomicGetPtrT ( &ev_que->readyList );
+    } while ( head && epicsAtomicCmpAndSwapPtrT ( &ev_que->readyList,
+                head, NULL ) != head );
+
+    /* pushed LIFO, so reverse */
+    pevent = (struct evSubscrip *) head;
+    while ( pevent ) {
+        struct evSubscrip * const pNext = pevent->nextReady;
+        pevent->nextReady = pFirst;
+        pFirst = pevent;
+        pevent = pNext;
+    }
+    return pFirst;
+}
+
+/*
+ * readyUnlink()
+ * called with the event queue lock applied, so the event task is not
+ * taking the list, returns true if the subscription was on the ready list
+ */
+static int readyUnlink ( struct event_que *ev_que, struct evSubscrip *pevent )
 {
-    if ( pevq->evque[pevq->putix] == EVENTQEMPTY ) {
-        if ( pevq->getix > pevq->putix ) {
-            return ( unsigned short ) ( pevq->getix - pevq->putix );
+    struct evSubscrip *pPrev;
+
+    /* posting threads only ever change the head */
+    while ( epicsAtomicGetPtrT ( &ev_que->readyList ) == pevent ) {
+        if ( epicsAtomicCmpAndSwapPtrT ( &ev_que->readyList,
+                pevent, pevent->nextReady ) == pevent ) {
+            return TRUE;
         }
-        else {
-            return ( unsigned short ) ( ( EVENTQUESIZE + pevq->getix ) - pevq->putix );
+    }
+    for ( pPrev = (struct evSubscrip *) epicsAtomicGetPtrT ( &ev_que->readyList );
+            pPrev; pPrev = pPrev->nextReady ) {
+        if ( pPrev->nextReady == pevent ) {
+            pPrev->nextReady = pevent->nextReady;
+            return TRUE;
         }
     }
-    return 0;
+    return FALSE;
 }
 
 /*
@@ -183,22 +258,23 @@ int dbel ( const char *pname, unsigned level )
                 if ( pevent->select & DBE_PROPERTY ) printf( "PROPERTY " );
 	        printf ( "}" );
 
-            if ( pevent->npend ) {
-                printf ( " undelivered=%ld", pevent->npend );
+            if ( ringCount ( pevent ) ) {
+                printf ( " undelivered=%lu",
+                    (unsigned long) ringCount ( pevent ) );
             }
 
             if ( level > 1 ) {
                 unsigned nEntriesFree;
                 const void * taskId;
                 LOCKEVQUE(pevent->ev_que);
-                nEntriesFree = ringSpace ( pevent->ev_que );
+                nEntriesFree = pevent->ringSize - (unsigned) ringCount ( pevent );
                 taskId = ( void * ) pevent->ev_que->evUser->taskid;
                 UNLOCKEVQUE(pevent->ev_que);
                 if ( nEntriesFree == 0u ) {
                     printf ( ", thread=%p, queue full",
                         (void *) taskId );
                 }
-                else if ( nEntriesFree == EVENTQUESIZE ) {
+                else if ( nEntriesFree == pevent->ringSize ) {
                     printf ( ", thread=%p, queue empty",
                         (void *) taskId );
                 }
@@ -206,27 +282,26 @@ int dbel ( const char *pname, unsigned level )
                     printf ( ", thread=%p, unused entries=%u",
                         (void *) taskId, nEntriesFree );
                 }
+                printf ( ", high water mark=%u of %u",
+                    pevent->npendMax, pevent->ringSize );
             }
 
             if ( level > 2 ) {
-                unsigned nDuplicates;
-                unsigned nCanceled;
+                size_t nDuplicates;
                 if ( pevent->nreplace ) {
                     printf (", discarded by replacement=%ld", pevent->nreplace);
                 }
                 if ( ! pevent->useValque ) {
                     printf (", queueing disabled" );
                 }
-                LOCKEVQUE(pevent->ev_que);
-                nDuplicates = pevent->ev_que->nDuplicates;
-                nCanceled = pevent->ev_que->nCanceled;
-                UNLOCKEVQUE(pevent->ev_que);
+                nDuplicates = epicsAtomicGetSizeT (
+                    &pevent->ev_que->nDuplicates );
                 if  ( nDuplicates ) {
-                    printf (", duplicate count =%u\n", nDuplicates );
-                }
-                if ( nCanceled ) {
-                    printf (", canceled count =%u\n", nCanceled );
+                    printf (", duplicate count =%lu",
+                        (unsigned long) nDuplicates );
                 }
+                printf ( ", most events ready at once=%u",
+                    pevent->ev_que->nReadyMax );
             }
 
             if ( level > 3 ) {
@@ -268,17 +343,13 @@ dbEventCtx db_init_events (void)
         freeListInitPvt(&dbevEventUserFreeList,
             sizeof(struct event_user),8);
     }
-    if (!dbevEventQueueFreeList) {
-        freeListInitPvt(&dbevEventQueueFreeList,
-            sizeof(struct event_que),8);
-    }
     if (!dbevEventSubscriptionFreeList) {
-        freeListInitPvt(&dbevEventSubscriptionFreeList,
-            sizeof(struct evSubscrip),256);
+        freeListInitCachedPvt(&dbevEventSubscriptionFreeList,
+            sizeof(struct evSubscrip),256,32);
     }
     if (!dbevFieldLogFreeList) {
-        freeListInitPvt(&dbevFieldLogFreeList,
-            sizeof(struct db_field_log),2048);
+        freeListInitCachedPvt(&dbevFieldLogFreeList,
+            sizeof(struct db_field_log),2048,64);
     }
 
     evUser = (struct event_user *)
@@ -290,9 +361,9 @@ dbEventCtx db_init_events (void)
     /* Flag will be cleared when event task starts */
     evUser->pendexit = TRUE;
 
-    evUser->firstque.evUser = evUser;
-    evUser->firstque.writelock = epicsMutexCreate();
-    if (!evUser->firstque.writelock)
+    evUser->que.evUser = evUser;
+    evUser->que.lock = epicsMutexCreate();
+    if (!evUser->que.lock)
         goto fail;
 
     evUser->ppendsem = epicsEventCreate(epicsEventEmpty);
@@ -315,8 +386,8 @@ dbEventCtx db_init_events (void)
 fail:
     if(evUser->lock)
         epicsMutexDestroy (evUser->lock);
-    if(evUser->firstque.writelock)
-        epicsMutexDestroy (evUser->firstque.writelock);
+    if(evUser->que.lock)
+        epicsMutexDestroy (evUser->que.lock);
     if(evUser->ppendsem)
         epicsEventDestroy (evUser->ppendsem);
     if(evUser->pflush_sem)
@@ -333,9 +404,6 @@ epicsShareFunc void db_cleanup_events(void)
     if(dbevEventUserFreeList) freeListCleanup(dbevEventUserFreeList);
     dbevEventUserFreeList = NULL;
 
-    if(dbevEventQueueFreeList) freeListCleanup(dbevEventQueueFreeList);
-    dbevEventQueueFreeList = NULL;
-
     if(dbevEventSubscriptionFreeList) freeListCleanup(dbevEventSubscriptionFreeList);
     dbevEventSubscriptionFreeList = NULL;
 
@@ -344,6 +412,37 @@ epicsShareFunc void db_cleanup_events(void)
 }
 
     /* intentionally leak stopSync to avoid possible shutdown races */
+/*
+ * event_free()
+ */
+static void event_free ( struct evSubscrip *pevent )
+{
+    free ( pevent->ring );
+    freeListFree ( dbevEventSubscriptionFreeList, pevent );
+}
+
+/*
+ * readyDrain()
+ * called when the event queue is closed, frees the subscriptions that
+ * were canceled while on the ready list and forgets the others
+ */
+static void readyDrain ( struct event_que *ev_que )
+{
+    struct evSubscrip *pevent = readyTakeAll ( ev_que );
+
+    while ( pevent ) {
+        struct evSubscrip * const pNext = pevent->nextReady;
+
+        if ( pevent->user_sub ) {
+            pevent->queued = FALSE;
+        }
+        else {
+            event_free ( pevent );
+        }
+        pevent = pNext;
+    }
+}
+
 /*
  *  DB_CLOSE_EVENTS()
  *
@@ -376,6 +475,12 @@ void db_close_events (dbEventCtx ctx)
 
         epicsMutexMustLock ( evUser->lock );
     }
+    else if (evUser->wakeup) { /* polled, the event task would do this */
+        LOCKEVQUE(&evUser->que);
+        readyDrain(&evUser->que);
+        UNLOCKEVQUE(&evUser->que);
+        epicsMutexDestroy(evUser->que.lock);
+    }
 
     epicsMutexUnlock ( evUser->lock );
 
@@ -392,22 +497,17 @@ void db_close_events (dbEventCtx ctx)
 }
 
 /*
- * create_ev_que()
+ * dbEventSetQueueSize()
  */
-static struct event_que * create_ev_que ( struct event_user * const evUser )
+int dbEventSetQueueSize ( int size )
 {
-    struct event_que * const ev_que = (struct event_que *) 
-        freeListCalloc ( dbevEventQueueFreeList );
-    if ( ! ev_que ) {
-        return NULL;
-    }
-    ev_que->writelock = epicsMutexCreate();
-    if ( ! ev_que->writelock ) {
-        freeListFree ( dbevEventQueueFreeList, ev_que );
-        return NULL;
+    if ( size < 1 || size > USHRT_MAX ) {
+        fprintf ( stderr, "dbEventSetQueueSize: size must be 1 .. %d\n",
+            USHRT_MAX );
+        return -1;
     }
-    ev_que->evUser = evUser;
-    return ev_que;
+    eventQueueSize = (unsigned) size;
+    return 0;
 }
 
 /*
@@ -418,8 +518,8 @@ dbEventSubscription db_add_event (
     EVENTFUNC *user_sub, void *user_arg, unsigned select)
 {
     struct event_user * const evUser = (struct event_user *) ctx;
-    struct event_que * ev_que;
     struct evSubscrip * pevent;
+    unsigned ringSize = eventQueueSize;
 
     /*
      * Don't add events which will not be triggered
@@ -433,48 +533,32 @@ dbEventSubscription db_add_event (
         return NULL;
     }
 
-    /* find an event que block with enough quota */
-    /* otherwise add a new one to the list */
-    epicsMutexMustLock ( evUser->lock );
-    ev_que = & evUser->firstque;
-    while ( TRUE ) {
-        int success = 0;
-        LOCKEVQUE ( ev_que );
-        success = ( ev_que->quota + ev_que->nCanceled < 
-                                EVENTQUESIZE - EVENTENTRIES );
-        if ( success ) {
-            ev_que->quota += EVENTENTRIES;
-        }
-        UNLOCKEVQUE ( ev_que );
-        if ( success ) {
-            break;
-        }
-        if ( ! ev_que->nextque ) {
-            ev_que->nextque = create_ev_que ( evUser );
-            if ( ! ev_que->nextque ) {
-                ev_que = NULL;
-                break;
-            }
-        }
-        ev_que = ev_que->nextque;
-    }
-    epicsMutexUnlock ( evUser->lock );
-
-    if ( ! ev_que ) {
+    /*
+     * Every subscription has its own ring on the one event que of the
+     * event user, so the que grows with the number of subscriptions
+     */
+    pevent->ring = calloc ( ringSize, sizeof ( *pevent->ring ) +
+        sizeof ( *pevent->ringDup ) );
+    if ( ! pevent->ring ) {
         freeListFree ( dbevEventSubscriptionFreeList, pevent );
         return NULL;
     }
+    pevent->ringDup = (char *) ( pevent->ring + ringSize );
+    pevent->ringSize = ringSize;
+    pevent->npendMax = 0u;
 
-    pevent->npend =     0ul;
+    pevent->putix =     0u;
+    pevent->getix =     0u;
     pevent->nreplace =  0ul;
     pevent->user_sub =  user_sub;
     pevent->user_arg =  user_arg;
     pevent->chan =      chan;
     pevent->select =    (unsigned char) select;
     pevent->pLastLog =  NULL; /* not yet in the queue */
+    pevent->queued =    FALSE;
     pevent->callBackInProgress = FALSE;
     pevent->enabled =   FALSE;
-    pevent->ev_que =    ev_que;
+    pevent->ev_que =    &evUser->que;
 
     /*
      * Simple types values queued up for reliable interprocess
@@ -527,25 +611,33 @@ void db_event_disable (dbEventSubscription event)
 
 /*
  * event_remove()
- * event queue lock _must_ be applied
- * this nulls the entry in the queue, but doesn't delete the db_field_log chunk
+ * called by the event task or, once no thread can post to the subscription
+ * any longer, by db_cancel_event(); event queue lock _must_ be applied
+ * this takes the oldest entry off the ring, but doesn't delete the
+ * db_field_log chunk
  */
-static void event_remove ( struct event_que *ev_que,
-    unsigned short index, struct evSubscrip *placeHolder )
+static db_field_log * event_remove ( struct event_que *ev_que,
+    struct evSubscrip *pevent )
 {
-    struct evSubscrip * const pevent = ev_que->evque[index];
+    const size_t getix = pevent->getix;
+    void ** const pSlot = &pevent->ring[RINGSLOT(pevent, getix)];
+    EpicsAtomicPtrT pfl;
 
-    ev_que->evque[index] = placeHolder;
-    ev_que->valque[index] = NULL;
-    if ( pevent->npend == 1u ) {
-        pevent->pLastLog = NULL;
-    }
-    else {
-        assert ( pevent->npend > 1u );
-        assert ( ev_que->nDuplicates >= 1u );
-        ev_que->nDuplicates--;
+    /*
+     * the posting thread may swap a replacement into
+     * the last entry while we are taking it
+     */
+    do {
+        pfl = epicsAtomicGetPtrT ( pSlot );
+    } while ( epicsAtomicCmpAndSwapPtrT ( pSlot, pfl, NULL ) != pfl );
+
+    if ( pevent->ringDup[RINGSLOT(pevent, getix)] ) {
+        assert ( epicsAtomicGetSizeT ( &ev_que->nDuplicates ) >= 1u );
+        epicsAtomicDecrSizeT ( &ev_que->nDuplicates );
     }
-    pevent->npend--;
+    epicsAtomicSetSizeT ( &pevent->getix, getix + 1u );
+
+    return (db_field_log *) pfl;
 }
 
 /*
@@ -558,7 +650,7 @@ static void event_remove ( struct event_que *ev_que,
 void db_cancel_event (dbEventSubscription event)
 {
     struct evSubscrip * const pevent = (struct evSubscrip *) event;
-    unsigned short getix;
+    int doFree = FALSE;
 
     db_event_disable ( event );
 
@@ -582,21 +674,14 @@ void db_cancel_event (dbEventSubscription event)
      * here will block CA's TCP input queue then a dead lock
      * would be possible.
      */
-    for (   getix = pevent->ev_que->getix;
-            pevent->ev_que->evque[getix] != EVENTQEMPTY; ) {
-        if ( pevent->ev_que->evque[getix] == pevent ) {
-            assert ( pevent->ev_que->nCanceled < USHRT_MAX );
-            pevent->ev_que->nCanceled++;
-            event_remove ( pevent->ev_que, getix, &canceledEvent );
-        }
-        getix = RNGINC ( getix );
-        if ( getix == pevent->ev_que->getix ) {
-            break;
-        }
+    while ( pevent->getix != epicsAtomicGetSizeT ( &pevent->putix ) ) {
+        db_delete_field_log ( event_remove ( pevent->ev_que, pevent ) );
     }
-    assert ( pevent->npend == 0u );
+    pevent->pLastLog = NULL;
 
-    if ( pevent->ev_que->evUser->taskid == epicsThreadGetIdSelf() ) {
+    if ( pevent->ev_que->evUser->taskid == epicsThreadGetIdSelf() &&
+            pevent->callBackInProgress ) {
+        /* event_read() frees it when the callback returns */
         pevent->ev_que->evUser->pSuicideEvent = pevent;
     }
     else {
@@ -605,13 +690,20 @@ void db_cancel_event (dbEventSubscription event)
             epicsEventMustWait ( pevent->ev_que->evUser->pflush_sem );
             LOCKEVQUE (pevent->ev_que);
         }
+        /*
+         * take it off the ready list, event_read() does not look
+         * at the list in flow control mode. If it is queued but
+         * not on the list the event task is draining it and
+         * event_read() frees it.
+         */
+        doFree = ! pevent->queued || readyUnlink ( pevent->ev_que, pevent );
     }
 
-    pevent->ev_que->quota -= EVENTENTRIES;
-
     UNLOCKEVQUE (pevent->ev_que);
 
-    freeListFree ( dbevEventSubscriptionFreeList, pevent );
+    if ( doFree ) {
+        event_free ( pevent );
+    }
 
     return;
 }
@@ -673,7 +765,7 @@ int db_post_extra_labor (dbEventCtx ctx)
     epicsMutexUnlock ( evUser->lock );
 
     if ( doit ) {
-        epicsEventSignal(evUser->ppendsem);
+        event_wakeup(evUser);
     }
 
     return DB_EVENT_OK;
@@ -733,100 +825,87 @@ db_field_log* db_create_read_log (struct dbChannel *chan)
 /*
  *  DB_QUEUE_EVENT_LOG()
  *
+ *  NOTE: This assumes that the record's mlok is applied, it
+ *        serializes all threads posting to this subscription
  */
 static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
 {
-    struct event_que    *ev_que;
-    int firstEventFlag;
-    unsigned rngSpace;
-
-    ev_que = pevent->ev_que;
-    /*
-     * evUser ring buffer must be locked for the multiple
-     * threads writing/reading it
-     */
-
-    LOCKEVQUE (ev_que);
-
-    /*
-     * if we have an event on the queue and both the last
-     * event on the queue and the current event are emtpy
-     * (i.e. of type dbfl_type_rec), simply ignore duplicate
-     * events (saving empty events serves no purpose)
-     */
-    if (pevent->npend > 0u &&
-        (*pevent->pLastLog)->type == dbfl_type_rec &&
-        pLog->type == dbfl_type_rec) {
-        db_delete_field_log(pLog);
-        UNLOCKEVQUE (ev_que);
-        return;
-    }
+    struct event_que * const ev_que = pevent->ev_que;
+    const size_t putix = pevent->putix;
+    size_t npend = putix - epicsAtomicGetSizeT ( &pevent->getix );
 
     /*
-     * add to task local event que
+     * The event task may take the last entry off the ring at any
+     * time, so it is only ever changed by compare and swap. If that
+     * succeeds the event task has not taken it yet, otherwise the
+     * event task has emptied the ring and we add a new entry.
      */
+    if ( npend > 0u ) {
+        void ** const pSlot = &pevent->ring[RINGSLOT(pevent, putix - 1u)];
+        db_field_log * const pLastLog = pevent->pLastLog;
 
-    /*
-     * if an event is on the queue and one of
-     * {flowCtrlMode, not room for one more of each monitor attached}
-     * then replace the last event on the queue (for this monitor)
-     */
-    rngSpace = ringSpace ( ev_que );
-    if ( pevent->npend>0u &&
-        (ev_que->evUser->flowCtrlMode || rngSpace<=EVENTSPERQUE) ) {
         /*
-         * replace last event if no space is left
+         * if we have an event on the queue and both the last
+         * event on the queue and the current event are emtpy
+         * (i.e. of type dbfl_type_rec), simply ignore duplicate
+         * events (saving empty events serves no purpose)
          */
-        if (*pevent->pLastLog) {
-            db_delete_field_log(*pevent->pLastLog);
-            *pevent->pLastLog = pLog;
+        if ( pevent->lastLogIsRec && pLog->type == dbfl_type_rec ) {
+            if ( epicsAtomicCmpAndSwapPtrT ( pSlot,
+                    pLastLog, pLastLog ) == pLastLog ) {
+                db_delete_field_log ( pLog );
+                return;
+            }
+            npend = 0u;
         }
-        pevent->nreplace++;
         /*
-         * the event task has already been notified about
-         * this so we dont need to post the semaphore
+         * if an event is on the queue and one of
+         * {flowCtrlMode, no room left on the ring}
+         * then replace the last event on the queue (for this monitor)
          */
-        firstEventFlag = 0;
+        else if ( ev_que->evUser->flowCtrlMode || npend >= pevent->ringSize ) {
+            if ( epicsAtomicCmpAndSwapPtrT ( pSlot,
+                    pLastLog, pLog ) == pLastLog ) {
+                db_delete_field_log ( pLastLog );
+                pevent->pLastLog = pLog;
+                pevent->lastLogIsRec = pLog->type == dbfl_type_rec;
+                pevent->nreplace++;
+                /*
+                 * the event task has already been notified about
+                 * this so we dont need to post the semaphore
+                 */
+                return;
+            }
+            npend = 0u;
+        }
     }
+
     /*
      * Otherwise, the current entry must be available.
      * Fill it in and advance the ring buffer.
      */
-    else {
-        assert ( ev_que->evque[ev_que->putix] == EVENTQEMPTY );
-        ev_que->evque[ev_que->putix] = pevent;
-        ev_que->valque[ev_que->putix] = pLog;
-        pevent->pLastLog = &ev_que->valque[ev_que->putix];
-        if (pevent->npend>0u) {
-            ev_que->nDuplicates++;
-        }
-        pevent->npend++;
-        /*
-         * if the ring buffer was empty before
-         * adding this event
-         */
-        if (rngSpace==EVENTQUESIZE) {
-            firstEventFlag = 1;
-        }
-        else {
-            firstEventFlag = 0;
-        }
-        ev_que->putix = RNGINC ( ev_que->putix );
+    assert ( pevent->ring[RINGSLOT(pevent, putix)] == NULL );
+    pevent->ring[RINGSLOT(pevent, putix)] = pLog;
+    pevent->ringDup[RINGSLOT(pevent, putix)] = npend > 0u;
+    pevent->pLastLog = pLog;
+    pevent->lastLogIsRec = pLog->type == dbfl_type_rec;
+    if ( npend > 0u ) {
+        epicsAtomicIncrSizeT ( &ev_que->nDuplicates );
     }
-
-    UNLOCKEVQUE (ev_que);
+    if ( npend >= pevent->npendMax ) {
+        pevent->npendMax = (unsigned) npend + 1u;
+    }
+    epicsAtomicWriteMemoryBarrier ();
+    epicsAtomicSetSizeT ( &pevent->putix, putix + 1u );
 
     /*
-     * its more efficent to notify the event handler
-     * only after the event is ready and the lock
-     * is off in case it runs at a higher priority
-     * than the caller here.
+     * put the subscription on the ready list unless it is already
+     * there or being drained, and notify the event handler if
+     * the ready list was empty before adding this event
      */
-    if (firstEventFlag) {
-        /*
-         * notify the event handler
-         */
-        epicsEventSignal(ev_que->evUser->ppendsem);
+    if ( epicsAtomicCmpAndSwapIntT ( &pevent->queued, FALSE, TRUE ) == FALSE &&
+            readyPush ( ev_que, pevent ) ) {
+        event_wakeup ( ev_que->evUser );
     }
 }
 
@@ -845,6 +924,7 @@ unsigned int    caEventMask
     struct dbCommon   * const prec = (struct dbCommon *) pRecord;
     struct evSubscrip *pevent;
 
+    dbArrayCopyDrop(prec);
     if (prec->mlis.count == 0) return DB_EVENT_OK;       /* no monitors set */
 
     LOCKREC (prec);
@@ -880,9 +960,14 @@ void db_post_single_event (dbEventSubscription event)
 
     dbScanLock (prec);
 
+    dbArrayCopyDrop(prec);
     pLog = db_create_event_log(pevent);
     pLog = dbChannelRunPreChain(pevent->chan, pLog);
-    if(pLog) db_queue_event_log(pevent, pLog);
+    if(pLog) {
+        LOCKREC (prec);
+        db_queue_event_log(pevent, pLog);
+        UNLOCKREC (prec);
+    }
 
     dbScanUnlock (prec);
 }
@@ -892,9 +977,12 @@ void db_post_single_event (dbEventSubscription event)
  */
 static int event_read ( struct event_que *ev_que )
 {
-    db_field_log *pfl;
-    void ( *user_sub ) ( void *user_arg, struct dbChannel *chan,
-            int eventsRemaining, db_field_log *pfl );
+    struct evSubscrip *pFirst = NULL;   /* subscriptions being drained */
+    struct evSubscrip *pLast = NULL;
+    struct evSubscrip *pAgain = NULL;   /* for the next pass, if polled */
+    const int polled = ev_que->evUser->wakeup != NULL;
+    int taken = FALSE;
+    int wakeup = FALSE;
 
     /*
      * evUser ring buffer must be locked for the multiple
@@ -907,24 +995,50 @@ static int event_read ( struct event_que *ev_que )
      * suspend processing events until flow control
      * mode is over
      */
-    if ( ev_que->evUser->flowCtrlMode && ev_que->nDuplicates == 0u ) {
+    if ( ev_que->evUser->flowCtrlMode &&
+            epicsAtomicGetSizeT ( &ev_que->nDuplicates ) == 0u ) {
         UNLOCKEVQUE (ev_que);
         return DB_EVENT_OK;
     }
 
-    while ( ev_que->evque[ev_que->getix] != EVENTQEMPTY ) {
-        struct evSubscrip *pevent = ev_que->evque[ev_que->getix];
+    while ( TRUE ) {
+        struct evSubscrip *pevent;
+        db_field_log *pfl;
+        void ( *user_sub ) ( void *user_arg, struct dbChannel *chan,
+                int eventsRemaining, db_field_log *pfl );
+
+        if ( ! pFirst ) {
+            unsigned nReady = 1u;
 
-        pfl = ev_que->valque[ev_que->getix];
-        if ( pevent == &canceledEvent ) {
-            ev_que->evque[ev_que->getix] = EVENTQEMPTY;
-            if (ev_que->valque[ev_que->getix]) {
-                db_delete_field_log(ev_que->valque[ev_que->getix]);
-                ev_que->valque[ev_que->getix] = NULL;
+            /*
+             * a polled queue is run by a thread which serves others,
+             * so give it back after one pass over the ready list
+             */
+            if ( polled && taken ) {
+                break;
+            }
+            taken = TRUE;
+            pFirst = readyTakeAll ( ev_que );
+            if ( ! pFirst ) {
+                break;
             }
-            ev_que->getix = RNGINC ( ev_que->getix );
-            assert ( ev_que->nCanceled > 0 );
-            ev_que->nCanceled--;
+            for ( pLast = pFirst; pLast->nextReady;
+                    pLast = pLast->nextReady ) {
+                nReady++;
+            }
+            if ( nReady > ev_que->nReadyMax ) {
+                ev_que->nReadyMax = nReady;
+            }
+        }
+        pevent = pFirst;
+        pFirst = pevent->nextReady;
+
+        /*
+         * canceled after we took it off the ready list,
+         * db_cancel_event() left it to us to free
+         */
+        if ( ! pevent->user_sub ) {
+            event_free ( pevent );
             continue;
         }
 
@@ -933,9 +1047,7 @@ static int event_read ( struct event_que *ev_que )
          * communication. (for other types they get whatever happens
          * to be there upon wakeup)
          */
-
-        event_remove ( ev_que, ev_que->getix, EVENTQEMPTY );
-        ev_que->getix = RNGINC ( ev_que->getix );
+        pfl = event_remove ( ev_que, pevent );
 
         /*
          * create a local copy of the call back parameters while
@@ -944,69 +1056,135 @@ static int event_read ( struct event_que *ev_que )
         user_sub = pevent->user_sub;
 
         /*
-         * Next event pointer can be used by event tasks to determine
-         * if more events are waiting in the queue
+         * Must remove the lock here so that the callback may
+         * block on the record lock or call db_cancel_event().
          *
-         * Must remove the lock here so that we dont deadlock if
-         * this calls dbGetField() and blocks on the record lock,
-         * dbPutField() is in progress in another task, it has the
-         * record lock, and it is calling db_post_events() waiting
-         * for the event queue lock (which this thread now has).
+         * This provides a way to test to see if an event is in use
+         * despite the fact that the event queue does not point to
+         * it.
          */
-        if ( user_sub ) {
-            /*
-             * This provides a way to test to see if an event is in use
-             * despite the fact that the event queue does not point to
-             * it.
-             */
-            pevent->callBackInProgress = TRUE;
-            UNLOCKEVQUE (ev_que);
-            /* Run post-event-queue filter chain */
-            if (ellCount(&pevent->chan->post_chain)) {
-                pfl = dbChannelRunPostChain(pevent->chan, pfl);
-            }
-            if (pfl) {
-                /* Issue user callback */
-                ( *user_sub ) ( pevent->user_arg, pevent->chan,
-                                ev_que->evque[ev_que->getix] != EVENTQEMPTY, pfl );
-            }
-            LOCKEVQUE (ev_que);
+        pevent->callBackInProgress = TRUE;
+        UNLOCKEVQUE (ev_que);
+        /* Run post-event-queue filter chain */
+        if (ellCount(&pevent->chan->post_chain)) {
+            pfl = dbChannelRunPostChain(pevent->chan, pfl);
+        }
+        if (pfl) {
+            /* Issue user callback */
+            ( *user_sub ) ( pevent->user_arg, pevent->chan,
+                            pFirst || ringCount ( pevent ) ||
+                            epicsAtomicGetPtrT ( &ev_que->readyList ),
+                            pfl );
+        }
+        db_delete_field_log(pfl);
+        LOCKEVQUE (ev_que);
 
-            /*
-             * check to see if this event has been canceled each
-             * time that the callBackInProgress flag is set to false
-             * while we have the event queue lock, and post the flush
-             * complete sem if there are no longer any events on the
-             * queue
-             */
-            if ( ev_que->evUser->pSuicideEvent == pevent ) {
-                ev_que->evUser->pSuicideEvent = NULL;
-            }
-            else {
-                if ( pevent->user_sub==NULL && pevent->npend==0u ) {
-                    pevent->callBackInProgress = FALSE;
-                    epicsEventSignal ( ev_que->evUser->pflush_sem );
-                }
-                else {
-                    pevent->callBackInProgress = FALSE;
-                }
+        /*
+         * check to see if this event has been canceled each
+         * time that the callBackInProgress flag is set to false
+         * while we have the event queue lock, and post the flush
+         * complete sem if there are no longer any events on the
+         * queue
+         */
+        pevent->callBackInProgress = FALSE;
+        if ( ev_que->evUser->pSuicideEvent == pevent ) {
+            ev_que->evUser->pSuicideEvent = NULL;
+            event_free ( pevent );
+            continue;
+        }
+        if ( pevent->user_sub == NULL ) {
+            /* db_cancel_event() frees it */
+            pevent->queued = FALSE;
+            epicsEventSignal ( ev_que->evUser->pflush_sem );
+            continue;
+        }
+
+        /*
+         * Keep draining a subscription with more entries behind the
+         * others taken from the ready list, otherwise give it back to
+         * the posting threads. If one posted after we looked but
+         * before it was given back it did not push it, so look again.
+         */
+        if ( ringCount ( pevent ) == 0u ) {
+            epicsAtomicCmpAndSwapIntT ( &pevent->queued, TRUE, FALSE );
+            if ( ringCount ( pevent ) == 0u ||
+                    epicsAtomicCmpAndSwapIntT ( &pevent->queued,
+                        FALSE, TRUE ) != FALSE ) {
+                continue;
             }
         }
-        db_delete_field_log(pfl);
+        if ( polled ) {
+            pevent->nextReady = pAgain;
+            pAgain = pevent;
+            continue;
+        }
+        pevent->nextReady = NULL;
+        if ( pFirst ) {
+            pLast->nextReady = pevent;
+        }
+        else {
+            pFirst = pevent;
+        }
+        pLast = pevent;
+    }
+
+    while ( pAgain ) {
+        struct evSubscrip * const pNext = pAgain->nextReady;
+        wakeup |= readyPush ( ev_que, pAgain );
+        pAgain = pNext;
     }
 
     UNLOCKEVQUE (ev_que);
 
+    if ( wakeup ) {
+        event_wakeup ( ev_que->evUser );
+    }
+
     return DB_EVENT_OK;
 }
 
+/*
+ * EVENT_WORK()
+ *
+ * one pass of the event task, after it was woken up
+ */
+static void event_work (struct event_user *evUser)
+{
+    void (*pExtraLaborSub) (void *);
+    void *pExtraLaborArg;
+
+    /*
+     * check to see if the caller has offloaded
+     * labor to this task
+     */
+    epicsMutexMustLock ( evUser->lock );
+    evUser->extraLaborBusy = TRUE;
+    if ( evUser->extra_labor && evUser->extralabor_sub ) {
+        evUser->extra_labor = FALSE;
+        pExtraLaborSub = evUser->extralabor_sub;
+        pExtraLaborArg = evUser->extralabor_arg;
+    }
+    else {
+        pExtraLaborSub = NULL;
+        pExtraLaborArg = NULL;
+    }
+    if ( pExtraLaborSub ) {
+        epicsMutexUnlock ( evUser->lock );
+        (*pExtraLaborSub)(pExtraLaborArg);
+        epicsMutexMustLock ( evUser->lock );
+    }
+    evUser->extraLaborBusy = FALSE;
+
+    epicsMutexUnlock ( evUser->lock );
+    event_read ( &evUser->que );
+}
+
 /*
  * EVENT_TASK()
  */
 static void event_task (void *pParm)
 {
     struct event_user * const evUser = (struct event_user *) pParm;
-    struct event_que * ev_que;
     unsigned char pendexit;
 
     /* init hook */
@@ -1017,56 +1195,20 @@ static void event_task (void *pParm)
     taskwdInsert ( epicsThreadGetIdSelf(), NULL, NULL );
 
     do {
-        void (*pExtraLaborSub) (void *);
-        void *pExtraLaborArg;
         epicsEventMustWait(evUser->ppendsem);
 
-        /*
-         * check to see if the caller has offloaded
-         * labor to this task
-         */
-        epicsMutexMustLock ( evUser->lock );
-        evUser->extraLaborBusy = TRUE;
-        if ( evUser->extra_labor && evUser->extralabor_sub ) {
-            evUser->extra_labor = FALSE;
-            pExtraLaborSub = evUser->extralabor_sub;
-            pExtraLaborArg = evUser->extralabor_arg;
-        }
-        else {
-            pExtraLaborSub = NULL;
-            pExtraLaborArg = NULL;
-        }
-        if ( pExtraLaborSub ) {
-            epicsMutexUnlock ( evUser->lock );
-            (*pExtraLaborSub)(pExtraLaborArg);
-            epicsMutexMustLock ( evUser->lock );
-        }
-        evUser->extraLaborBusy = FALSE;
+        event_work ( evUser );
 
-        for ( ev_que = &evUser->firstque; ev_que;
-                ev_que = ev_que->nextque ) {
-            epicsMutexUnlock ( evUser->lock );
-            event_read (ev_que);
-            epicsMutexMustLock ( evUser->lock );
-        }
+        epicsMutexMustLock ( evUser->lock );
         pendexit = evUser->pendexit;
         epicsMutexUnlock ( evUser->lock );
 
     } while( ! pendexit );
 
-    epicsMutexDestroy(evUser->firstque.writelock);
-
-    {
-        struct event_que    *nextque;
-
-        ev_que = evUser->firstque.nextque;
-        while (ev_que) {
-            nextque = ev_que->nextque;
-            epicsMutexDestroy(ev_que->writelock);
-            freeListFree(dbevEventQueueFreeList, ev_que);
-            ev_que = nextque;
-        }
-    }
+    LOCKEVQUE(&evUser->que);
+    readyDrain(&evUser->que);
+    UNLOCKEVQUE(&evUser->que);
+    epicsMutexDestroy(evUser->que.lock);
 
     taskwdRemove(epicsThreadGetIdSelf());
 
@@ -1120,6 +1262,52 @@ int db_start_events (
      return DB_EVENT_OK;
 }
 
+/*
+ * DB_START_EVENTS_POLLED()
+ *
+ * no event task, wakeup() tells the owner to call db_process_events()
+ */
+int db_start_events_polled (
+    dbEventCtx ctx, void (*wakeup)(void *arg), void *arg )
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+
+    epicsMutexMustLock ( evUser->lock );
+    if ( evUser->taskid || evUser->wakeup || !wakeup ) {
+        epicsMutexUnlock ( evUser->lock );
+        return DB_EVENT_ERROR;
+    }
+    evUser->wakeup = wakeup;
+    evUser->wakeup_arg = arg;
+    epicsMutexUnlock ( evUser->lock );
+    return DB_EVENT_OK;
+}
+
+/*
+ * DB_PROCESS_EVENTS()
+ *
+ * The calling thread stands in for the event task while in here, so
+ * a callback can still cancel its own subscription.
+ */
+void db_process_events (dbEventCtx ctx)
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+
+    if ( ! evUser->wakeup ) {
+        return;
+    }
+
+    epicsMutexMustLock ( evUser->lock );
+    evUser->taskid = epicsThreadGetIdSelf();
+    epicsMutexUnlock ( evUser->lock );
+
+    event_work ( evUser );
+
+    epicsMutexMustLock ( evUser->lock );
+    evUser->taskid = 0;
+    epicsMutexUnlock ( evUser->lock );
+}
+
 /*
  * db_event_change_priority()
  */
@@ -1127,6 +1315,11 @@ void db_event_change_priority ( dbEventCtx ctx,
                                         unsigned epicsPriority )
 {
     struct event_user * const evUser = ( struct event_user * ) ctx;
+
+    /* polled queues run at the priority of whoever polls them */
+    if ( evUser->wakeup ) {
+        return;
+    }
     epicsThreadSetPriority ( evUser->taskid, epicsPriority );
 }
 
@@ -1143,7 +1336,7 @@ void db_event_flow_ctrl_mode_on (dbEventCtx ctx)
     /*
      * notify the event handler task
      */
-    epicsEventSignal(evUser->ppendsem);
+    event_wakeup(evUser);
 #ifdef DEBUG
     printf("fc on %lu\n", tickGet());
 #endif
@@ -1162,7 +1355,7 @@ void db_event_flow_ctrl_mode_off (dbEventCtx ctx)
     /*
      * notify the event handler task
      */
-    epicsEventSignal (evUser->ppendsem);
+    event_wakeup(evUser);
 #ifdef DEBUG
     printf("fc off %lu\n", tickGet());
 #endif
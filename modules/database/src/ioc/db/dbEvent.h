@@ -54,6 +54,15 @@ epicsShareFunc dbEventCtx db_init_events (void);
 epicsShareFunc int db_start_events (
     dbEventCtx ctx, const char *taskname, void (*init_func)(void *),
     void *init_func_arg, unsigned osiPriority );
+/* Instead of starting an event task, have the caller's own thread run
+ * the queue: wakeup(arg) is called, possibly from any thread, whenever
+ * db_process_events() needs to be called. Use one or the other.
+ * db_process_events() delivers at most one event per subscription and
+ * calls wakeup(arg) again if more are left.
+ */
+epicsShareFunc int db_start_events_polled (
+    dbEventCtx ctx, void (*wakeup)(void *arg), void *arg );
+epicsShareFunc void db_process_events (dbEventCtx ctx);
 epicsShareFunc void db_close_events (dbEventCtx ctx);
 epicsShareFunc void db_event_flow_ctrl_mode_on (dbEventCtx ctx);
 epicsShareFunc void db_event_flow_ctrl_mode_off (dbEventCtx ctx);
@@ -62,6 +71,7 @@ epicsShareFunc int db_add_extra_labor_event (
 epicsShareFunc void db_flush_extra_labor_event (dbEventCtx);
 epicsShareFunc int db_post_extra_labor (dbEventCtx ctx);
 epicsShareFunc void db_event_change_priority ( dbEventCtx ctx, unsigned epicsPriority );
+epicsShareFunc int dbEventSetQueueSize ( int size );
 
 #ifdef EPICS_PRIVATE_API
 epicsShareFunc void db_cleanup_events(void);
@@ -13,6 +13,7 @@
 #include "callback.h"
 #include "dbAccess.h"
 #include "dbBkpt.h"
+#include "dbCa.h"
 #include "dbCaTest.h"
 #include "dbEvent.h"
 #include "dbIocRegister.h"
@@ -110,6 +111,16 @@ static void dbcarCallFunc(const iocshArgBuf *args)
     dbcar(args[0].sval,args[1].ival);
 }
 
+/* dbCaLinkThreads */
+static const iocshArg dbCaLinkThreadsArg0 = { "no of threads",iocshArgInt};
+static const iocshArg * const dbCaLinkThreadsArgs[1] = {&dbCaLinkThreadsArg0};
+static const iocshFuncDef dbCaLinkThreadsFuncDef =
+    {"dbCaLinkThreads",1,dbCaLinkThreadsArgs};
+static void dbCaLinkThreadsCallFunc(const iocshArgBuf *args)
+{
+    dbCaLinkThreads(args[0].ival);
+}
+
 /* dbjlr */
 static const iocshArg dbjlrArg0 = { "record name",iocshArgString};
 static const iocshArg dbjlrArg1 = { "level",iocshArgInt};
@@ -296,6 +307,29 @@ static void scanOnceSetQueueSizeCallFunc(const iocshArgBuf *args)
     scanOnceSetQueueSize(args[0].ival);
 }
 
+/* dbEventSetQueueSize */
+static const iocshArg dbEventSetQueueSizeArg0 = { "size",iocshArgInt};
+static const iocshArg * const dbEventSetQueueSizeArgs[1] =
+    {&dbEventSetQueueSizeArg0};
+static const iocshFuncDef dbEventSetQueueSizeFuncDef =
+    {"dbEventSetQueueSize",1,dbEventSetQueueSizeArgs};
+static void dbEventSetQueueSizeCallFunc(const iocshArgBuf *args)
+{
+    dbEventSetQueueSize(args[0].ival);
+}
+
+/* scanParallelThreads */
+static const iocshArg scanParallelThreadsArg0 = { "no of threads", iocshArgInt};
+static const iocshArg scanParallelThreadsArg1 = { "rate", iocshArgDouble};
+static const iocshArg * const scanParallelThreadsArgs[2] =
+    {&scanParallelThreadsArg0,&scanParallelThreadsArg1};
+static const iocshFuncDef scanParallelThreadsFuncDef =
+    {"scanParallelThreads",2,scanParallelThreadsArgs};
+static void scanParallelThreadsCallFunc(const iocshArgBuf *args)
+{
+    scanParallelThreads(args[0].ival, args[1].dval);
+}
+
 /* scanppl */
 static const iocshArg scanpplArg0 = { "rate",iocshArgDouble};
 static const iocshArg * const scanpplArgs[1] = {&scanpplArg0};
@@ -347,6 +381,17 @@ static void callbackParallelThreadsCallFunc(const iocshArgBuf *args)
     callbackParallelThreads(args[0].ival, args[1].sval);
 }
 
+/* callbackQueueShow */
+static const iocshArg callbackQueueShowArg0 = { "reset", iocshArgInt};
+static const iocshArg * const callbackQueueShowArgs[1] =
+    {&callbackQueueShowArg0};
+static const iocshFuncDef callbackQueueShowFuncDef =
+    {"callbackQueueShow",1,callbackQueueShowArgs};
+static void callbackQueueShowCallFunc(const iocshArgBuf *args)
+{
+    callbackQueueShow(args[0].ival);
+}
+
 /* dbStateCreate */
 static const iocshArg dbStateArgName = { "name", iocshArgString };
 static const iocshArg * const dbStateCreateArgs[] = { &dbStateArgName };
@@ -411,6 +456,7 @@ void dbIocRegister(void)
 
     iocshRegister(&dbsrFuncDef,dbsrCallFunc);
     iocshRegister(&dbcarFuncDef,dbcarCallFunc);
+    iocshRegister(&dbCaLinkThreadsFuncDef,dbCaLinkThreadsCallFunc);
     iocshRegister(&dbelFuncDef,dbelCallFunc);
     iocshRegister(&dbjlrFuncDef,dbjlrCallFunc);
 
@@ -440,7 +486,9 @@ void dbIocRegister(void)
     iocshRegister(&dblsrFuncDef,dblsrCallFunc);
     iocshRegister(&dbLockShowLockedFuncDef,dbLockShowLockedCallFunc);
 
+    iocshRegister(&dbEventSetQueueSizeFuncDef,dbEventSetQueueSizeCallFunc);
     iocshRegister(&scanOnceSetQueueSizeFuncDef,scanOnceSetQueueSizeCallFunc);
+    iocshRegister(&scanParallelThreadsFuncDef,scanParallelThreadsCallFunc);
     iocshRegister(&scanpplFuncDef,scanpplCallFunc);
     iocshRegister(&scanpelFuncDef,scanpelCallFunc);
     iocshRegister(&postEventFuncDef,postEventCallFunc);
@@ -448,6 +496,7 @@ void dbIocRegister(void)
 
     iocshRegister(&callbackSetQueueSizeFuncDef,callbackSetQueueSizeCallFunc);
     iocshRegister(&callbackParallelThreadsFuncDef,callbackParallelThreadsCallFunc);
+    iocshRegister(&callbackQueueShowFuncDef,callbackQueueShowCallFunc);
 
     /* Needed before callback system is initialized */
     callbackParallelThreadsDefault = epicsThreadGetCPUs();
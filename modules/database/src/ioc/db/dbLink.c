@@ -142,6 +142,23 @@ void dbInitLink(struct link *plink, short dbfType)
     }
 }
 
+/*
+ * Do the part of dbInitLink() that may be done for several links at
+ * the same time, finding the target of a link that may be a DB link.
+ */
+void dbLookupLink(struct link *plink)
+{
+    struct dbCommon *precord = plink->precord;
+
+    if (plink->flags & DBLINK_FLAG_INITIALIZED ||
+        plink->type != PV_LINK ||
+        plink == &precord->tsel ||  /* TSEL_modified() may change it */
+        plink->value.pv_link.pvlMask & (pvlOptCA | pvlOptCP | pvlOptCPP))
+        return;
+
+    dbDbLookupLink(plink);
+}
+
 void dbAddLink(struct dbLocker *locker, struct link *plink, short dbfType,
     DBADDR *ptarget)
 {
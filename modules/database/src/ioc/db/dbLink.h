@@ -84,6 +84,7 @@ typedef struct lset {
 epicsShareFunc const char * dbLinkFieldName(const struct link *plink);
 
 epicsShareFunc void dbInitLink(struct link *plink, short dbfType);
+epicsShareFunc void dbLookupLink(struct link *plink);
 epicsShareFunc void dbAddLink(struct dbLocker *locker, struct link *plink,
         short dbfType, DBADDR *ptarget);
 
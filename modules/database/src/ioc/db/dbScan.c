@@ -24,6 +24,7 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "ellLib.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsPrint.h"
@@ -68,14 +69,28 @@ static void *exitOnce;
 
 
 /* All other scan types */
+
+/* The records of a scan list are kept in an array sorted by PHAS.
+ * Changes copy the array and publish the copy, so a scan pass reads
+ * the array without taking the list lock.  Replaced arrays are kept
+ * until no scan pass can be using them.
+ */
+typedef struct scan_array {
+    struct scan_array   *next;      /* on the retired list */
+    size_t              count;
+    size_t              size;       /* allocated entries */
+    struct dbCommon     *precords[1]; /* actually size */
+} scan_array;
+
 typedef struct scan_list{
-    epicsMutexId        lock;
-    ELLLIST             list;
-    short               modified;/*has list been modified?*/
+    epicsMutexId        lock;       /* serializes changes */
+    scan_array          *parray;    /* current records, may be NULL */
+    size_t              count;      /* parray->count */
+    int                 nreaders;   /* scan passes in progress */
+    scan_array          *retired;   /* replaced arrays */
 } scan_list;
 /*scan_elements are allocated and the address stored in dbCommon.spvt*/
 typedef struct scan_element{
-    ELLNODE             node;
     scan_list           *pscan_list;
     struct dbCommon     *precord;
 } scan_element;
@@ -85,6 +100,26 @@ typedef struct scan_element{
 
 #define OVERRUN_REPORT_DELAY 10.0   /* Time between initial reports */
 #define OVERRUN_REPORT_MAX 3600.0   /* Maximum time between reports */
+
+/* A periodic scan list may be shared between several worker threads.
+ * Worker 0 is the periodic scan thread itself.  Each pass takes a
+ * snapshot of the list and gives every lock set to one worker.
+ */
+typedef struct scan_item {
+    struct dbCommon     *precord;
+    short               phas;
+    unsigned short      worker;
+} scan_item;
+
+typedef struct scan_worker {
+    struct periodic_scan_list *ppsl;
+    unsigned short      index;
+    epicsEventId        go;
+    unsigned long       nprocessed; /* records processed in last pass */
+    double              busy;       /* seconds spent in last pass */
+    double              busyMax;
+} scan_worker;
+
 typedef struct periodic_scan_list {
     scan_list           scan_list;
     double              period;
@@ -92,12 +127,31 @@ typedef struct periodic_scan_list {
     unsigned long       overruns;
     volatile enum ctl   scanCtl;
     epicsEventId        loopEvent;
+    int                 nworkers;
+    scan_worker         *workers;
+    epicsEventId        doneEvent;
+    int                 nbusy;      /* workers still running */
+    int                 stopWorkers;
+    scan_item           *pitems;    /* snapshot of the list */
+    size_t              nitems, maxitems;
+    size_t              first, last; /* phase group being processed */
 } periodic_scan_list;
 
 static int nPeriodic = 0;
 static periodic_scan_list **papPeriodic; /* pointer to array of pointers */
 static epicsThreadId *periodicTaskId;    /* array of thread ids */
 
+/* Requests from scanParallelThreads() */
+typedef struct parallel_request {
+    ELLNODE             node;
+    double              period;     /* 0 means all periodic scans */
+    int                 count;
+} parallel_request;
+static ELLLIST parallelRequests = ELLLIST_INIT;
+
+/* Set while the scan lists are built, no scan passes can run */
+static int buildingLists;
+
 
 static char *priorityName[NUM_CALLBACK_PRIORITIES] = {
     "Low", "Medium", "High"
@@ -139,12 +193,17 @@ static void periodicTask(void *arg);
 static void initPeriodic(void);
 static void deletePeriodic(void);
 static void spawnPeriodic(int ind);
+static void scanPeriodic(periodic_scan_list *ppsl);
 static void eventCallback(CALLBACK *pcallback);
 static void ioscanInit(void);
 static void ioscanCallback(CALLBACK *pcallback);
 static void ioscanDestroy(void);
 static void printList(scan_list *psl, char *message);
 static void scanList(scan_list *psl);
+static void initList(scan_list *psl);
+static void freeList(scan_list *psl);
+static scan_array *getList(scan_list *psl);
+static void releaseList(scan_list *psl);
 static void buildScanLists(void);
 static void addToList(struct dbCommon *precord, scan_list *psl);
 static void deleteFromList(struct dbCommon *precord, scan_list *psl);
@@ -179,6 +238,8 @@ void scanCleanup(void)
 
     epicsRingBytesDelete(onceQ);
 
+    ellFree(&parallelRequests);
+
     free(periodicTaskId);
     papPeriodic = NULL;
     periodicTaskId = NULL;
@@ -398,6 +459,17 @@ int scanppl(double period)      /* print periodic scan list(s) */
         sprintf(message, "Records with SCAN = '%s' (%lu over-runs):",
             ppsl->name, ppsl->overruns);
         printList(&ppsl->scan_list, message);
+        if (ppsl->nworkers > 1) {
+            int j;
+
+            printf("    %d scan threads, last pass (max):\n", ppsl->nworkers);
+            for (j = 0; j < ppsl->nworkers; j++) {
+                scan_worker *pw = &ppsl->workers[j];
+
+                printf("    Thread %2d: %6lu records in %.3f ms (%.3f ms)\n",
+                    j, pw->nprocessed, pw->busy * 1e3, pw->busyMax * 1e3);
+            }
+        }
     }
     return 0;
 }
@@ -412,7 +484,8 @@ int scanpel(const char* eventname)   /* print event list */
         if (!eventname || epicsStrGlobMatch(pel->eventname, eventname)) {
             printf("Event \"%s\"\n", pel->eventname);
             for (prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-                if (ellCount(&pel->scan_list[prio].list) == 0) continue;
+                if (epicsAtomicGetSizeT(&pel->scan_list[prio].count) == 0)
+                    continue;
                 sprintf(message, " Priority %s", priorityName[prio]);
                 printList(&pel->scan_list[prio], message);
             }
@@ -514,8 +587,7 @@ event_list *eventNameToHandle(const char *eventname)
             callbackSetUser(&pel->scan_list[prio], &pel->callback[prio]);
             callbackSetPriority(prio, &pel->callback[prio]);
             callbackSetCallback(eventCallback, &pel->callback[prio]);
-            pel->scan_list[prio].lock = epicsMutexMustCreate();
-            ellInit(&pel->scan_list[prio].list);
+            initList(&pel->scan_list[prio]);
         }
         pel->next=pevent_list[0];
         pevent_list[0]=pel;
@@ -532,7 +604,7 @@ void postEvent(event_list *pel)
     if (scanCtl != ctlRun) return;
     if (!pel) return;
     for (prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-        if (ellCount(&pel->scan_list[prio].list) >0)
+        if (epicsAtomicGetSizeT(&pel->scan_list[prio].count) > 0)
             callbackRequest(&pel->callback[prio]);
     }
 }
@@ -570,8 +642,7 @@ static void ioscanDestroy(void)
         int prio;
 
         for (prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsMutexDestroy(piosh->iosl[prio].scan_list.lock);
-            ellFree(&piosh->iosl[prio].scan_list.list);
+            freeList(&piosh->iosl[prio].scan_list);
         }
         free(piosh);
         piosh = pnext;
@@ -590,8 +661,7 @@ void scanIoInit(IOSCANPVT *pioscanpvt)
         callbackSetCallback(ioscanCallback, &piosl->callback);
         callbackSetPriority(prio, &piosl->callback);
         callbackSetUser(piosh, &piosl->callback);
-        ellInit(&piosl->scan_list.list);
-        piosl->scan_list.lock = epicsMutexMustCreate();
+        initList(&piosl->scan_list);
     }
     epicsMutexMustLock(ioscan_lock);
     piosh->next = pioscan_list;
@@ -614,7 +684,7 @@ unsigned int scanIoRequest(IOSCANPVT piosh)
     for (prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
         io_scan_list *piosl = &piosh->iosl[prio];
 
-        if (ellCount(&piosl->scan_list.list) > 0)
+        if (epicsAtomicGetSizeT(&piosl->scan_list.count) > 0)
             if (!callbackRequest(&piosl->callback))
                 queued |= 1 << prio;
     }
@@ -633,7 +703,7 @@ unsigned int scanIoImmediate(IOSCANPVT piosh, int prio)
 
     piosl = &piosh->iosl[prio];
 
-    if (ellCount(&piosl->scan_list.list) == 0)
+    if (epicsAtomicGetSizeT(&piosl->scan_list.count) == 0)
         return 0;
 
     scanList(&piosl->scan_list);
@@ -722,6 +792,31 @@ int scanOnceSetQueueSize(int size)
     return 0;
 }
 
+int scanParallelThreads(int count, double period)
+{
+    parallel_request *preq;
+
+    if (papPeriodic) {
+        fprintf(stderr, "Scan system already initialized\n");
+        return -1;
+    }
+
+    if (count <= 0)
+        count = epicsThreadGetCPUs() + count;
+    if (count < 1) count = 1;
+    if (count > USHRT_MAX) count = USHRT_MAX;
+    if (period < 0) {
+        fprintf(stderr, "scanParallelThreads: Bad period %g\n", period);
+        return -1;
+    }
+
+    preq = dbCalloc(1, sizeof(parallel_request));
+    preq->period = period;
+    preq->count = count;
+    ellAdd(&parallelRequests, &preq->node);
+    return 0;
+}
+
 static void initOnce(void)
 {
     if ((onceQ = epicsRingBytesLockedCreate(sizeof(onceEntry)*onceQueueSize)) == NULL) {
@@ -757,8 +852,12 @@ static void periodicTask(void *arg)
         double delay;
         epicsTimeStamp now;
 
-        if (ppsl->scanCtl == ctlRun)
-            scanList(&ppsl->scan_list);
+        if (ppsl->scanCtl == ctlRun) {
+            if (ppsl->nworkers > 1)
+                scanPeriodic(ppsl);
+            else
+                scanList(&ppsl->scan_list);
+        }
 
         epicsTimeAddSeconds(&next, ppsl->period);
         epicsTimeGetCurrent(&now);
@@ -803,15 +902,135 @@ static void periodicTask(void *arg)
         epicsEventWaitWithTimeout(ppsl->loopEvent, delay);
     }
 
+    if (ppsl->nworkers > 1) {
+        int i;
+
+        ppsl->stopWorkers = TRUE;
+        epicsAtomicSetIntT(&ppsl->nbusy, ppsl->nworkers - 1);
+        for (i = 1; i < ppsl->nworkers; i++)
+            epicsEventSignal(ppsl->workers[i].go);
+        epicsEventMustWait(ppsl->doneEvent);
+    }
+
     taskwdRemove(0);
     epicsEventSignal(startStopEvent);
 }
 
+/* Process this worker's share of the current phase group */
+static void scanShare(scan_worker *pw)
+{
+    periodic_scan_list *ppsl = pw->ppsl;
+    scan_list *psl = &ppsl->scan_list;
+    epicsUInt64 start = epicsMonotonicGet();
+    size_t i;
+
+    for (i = ppsl->first; i < ppsl->last; i++) {
+        struct dbCommon *precord = ppsl->pitems[i].precord;
+        scan_element *pse;
+
+        if (ppsl->pitems[i].worker != pw->index)
+            continue;
+
+        /* SCAN and PHAS are only changed with the record locked,
+         * so skip records that have left the list since the snapshot.
+         */
+        dbScanLock(precord);
+        pse = precord->spvt;
+        if (pse && pse->pscan_list == psl) {
+            dbProcess(precord);
+            pw->nprocessed++;
+        }
+        dbScanUnlock(precord);
+    }
+    pw->busy += (epicsMonotonicGet() - start) * 1e-9;
+}
+
+static void periodicWorker(void *arg)
+{
+    scan_worker *pw = (scan_worker *)arg;
+    periodic_scan_list *ppsl = pw->ppsl;
+
+    taskwdInsert(0, NULL, NULL);
+
+    while (TRUE) {
+        int exiting;
+
+        epicsEventMustWait(pw->go);
+        exiting = ppsl->stopWorkers;
+        if (!exiting)
+            scanShare(pw);
+        if (epicsAtomicDecrIntT(&ppsl->nbusy) == 0)
+            epicsEventSignal(ppsl->doneEvent);
+        if (exiting)
+            break;
+    }
+
+    taskwdRemove(0);
+}
+
+/* Scan a periodic list with all of its workers.  The records of one lock
+ * set all go to the same worker, so workers rarely wait for each other.
+ * Each group of records with the same PHAS ends with a barrier.
+ */
+static void scanPeriodic(periodic_scan_list *ppsl)
+{
+    scan_list *psl = &ppsl->scan_list;
+    scan_array *parr = getList(psl);
+    size_t n = parr ? parr->count : 0;
+    size_t i;
+    int w;
+
+    if (n > ppsl->maxitems) {
+        free(ppsl->pitems);
+        ppsl->maxitems = n + n / 2;
+        ppsl->pitems = dbCalloc(ppsl->maxitems, sizeof(scan_item));
+    }
+    for (i = 0; i < n; i++) {
+        ppsl->pitems[i].precord = parr->precords[i];
+        ppsl->pitems[i].phas = parr->precords[i]->phas;
+    }
+    releaseList(psl);
+    ppsl->nitems = n;
+
+    for (i = 0; i < n; i++)
+        ppsl->pitems[i].worker = (unsigned short)
+            (dbLockGetLockId(ppsl->pitems[i].precord) % ppsl->nworkers);
+
+    for (w = 0; w < ppsl->nworkers; w++) {
+        ppsl->workers[w].nprocessed = 0;
+        ppsl->workers[w].busy = 0.0;
+    }
+
+    for (i = 0; i < n; ) {
+        size_t end = i + 1;
+
+        while (end < n && ppsl->pitems[end].phas == ppsl->pitems[i].phas)
+            end++;
+        ppsl->first = i;
+        ppsl->last = end;
+
+        epicsAtomicSetIntT(&ppsl->nbusy, ppsl->nworkers - 1);
+        for (w = 1; w < ppsl->nworkers; w++)
+            epicsEventSignal(ppsl->workers[w].go);
+        scanShare(&ppsl->workers[0]);
+        epicsEventMustWait(ppsl->doneEvent);
+        i = end;
+    }
+
+    for (w = 0; w < ppsl->nworkers; w++) {
+        scan_worker *pw = &ppsl->workers[w];
+
+        if (pw->busy > pw->busyMax)
+            pw->busyMax = pw->busy;
+    }
+}
+
 
 static void initPeriodic(void)
 {
     dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
     double quantum = epicsThreadSleepQuantum();
+    parallel_request *preq;
     int i;
 
     if (!pmenu) {
@@ -856,12 +1075,30 @@ static void initPeriodic(void)
             continue;
         }
 
-        ppsl->scan_list.lock = epicsMutexMustCreate();
-        ellInit(&ppsl->scan_list.list);
+        initList(&ppsl->scan_list);
         ppsl->name = choice;
         ppsl->scanCtl = ctlPause;
         ppsl->loopEvent = epicsEventMustCreate(epicsEventEmpty);
 
+        ppsl->nworkers = 1;
+        for (preq = (parallel_request *)ellFirst(&parallelRequests); preq;
+             preq = (parallel_request *)ellNext(&preq->node)) {
+            if (preq->period == 0.0 ||
+                fabs(preq->period - ppsl->period) <= 0.05)
+                ppsl->nworkers = preq->count;
+        }
+        if (ppsl->nworkers > 1) {
+            int j;
+
+            ppsl->workers = dbCalloc(ppsl->nworkers, sizeof(scan_worker));
+            for (j = 0; j < ppsl->nworkers; j++) {
+                ppsl->workers[j].ppsl = ppsl;
+                ppsl->workers[j].index = j;
+                ppsl->workers[j].go = epicsEventMustCreate(epicsEventEmpty);
+            }
+            ppsl->doneEvent = epicsEventMustCreate(epicsEventEmpty);
+        }
+
         number = ppsl->period / quantum;
         if ((ppsl->period < 2 * quantum) ||
             (number / floor(number) > 1.1)) {
@@ -881,9 +1118,17 @@ static void deletePeriodic(void)
         periodic_scan_list *ppsl = papPeriodic[i];
 
         if (!ppsl) continue;
-        ellFree(&ppsl->scan_list.list);
+        if (ppsl->workers) {
+            int j;
+
+            for (j = 0; j < ppsl->nworkers; j++)
+                epicsEventDestroy(ppsl->workers[j].go);
+            epicsEventDestroy(ppsl->doneEvent);
+            free(ppsl->workers);
+        }
+        free(ppsl->pitems);
+        freeList(&ppsl->scan_list);
         epicsEventDestroy(ppsl->loopEvent);
-        epicsMutexDestroy(ppsl->scan_list.lock);
         free(ppsl);
     }
 
@@ -894,10 +1139,18 @@ static void deletePeriodic(void)
 static void spawnPeriodic(int ind)
 {
     periodic_scan_list *ppsl = papPeriodic[ind];
-    char taskName[20];
+    char taskName[32];
+    int j;
 
     if (!ppsl) return;
 
+    for (j = 1; j < ppsl->nworkers; j++) {
+        sprintf(taskName, "scan-%g-%d", ppsl->period, j);
+        epicsThreadMustCreate(taskName, epicsThreadPriorityScanLow + ind,
+            epicsThreadGetStackSize(epicsThreadStackBig),
+            periodicWorker, (void *)&ppsl->workers[j]);
+    }
+
     sprintf(taskName, "scan-%g", ppsl->period);
     periodicTaskId[ind] = epicsThreadCreate(
         taskName, epicsThreadPriorityScanLow + ind,
@@ -921,90 +1174,142 @@ static void ioscanCallback(CALLBACK *pcallback)
 
 static void printList(scan_list *psl, char *message)
 {
-    scan_element *pse;
-
-    epicsMutexMustLock(psl->lock);
-    pse = (scan_element *)ellFirst(&psl->list);
-    epicsMutexUnlock(psl->lock);
+    scan_array *parr = getList(psl);
 
-    if (!pse)
-        return;
+    if (parr && parr->count) {
+        size_t i;
 
-    printf("%s\n", message);
-    while (pse) {
-        printf("    %-28s\n", pse->precord->name);
-        epicsMutexMustLock(psl->lock);
-        if (pse->pscan_list != psl) {
-            epicsMutexUnlock(psl->lock);
-            printf("    Scan list changed while printing, try again.\n");
-            return;
-        }
-        pse = (scan_element *)ellNext(&pse->node);
-        epicsMutexUnlock(psl->lock);
+        printf("%s\n", message);
+        for (i = 0; i < parr->count; i++)
+            printf("    %-28s\n", parr->precords[i]->name);
     }
+    releaseList(psl);
 }
-
+
 static void scanList(scan_list *psl)
 {
     /* When reading this code remember that the call to dbProcess can result
      * in the SCAN field being changed in an arbitrary number of records.
      */
 
-    scan_element *pse;
-    scan_element *prev = NULL;
-    scan_element *next = NULL;
+    scan_array *parr = getList(psl);
+    size_t i;
 
-    epicsMutexMustLock(psl->lock);
-    psl->modified = FALSE;
-    pse = (scan_element *)ellFirst(&psl->list);
-    if (pse) next = (scan_element *)ellNext(&pse->node);
-    epicsMutexUnlock(psl->lock);
-
-    while (pse) {
-        struct dbCommon *precord = pse->precord;
+    for (i = 0; parr && i < parr->count; i++) {
+        struct dbCommon *precord = parr->precords[i];
+        scan_element *pse;
 
+        /* SCAN and PHAS are only changed with the record locked,
+         * so skip records that have left the list since getList().
+         */
         dbScanLock(precord);
-        dbProcess(precord);
+        pse = precord->spvt;
+        if (pse && pse->pscan_list == psl)
+            dbProcess(precord);
         dbScanUnlock(precord);
+    }
+    releaseList(psl);
+}
 
-        epicsMutexMustLock(psl->lock);
-        if (!psl->modified) {
-            prev = pse;
-            pse = (scan_element *)ellNext(&pse->node);
-            if (pse) next = (scan_element *)ellNext(&pse->node);
-        } else if (pse->pscan_list == psl) {
-            /*This scan element is still in same scan list*/
-            prev = pse;
-            pse = (scan_element *)ellNext(&pse->node);
-            if (pse) next = (scan_element *)ellNext(&pse->node);
-            psl->modified = FALSE;
-        } else if (prev && prev->pscan_list == psl) {
-            /*Previous scan element is still in same scan list*/
-            pse = (scan_element *)ellNext(&prev->node);
-            if (pse) {
-                prev = (scan_element *)ellPrevious(&pse->node);
-                next = (scan_element *)ellNext(&pse->node);
-            }
-            psl->modified = FALSE;
-        } else if (next && next->pscan_list == psl) {
-            /*Next scan element is still in same scan list*/
-            pse = next;
-            prev = (scan_element *)ellPrevious(&pse->node);
-            next = (scan_element *)ellNext(&pse->node);
-            psl->modified = FALSE;
-        } else {
-            /*Too many changes. Just wait till next period*/
-            epicsMutexUnlock(psl->lock);
-            return;
-        }
+static void initList(scan_list *psl)
+{
+    psl->lock = epicsMutexMustCreate();
+    psl->parray = NULL;
+    psl->count = 0;
+    psl->nreaders = 0;
+    psl->retired = NULL;
+}
+
+/* Free the retired arrays if no scan pass can still see them.
+ * Called with psl->lock held.
+ */
+static void reclaimList(scan_list *psl)
+{
+    scan_array *parr = psl->retired;
+
+    if (!parr || epicsAtomicGetIntT(&psl->nreaders) != 0)
+        return;
+    psl->retired = NULL;
+    while (parr) {
+        scan_array *pnext = parr->next;
+
+        free(parr);
+        parr = pnext;
+    }
+}
+
+static void freeList(scan_list *psl)
+{
+    scan_array *parr = psl->parray;
+
+    if (parr) {
+        size_t i;
+
+        for (i = 0; i < parr->count; i++)
+            free(parr->precords[i]->spvt);
+        free(parr);
+    }
+    psl->parray = NULL;
+    psl->count = 0;
+    reclaimList(psl);
+    epicsMutexDestroy(psl->lock);
+}
+
+/* Start a scan pass, the array returned stays valid until releaseList() */
+static scan_array *getList(scan_list *psl)
+{
+    /* The full barrier of the increment orders it before the load.
+     * A writer which replaces the array after this point will see
+     * nreaders != 0 and keep the old array.
+     */
+    epicsAtomicIncrIntT(&psl->nreaders);
+    return (scan_array *)epicsAtomicGetPtrT((EpicsAtomicPtrT *)&psl->parray);
+}
+
+static void releaseList(scan_list *psl)
+{
+    if (epicsAtomicDecrIntT(&psl->nreaders) == 0 &&
+        epicsAtomicGetPtrT((EpicsAtomicPtrT *)&psl->retired) &&
+        epicsMutexTryLock(psl->lock) == epicsMutexLockOK) {
+        reclaimList(psl);
         epicsMutexUnlock(psl->lock);
     }
 }
-
+
+/* Make parr the current array.  Called with psl->lock held. */
+static void publishList(scan_list *psl, scan_array *parr)
+{
+    scan_array *pold = psl->parray;
+
+    /* Full barrier, orders the store before reading nreaders */
+    epicsAtomicCmpAndSwapPtrT((EpicsAtomicPtrT *)&psl->parray, pold, parr);
+    epicsAtomicSetSizeT(&psl->count, parr ? parr->count : 0);
+    if (pold && pold != parr) {
+        pold->next = psl->retired;
+        psl->retired = pold;
+    }
+    reclaimList(psl);
+}
+
+static scan_array *allocArray(size_t size)
+{
+    scan_array *parr;
+
+    if (size < 4)
+        size = 4;
+    parr = dbMalloc(sizeof(scan_array) +
+        (size - 1) * sizeof(struct dbCommon *));
+    parr->next = NULL;
+    parr->count = 0;
+    parr->size = size;
+    return parr;
+}
+
 static void buildScanLists(void)
 {
     dbRecordType *pdbRecordType;
 
+    buildingLists = TRUE;
     for (pdbRecordType = (dbRecordType *)ellFirst(&pdbbase->recordTypeList);
          pdbRecordType;
          pdbRecordType = (dbRecordType *)ellNext(&pdbRecordType->node)) {
@@ -1022,11 +1327,14 @@ static void buildScanLists(void)
             scanAdd(precord);
         }
     }
+    buildingLists = FALSE;
 }
 
 static void addToList(struct dbCommon *precord, scan_list *psl)
 {
-    scan_element *pse, *ptemp;
+    scan_element *pse;
+    scan_array *pold, *pnew;
+    size_t count, pos;
 
     epicsMutexMustLock(psl->lock);
     pse = precord->spvt;
@@ -1036,22 +1344,41 @@ static void addToList(struct dbCommon *precord, scan_list *psl)
         pse->precord = precord;
     }
     pse->pscan_list = psl;
-    ptemp = (scan_element *)ellLast(&psl->list);
-    while (ptemp) {
-        if (ptemp->precord->phas <= precord->phas) {
-            ellInsert(&psl->list, &ptemp->node, &pse->node);
+
+    pold = psl->parray;
+    count = pold ? pold->count : 0;
+    /* after the last record with the same or a lower PHAS */
+    for (pos = count; pos > 0; pos--) {
+        if (pold->precords[pos - 1]->phas <= precord->phas)
             break;
+    }
+
+    if (buildingLists && pold && count < pold->size) {
+        /* Nothing can be scanning the list yet, change it in place */
+        pnew = pold;
+        memmove(&pnew->precords[pos + 1], &pnew->precords[pos],
+            (count - pos) * sizeof(struct dbCommon *));
+    }
+    else {
+        pnew = allocArray(buildingLists ? 2 * count : count + 1);
+        if (pold) {
+            memcpy(pnew->precords, pold->precords,
+                pos * sizeof(struct dbCommon *));
+            memcpy(&pnew->precords[pos + 1], &pold->precords[pos],
+                (count - pos) * sizeof(struct dbCommon *));
         }
-        ptemp = (scan_element *)ellPrevious(&ptemp->node);
     }
-    if (ptemp == NULL) ellAdd(&psl->list, (void *)pse);
-    psl->modified = TRUE;
+    pnew->precords[pos] = precord;
+    pnew->count = count + 1;
+    publishList(psl, pnew);
     epicsMutexUnlock(psl->lock);
 }
 
 static void deleteFromList(struct dbCommon *precord, scan_list *psl)
 {
     scan_element *pse;
+    scan_array *pold, *pnew = NULL;
+    size_t count, pos;
 
     epicsMutexMustLock(psl->lock);
     pse = precord->spvt;
@@ -1070,7 +1397,25 @@ static void deleteFromList(struct dbCommon *precord, scan_list *psl)
         return;
     }
     pse->pscan_list = NULL;
-    ellDelete(&psl->list, (void *)pse);
-    psl->modified = TRUE;
+
+    pold = psl->parray;
+    count = pold ? pold->count : 0;
+    for (pos = 0; pos < count; pos++) {
+        if (pold->precords[pos] == precord)
+            break;
+    }
+    if (pos == count) {
+        epicsMutexUnlock(psl->lock);
+        return;
+    }
+    if (count > 1) {
+        pnew = allocArray(count - 1);
+        memcpy(pnew->precords, pold->precords,
+            pos * sizeof(struct dbCommon *));
+        memcpy(&pnew->precords[pos], &pold->precords[pos + 1],
+            (count - pos - 1) * sizeof(struct dbCommon *));
+        pnew->count = count - 1;
+    }
+    publishList(psl, pnew);
     epicsMutexUnlock(psl->lock);
 }
@@ -58,6 +58,7 @@ epicsShareFunc double scanPeriod(int scan);
 epicsShareFunc int scanOnce(struct dbCommon *);
 epicsShareFunc int scanOnceCallback(struct dbCommon *, once_complete cb, void *usr);
 epicsShareFunc int scanOnceSetQueueSize(int size);
+epicsShareFunc int scanParallelThreads(int count, double rate);
 
 /*print periodic lists*/
 epicsShareFunc int scanppl(double rate);
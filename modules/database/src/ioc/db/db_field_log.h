@@ -81,6 +81,9 @@ struct dbfl_val {
  * db_delete_field_log().  Any code which changes a dbfl_type_ref
  * field log to another type, or to reference different data,
  * must explicitly call the dtor function.
+ * The referenced data may be shared with other field logs, so it must
+ * be treated as read-only. Filters which transform the data make their
+ * own copy of the result.
  */
 struct dbfl_ref {
     dbfl_freeFunc     *dtor;  /* Callback to free filter-allocated resources */
@@ -42,6 +42,7 @@ typedef struct devSup {
 	/*Following only available on run time system*/
 	struct dset	*pdset;
 	struct dsxt	*pdsxt;       /* Extended device support */
+	int		initThreadSafe; /* set by devInitThreadSafe() */
 }devSup;
 
 typedef struct linkSup {
@@ -88,6 +88,10 @@ static void dbBreakBody(void);
 
 static void dbRecordHead(char *recordType,char*name,int visible);
 static void dbRecordField(char *name,char *value);
+static void dbRecordFieldPut(char *name,char *value);
+static void dbRecordInfoPut(char *name,char *value);
+static void dbRecordAlias(char *name);
+static void dbAlias(char *name, char *alias);
 static void dbRecordBody(void);
 
 /*private declarations*/
@@ -185,6 +189,68 @@ static char *dbOpenFile(DBBASE *pdbbase,const char *filename,FILE **fp)
 }
 
 
+/* Tell the cache about a file being read */
+static void dbCacheInputFile(inputFile *pinputFile)
+{
+    char *fullfilename;
+
+    if (!pinputFile->path) {
+        dbCacheLoadFile(pinputFile->filename);
+        return;
+    }
+    fullfilename = dbMalloc(strlen(pinputFile->path) +
+        strlen(pinputFile->filename) + 2);
+    strcpy(fullfilename, pinputFile->path);
+    strcat(fullfilename, "/");
+    strcat(fullfilename, pinputFile->filename);
+    dbCacheLoadFile(fullfilename);
+    free(fullfilename);
+}
+
+/* Repeat the record definitions of a file loaded earlier */
+static long dbCacheReplay(dbCacheLoad *pload, const char *filename)
+{
+    size_t pos = 0;
+    char *args[2];
+    int op;
+    long status;
+
+    pinputFileNow = NULL;
+    while (!yyAbort && (op = dbCacheNextOp(pload, &pos, args)) > 0) {
+        switch (op) {
+        case dbCacheRecordHead:
+            dbRecordHead(args[0], args[1], 0);
+            break;
+        case dbCacheGRecordHead:
+            dbRecordHead(args[0], args[1], 1);
+            break;
+        case dbCacheRecordField:
+            dbRecordFieldPut(args[0], args[1]);
+            break;
+        case dbCacheRecordInfo:
+            dbRecordInfoPut(args[0], args[1]);
+            break;
+        case dbCacheRecordAlias:
+            dbRecordAlias(args[0]);
+            break;
+        case dbCacheAlias:
+            dbAlias(args[0], args[1]);
+            break;
+        case dbCacheRecordBody:
+            dbRecordBody();
+            break;
+        }
+    }
+    while (ellCount(&tempList))
+        dbFreeEntry(popFirstTemp());
+
+    status = (yyFailed || yyAbort) ? -1 : 0;
+    if (status)
+        epicsPrintf("\nError loading \"%s\" from the cache\n", filename);
+    yyFailed = yyAbort = FALSE;
+    return status;
+}
+
 static void freeInputFileList(void)
 {
     inputFile *pinputFileNow;
@@ -215,6 +281,7 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     inputFile	*pinputFile = NULL;
     char	*penv;
     char	**macPairs;
+    dbCacheLoad	*pload;
 
     if(ellCount(&tempList)) {
         epicsPrintf("dbReadCOM: Parser stack dirty %d\n", ellCount(&tempList));
@@ -227,10 +294,11 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     } else {
 	penv = getenv("EPICS_DB_INCLUDE_PATH");
 	if(penv) {
-	    dbPath(pdbbase,penv);
+	    path = penv;
 	} else {
-	    dbPath(pdbbase,".");
+	    path = ".";
 	}
+	dbPath(pdbbase,path);
     }
     my_buffer = dbCalloc(MY_BUFFER_SIZE,sizeof(char));
     freeListInitPvt(&freeListPvt,sizeof(tempListNode),100);
@@ -255,6 +323,14 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     if (filename) {
         pinputFile->filename = macEnvExpand(filename);
     }
+    pload = fp ? NULL :
+        dbCacheFind(pinputFile->filename, path, substitutions);
+    if (pload) {
+        status = dbCacheReplay(pload, pinputFile->filename);
+        free(pinputFile->filename);
+        free(pinputFile);
+        goto loaded;
+    }
     if (!fp) {
         FILE *fp1 = 0;
 
@@ -269,6 +345,8 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
             goto cleanup;
         }
         pinputFile->fp = fp1;
+        dbCacheLoadBegin(pinputFile->filename, path, substitutions);
+        dbCacheInputFile(pinputFile);
     } else {
         pinputFile->fp = fp;
     }
@@ -283,7 +361,9 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
         epicsPrintf("dbReadCOM: Parser stack dirty w/o error. %d\n", ellCount(&tempList));
     while (ellCount(&tempList))
         popFirstTemp(); /* Memory leak on parser failure */
+    dbCacheLoadEnd(!status);
 
+loaded:
     dbFreePath(pdbbase);
     if(!status) { /*add RTYP and VERS as an attribute */
 	DBENTRY	dbEntry;
@@ -354,6 +434,7 @@ static int db_yyinput(char *buf, int max_size)
 		    if (exp < 0) {
 			fprintf(stderr, "Warning: '%s' line %d has undefined macros\n",
 			    pinputFileNow->filename, pinputFileNow->line_num+1);
+			dbCacheLoadDrop(); /* keep the warning */
 		    }
 		}
 	    } else {
@@ -427,6 +508,7 @@ static void dbIncludeNew(char *filename)
     pinputFile->fp = fp;
     ellAdd(&inputFileList,&pinputFile->node);
     pinputFileNow = pinputFile;
+    dbCacheInputFile(pinputFile);
 }
 
 static void dbMenuHead(char *name)
@@ -1001,6 +1083,9 @@ static void dbRecordHead(char *recordType, char *name, int visible)
     DBENTRY *pdbentry;
     long status;
 
+    dbCacheLoadOp(visible ? dbCacheGRecordHead : dbCacheRecordHead,
+        recordType, name);
+
     badch = strpbrk(name, " \"'.$");
     if (badch) {
         epicsPrintf("Bad character '%c' in record name \"%s\"\n",
@@ -1063,6 +1148,18 @@ static void dbRecordHead(char *recordType, char *name, int visible)
 }
 
 static void dbRecordField(char *name,char *value)
+{
+    if (*value == '"') {
+        /* jsonSTRING values still have their quotes */
+        value++;
+        value[strlen(value) - 1] = 0;
+    }
+    dbTranslateEscape(value, value);    /* in-place; safe & legal */
+    dbCacheLoadOp(dbCacheRecordField, name, value);
+    dbRecordFieldPut(name, value);
+}
+
+static void dbRecordFieldPut(char *name,char *value)
 {
     DBENTRY *pdbentry;
     tempListNode *ptempListNode;
@@ -1084,12 +1181,6 @@ static void dbRecordField(char *name,char *value)
         yyerror(NULL);
         return;
     }
-    if (*value == '"') {
-        /* jsonSTRING values still have their quotes */
-        value++;
-        value[strlen(value) - 1] = 0;
-    }
-    dbTranslateEscape(value, value);    /* in-place; safe & legal */
     status = dbPutString(pdbentry,value);
     if (status) {
         char msg[128];
@@ -1103,6 +1194,18 @@ static void dbRecordField(char *name,char *value)
 }
 
 static void dbRecordInfo(char *name, char *value)
+{
+    if (*value == '"') {
+        /* jsonSTRING values still have their quotes */
+        value++;
+        value[strlen(value) - 1] = 0;
+    }
+    dbTranslateEscape(value, value);    /* yuck: in-place, but safe */
+    dbCacheLoadOp(dbCacheRecordInfo, name, value);
+    dbRecordInfoPut(name, value);
+}
+
+static void dbRecordInfoPut(char *name, char *value)
 {
     DBENTRY *pdbentry;
     tempListNode *ptempListNode;
@@ -1111,12 +1214,6 @@ static void dbRecordInfo(char *name, char *value)
     if (duplicate) return;
     ptempListNode = (tempListNode *)ellFirst(&tempList);
     pdbentry = ptempListNode->item;
-    if (*value == '"') {
-        /* jsonSTRING values still have their quotes */
-        value++;
-        value[strlen(value) - 1] = 0;
-    }
-    dbTranslateEscape(value, value);    /* yuck: in-place, but safe */
     status = dbPutInfo(pdbentry,name,value);
     if (status) {
         epicsPrintf("Can't set \"%s\" info \"%s\" to \"%s\"\n",
@@ -1132,6 +1229,8 @@ static void dbRecordAlias(char *name)
     tempListNode *ptempListNode;
     long status;
 
+    dbCacheLoadOp(dbCacheRecordAlias, name, NULL);
+
     if (duplicate) return;
     ptempListNode = (tempListNode *)ellFirst(&tempList);
     pdbentry = ptempListNode->item;
@@ -1149,6 +1248,7 @@ static void dbAlias(char *name, char *alias)
     DBENTRY dbEntry;
     DBENTRY *pdbEntry = &dbEntry;
 
+    dbCacheLoadOp(dbCacheAlias, name, alias);
     dbInitEntry(pdbbase, pdbEntry);
     if (dbFindRecord(pdbEntry, name)) {
         epicsPrintf("Alias \"%s\" refers to unknown record \"%s\"\n",
@@ -1167,6 +1267,8 @@ static void dbRecordBody(void)
 {
     DBENTRY *pdbentry;
 
+    dbCacheLoadOp(dbCacheRecordBody, NULL, NULL);
+
     if (duplicate) {
         duplicate = FALSE;
         return;
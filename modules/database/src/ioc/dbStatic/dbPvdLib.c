@@ -16,6 +16,7 @@
 
 #include "dbDefs.h"
 #include "ellLib.h"
+#include "epicsAtomic.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
@@ -25,22 +26,60 @@
 #include "dbStaticLib.h"
 #include "dbStaticPvt.h"
 
+/*
+ * The directory is an open addressing hash table with linear probing.
+ * Each slot holds the hash of the record name next to the entry, so a
+ * lookup only touches the records whose hash matches.
+ *
+ * Lookups take no lock.  Writers are serialized by the directory lock
+ * and only ever change a slot from empty or deleted to an entry, or
+ * from an entry to deleted, so a reader always meets an empty slot
+ * before running off the end of a chain.  When the table gets too
+ * full a writer builds a new one and publishes it; the old table is
+ * never changed again and, like deleted entries, is kept until the
+ * directory is freed as readers may still be walking it.
+ *
+ * Readers don't announce themselves, so there is no point at which
+ * that memory is known to be unused.  It is bounded though.  Each
+ * record deleted or renamed keeps one PVDENTRY.  A table that grew is
+ * at least twice the size of the one it replaces, so those retired
+ * tables together are smaller than the current one.  A table rebuilt
+ * at the same size to clear deleted slots has had at least a quarter
+ * of its slots deleted, so adds at most four slots per deleted record.
+ * Records are only deleted while databases are loaded or freed, not
+ * while an IOC runs.  dbPvdDump() shows how much is kept.
+ */
+
 typedef struct {
-    ELLLIST      list;
-    epicsMutexId lock;
-} dbPvdBucket;
+    unsigned int hash;
+    PVDENTRY     *ppvdNode;
+} dbPvdSlot;
 
-typedef struct dbPvd {
+typedef struct dbPvdTable {
+    struct dbPvdTable *retired;
     unsigned int size;
     unsigned int mask;
-    dbPvdBucket **buckets;
+    dbPvdSlot    slots[1];
+} dbPvdTable;
+
+typedef struct dbPvd {
+    dbPvdTable   *ptable;
+    epicsMutexId lock;
+    unsigned int count;     /* records */
+    unsigned int used;      /* slots holding a record or deleted */
+    dbPvdTable   *retired;  /* replaced tables, see above */
+    ELLLIST      deleted;   /* PVDENTRYs of deleted records */
 } dbPvd;
 
+/* Marks a slot whose record was deleted */
+static PVDENTRY deletedEntry;
+#define DELETED (&deletedEntry)
+
 unsigned int dbPvdHashTableSize = 0;
 
 #define MIN_SIZE 256
 #define DEFAULT_SIZE 512
-#define MAX_SIZE 65536
+#define MAX_SIZE (1u << 24)
 
 
 int dbPvdTableSize(int size)
@@ -60,6 +99,43 @@ int dbPvdTableSize(int size)
     return 0;
 }
 
+static dbPvdTable *dbPvdTableCreate(unsigned int size)
+{
+    dbPvdTable *ptable = dbCalloc(1,
+        sizeof(dbPvdTable) + (size - 1) * sizeof(dbPvdSlot));
+
+    ptable->size = size;
+    ptable->mask = size - 1;
+    return ptable;
+}
+
+static dbPvdTable *dbPvdTableGet(dbPvd *ppvd)
+{
+    dbPvdTable *ptable =
+        epicsAtomicGetPtrT((EpicsAtomicPtrT *)&ppvd->ptable);
+
+    epicsAtomicReadMemoryBarrier();
+    return ptable;
+}
+
+static PVDENTRY *dbPvdSlotGet(dbPvdSlot *pslot)
+{
+    PVDENTRY *ppvdNode =
+        epicsAtomicGetPtrT((EpicsAtomicPtrT *)&pslot->ppvdNode);
+
+    epicsAtomicReadMemoryBarrier();
+    return ppvdNode;
+}
+
+/* The hash must be set and visible before the entry is */
+static void dbPvdSlotSet(dbPvdSlot *pslot, unsigned int hash,
+    PVDENTRY *ppvdNode)
+{
+    pslot->hash = hash;
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *)&pslot->ppvdNode, ppvdNode);
+}
+
 void dbPvdInitPvt(dbBase *pdbbase)
 {
     dbPvd *ppvd;
@@ -70,10 +146,10 @@ void dbPvdInitPvt(dbBase *pdbbase)
         dbPvdHashTableSize = DEFAULT_SIZE;
     }
 
-    ppvd = (dbPvd *)dbMalloc(sizeof(dbPvd));
-    ppvd->size    = dbPvdHashTableSize;
-    ppvd->mask    = dbPvdHashTableSize - 1;
-    ppvd->buckets = dbCalloc(ppvd->size, sizeof(dbPvdBucket *));
+    ppvd = (dbPvd *)dbCalloc(1, sizeof(dbPvd));
+    ppvd->ptable = dbPvdTableCreate(dbPvdHashTableSize);
+    ppvd->lock   = epicsMutexMustCreate();
+    ellInit(&ppvd->deleted);
 
     pdbbase->ppvd = ppvd;
     return;
@@ -81,119 +157,174 @@ void dbPvdInitPvt(dbBase *pdbbase)
 
 PVDENTRY *dbPvdFind(dbBase *pdbbase, const char *name, size_t lenName)
 {
-    dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
-    
-    pbucket = ppvd->buckets[epicsMemHash(name, lenName, 0) & ppvd->mask];
-    if (pbucket == NULL) return NULL;
+    dbPvdTable *ptable = dbPvdTableGet(pdbbase->ppvd);
+    unsigned int hash = epicsMemHash(name, lenName, 0);
+    unsigned int h;
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        const char *recordname = ppvdNode->precnode->recordname;
+    for (h = hash & ptable->mask; ; h = (h + 1) & ptable->mask) {
+        dbPvdSlot *pslot = &ptable->slots[h];
+        PVDENTRY *ppvdNode = dbPvdSlotGet(pslot);
 
-        if (strncmp(name, recordname, lenName) == 0 &&
-            strlen(recordname) == lenName)
-            break;
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+        if (ppvdNode == NULL)
+            return NULL;
+        if (ppvdNode == DELETED || pslot->hash != hash)
+            continue;
+
+        if (strncmp(name, ppvdNode->name, lenName) == 0 &&
+            ppvdNode->name[lenName] == '\0')
+            return ppvdNode;
     }
-    epicsMutexUnlock(pbucket->lock);
-    return ppvdNode;
 }
-
+
+/* Copy the records into a new table and publish it.  Called locked. */
+static void dbPvdGrow(dbPvd *ppvd)
+{
+    dbPvdTable *pold = ppvd->ptable;
+    dbPvdTable *pnew;
+    unsigned int size = pold->size;
+    unsigned int h;
+
+    /* Leave the new table at most half full */
+    while ((ppvd->count + 1) * 2 > size)
+        size <<= 1;
+
+    pnew = dbPvdTableCreate(size);
+    for (h = 0; h < pold->size; h++) {
+        PVDENTRY *ppvdNode = pold->slots[h].ppvdNode;
+        unsigned int i;
+
+        if (ppvdNode == NULL || ppvdNode == DELETED)
+            continue;
+        for (i = ppvdNode->hash & pnew->mask; pnew->slots[i].ppvdNode;
+             i = (i + 1) & pnew->mask);
+        pnew->slots[i].hash = ppvdNode->hash;
+        pnew->slots[i].ppvdNode = ppvdNode;
+    }
+    ppvd->used = ppvd->count;
+
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *)&ppvd->ptable, pnew);
+    pold->retired = ppvd->retired;
+    ppvd->retired = pold;
+}
+
 PVDENTRY *dbPvdAdd(dbBase *pdbbase, dbRecordType *precordType,
     dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
+    dbPvdTable *ptable;
+    dbPvdSlot *pfree = NULL;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
+    unsigned int hash = epicsStrHash(name, 0);
     unsigned int h;
 
-    h = epicsStrHash(name, 0) & ppvd->mask;
-    pbucket = ppvd->buckets[h];
-    if (pbucket == NULL) {
-        pbucket = dbCalloc(1, sizeof(dbPvdBucket));
-        ellInit(&pbucket->list);
-        pbucket->lock = epicsMutexCreate();
-        ppvd->buckets[h] = pbucket;
-    }
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            epicsMutexUnlock(pbucket->lock);
+    epicsMutexMustLock(ppvd->lock);
+    /* Keep at least a quarter of the slots empty */
+    if ((ppvd->used + 1) * 4 > ppvd->ptable->size * 3)
+        dbPvdGrow(ppvd);
+    ptable = ppvd->ptable;
+
+    for (h = hash & ptable->mask; ; h = (h + 1) & ptable->mask) {
+        dbPvdSlot *pslot = &ptable->slots[h];
+
+        ppvdNode = pslot->ppvdNode;
+        if (ppvdNode == NULL) {
+            if (!pfree) {
+                pfree = pslot;
+                ppvd->used++;
+            }
+            break;
+        }
+        if (ppvdNode == DELETED) {
+            if (!pfree)
+                pfree = pslot;
+            continue;
+        }
+        if (pslot->hash == hash &&
+            strcmp(name, ppvdNode->name) == 0) {
+            epicsMutexUnlock(ppvd->lock);
             return NULL;
         }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
     }
+
     ppvdNode = dbCalloc(1, sizeof(PVDENTRY));
     ppvdNode->precordType = precordType;
     ppvdNode->precnode = precnode;
-    ellAdd(&pbucket->list, (ELLNODE *)ppvdNode);
-    epicsMutexUnlock(pbucket->lock);
+    ppvdNode->name = name;
+    ppvdNode->hash = hash;
+    dbPvdSlotSet(pfree, hash, ppvdNode);
+    ppvd->count++;
+    epicsMutexUnlock(ppvd->lock);
     return ppvdNode;
 }
 
 void dbPvdDelete(dbBase *pdbbase, dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
+    dbPvdTable *ptable;
     char *name = precnode->recordname;
+    unsigned int hash = epicsStrHash(name, 0);
+    unsigned int h;
 
-    pbucket = ppvd->buckets[epicsStrHash(name, 0) & ppvd->mask];
-    if (pbucket == NULL) return;
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->ptable;
+    for (h = hash & ptable->mask; ; h = (h + 1) & ptable->mask) {
+        dbPvdSlot *pslot = &ptable->slots[h];
+        PVDENTRY *ppvdNode = pslot->ppvdNode;
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (ppvdNode->precnode &&
-            ppvdNode->precnode->recordname &&
-            strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
-            free(ppvdNode);
+        if (ppvdNode == NULL)
+            break;
+        if (ppvdNode == DELETED || pslot->hash != hash)
+            continue;
+        if (strcmp(name, ppvdNode->name) == 0) {
+            dbPvdSlotSet(pslot, hash, DELETED);
+            /* Readers may still hold it */
+            ellAdd(&ppvd->deleted, &ppvdNode->node);
+            ppvd->count--;
             break;
         }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
     }
-    epicsMutexUnlock(pbucket->lock);
+    epicsMutexUnlock(ppvd->lock);
     return;
 }
 
 void dbPvdFreeMem(dbBase *pdbbase)
 {
     dbPvd *ppvd = pdbbase->ppvd;
+    dbPvdTable *ptable;
     unsigned int h;
 
     if (ppvd == NULL) return;
     pdbbase->ppvd = NULL;
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
+    ptable = ppvd->ptable;
+    for (h = 0; h < ptable->size; h++) {
+        PVDENTRY *ppvdNode = ptable->slots[h].ppvdNode;
 
-        if (pbucket == NULL) continue;
-        epicsMutexMustLock(pbucket->lock);
-        ppvd->buckets[h] = NULL;
-        while ((ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list))) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
+        if (ppvdNode && ppvdNode != DELETED)
             free(ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
-        epicsMutexDestroy(pbucket->lock);
-        free(pbucket);
     }
-    free(ppvd->buckets);
+    ellFree(&ppvd->deleted);
+
+    ptable->retired = ppvd->retired;
+    while (ptable) {
+        dbPvdTable *pnext = ptable->retired;
+
+        free(ptable);
+        ptable = pnext;
+    }
+    epicsMutexDestroy(ppvd->lock);
     free(ppvd);
 }
 
 void dbPvdDump(dbBase *pdbbase, int verbose)
 {
-    unsigned int empty = 0;
     dbPvd *ppvd;
+    dbPvdTable *ptable;
+    unsigned long retired = 0;
+    unsigned long total = 0;
+    unsigned int longest = 0;
     unsigned int h;
 
     if (!pdbbase) {
@@ -203,27 +334,33 @@ void dbPvdDump(dbBase *pdbbase, int verbose)
     ppvd = pdbbase->ppvd;
     if (ppvd == NULL) return;
 
-    printf("Process Variable Directory has %u buckets", ppvd->size);
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->ptable;
+    printf("Process Variable Directory has %u slots, %u records,"
+        " %u deleted", ptable->size, ppvd->count, ppvd->used - ppvd->count);
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
-        int i = 1;
+    for (h = 0; h < ptable->size; h++) {
+        PVDENTRY *ppvdNode = ptable->slots[h].ppvdNode;
+        unsigned int probes;
 
-        if (pbucket == NULL) {
-            empty++;
+        if (ppvdNode == NULL || ppvdNode == DELETED)
             continue;
-        }
-        epicsMutexMustLock(pbucket->lock);
-        ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-        printf("\n [%4u] %4d  ", h, ellCount(&pbucket->list));
-        while (ppvdNode && verbose) {
-            if (!(++i % 4))
-                printf("\n         ");
-            printf("  %s", ppvdNode->precnode->recordname);
-            ppvdNode = (PVDENTRY *) ellNext((ELLNODE*)ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
+
+        /* Number of slots a lookup of this record examines */
+        probes = ((h - ppvdNode->hash) & ptable->mask) + 1;
+        total += probes;
+        if (probes > longest)
+            longest = probes;
+        if (verbose)
+            printf("\n [%8u] %3u  %s", h, probes, ppvdNode->name);
     }
-    printf("\n%u buckets empty.\n", empty);
+    printf("\nLookups examine %.2f slots on average, %u at most.\n",
+        ppvd->count ? (double)total / ppvd->count : 0.0, longest);
+
+    for (ptable = ppvd->retired; ptable; ptable = ptable->retired)
+        retired += ptable->size;
+    printf("Kept for readers until freed: %d deleted entries,"
+        " %lu slots of retired tables.\n",
+        ellCount(&ppvd->deleted), retired);
+    epicsMutexUnlock(ppvd->lock);
 }
@@ -0,0 +1,570 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * A binary cache of the record instances loaded by dbReadDatabase().
+ *
+ * For each file loaded the cache holds the record, field, info and alias
+ * definitions the parser produced, after macro expansion, and the size
+ * and checksum of every file that was read for it. When the same file
+ * is loaded again with the same path and macros and none of those files
+ * has changed, the definitions are replayed from the cache without
+ * lexing, parsing or expanding anything.
+ *
+ * The file format is native byte order:
+ *   "EPICSDBC", version, byte order mark, number of loads
+ *   for each load:
+ *     filename, path, macros,
+ *     number of files, then for each file: name, size, checksum
+ *     length of the definitions, definitions
+ * Strings are a length then the characters with a nil. A definition is
+ * an operation byte followed by its string arguments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "ellLib.h"
+#include "epicsPrint.h"
+#include "epicsString.h"
+#include "epicsTypes.h"
+#include "gpHash.h"
+
+#define epicsExportSharedSymbols
+#include "dbBase.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+
+#define DBCACHE_MAGIC "EPICSDBC"
+#define DBCACHE_VERSION 1
+#define DBCACHE_ORDER 0x01020304
+
+typedef struct cacheFile {
+    const char *name;
+    epicsUInt32 size;
+    epicsUInt32 hash;
+} cacheFile;
+
+struct dbCacheLoad {
+    ELLNODE node;           /* in the list of loads to be written */
+    const char *filename;
+    const char *path;
+    const char *macros;
+    epicsUInt32 nFiles;
+    cacheFile *files;
+    epicsUInt32 opsLen;
+    char *ops;
+    int used;
+    int owned;              /* strings and ops were allocated */
+    size_t opsSize;
+};
+
+static char *cacheName;
+static char *cacheBuf;      /* contents of the cache file */
+static dbCacheLoad *cacheLoads;
+static epicsUInt32 nCacheLoads;
+static epicsUInt32 cacheNext;
+static ELLLIST loadList = ELLLIST_INIT;
+static dbCacheLoad *pRecording;
+static unsigned cacheHits, cacheMisses;
+
+/* the size and checksum of each file read, so each is only read once */
+typedef struct fileNode {
+    ELLNODE node;
+    cacheFile info;
+} fileNode;
+
+static struct gphPvt *fileHash;
+static ELLLIST fileList = ELLLIST_INIT;
+
+static const cacheFile *fileInfo(const char *name)
+{
+    GPHENTRY *pgph;
+    fileNode *pnode;
+    cacheFile *pfile;
+    FILE *fp;
+    char *buf = NULL;
+    size_t size = 0, len;
+
+    if (!fileHash)
+        gphInitPvt(&fileHash, 256);
+    pgph = gphFind(fileHash, name, &fileList);
+    if (pgph)
+        return pgph->userPvt;
+
+    pnode = dbCalloc(1, sizeof(fileNode));
+    ellAdd(&fileList, &pnode->node);
+    pfile = &pnode->info;
+    pfile->name = epicsStrDup(name);
+    fp = fopen(name, "rb");
+    if (fp) {
+        buf = dbMalloc(BUFSIZ);
+        while ((len = fread(buf, 1, BUFSIZ, fp)) > 0) {
+            pfile->hash = epicsMemHash(buf, len, pfile->hash);
+            size += len;
+        }
+        fclose(fp);
+        free(buf);
+        pfile->size = (epicsUInt32) size;
+    }
+    else {
+        /* never matches a file that was read */
+        pfile->hash = ~0u;
+        pfile->size = ~0u;
+    }
+    pgph = gphAdd(fileHash, pfile->name, &fileList);
+    pgph->userPvt = pfile;
+    return pfile;
+}
+
+static void *reallocMustSucceed(void *ptr, size_t size)
+{
+    void *pnew = realloc(ptr, size);
+
+    if (!pnew)
+        cantProceed("dbStaticCache: Can't allocate %lu bytes\n",
+            (unsigned long) size);
+    return pnew;
+}
+
+static int strEq(const char *a, const char *b)
+{
+    return !strcmp(a ? a : "", b ? b : "");
+}
+
+/* Reading */
+
+typedef struct cacheReader {
+    char *pos;
+    char *end;
+} cacheReader;
+
+static int readU32(cacheReader *prd, epicsUInt32 *pval)
+{
+    if (prd->end - prd->pos < (ptrdiff_t) sizeof(epicsUInt32))
+        return -1;
+    memcpy(pval, prd->pos, sizeof(epicsUInt32));
+    prd->pos += sizeof(epicsUInt32);
+    return 0;
+}
+
+static int readStr(cacheReader *prd, const char **pstr)
+{
+    epicsUInt32 len;
+
+    if (readU32(prd, &len) || (epicsUInt32)(prd->end - prd->pos) <= len ||
+        prd->pos[len] != 0)
+        return -1;
+    *pstr = prd->pos;
+    prd->pos += len + 1;
+    return 0;
+}
+
+static int readCache(cacheReader *prd)
+{
+    epicsUInt32 val, i, j;
+
+    if (prd->end - prd->pos < 8 || memcmp(prd->pos, DBCACHE_MAGIC, 8))
+        return -1;
+    prd->pos += 8;
+    if (readU32(prd, &val) || val != DBCACHE_VERSION ||
+        readU32(prd, &val) || val != DBCACHE_ORDER ||
+        readU32(prd, &nCacheLoads) ||
+        nCacheLoads > (epicsUInt32)(prd->end - prd->pos))
+        return -1;
+
+    cacheLoads = dbCalloc(nCacheLoads + 1, sizeof(dbCacheLoad));
+    for (i = 0; i < nCacheLoads; i++) {
+        dbCacheLoad *pload = &cacheLoads[i];
+
+        if (readStr(prd, &pload->filename) ||
+            readStr(prd, &pload->path) ||
+            readStr(prd, &pload->macros) ||
+            readU32(prd, &pload->nFiles) ||
+            pload->nFiles > (epicsUInt32)(prd->end - prd->pos))
+            return -1;
+        pload->files = dbCalloc(pload->nFiles + 1, sizeof(cacheFile));
+        for (j = 0; j < pload->nFiles; j++) {
+            if (readStr(prd, &pload->files[j].name) ||
+                readU32(prd, &pload->files[j].size) ||
+                readU32(prd, &pload->files[j].hash))
+                return -1;
+        }
+        if (readU32(prd, &pload->opsLen) ||
+            (epicsUInt32)(prd->end - prd->pos) < pload->opsLen)
+            return -1;
+        pload->ops = prd->pos;
+        prd->pos += pload->opsLen;
+    }
+    return 0;
+}
+
+static void freeLoads(void)
+{
+    epicsUInt32 i;
+
+    for (i = 0; i < nCacheLoads; i++)
+        free(cacheLoads[i].files);
+    free(cacheLoads);
+    cacheLoads = NULL;
+    nCacheLoads = 0;
+    cacheNext = 0;
+}
+
+static void freeLoad(dbCacheLoad *pload)
+{
+    if (pload->owned) {
+        free(pload->files);
+        free((void *) pload->filename);
+        free((void *) pload->path);
+        free((void *) pload->macros);
+        free(pload->ops);
+        free(pload);
+    }
+}
+
+static void freeCache(void)
+{
+    ELLNODE *pnode;
+
+    while ((pnode = ellGet(&loadList)))
+        freeLoad(CONTAINER(pnode, dbCacheLoad, node));
+    freeLoads();
+    free(cacheBuf);
+    cacheBuf = NULL;
+    free(cacheName);
+    cacheName = NULL;
+
+    if (fileHash)
+        gphFreeMem(fileHash);
+    fileHash = NULL;
+    while ((pnode = ellGet(&fileList))) {
+        fileNode *pfile = CONTAINER(pnode, fileNode, node);
+
+        free((void *) pfile->info.name);
+        free(pfile);
+    }
+}
+
+long dbCacheOpen(const char *filename)
+{
+    cacheReader rd;
+    FILE *fp;
+    long size;
+
+    if (cacheName)
+        dbCacheClose();
+    if (!filename || !*filename) {
+        epicsPrintf("dbCacheOpen: No file name\n");
+        return -1;
+    }
+    cacheName = epicsStrDup(filename);
+    cacheHits = cacheMisses = 0;
+
+    fp = fopen(filename, "rb");
+    if (!fp)
+        return 0;   /* created by dbCacheClose() */
+    if (fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0 ||
+        fseek(fp, 0, SEEK_SET)) {
+        fclose(fp);
+        size = 0;
+    }
+    else {
+        cacheBuf = dbMalloc(size + 1);
+        if (fread(cacheBuf, 1, size, fp) != (size_t) size)
+            size = 0;
+        fclose(fp);
+    }
+
+    rd.pos = cacheBuf;
+    rd.end = cacheBuf + size;
+    if (!cacheBuf || readCache(&rd)) {
+        epicsPrintf("dbCacheOpen: Ignoring invalid cache file \"%s\"\n",
+            filename);
+        freeLoads();
+    }
+    return 0;
+}
+
+/* Writing */
+
+static void writeU32(FILE *fp, epicsUInt32 val)
+{
+    fwrite(&val, sizeof(val), 1, fp);
+}
+
+static void writeStr(FILE *fp, const char *str)
+{
+    epicsUInt32 len;
+
+    if (!str)
+        str = "";
+    len = (epicsUInt32) strlen(str);
+    writeU32(fp, len);
+    fwrite(str, 1, len + 1, fp);
+}
+
+static long writeCache(void)
+{
+    char *tmpName = dbMalloc(strlen(cacheName) + 5);
+    dbCacheLoad *pload;
+    FILE *fp;
+    int err;
+
+    strcpy(tmpName, cacheName);
+    strcat(tmpName, ".tmp");
+    fp = fopen(tmpName, "wb");
+    if (!fp) {
+        epicsPrintf("dbCacheClose: Can't create \"%s\"\n", tmpName);
+        free(tmpName);
+        return -1;
+    }
+
+    fwrite(DBCACHE_MAGIC, 1, 8, fp);
+    writeU32(fp, DBCACHE_VERSION);
+    writeU32(fp, DBCACHE_ORDER);
+    writeU32(fp, ellCount(&loadList));
+    for (pload = (dbCacheLoad *) ellFirst(&loadList); pload;
+         pload = (dbCacheLoad *) ellNext(&pload->node)) {
+        epicsUInt32 j;
+
+        writeStr(fp, pload->filename);
+        writeStr(fp, pload->path);
+        writeStr(fp, pload->macros);
+        writeU32(fp, pload->nFiles);
+        for (j = 0; j < pload->nFiles; j++) {
+            writeStr(fp, pload->files[j].name);
+            writeU32(fp, pload->files[j].size);
+            writeU32(fp, pload->files[j].hash);
+        }
+        writeU32(fp, pload->opsLen);
+        fwrite(pload->ops, 1, pload->opsLen, fp);
+    }
+
+    err = ferror(fp);
+    if (fclose(fp) || err) {
+        epicsPrintf("dbCacheClose: Error writing \"%s\"\n", tmpName);
+        remove(tmpName);
+        free(tmpName);
+        return -1;
+    }
+    remove(cacheName);
+    if (rename(tmpName, cacheName)) {
+        epicsPrintf("dbCacheClose: Can't rename \"%s\" to \"%s\"\n",
+            tmpName, cacheName);
+        remove(tmpName);
+        free(tmpName);
+        return -1;
+    }
+    free(tmpName);
+    return 0;
+}
+
+long dbCacheClose(void)
+{
+    long status = 0;
+
+    if (!cacheName)
+        return 0;
+    if (pRecording)
+        dbCacheLoadEnd(0);
+
+    /* Only rewrite it if this boot loaded something different */
+    if (cacheMisses || cacheHits != nCacheLoads)
+        status = writeCache();
+    freeCache();
+    return status;
+}
+
+void dbCacheCounts(unsigned *pHits, unsigned *pMisses)
+{
+    if (pHits)
+        *pHits = cacheHits;
+    if (pMisses)
+        *pMisses = cacheMisses;
+}
+
+int dbCacheActive(void)
+{
+    return cacheName != NULL;
+}
+
+/* Replaying */
+
+static int loadValid(dbCacheLoad *pload)
+{
+    epicsUInt32 j;
+
+    for (j = 0; j < pload->nFiles; j++) {
+        const cacheFile *pfile = fileInfo(pload->files[j].name);
+
+        if (pfile->size != pload->files[j].size ||
+            pfile->hash != pload->files[j].hash)
+            return 0;
+    }
+    return 1;
+}
+
+static int loadMatches(dbCacheLoad *pload, const char *filename,
+    const char *path, const char *macros)
+{
+    return !pload->used &&
+        strEq(pload->filename, filename) &&
+        strEq(pload->path, path) &&
+        strEq(pload->macros, macros) &&
+        loadValid(pload);
+}
+
+dbCacheLoad *dbCacheFind(const char *filename, const char *path,
+    const char *macros)
+{
+    dbCacheLoad *pload = NULL;
+    epicsUInt32 i;
+
+    if (!cacheName || !filename)
+        return NULL;
+
+    /* Usually the loads are in the same order as last time */
+    if (cacheNext < nCacheLoads &&
+        loadMatches(&cacheLoads[cacheNext], filename, path, macros))
+        pload = &cacheLoads[cacheNext];
+    for (i = 0; !pload && i < nCacheLoads; i++) {
+        if (loadMatches(&cacheLoads[i], filename, path, macros))
+            pload = &cacheLoads[i];
+    }
+    if (!pload)
+        return NULL;
+
+    pload->used = TRUE;
+    cacheNext = (epicsUInt32)(pload - cacheLoads) + 1;
+    ellAdd(&loadList, &pload->node);
+    cacheHits++;
+    return pload;
+}
+
+static int opArgs(int op)
+{
+    switch (op) {
+    case dbCacheRecordField:
+    case dbCacheRecordInfo:
+    case dbCacheAlias:
+    case dbCacheRecordHead:
+    case dbCacheGRecordHead:
+        return 2;
+    case dbCacheRecordAlias:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+int dbCacheNextOp(dbCacheLoad *pload, size_t *ppos, char **args)
+{
+    cacheReader rd;
+    int op, i;
+
+    if (*ppos >= pload->opsLen)
+        return -1;
+    rd.pos = pload->ops + *ppos;
+    rd.end = pload->ops + pload->opsLen;
+    op = *rd.pos++;
+    for (i = 0; i < opArgs(op); i++) {
+        const char *str;
+
+        if (readStr(&rd, &str))
+            return -1;
+        args[i] = (char *) str;
+    }
+    *ppos = rd.pos - pload->ops;
+    return op;
+}
+
+/* Recording */
+
+void dbCacheLoadBegin(const char *filename, const char *path,
+    const char *macros)
+{
+    if (pRecording)
+        dbCacheLoadEnd(0);
+    if (!cacheName || !filename)
+        return;
+
+    pRecording = dbCalloc(1, sizeof(dbCacheLoad));
+    pRecording->owned = TRUE;
+    pRecording->filename = epicsStrDup(filename);
+    pRecording->path = epicsStrDup(path ? path : "");
+    pRecording->macros = epicsStrDup(macros ? macros : "");
+}
+
+void dbCacheLoadFile(const char *name)
+{
+    const cacheFile *pfile;
+
+    if (!pRecording || !name)
+        return;
+    pfile = fileInfo(name);
+    pRecording->files = reallocMustSucceed(pRecording->files,
+        (pRecording->nFiles + 1) * sizeof(cacheFile));
+    pRecording->files[pRecording->nFiles++] = *pfile;
+}
+
+static void appendOps(const void *data, size_t len)
+{
+    dbCacheLoad *pload = pRecording;
+
+    if (pload->opsLen + len > pload->opsSize) {
+        pload->opsSize = 2 * pload->opsSize + len + 256;
+        pload->ops = reallocMustSucceed(pload->ops, pload->opsSize);
+    }
+    memcpy(pload->ops + pload->opsLen, data, len);
+    pload->opsLen += (epicsUInt32) len;
+}
+
+static void appendStr(const char *str)
+{
+    epicsUInt32 len = (epicsUInt32) strlen(str);
+
+    appendOps(&len, sizeof(len));
+    appendOps(str, len + 1);
+}
+
+void dbCacheLoadOp(int op, const char *arg1, const char *arg2)
+{
+    char opc = (char) op;
+    int nargs;
+
+    if (!pRecording)
+        return;
+    nargs = opArgs(op);
+    appendOps(&opc, 1);
+    if (nargs > 0)
+        appendStr(arg1);
+    if (nargs > 1)
+        appendStr(arg2);
+}
+
+void dbCacheLoadDrop(void)
+{
+    if (!pRecording)
+        return;
+    freeLoad(pRecording);
+    pRecording = NULL;
+}
+
+void dbCacheLoadEnd(int ok)
+{
+    if (!pRecording)
+        return;
+    if (!ok) {
+        dbCacheLoadDrop();
+        return;
+    }
+    ellAdd(&loadList, &pRecording->node);
+    pRecording = NULL;
+    cacheMisses++;
+}
@@ -150,6 +150,23 @@ static void dbPvdTableSizeCallFunc(const iocshArgBuf *args)
     dbPvdTableSize(args[0].ival);
 }
 
+/* dbCacheOpen */
+static const iocshArg dbCacheOpenArg0 = { "file name",iocshArgString};
+static const iocshArg * const dbCacheOpenArgs[1] = {&dbCacheOpenArg0};
+static const iocshFuncDef dbCacheOpenFuncDef =
+    {"dbCacheOpen",1,dbCacheOpenArgs};
+static void dbCacheOpenCallFunc(const iocshArgBuf *args)
+{
+    dbCacheOpen(args[0].sval);
+}
+
+/* dbCacheClose */
+static const iocshFuncDef dbCacheCloseFuncDef = {"dbCacheClose",0,NULL};
+static void dbCacheCloseCallFunc(const iocshArgBuf *args)
+{
+    dbCacheClose();
+}
+
 /* dbReportDeviceConfig */
 static const iocshArg * const dbReportDeviceConfigArgs[] = {&argPdbbase};
 static const iocshFuncDef dbReportDeviceConfigFuncDef = {
@@ -176,4 +193,6 @@ void dbStaticIocRegister(void)
     iocshRegister(&dbPvdDumpFuncDef, dbPvdDumpCallFunc);
     iocshRegister(&dbPvdTableSizeFuncDef,dbPvdTableSizeCallFunc);
     iocshRegister(&dbReportDeviceConfigFuncDef, dbReportDeviceConfigCallFunc);
+    iocshRegister(&dbCacheOpenFuncDef, dbCacheOpenCallFunc);
+    iocshRegister(&dbCacheCloseFuncDef, dbCacheCloseCallFunc);
 }
@@ -92,6 +92,9 @@ epicsShareFunc long dbReadDatabase(DBBASE **ppdbbase,
 epicsShareFunc long dbReadDatabaseFP(DBBASE **ppdbbase,
     FILE *fp, const char *path, const char *substitutions);
 epicsShareFunc long dbPath(DBBASE *pdbbase, const char *path);
+epicsShareFunc long dbCacheOpen(const char *filename);
+epicsShareFunc long dbCacheClose(void);
+epicsShareFunc void dbCacheCounts(unsigned *pHits, unsigned *pMisses);
 epicsShareFunc long dbAddPath(DBBASE *pdbbase, const char *path);
 epicsShareFunc char * dbGetPromptGroupNameFromKey(DBBASE *pdbbase,
     const short key);
@@ -93,12 +93,31 @@ typedef struct dbGuiGroup {
     char        *name;
 } dbGuiGroup;
 
+/*The following are in dbStaticCache.c*/
+typedef struct dbCacheLoad dbCacheLoad;
+enum {
+    dbCacheRecordHead = 1, dbCacheGRecordHead, dbCacheRecordField,
+    dbCacheRecordInfo, dbCacheRecordAlias, dbCacheAlias, dbCacheRecordBody
+};
+int dbCacheActive(void);
+dbCacheLoad *dbCacheFind(const char *filename, const char *path,
+    const char *macros);
+int dbCacheNextOp(dbCacheLoad *pload, size_t *ppos, char **args);
+void dbCacheLoadBegin(const char *filename, const char *path,
+    const char *macros);
+void dbCacheLoadFile(const char *name);
+void dbCacheLoadOp(int op, const char *arg1, const char *arg2);
+void dbCacheLoadDrop(void);
+void dbCacheLoadEnd(int ok);
+
 /*The following are in dbPvdLib.c*/
 /*directory*/
 typedef struct{
 	ELLNODE		node;
 	dbRecordType	*precordType;
 	dbRecordNode	*precnode;
+	const char	*name;		/* precnode->recordname */
+	unsigned int	hash;		/* epicsStrHash() of the name */
 }PVDENTRY;
 epicsShareFunc int dbPvdTableSize(int size);
 extern int dbStaticDebug;
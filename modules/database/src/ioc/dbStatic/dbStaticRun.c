@@ -65,6 +65,15 @@ void devExtend(dsxt *pdsxt)
         pthisDevSup->pdsxt = pdsxt;
     }
 }
+
+void devInitThreadSafe(void)
+{
+    if (!pthisDevSup)
+        errlogPrintf("devInitThreadSafe() called outside of dbInitDevSup()\n");
+    else {
+        pthisDevSup->initThreadSafe = TRUE;
+    }
+}
 
 long dbAllocRecord(DBENTRY *pdbentry,const char *precordName)
 {
@@ -175,11 +184,14 @@ long dbFreeRecord(DBENTRY *pdbentry)
 {
     dbRecordType *pdbRecordType = pdbentry->precordType;
     dbRecordNode *precnode = pdbentry->precnode;
+    dbCommonPvt *ppvt;
 
     if(!pdbRecordType) return(S_dbLib_recordTypeNotFound);
     if(!precnode) return(S_dbLib_recNotFound);
     if(!precnode->precord) return(S_dbLib_recNotFound);
-    free(CONTAINER(precnode->precord, dbCommonPvt, common));
+    ppvt = CONTAINER(precnode->precord, dbCommonPvt, common);
+    dbArrayCopyRelease(ppvt->arrayCopy);
+    free(ppvt);
     precnode->precord = NULL;
     return(0);
 }
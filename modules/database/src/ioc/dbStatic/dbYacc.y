@@ -47,7 +47,14 @@ database_item_list:	database_item_list database_item
 database_item:	include
 	|	path
 	|	addpath
-	|	tokenMENU menu_head menu_body
+	|	dbd_item	{ dbCacheLoadDrop(); }
+	|	tokenRECORD record_head record_body
+	|	tokenGRECORD grecord_head record_body
+	|	alias
+	;
+
+/* Only record instances can be cached */
+dbd_item:	tokenMENU menu_head menu_body
 	|	tokenRECORDTYPE recordtype_head recordtype_body
 	|	device
 	|	driver
@@ -56,9 +63,6 @@ database_item:	include
 	|	function
 	|	variable
 	|	tokenBREAKTABLE	break_head break_body
-	|	tokenRECORD record_head record_body
-	|	tokenGRECORD grecord_head record_body
-	|	alias
 	;
 
 include:	tokenINCLUDE tokenSTRING
@@ -362,7 +366,8 @@ static int yyerror(char *str)
     else
         epicsPrintf("Error");
     if (!yyFailed) {    /* Only print this stuff once */
-        epicsPrintf(" at or before \"%s\"", yytext);
+        if (pinputFileNow)  /* not replaying the cache */
+            epicsPrintf(" at or before \"%s\"", yytext);
         dbIncludePrint();
         yyFailed = TRUE;
     }
@@ -47,6 +47,9 @@ typedef struct dsxt {   /* device support extension table */
 epicsShareExtern dsxt devSoft_DSXT;  /* Allow anything table */
 
 epicsShareFunc void devExtend(dsxt *pdsxt);
+/* Called by init(0) if init_record() may run at the same time as the
+ * initialization of other records, when iocInitThreads() is used */
+epicsShareFunc void devInitThreadSafe(void);
 epicsShareFunc void dbInitDevSup(struct devSup *pdevSup, dset *pdset);
 
 
@@ -20,7 +20,10 @@
 #include <macLib.h>
 #include <ellLib.h>
 #include <errlog.h>
+#include <epicsAtomic.h>
 #include <epicsString.h>
+#include <epicsThread.h>
+#include <epicsThreadPool.h>
 #include <osiFileName.h>
 
 #define MAX_BUFFER_SIZE 4096
@@ -37,6 +40,29 @@ static char *inputNextLine(inputData *pvt);
 static void inputNewIncludeFile(inputData *pvt, char *name);
 static void inputErrPrint(inputData *pvt);
 
+/* Module to keep the template files, read once each */
+typedef struct templateFile templateFile;
+
+static templateFile *templateFind(inputData *inputPvt, char *templateName);
+static void templateFreeAll(void);
+
+/* Output of one template instance */
+typedef struct outputBuffer {
+    char        *buf;
+    size_t      len;
+    size_t      size;
+} outputBuffer;
+
+static void templateExpand(templateFile *ptemplate, MAC_HANDLE *macPvt,
+    outputBuffer *pout);
+
+/* Module to expand the template instances in several threads */
+static int parallelInit(int nThreads);
+static void parallelAddGlobal(char *pval);
+static void parallelExpand(templateFile *ptemplate, char *pval);
+static void parallelFlush(void);
+static void parallelDestruct(void);
+
 /* Module to read the substitution file */
 typedef struct subInfo subInfo;
 
@@ -70,6 +96,8 @@ int main(int argc,char **argv)
     char *templateName=0;
     int  i;
     int  localScope = 1;
+    int  nThreads = epicsThreadGetCPUs();
+    int  parallel;
 
     inputConstruct(&inputPvt);
     macCreateHandle(&macPvt,0);
@@ -85,6 +113,7 @@ int main(int argc,char **argv)
             outFile = epicsStrDup(pval);
         } else if(strncmp(argv[1],"-M",2)==0) {
             addMacroReplacements(macPvt,pval);
+            parallelAddGlobal(pval);
         } else if(strncmp(argv[1],"-S",2)==0) {
             substitutionName = epicsStrDup(pval);
         } else if (strcmp(argv[1], "-V") == 0) {
@@ -93,6 +122,8 @@ int main(int argc,char **argv)
         } else if (strcmp(argv[1], "-g") == 0) {
             localScope = 0;
             narg = 1; /* no argument for this option */
+        } else if(strncmp(argv[1],"-j",2)==0) {
+            nThreads = atoi(pval);
         } else if (strcmp(argv[1], "-h") == 0) {
             usageExit(0);
         } else {
@@ -130,12 +161,18 @@ int main(int argc,char **argv)
         char *filename = 0;
         int isGlobal, isFile;
 
+        /* Instances only depend on each other with global scope, and
+         * warnings and dependencies must come out in order */
+        parallel = localScope && !opt_V && !opt_D &&
+            parallelInit(nThreads);
+
         substituteOpen(&substitutePvt,substitutionName);
         do {
             if ((isGlobal = substituteGetGlobalSet(substitutePvt))) {
                 pval = substituteGetGlobalReplacements(substitutePvt);
                 if(pval) {
                     addMacroReplacements(macPvt,pval);
+                    parallelAddGlobal(pval);
                 }
             } else if ((isFile = substituteGetNextSet(substitutePvt,&filename))) {
                 if(templateName) filename = templateName;
@@ -144,6 +181,10 @@ int main(int argc,char **argv)
                     usageExit(1);
                 }
                 while((pval = substituteGetReplacements(substitutePvt))){
+                    if (parallel) {
+                        parallelExpand(templateFind(inputPvt,filename),pval);
+                        continue;
+                    }
                     if (localScope) macPushScope(macPvt);
                     addMacroReplacements(macPvt,pval);
                     makeSubstitutions(inputPvt,macPvt,filename);
@@ -151,9 +192,12 @@ int main(int argc,char **argv)
                 }
             }
         } while (isGlobal || isFile);
+        parallelFlush();
         substituteDestruct(substitutePvt);
     }
     errlogFlush();
+    parallelDestruct();
+    templateFreeAll();
     macDeleteHandle(macPvt);
     inputDestruct(inputPvt);
     if (opt_D) {
@@ -174,6 +218,7 @@ void usageExit(int status)
         "    -D        Output file dependencies, not substitutions\n"
         "    -V        Undefined macros generate an error\n"
         "    -g        All macros have global scope\n"
+        "    -j<N>     Expand substitution file instances in <N> threads\n"
         "    -o<FILE>  Send output to <FILE>\n"
         "    -I<DIR>   Add <DIR> to include file search path\n"
         "    -M<SUBST> Add <SUBST> to (global) macro definitions\n"
@@ -207,10 +252,52 @@ static const char *cmdNames[] = {"include","substitute"};
 
 static void makeSubstitutions(inputData *inputPvt, MAC_HANDLE *macPvt, char *templateName)
 {
+    templateExpand(templateFind(inputPvt,templateName),macPvt,NULL);
+}
+
+typedef enum {lineText,lineSubstitute} lineType;
+
+typedef struct templateLine {
+    lineType    type;
+    char        *text;
+} templateLine;
+
+struct templateFile {
+    ELLNODE     node;
+    char        *name;
+    templateLine *lines;
+    size_t      nLines;
+    size_t      size;
+};
+
+static ELLLIST templateList = ELLLIST_INIT;
+
+static void templateAddLine(templateFile *ptemplate, lineType type,
+    const char *text)
+{
+    if (ptemplate->nLines == ptemplate->size) {
+        ptemplate->size = 2 * ptemplate->size + 64;
+        ptemplate->lines = realloc(ptemplate->lines,
+            ptemplate->size * sizeof(templateLine));
+        if (!ptemplate->lines) {
+            fprintf(stderr,"msi: realloc failed\n");
+            exit(1);
+        }
+    }
+    ptemplate->lines[ptemplate->nLines].type = type;
+    ptemplate->lines[ptemplate->nLines].text = epicsStrDup(text);
+    ptemplate->nLines++;
+}
+
+/* Read a template and its include files into lines to be expanded
+ * and substitute commands */
+static templateFile *templateLoad(inputData *inputPvt, char *templateName)
+{
+    templateFile *ptemplate = calloc(1,sizeof(templateFile));
     char *input;
-    static char buffer[MAX_BUFFER_SIZE];
-    int  n;
 
+    if (templateName)
+        ptemplate->name = epicsStrDup(templateName);
     inputBegin(inputPvt,templateName);
     while((input = inputNextLine(inputPvt))) {
         int     expand=1;
@@ -263,7 +350,7 @@ static void makeSubstitutions(inputData *inputPvt, MAC_HANDLE *macPvt, char *tem
                 inputNewIncludeFile(inputPvt,copy);
                 break;
             case cmdSubstitute:
-                addMacroReplacements(macPvt,copy);
+                templateAddLine(ptemplate,lineSubstitute,copy);
                 break;
             default:
                 fprintf(stderr,"msi: Logic error in makeSubstitutions\n");
@@ -274,17 +361,241 @@ static void makeSubstitutions(inputData *inputPvt, MAC_HANDLE *macPvt, char *tem
             expand = 0;
         }
 endif:
-        if (expand && !opt_D) {
-            n = macExpandString(macPvt,input,buffer,MAX_BUFFER_SIZE-1);
-            fputs(buffer,stdout);
-            if (opt_V == 1 && n < 0) {
-                fprintf(stderr,"msi: Error - undefined macros present\n");
-                opt_V++;
+        if (expand && !opt_D)
+            templateAddLine(ptemplate,lineText,input);
+    }
+    ellAdd(&templateList,&ptemplate->node);
+    return ptemplate;
+}
+
+static templateFile *templateFind(inputData *inputPvt, char *templateName)
+{
+    templateFile *ptemplate;
+
+    for (ptemplate = (templateFile *)ellFirst(&templateList); ptemplate;
+         ptemplate = (templateFile *)ellNext(&ptemplate->node)) {
+        if (templateName ? (ptemplate->name &&
+                            strcmp(ptemplate->name,templateName)==0) :
+                           !ptemplate->name)
+            return ptemplate;
+    }
+    return templateLoad(inputPvt,templateName);
+}
+
+static void templateFreeAll(void)
+{
+    templateFile *ptemplate;
+
+    while((ptemplate = (templateFile *)ellGet(&templateList))) {
+        size_t i;
+
+        for (i = 0; i < ptemplate->nLines; i++)
+            free(ptemplate->lines[i].text);
+        free(ptemplate->lines);
+        free(ptemplate->name);
+        free(ptemplate);
+    }
+}
+
+static void outputString(outputBuffer *pout, const char *str)
+{
+    size_t len;
+
+    if (!pout) {
+        fputs(str,stdout);
+        return;
+    }
+    len = strlen(str);
+    if (pout->len + len > pout->size) {
+        pout->size = 2 * pout->size + len + MAX_BUFFER_SIZE;
+        pout->buf = realloc(pout->buf,pout->size);
+        if (!pout->buf) {
+            fprintf(stderr,"msi: realloc failed\n");
+            exit(1);
+        }
+    }
+    memcpy(pout->buf + pout->len,str,len);
+    pout->len += len;
+}
+
+/* Expand a template to stdout, or to pout if not NULL */
+static void templateExpand(templateFile *ptemplate, MAC_HANDLE *macPvt,
+    outputBuffer *pout)
+{
+    char    buffer[MAX_BUFFER_SIZE];
+    size_t  i;
+    int     n;
+
+    for (i = 0; i < ptemplate->nLines; i++) {
+        templateLine *pline = &ptemplate->lines[i];
+
+        if (pline->type == lineSubstitute) {
+            addMacroReplacements(macPvt,pline->text);
+            continue;
+        }
+        n = macExpandString(macPvt,pline->text,buffer,MAX_BUFFER_SIZE-1);
+        outputString(pout,buffer);
+        if (opt_V == 1 && n < 0) {
+            fprintf(stderr,"msi: Error - undefined macros present\n");
+            opt_V++;
+        }
+    }
+}
+
+/* Instances of templates are expanded in batches, each thread taking
+ * the next one from the batch, and written out in order. Each thread
+ * has its own macro handle with the global macros, and a scope for
+ * the instance's own. */
+#define BATCH_PER_THREAD 256
+
+typedef struct instance {
+    templateFile *ptemplate;
+    char        *macros;
+    int         nGlobals;   /* global macro sets before this one */
+    outputBuffer out;
+} instance;
+
+typedef struct worker {
+    epicsJob    *job;
+    MAC_HANDLE  *macPvt;
+    int         nGlobals;   /* global macro sets installed */
+} worker;
+
+static char **globals;
+static int nGlobals, globalsSize;
+
+static epicsThreadPool *pool;
+static worker *workers;
+static int nWorkers;
+static instance *batch;
+static size_t batchSize, nBatch, nextInstance;
+
+static void parallelAddGlobal(char *pval)
+{
+    if (nGlobals == globalsSize) {
+        globalsSize = 2 * globalsSize + 16;
+        globals = realloc(globals,globalsSize * sizeof(char *));
+        if (!globals) {
+            fprintf(stderr,"msi: realloc failed\n");
+            exit(1);
+        }
+    }
+    globals[nGlobals++] = epicsStrDup(pval);
+}
+
+static void workerExpand(worker *pworker)
+{
+    size_t i;
+
+    while ((i = epicsAtomicIncrSizeT(&nextInstance) - 1) < nBatch) {
+        instance *pinstance = &batch[i];
+
+        while (pworker->nGlobals < pinstance->nGlobals)
+            addMacroReplacements(pworker->macPvt,
+                globals[pworker->nGlobals++]);
+        macPushScope(pworker->macPvt);
+        addMacroReplacements(pworker->macPvt,pinstance->macros);
+        templateExpand(pinstance->ptemplate,pworker->macPvt,
+            &pinstance->out);
+        macPopScope(pworker->macPvt);
+    }
+}
+
+static void workerJob(void *arg, epicsJobMode mode)
+{
+    if (mode == epicsJobModeRun)
+        workerExpand((worker *)arg);
+}
+
+static int parallelInit(int nThreads)
+{
+    epicsThreadPoolConfig opts;
+    int i;
+
+    if (nThreads <= 1)
+        return 0;
+
+    epicsThreadPoolConfigDefaults(&opts);
+    opts.initialThreads = opts.maxThreads = nThreads - 1;
+    pool = epicsThreadPoolCreate(&opts);
+    if (!pool)
+        return 0;
+
+    /* workers[0] is the main thread */
+    nWorkers = nThreads;
+    workers = calloc(nWorkers,sizeof(worker));
+    batchSize = BATCH_PER_THREAD * nWorkers;
+    batch = calloc(batchSize,sizeof(instance));
+    if (!workers || !batch) {
+        fprintf(stderr,"msi: calloc failed\n");
+        exit(1);
+    }
+    for (i = 0; i < nWorkers; i++) {
+        macCreateHandle(&workers[i].macPvt,0);
+        macSuppressWarning(workers[i].macPvt,1);
+        if (i > 0) {
+            workers[i].job = epicsJobCreate(pool,workerJob,&workers[i]);
+            if (!workers[i].job) {
+                fprintf(stderr,"msi: Can't create thread pool job\n");
+                exit(1);
             }
         }
     }
+    return 1;
 }
-
+
+static void parallelExpand(templateFile *ptemplate, char *pval)
+{
+    instance *pinstance = &batch[nBatch++];
+
+    pinstance->ptemplate = ptemplate;
+    pinstance->macros = epicsStrDup(pval);
+    pinstance->nGlobals = nGlobals;
+    if (nBatch == batchSize)
+        parallelFlush();
+}
+
+static void parallelFlush(void)
+{
+    size_t i;
+
+    if (!nBatch)
+        return;
+    nextInstance = 0;
+    for (i = 1; i < (size_t)nWorkers; i++)
+        epicsJobQueue(workers[i].job);
+    workerExpand(&workers[0]);
+    epicsThreadPoolWait(pool,-1.0);
+
+    for (i = 0; i < nBatch; i++) {
+        instance *pinstance = &batch[i];
+
+        fwrite(pinstance->out.buf,1,pinstance->out.len,stdout);
+        free(pinstance->out.buf);
+        free(pinstance->macros);
+        memset(pinstance,0,sizeof(instance));
+    }
+    nBatch = 0;
+}
+
+static void parallelDestruct(void)
+{
+    int i;
+
+    for (i = 0; i < nWorkers; i++) {
+        if (workers[i].job)
+            epicsJobDestroy(workers[i].job);
+        macDeleteHandle(workers[i].macPvt);
+    }
+    if (pool)
+        epicsThreadPoolDestroy(pool);
+    for (i = 0; i < nGlobals; i++)
+        free(globals[i]);
+    free(globals);
+    free(workers);
+    free(batch);
+}
+
 typedef struct inputFile{
     ELLNODE     node;
     char        *filename;
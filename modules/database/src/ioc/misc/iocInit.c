@@ -22,14 +22,19 @@
 #include <errno.h>
 #include <limits.h>
 
+#include "cantProceed.h"
 #include "dbDefs.h"
 #include "ellLib.h"
 #include "envDefs.h"
+#include "epicsAtomic.h"
 #include "epicsExit.h"
 #include "epicsGeneralTime.h"
 #include "epicsPrint.h"
 #include "epicsSignal.h"
+#include "epicsString.h"
 #include "epicsThread.h"
+#include "epicsThreadPool.h"
+#include "epicsTime.h"
 #include "errMdef.h"
 #include "iocsh.h"
 #include "taskwd.h"
@@ -55,6 +60,7 @@
 #include "dbServer.h"
 #include "dbStaticLib.h"
 #include "dbStaticPvt.h"
+#include "dbLink.h"
 #include "devSup.h"
 #include "drvSup.h"
 #include "epicsRelease.h"
@@ -121,6 +127,7 @@ static int iocBuild_1(void)
     }
 
     errlogPrintf("Starting iocInit\n");
+    dbCacheClose();     /* All records have been loaded */
     if (checkDatabase(pdbbase)) {
         errlogPrintf("iocBuild: Aborting, bad database definition (DBD)!\n");
         return -1;
@@ -515,6 +522,20 @@ static void doInitRecord0(dbRecordType *pdbRecordType, dbCommon *precord,
         prset->init_record(precord, 0);
 }
 
+static void doLookupLinks(dbRecordType *pdbRecordType, dbCommon *precord,
+    void *user)
+{
+    dbFldDes **papFldDes = pdbRecordType->papFldDes;
+    short *link_ind = pdbRecordType->link_ind;
+    int j;
+
+    for (j = 0; j < pdbRecordType->no_links; j++) {
+        dbFldDes *pdbFldDes = papFldDes[link_ind[j]];
+
+        dbLookupLink((DBLINK*)((char*)precord + pdbFldDes->offset));
+    }
+}
+
 static void doResolveLinks(dbRecordType *pdbRecordType, dbCommon *precord,
     void *user)
 {
@@ -553,17 +574,325 @@ static void doInitRecord1(dbRecordType *pdbRecordType, dbCommon *precord,
         prset->init_record(precord, 1);
 }
 
+/*
+ * With iocInitThreads(), the record initialization passes are shared with
+ * a thread pool. Any record's links may be looked up in parallel, but
+ * only records with devInitThreadSafe() device support get their
+ * init_record() calls in parallel, while the iocInit thread does the
+ * others in the usual order. The links are always resolved in order,
+ * because that merges lock sets.
+ */
+enum {
+    initPassRecord0, initPassLookupLinks, initPassResolveLinks,
+    initPassRecord1, initPasses
+};
+
+static const char * const initPassNames[initPasses] = {
+    "init_record(0)", "lookup links", "resolve links", "init_record(1)"
+};
+
+static int initThreads;
+
+typedef struct {
+    char *name;
+    unsigned long nRecords;
+    unsigned long nSafe;
+    epicsUInt64 time[initPasses];   /* ns, summed over all threads */
+} initTypeTimes;
+
+static struct {
+    unsigned nTypes;
+    initTypeTimes *types;
+    epicsUInt64 wall[initPasses];
+    int nThreads;
+} initTimes;
+
+typedef struct {
+    dbRecordType *rtyp;
+    dbCommon *prec;
+    unsigned type;                  /* index in initTimes.types */
+    int safe;
+} initRecord;
+
+static initRecord *initRecords;
+static size_t nInitRecords;
+
+/* records per chunk taken by a thread */
+#define INIT_CHUNK 64
+
+typedef struct {
+    recIterFunc func;
+    int allSafe;
+    size_t nextChunk;
+} initPass;
+
+typedef struct {
+    epicsJob *job;
+    initPass *ppass;
+    epicsUInt64 *time;              /* for each record type */
+} initWorker;
+
+static initWorker *initWorkers;
+static int nInitWorkers;
+static epicsThreadPool *initPool;
+
+int iocInitThreads(int count)
+{
+    if (iocState != iocVirgin && iocState != iocStopped) {
+        errlogPrintf("iocInitThreads: IOC already initialized\n");
+        return -1;
+    }
+    initThreads = count;
+    return 0;
+}
+
+static void initRecordsCreate(void)
+{
+    dbRecordType *pdbRecordType;
+    unsigned type = 0;
+    size_t n = 0;
+    unsigned i;
+
+    for (i = 0; i < initTimes.nTypes; i++)
+        free(initTimes.types[i].name);
+    free(initTimes.types);
+    memset(&initTimes, 0, sizeof(initTimes));
+
+    initTimes.nTypes = ellCount(&pdbbase->recordTypeList);
+    initTimes.types = callocMustSucceed(initTimes.nTypes + 1,
+        sizeof(initTypeTimes), "initRecordsCreate");
+
+    nInitRecords = 0;
+    for (pdbRecordType = (dbRecordType *)ellFirst(&pdbbase->recordTypeList);
+         pdbRecordType;
+         pdbRecordType = (dbRecordType *)ellNext(&pdbRecordType->node))
+        nInitRecords += ellCount(&pdbRecordType->recList);
+    initRecords = callocMustSucceed(nInitRecords + 1, sizeof(initRecord),
+        "initRecordsCreate");
+
+    /* the same order as iterateRecords() */
+    for (pdbRecordType = (dbRecordType *)ellFirst(&pdbbase->recordTypeList);
+         pdbRecordType;
+         pdbRecordType = (dbRecordType *)ellNext(&pdbRecordType->node),
+         type++) {
+        initTypeTimes *ptype = &initTimes.types[type];
+        dbRecordNode *pdbRecordNode;
+
+        ptype->name = epicsStrDup(pdbRecordType->name);
+
+        for (pdbRecordNode = (dbRecordNode *)ellFirst(&pdbRecordType->recList);
+             pdbRecordNode;
+             pdbRecordNode = (dbRecordNode *)ellNext(&pdbRecordNode->node)) {
+            dbCommon *precord = pdbRecordNode->precord;
+            devSup *pdevSup;
+
+            if (!precord->name[0] ||
+                pdbRecordNode->flags & DBRN_FLAGS_ISALIAS)
+                continue;
+
+            pdevSup = dbDTYPtoDevSup(pdbRecordType, precord->dtyp);
+            initRecords[n].rtyp = pdbRecordType;
+            initRecords[n].prec = precord;
+            initRecords[n].type = type;
+            initRecords[n].safe = pdevSup && pdevSup->initThreadSafe;
+            ptype->nRecords++;
+            if (initRecords[n].safe)
+                ptype->nSafe++;
+            n++;
+        }
+    }
+    nInitRecords = n;
+}
+
+static void initRecordsDo(initWorker *pw, size_t i)
+{
+    initRecord *pir = &initRecords[i];
+    epicsUInt64 start = epicsMonotonicGet();
+
+    pw->ppass->func(pir->rtyp, pir->prec, NULL);
+    pw->time[pir->type] += epicsMonotonicGet() - start;
+}
+
+static void initRecordsShare(initWorker *pw)
+{
+    initPass *ppass = pw->ppass;
+    size_t nChunks = (nInitRecords + INIT_CHUNK - 1) / INIT_CHUNK;
+    size_t chunk;
+
+    while ((chunk = epicsAtomicIncrSizeT(&ppass->nextChunk) - 1) < nChunks) {
+        size_t i = chunk * INIT_CHUNK;
+        size_t end = i + INIT_CHUNK;
+
+        if (end > nInitRecords)
+            end = nInitRecords;
+        for (; i < end; i++) {
+            if (ppass->allSafe || initRecords[i].safe)
+                initRecordsDo(pw, i);
+        }
+    }
+}
+
+static void initWorkerJob(void *arg, epicsJobMode mode)
+{
+    initWorker *pw = (initWorker *)arg;
+
+    if (mode != epicsJobModeRun)
+        return;
+    epicsThreadSetOkToBlock(1);
+    initRecordsShare(pw);
+}
+
+static void initWorkersCreate(void)
+{
+    epicsThreadPoolConfig opts;
+    int i;
+
+    nInitWorkers = initThreads > 1 ? initThreads - 1 : 0;
+    initWorkers = callocMustSucceed(nInitWorkers + 1, sizeof(initWorker),
+        "initWorkersCreate");
+    for (i = 0; i <= nInitWorkers; i++)
+        initWorkers[i].time = callocMustSucceed(initTimes.nTypes + 1,
+            sizeof(epicsUInt64), "initWorkersCreate");
+    initTimes.nThreads = 1;
+    if (nInitWorkers <= 0)
+        return;
+
+    epicsThreadPoolConfigDefaults(&opts);
+    opts.initialThreads = opts.maxThreads = nInitWorkers;
+    opts.workerPriority = epicsThreadGetPrioritySelf();
+    initPool = epicsThreadPoolCreate(&opts);
+    if (!initPool) {
+        errlogPrintf("iocInit: Can't create %d threads, initializing "
+            "records serially\n", nInitWorkers);
+        return;
+    }
+    /* initWorkers[0] is this thread */
+    for (i = 1; i <= nInitWorkers; i++) {
+        initWorkers[i].job = epicsJobCreate(initPool, initWorkerJob,
+            &initWorkers[i]);
+        if (!initWorkers[i].job)
+            cantProceed("iocInit: Can't create job\n");
+    }
+    initTimes.nThreads = initThreads;
+}
+
+static void initWorkersDestroy(void)
+{
+    int i;
+
+    for (i = 0; i <= nInitWorkers; i++) {
+        if (initWorkers[i].job)
+            epicsJobDestroy(initWorkers[i].job);
+        free(initWorkers[i].time);
+    }
+    if (initPool)
+        epicsThreadPoolDestroy(initPool);
+    initPool = NULL;
+    free(initWorkers);
+    initWorkers = NULL;
+    nInitWorkers = 0;
+
+    free(initRecords);
+    initRecords = NULL;
+    nInitRecords = 0;
+}
+
+/*
+ * parallel is 0 to initialize every record in this thread, 1 to share
+ * records with devInitThreadSafe() device support with the workers,
+ * or 2 to share all of them.
+ */
+static void initRecordsPass(int pass, recIterFunc func, int parallel)
+{
+    initPass ipass;
+    epicsUInt64 start = epicsMonotonicGet();
+    initWorker *pme = &initWorkers[0];
+    unsigned t;
+    size_t i;
+    int w;
+
+    ipass.func = func;
+    ipass.allSafe = parallel == 2;
+    ipass.nextChunk = 0;
+    for (w = 0; w <= nInitWorkers; w++)
+        initWorkers[w].ppass = &ipass;
+
+    if (!initPool || !parallel) {
+        for (i = 0; i < nInitRecords; i++)
+            initRecordsDo(pme, i);
+    }
+    else {
+        for (w = 1; w <= nInitWorkers; w++)
+            epicsJobQueue(initWorkers[w].job);
+        if (!ipass.allSafe) {
+            for (i = 0; i < nInitRecords; i++) {
+                if (!initRecords[i].safe)
+                    initRecordsDo(pme, i);
+            }
+        }
+        initRecordsShare(pme);
+        epicsThreadPoolWait(initPool, -1.0);
+    }
+
+    initTimes.wall[pass] = epicsMonotonicGet() - start;
+    for (w = 0; w <= nInitWorkers; w++) {
+        for (t = 0; t < initTimes.nTypes; t++) {
+            initTimes.types[t].time[pass] += initWorkers[w].time[t];
+            initWorkers[w].time[t] = 0;
+        }
+    }
+}
+
+void iocInitTimes(void)
+{
+    unsigned t;
+    int pass;
+
+    if (!initTimes.nThreads) {
+        printf("iocInitTimes: The IOC hasn't been initialized\n");
+        return;
+    }
+    printf("Record initialization with %d thread%s:\n",
+        initTimes.nThreads, initTimes.nThreads == 1 ? "" : "s");
+    for (pass = 0; pass < initPasses; pass++)
+        printf("    %-16s %10.3f s\n", initPassNames[pass],
+            initTimes.wall[pass] * 1e-9);
+
+    printf("Seconds per record type, summed over all threads:\n");
+    printf("%-20s %9s %9s", "record type", "records", "parallel");
+    for (pass = 0; pass < initPasses; pass++)
+        printf(" %15s", initPassNames[pass]);
+    printf("\n");
+    for (t = 0; t < initTimes.nTypes; t++) {
+        initTypeTimes *ptype = &initTimes.types[t];
+
+        if (!ptype->nRecords)
+            continue;
+        printf("%-20s %9lu %9lu", ptype->name,
+            ptype->nRecords, ptype->nSafe);
+        for (pass = 0; pass < initPasses; pass++)
+            printf(" %15.3f", ptype->time[pass] * 1e-9);
+        printf("\n");
+    }
+}
+
 static void initDatabase(void)
 {
     dbChannelInit();
-    iterateRecords(doInitRecord0, NULL);
-    iterateRecords(doResolveLinks, NULL);
-    iterateRecords(doInitRecord1, NULL);
+
+    initRecordsCreate();
+    initWorkersCreate();
+    initRecordsPass(initPassRecord0, doInitRecord0, 1);
+    if (initPool)
+        initRecordsPass(initPassLookupLinks, doLookupLinks, 2);
+    initRecordsPass(initPassResolveLinks, doResolveLinks, 0);
+    initRecordsPass(initPassRecord1, doInitRecord1, 1);
+    initWorkersDestroy();
 
     epicsAtExit(exitDatabase, NULL);
     return;
 }
-
+
 /*
  *  Process database records at initialization ordered by phase
  *     if their pini (process at init) field is set.
@@ -23,6 +23,8 @@ epicsShareFunc int iocBuildIsolated(void);
 epicsShareFunc int iocRun(void);
 epicsShareFunc int iocPause(void);
 epicsShareFunc int iocShutdown(void);
+epicsShareFunc int iocInitThreads(int count);
+epicsShareFunc void iocInitTimes(void);
 
 #ifdef __cplusplus
 }
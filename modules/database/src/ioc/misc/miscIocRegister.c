@@ -46,6 +46,23 @@ static void iocPauseCallFunc(const iocshArgBuf *args)
     iocPause();
 }
 
+/* iocInitThreads */
+static const iocshArg iocInitThreadsArg0 = { "no of threads",iocshArgInt};
+static const iocshArg * const iocInitThreadsArgs[1] = {&iocInitThreadsArg0};
+static const iocshFuncDef iocInitThreadsFuncDef =
+    {"iocInitThreads",1,iocInitThreadsArgs};
+static void iocInitThreadsCallFunc(const iocshArgBuf *args)
+{
+    iocInitThreads(args[0].ival);
+}
+
+/* iocInitTimes */
+static const iocshFuncDef iocInitTimesFuncDef = {"iocInitTimes",0,NULL};
+static void iocInitTimesCallFunc(const iocshArgBuf *args)
+{
+    iocInitTimes();
+}
+
 /* coreRelease */
 static const iocshFuncDef coreReleaseFuncDef = {"coreRelease",0,NULL};
 static void coreReleaseCallFunc(const iocshArgBuf *args)
@@ -60,6 +77,8 @@ void miscIocRegister(void)
     iocshRegister(&iocBuildFuncDef,iocBuildCallFunc);
     iocshRegister(&iocRunFuncDef,iocRunCallFunc);
     iocshRegister(&iocPauseFuncDef,iocPauseCallFunc);
+    iocshRegister(&iocInitThreadsFuncDef,iocInitThreadsCallFunc);
+    iocshRegister(&iocInitTimesFuncDef,iocInitTimesCallFunc);
     iocshRegister(&coreReleaseFuncDef, coreReleaseCallFunc);
 }
 
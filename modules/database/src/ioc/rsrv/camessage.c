@@ -372,6 +372,12 @@ static int tcp_version_action ( caHdrLargeArray *mp, void *pPayload,
         return RSRV_ERROR;
     }
 
+    /* the thread is shared with other clients, only show it in casr */
+    if ( client->pMux ) {
+        client->priority = mp->m_dataType;
+        return RSRV_OK;
+    }
+
     tmp = mp->m_dataType - CA_PROTO_PRIORITY_MIN;
     tmp *= epicsThreadPriorityCAServerHigh - epicsThreadPriorityCAServerLow;
     tmp /= CA_PROTO_PRIORITY_MAX - CA_PROTO_PRIORITY_MIN;
@@ -482,6 +488,55 @@ static void no_read_access_event ( struct client *pClient,
 /*
  *  read_reply()
  */
+/*
+ * Queue a read reply whose array is sent straight from a dbfl_type_ref
+ * field log.  Only done for large byte arrays, which need no conversion
+ * to the requested type nor to network byte order; the meta-data ahead
+ * of the array is fetched and converted as usual.
+ */
+static int read_reply_ref ( struct event_ext *pevext, struct client *pClient,
+                            struct dbChannel *dbch, db_field_log *pfl )
+{
+    struct dbr_ctrl_char meta;
+    ca_uint16_t dbrType = pevext->msg.m_dataType;
+    ca_uint32_t meta_size;
+    ca_uint32_t payload_size;
+    long item_count;
+
+    if ( pClient->proto != IPPROTO_TCP || ! pfl ||
+         pfl->type != dbfl_type_ref || ! pfl->u.r.dtor ||
+         ! pfl->u.r.field || ! dbr_type_is_CHAR ( dbrType ) ||
+         pfl->field_size != dbr_value_size[dbrType] ) {
+        return FALSE;
+    }
+
+    /* A longer request needs padding with zeros, leave that to read_reply */
+    item_count = pevext->msg.m_count ? pevext->msg.m_count : pfl->no_elements;
+    if ( item_count > pfl->no_elements ) {
+        return FALSE;
+    }
+    payload_size = dbr_size_n ( dbrType, item_count );
+    if ( payload_size < CAS_SEND_REF_MIN ) {
+        return FALSE;
+    }
+
+    /* The array is the last member of every DBR_xxx_CHAR structure */
+    meta_size = dbr_size[dbrType] - dbr_value_size[dbrType];
+    assert ( meta_size < sizeof ( meta ) );
+    {
+        long one = 1;
+
+        if ( dbChannel_get_count ( dbch, dbrType, &meta, &one, pfl ) < 0 ||
+             caNetConvert ( dbrType, &meta, &meta, TRUE, 1 ) != ECA_NORMAL ) {
+            return FALSE;
+        }
+    }
+
+    return cas_copy_in_ref ( pClient, pevext->msg.m_cmmd, payload_size,
+        dbrType, item_count, ECA_NORMAL, pevext->msg.m_available,
+        &meta, meta_size, pfl ) == ECA_NORMAL;
+}
+
 static void read_reply ( void *pArg, struct dbChannel *dbch,
                        int eventsRemaining, db_field_log *pfl )
 {
@@ -500,6 +555,13 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
 
     SEND_LOCK ( pClient );
 
+    if ( readAccess && read_reply_ref ( pevext, pClient, dbch, pfl ) ) {
+        if ( ! eventsRemaining )
+            cas_send_bs_msg ( pClient, FALSE );
+        SEND_UNLOCK ( pClient );
+        return;
+    }
+
     cid = ECA_NORMAL;
 
     /* If the client has requested a zero element count we interpret this as a
@@ -1683,7 +1745,20 @@ static int write_notify_action ( caHdrLargeArray *mp, void *pPayload,
         epicsMutexMustLock(client->putNotifyLock);
         while(pciu->pPutNotify->busy){
             epicsMutexUnlock(client->putNotifyLock);
-            status = epicsEventWaitWithTimeout(client->blockSem,60.0);
+            if ( client->pMux ) {
+                /*
+                 * don't block the thread's other clients, the
+                 * request is tried again when the put notify
+                 * completes, or every second until it times out
+                 */
+                if ( casMuxStall ( client ) < 60.0 ) {
+                    return RSRV_BLOCKED;
+                }
+                status = epicsEventWaitTimeout;
+            }
+            else {
+                status = epicsEventWaitWithTimeout(client->blockSem,60.0);
+            }
             if ( status != epicsEventWaitOK ) {
                 char busyTmp;
                 void * asWritePvtTmp = 0;
@@ -2181,12 +2256,16 @@ static int search_reply_udp ( caHdrLargeArray *mp, void *pPayload, struct client
     }
     pName[mp->m_postsize-1] = '\0';
 
+    client->nSearch++;
+
     /* Exit quickly if channel not on this node */
     if (dbChannelTest(pName)) {
         DLOG ( 2, ( "CAS: Lookup for channel \"%s\" failed\n", pPayLoad ) );
         return RSRV_OK;
     }
 
+    client->nSearchHit++;
+
     /*
      * stop further use of server if memory becomes scarce
      */
@@ -2534,12 +2613,28 @@ int camessage ( struct client *client )
             }
         }
         else {
+            /*
+             * a mux client stops reading requests while the socket
+             * doesn't take the replies, or one has to wait
+             */
+            if ( client->pMux && client->backlogSize ) {
+                casMuxStall ( client );
+                status = RSRV_OK;
+                break;
+            }
             if ( msg.m_cmmd < NELEMENTS(tcpJumpTable) ) {
                 status = ( *tcpJumpTable[msg.m_cmmd] ) ( &msg, pBody, client );
+                if ( status == RSRV_BLOCKED ) {
+                    status = RSRV_OK;
+                    break;
+                }
                 if ( status != RSRV_OK ) {
                     status = RSRV_ERROR;
                     break;
                 }
+                if ( client->muxStalled ) {
+                    casMuxUnstall ( client );
+                }
             }
             else {
                 return bad_tcp_cmd_action ( &msg, pBody, client );
@@ -35,122 +35,166 @@
 #include "server.h"
 
 /*
- *  camsgtask()
+ *  casFlushIfIdle()
  *
- *  CA server TCP client task (one spawned for each client)
+ *  send what is queued for a client unless more requests are waiting,
+ *  which allows replies to batch up if more are comming
  */
-void camsgtask ( void *pParm )
+void casFlushIfIdle ( struct client *client )
 {
-    struct client *client = (struct client *) pParm;
+    osiSockIoctl_t check_nchars;
+    int status;
+
+    status = socket_ioctl (client->sock, FIONREAD, &check_nchars);
+    if (status < 0) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString ( 
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf("CAS: FIONREAD error: %s\n",
+            sockErrBuf);
+        cas_send_bs_msg(client, TRUE);
+    }
+    else if (check_nchars == 0){
+        cas_send_bs_msg(client, TRUE);
+    }
+}
 
-    casAttachThreadToClient ( client );
+/*
+ *  casRecvMessages()
+ *
+ *  receive once from a TCP client and process the complete messages,
+ *  returns RSRV_ERROR when the client should be disconnected
+ */
+int casRecvMessages ( struct client *client )
+{
+    long nchars;
+
+    assert ( client->recv.maxstk >= client->recv.cnt );
+    nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt], 
+            (int) ( client->recv.maxstk - client->recv.cnt ), 0 );
+    if ( nchars == 0 ){
+        if ( CASDEBUG > 0 ) {
+            /* convert to u long so that %lu works on both 32 and 64 bit archs */
+            unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
+            errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
+                cnt );
+        }
+        return RSRV_ERROR;
+    }
+    else if ( nchars < 0 ) {
+        int anerrno = SOCKERRNO;
 
-    while (castcp_ctl == ctlRun && !client->disconnect) {
-        osiSockIoctl_t check_nchars;
-        long nchars;
-        int status;
+        if ( anerrno == SOCK_EINTR ) {
+            return RSRV_OK;
+        }
+
+        /* epoll tells the mux thread when to try again */
+        if ( client->pMux && ( anerrno == SOCK_EWOULDBLOCK ||
+                anerrno == SOCK_ENOBUFS ) ) {
+            return RSRV_OK;
+        }
+
+        if ( anerrno == SOCK_ENOBUFS ) {
+            errlogPrintf (
+                "CAS: Out of network buffers, retring receive in 15 seconds\n" );
+            epicsThreadSleep ( 15.0 );
+            return RSRV_OK;
+        }
 
         /*
-         * allow message to batch up if more are comming
+         * normal conn lost conditions
          */
-        status = socket_ioctl (client->sock, FIONREAD, &check_nchars);
-        if (status < 0) {
+        if (    ( anerrno != SOCK_ECONNABORTED &&
+            anerrno != SOCK_ECONNRESET &&
+            anerrno != SOCK_ETIMEDOUT ) ||
+            CASDEBUG > 2 ) {
             char sockErrBuf[64];
 
-            epicsSocketConvertErrnoToString ( 
-                sockErrBuf, sizeof ( sockErrBuf ) );
-            errlogPrintf("CAS: FIONREAD error: %s\n",
-                sockErrBuf);
-            cas_send_bs_msg(client, TRUE);
-        }
-        else if (check_nchars == 0){
-            cas_send_bs_msg(client, TRUE);
+            epicsSocketConvertErrorToString(
+                sockErrBuf, sizeof ( sockErrBuf ), anerrno);
+            errlogPrintf ( "CAS: Client disconnected - %s\n",
+                sockErrBuf );
         }
+        return RSRV_ERROR;
+    }
 
-        client->recv.stk = 0;
-        assert ( client->recv.maxstk >= client->recv.cnt );
-        nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt], 
-                (int) ( client->recv.maxstk - client->recv.cnt ), 0 );
-        if ( nchars == 0 ){
-            if ( CASDEBUG > 0 ) {
-                /* convert to u long so that %lu works on both 32 and 64 bit archs */
-                unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
-                errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
-                    cnt );
-            }
-            break;
-        }
-        else if ( nchars < 0 ) {
-            int anerrno = SOCKERRNO;
+    epicsTimeGetCurrent ( &client->time_at_last_recv );
+    client->recv.cnt += ( unsigned ) nchars;
 
-            if ( anerrno == SOCK_EINTR ) {
-                continue;
-            }
+    return casProcessMessages ( client );
+}
 
-            if ( anerrno == SOCK_ENOBUFS ) {
-                errlogPrintf (
-                    "CAS: Out of network buffers, retring receive in 15 seconds\n" );
-                epicsThreadSleep ( 15.0 );
-                continue;
-            }
+/*
+ *  casProcessMessages()
+ *
+ *  process the complete messages in the receive buffer, returns
+ *  RSRV_ERROR when the client should be disconnected
+ */
+int casProcessMessages ( struct client *client )
+{
+    int status;
 
-            /*
-             * normal conn lost conditions
-             */
-            if (    ( anerrno != SOCK_ECONNABORTED &&
-                anerrno != SOCK_ECONNRESET &&
-                anerrno != SOCK_ETIMEDOUT ) ||
-                CASDEBUG > 2 ) {
-                char sockErrBuf[64];
-
-                epicsSocketConvertErrorToString(
-                    sockErrBuf, sizeof ( sockErrBuf ), anerrno);
-                errlogPrintf ( "CAS: Client disconnected - %s\n",
-                    sockErrBuf );
-            }
-            break;
-        }
+    client->recv.stk = 0;
+    status = camessage ( client );
+    if (status == 0) {
+        /*
+         * if there is a partial message
+         * align it with the start of the buffer
+         */
+        if (client->recv.cnt > client->recv.stk) {
+            unsigned bytes_left;
 
-        epicsTimeGetCurrent ( &client->time_at_last_recv );
-        client->recv.cnt += ( unsigned ) nchars;
+            bytes_left = client->recv.cnt - client->recv.stk;
 
-        status = camessage ( client );
-        if (status == 0) {
             /*
-             * if there is a partial message
-             * align it with the start of the buffer
+             * overlapping regions handled
+             * properly by memmove 
              */
-            if (client->recv.cnt > client->recv.stk) {
-                unsigned bytes_left;
-
-                bytes_left = client->recv.cnt - client->recv.stk;
-
-                /*
-                 * overlapping regions handled
-                 * properly by memmove 
-                 */
-                memmove (client->recv.buf, 
-                    &client->recv.buf[client->recv.stk], bytes_left);
-                client->recv.cnt = bytes_left;
-            }
-            else {
-                client->recv.cnt = 0ul;
-            }
+            memmove (client->recv.buf, 
+                &client->recv.buf[client->recv.stk], bytes_left);
+            client->recv.cnt = bytes_left;
         }
         else {
-            char buf[64];
-
-            /* flush any queued messages before shutdown */
-            cas_send_bs_msg(client, 1);
-            
             client->recv.cnt = 0ul;
-            
-            /*
-             * disconnect when there are severe message errors
-             */
-            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-            epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
-                break;
+        }
+        /* for casr while the request waits */
+        client->recv.stk = 0;
+    }
+    else {
+        char buf[64];
+
+        /* flush any queued messages before shutdown */
+        cas_send_bs_msg(client, 1);
+        
+        client->recv.cnt = 0ul;
+        
+        /*
+         * disconnect when there are severe message errors
+         */
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+        epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
+/*
+ *  camsgtask()
+ *
+ *  CA server TCP client task (one spawned for each client)
+ */
+void camsgtask ( void *pParm )
+{
+    struct client *client = (struct client *) pParm;
+
+    casAttachThreadToClient ( client );
+
+    while (castcp_ctl == ctlRun && !client->disconnect) {
+        casFlushIfIdle ( client );
+
+        if ( casRecvMessages ( client ) != RSRV_OK ) {
+            break;
         }
     }
 
@@ -0,0 +1,618 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Multiplexed TCP clients
+ *
+ *  When EPICS_CAS_MUX_THREADS is set a fixed pool of CAS-mux threads
+ *  replaces the CAS-client and CAS-event threads of each client. Every
+ *  pool thread waits in epoll_wait() for requests from its share of the
+ *  client sockets, and runs the event queues of those clients itself
+ *  (see db_start_events_polled()), so subscription updates are sent by
+ *  the same thread. Posting an event queues the client on its thread's
+ *  pending list and wakes it through an eventfd.
+ *
+ *  The client sockets don't block. What a socket doesn't take is kept
+ *  in the client's backlog and sent when epoll finds it writable, and
+ *  until then the client's requests and events wait. A put notify
+ *  request to a channel whose last one is still busy also waits,
+ *  instead of blocking the thread, until that completes or times out.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "epicsAtomic.h"
+#include "epicsSignal.h"
+#include "epicsStdio.h"
+#include "errlog.h"
+#include "osiSock.h"
+#include "taskwd.h"
+
+#define epicsExportSharedSymbols
+#include "dbEvent.h"
+#include "rsrv.h"
+#include "server.h"
+
+#ifdef CAS_USE_EPOLL
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define MUX_EVENTS 64   /* epoll events taken per wait */
+
+#define MUX_STALL_POLL 1.0 /* sec between retries of waiting requests */
+
+struct casMuxThread {
+    int                 epollFD;
+    int                 wakeFD;     /* eventfd, readable if pending */
+    epicsMutexId        lock;       /* guards pending and stalled */
+    ELLLIST             pending;    /* client::muxNode, events to run */
+    ELLLIST             stalled;    /* client::muxStallNode */
+    epicsThreadId       tid;
+    int                 nClients;   /* for casMuxAssign() */
+};
+
+static struct casMuxThread *muxThreads;
+
+/*
+ *  casMuxDrop()
+ *
+ *  the client disconnected, or we gave up on it
+ */
+static void casMuxDrop ( struct client *client )
+{
+    LOCK_CLIENTQ;
+    ellDelete ( &clientQ, &client->node );
+    UNLOCK_CLIENTQ;
+
+    destroy_tcp_client ( client );
+}
+
+/*
+ *  casMuxQueue()
+ *
+ *  put a client on the pending list, returns TRUE if it was empty
+ *
+ *  thread lock must be on while in this routine
+ */
+static int casMuxQueue ( struct casMuxThread *pThread, struct client *client )
+{
+    if ( client->muxPending ) {
+        return FALSE;
+    }
+    client->muxPending = TRUE;
+    ellAdd ( &pThread->pending, &client->muxNode );
+    return ellCount ( &pThread->pending ) == 1;
+}
+
+/*
+ *  casMuxRecv()
+ *
+ *  a client socket is readable (or hung up)
+ */
+static void casMuxRecv ( struct client *client )
+{
+    epicsThreadPrivateSet ( rsrvCurrentClient, client );
+
+    if ( castcp_ctl != ctlRun || client->disconnect ||
+            casRecvMessages ( client ) != RSRV_OK || client->disconnect ) {
+        epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+        casMuxDrop ( client );
+        return;
+    }
+    /* the requests behind a waiting one aren't read */
+    if ( client->muxStalled ) {
+        cas_send_bs_msg ( client, TRUE );
+    }
+    else {
+        casFlushIfIdle ( client );
+    }
+
+    epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+}
+
+/*
+ *  casMuxEvent()
+ *
+ *  epoll reported a client socket
+ */
+static void casMuxEvent ( struct client *client, unsigned events )
+{
+    if ( events & EPOLLOUT ) {
+        /* wakes the client up if the backlog is gone */
+        cas_send_bs_msg ( client, TRUE );
+    }
+    if ( client->disconnect ) {
+        casMuxDrop ( client );
+    }
+    else if ( events & EPOLLIN ) {
+        casMuxRecv ( client );
+    }
+    else if ( events & ( EPOLLERR | EPOLLHUP ) ) {
+        /* EPOLLIN isn't watched while its requests wait */
+        casMuxDrop ( client );
+    }
+}
+
+/*
+ *  casMuxRetryStalled()
+ *
+ *  retry the waiting requests, they may have timed out
+ */
+static void casMuxRetryStalled ( struct casMuxThread *pThread )
+{
+    ELLNODE *node;
+
+    epicsMutexMustLock ( pThread->lock );
+    for ( node = ellFirst ( &pThread->stalled ); node;
+            node = ellNext ( node ) ) {
+        casMuxQueue ( pThread,
+            CONTAINER ( node, struct client, muxStallNode ) );
+    }
+    epicsMutexUnlock ( pThread->lock );
+}
+
+/*
+ *  casMuxRunPending()
+ *
+ *  run the event queues of the clients that were woken up, returns
+ *  TRUE if more were woken up in the meantime
+ */
+static int casMuxRunPending ( struct casMuxThread *pThread )
+{
+    int n, more;
+
+    /* only those queued now, or a busy client could starve the sockets */
+    epicsMutexMustLock ( pThread->lock );
+    n = ellCount ( &pThread->pending );
+    epicsMutexUnlock ( pThread->lock );
+
+    while ( n-- > 0 ) {
+        struct client *client = NULL;
+        ELLNODE *node;
+        int backlogged;
+
+        epicsMutexMustLock ( pThread->lock );
+        node = ellGet ( &pThread->pending );
+        if ( node ) {
+            client = CONTAINER ( node, struct client, muxNode );
+            client->muxPending = FALSE;
+        }
+        epicsMutexUnlock ( pThread->lock );
+
+        if ( ! node ) {
+            break;
+        }
+
+        /* woken up again when the socket has taken the backlog */
+        SEND_LOCK ( client );
+        backlogged = client->backlogSize != 0u;
+        SEND_UNLOCK ( client );
+        if ( backlogged ) {
+            continue;
+        }
+
+        epicsThreadPrivateSet ( rsrvCurrentClient, client );
+        db_process_events ( client->evuser );
+        if ( client->muxStalled && ! client->disconnect &&
+                casProcessMessages ( client ) != RSRV_OK ) {
+            client->disconnect = TRUE;
+        }
+        cas_send_bs_msg ( client, TRUE );
+        epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+
+        if ( client->disconnect ) {
+            /* an update couldn't be sent */
+            casMuxDrop ( client );
+        }
+    }
+
+    epicsMutexMustLock ( pThread->lock );
+    more = ellCount ( &pThread->pending ) > 0;
+    epicsMutexUnlock ( pThread->lock );
+    return more;
+}
+
+/*
+ *  camuxtask()
+ *
+ *  CA server thread serving many TCP clients
+ */
+static void camuxtask ( void *pParm )
+{
+    struct casMuxThread *pThread = (struct casMuxThread *) pParm;
+    struct epoll_event events[MUX_EVENTS];
+    epicsTimeStamp lastRetry;
+    int more = FALSE;
+
+    epicsSignalInstallSigAlarmIgnore ();
+    epicsSignalInstallSigPipeIgnore ();
+    taskwdInsert ( epicsThreadGetIdSelf (), NULL, NULL );
+    epicsTimeGetCurrent ( &lastRetry );
+
+    while ( TRUE ) {
+        epicsTimeStamp now;
+        int i, n, timeout;
+
+        epicsMutexMustLock ( pThread->lock );
+        if ( more ) {
+            timeout = 0;
+        }
+        else if ( ellCount ( &pThread->stalled ) ) {
+            timeout = (int) ( MUX_STALL_POLL * 1000 );
+        }
+        else {
+            timeout = -1;
+        }
+        epicsMutexUnlock ( pThread->lock );
+
+        n = epoll_wait ( pThread->epollFD, events, MUX_EVENTS, timeout );
+        if ( n < 0 ) {
+            char sockErrBuf[64];
+
+            if ( errno == EINTR ) {
+                continue;
+            }
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            errlogPrintf ( "CAS: epoll_wait error: %s\n", sockErrBuf );
+            epicsThreadSleep ( 15.0 );
+            continue;
+        }
+
+        for ( i = 0; i < n; i++ ) {
+            struct client *client = (struct client *) events[i].data.ptr;
+
+            if ( client ) {
+                casMuxEvent ( client, events[i].events );
+            }
+            else {
+                epicsUInt64 count;
+
+                if ( read ( pThread->wakeFD, &count, sizeof ( count ) ) < 0 &&
+                        errno != EAGAIN ) {
+                    errlogPrintf ( "CAS: eventfd read error\n" );
+                }
+            }
+        }
+
+        epicsTimeGetCurrent ( &now );
+        if ( epicsTimeDiffInSeconds ( &now, &lastRetry ) >= MUX_STALL_POLL ) {
+            casMuxRetryStalled ( pThread );
+            lastRetry = now;
+        }
+
+        more = casMuxRunPending ( pThread );
+    }
+}
+
+/*
+ *  casMuxStart()
+ *
+ *  start the pool, returns the number of threads started
+ */
+unsigned casMuxStart ( unsigned nThreads )
+{
+    unsigned i;
+
+    muxThreads = callocMustSucceed ( nThreads, sizeof ( *muxThreads ),
+        "casMuxStart" );
+
+    for ( i = 0u; i < nThreads; i++ ) {
+        struct casMuxThread *pThread = &muxThreads[i];
+        struct epoll_event ev;
+
+        pThread->epollFD = epoll_create1 ( EPOLL_CLOEXEC );
+        pThread->wakeFD = eventfd ( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        if ( pThread->epollFD < 0 || pThread->wakeFD < 0 ) {
+            char sockErrBuf[64];
+
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            errlogPrintf ( "CAS: unable to create epoll instance: %s\n",
+                sockErrBuf );
+            break;
+        }
+        memset ( &ev, 0, sizeof ( ev ) );
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        if ( epoll_ctl ( pThread->epollFD, EPOLL_CTL_ADD, pThread->wakeFD,
+                &ev ) < 0 ) {
+            errlogPrintf ( "CAS: unable to watch eventfd\n" );
+            break;
+        }
+        pThread->lock = epicsMutexMustCreate ();
+        ellInit ( &pThread->pending );
+        ellInit ( &pThread->stalled );
+
+        pThread->tid = epicsThreadCreate ( "CAS-mux",
+            epicsThreadPriorityCAServerLow,
+            epicsThreadGetStackSize ( epicsThreadStackBig ),
+            camuxtask, pThread );
+        if ( ! pThread->tid ) {
+            errlogPrintf ( "CAS: task creation for client multiplexer failed\n" );
+            epicsMutexDestroy ( pThread->lock );
+            break;
+        }
+    }
+
+    if ( i < nThreads ) {
+        if ( muxThreads[i].epollFD >= 0 ) {
+            close ( muxThreads[i].epollFD );
+        }
+        if ( muxThreads[i].wakeFD >= 0 ) {
+            close ( muxThreads[i].wakeFD );
+        }
+    }
+    if ( i == 0u ) {
+        free ( muxThreads );
+        muxThreads = NULL;
+    }
+    return i;
+}
+
+/*
+ *  casMuxAssign()
+ *
+ *  pick the thread with the fewest clients, before the client's events
+ *  are started
+ */
+void casMuxAssign ( struct client *client )
+{
+    struct casMuxThread *pThread = &muxThreads[0];
+    unsigned i;
+
+    for ( i = 1u; i < casMuxThreads; i++ ) {
+        if ( epicsAtomicGetIntT ( &muxThreads[i].nClients ) <
+                epicsAtomicGetIntT ( &pThread->nClients ) ) {
+            pThread = &muxThreads[i];
+        }
+    }
+    epicsAtomicIncrIntT ( &pThread->nClients );
+    client->pMux = pThread;
+    client->tid = pThread->tid;
+}
+
+/*
+ *  casMuxAttach()
+ *
+ *  start serving an assigned client
+ */
+int casMuxAttach ( struct client *client )
+{
+    struct epoll_event ev;
+    osiSockIoctl_t yes = TRUE;
+
+    /* the version reply queued by create_tcp_client(), before
+     * the socket stops blocking */
+    cas_send_bs_msg ( client, TRUE );
+    if ( client->disconnect ) {
+        return RSRV_ERROR;
+    }
+
+    if ( socket_ioctl ( client->sock, FIONBIO, &yes ) < 0 ) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: unable to set non-blocking IO: %s\n",
+            sockErrBuf );
+        return RSRV_ERROR;
+    }
+
+    /* the thread may drop the client as soon as it's added */
+    client->muxEvents = EPOLLIN;
+    memset ( &ev, 0, sizeof ( ev ) );
+    ev.events = EPOLLIN;
+    ev.data.ptr = client;
+    if ( epoll_ctl ( client->pMux->epollFD, EPOLL_CTL_ADD, client->sock,
+            &ev ) < 0 ) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: epoll_ctl error: %s\n", sockErrBuf );
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
+/*
+ *  casMuxDetach()
+ *
+ *  called by destroy_client(), the client's events are closed already
+ */
+void casMuxDetach ( struct client *client )
+{
+    struct casMuxThread *pThread = client->pMux;
+
+    if ( client->sock != INVALID_SOCKET ) {
+        /* fails harmlessly if it never was attached */
+        epoll_ctl ( pThread->epollFD, EPOLL_CTL_DEL, client->sock, NULL );
+    }
+
+    epicsMutexMustLock ( pThread->lock );
+    if ( client->muxPending ) {
+        ellDelete ( &pThread->pending, &client->muxNode );
+        client->muxPending = FALSE;
+    }
+    if ( client->muxStalled ) {
+        ellDelete ( &pThread->stalled, &client->muxStallNode );
+        client->muxStalled = FALSE;
+    }
+    epicsMutexUnlock ( pThread->lock );
+
+    free ( client->pBacklog );
+    client->pBacklog = NULL;
+    client->backlogSize = 0u;
+    client->backlogSent = 0u;
+
+    epicsAtomicDecrIntT ( &pThread->nClients );
+    client->pMux = NULL;
+    client->tid = 0;
+}
+
+/*
+ *  casMuxWakeup()
+ *
+ *  the wakeup function given to db_start_events_polled(), may be called
+ *  by any thread
+ */
+void casMuxWakeup ( void *pArg )
+{
+    struct client *client = (struct client *) pArg;
+    struct casMuxThread *pThread = client->pMux;
+    int signal;
+
+    epicsMutexMustLock ( pThread->lock );
+    signal = casMuxQueue ( pThread, client );
+    epicsMutexUnlock ( pThread->lock );
+
+    if ( signal ) {
+        epicsUInt64 one = 1u;
+
+        if ( write ( pThread->wakeFD, &one, sizeof ( one ) ) < 0 &&
+                errno != EAGAIN ) {
+            errlogPrintf ( "CAS: eventfd write error\n" );
+        }
+    }
+}
+
+/*
+ *  casMuxWatch()
+ *
+ *  have epoll report what the client waits for, no requests while
+ *  they are stalled and the socket becoming writable while there is
+ *  a backlog
+ *
+ *  send lock must be on while in this routine
+ */
+void casMuxWatch ( struct client *client )
+{
+    struct epoll_event ev;
+    unsigned events = 0u;
+
+    if ( client->backlogSize ) {
+        events = EPOLLOUT;
+    }
+    else if ( ! client->muxStalled ) {
+        events = EPOLLIN;
+    }
+    if ( events == client->muxEvents || client->sock == INVALID_SOCKET ) {
+        return;
+    }
+
+    memset ( &ev, 0, sizeof ( ev ) );
+    ev.events = events;
+    ev.data.ptr = client;
+    if ( epoll_ctl ( client->pMux->epollFD, EPOLL_CTL_MOD, client->sock,
+            &ev ) < 0 ) {
+        char sockErrBuf[64];
+
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: epoll_ctl error: %s\n", sockErrBuf );
+        return;
+    }
+    client->muxEvents = events;
+}
+
+/*
+ *  casMuxStall()
+ *
+ *  the request at the start of the receive buffer has to wait, returns
+ *  the seconds since it started waiting
+ */
+double casMuxStall ( struct client *client )
+{
+    struct casMuxThread *pThread = client->pMux;
+    epicsTimeStamp now;
+    double stalled = 0.0;
+
+    epicsTimeGetCurrent ( &now );
+
+    SEND_LOCK ( client );
+    if ( client->muxStalled ) {
+        stalled = epicsTimeDiffInSeconds ( &now, &client->muxStallTime );
+    }
+    else {
+        client->muxStalled = TRUE;
+        client->muxStallTime = now;
+        casMuxWatch ( client );
+
+        epicsMutexMustLock ( pThread->lock );
+        ellAdd ( &pThread->stalled, &client->muxStallNode );
+        epicsMutexUnlock ( pThread->lock );
+    }
+    SEND_UNLOCK ( client );
+
+    return stalled;
+}
+
+/*
+ *  casMuxUnstall()
+ *
+ *  the request which had to wait went through
+ */
+void casMuxUnstall ( struct client *client )
+{
+    struct casMuxThread *pThread = client->pMux;
+
+    SEND_LOCK ( client );
+    if ( client->muxStalled ) {
+        client->muxStalled = FALSE;
+        casMuxWatch ( client );
+
+        epicsMutexMustLock ( pThread->lock );
+        ellDelete ( &pThread->stalled, &client->muxStallNode );
+        epicsMutexUnlock ( pThread->lock );
+    }
+    SEND_UNLOCK ( client );
+}
+
+#else /* CAS_USE_EPOLL */
+
+unsigned casMuxStart ( unsigned nThreads )
+{
+    errlogPrintf ( "CAS: EPICS_CAS_MUX_THREADS isn't supported on this target\n" );
+    return 0u;
+}
+
+void casMuxAssign ( struct client *client )
+{
+}
+
+int casMuxAttach ( struct client *client )
+{
+    return RSRV_ERROR;
+}
+
+void casMuxDetach ( struct client *client )
+{
+}
+
+void casMuxWakeup ( void *pArg )
+{
+}
+
+void casMuxWatch ( struct client *client )
+{
+}
+
+double casMuxStall ( struct client *client )
+{
+    return 0.0;
+}
+
+void casMuxUnstall ( struct client *client )
+{
+}
+
+#endif /* CAS_USE_EPOLL */
@@ -33,6 +33,256 @@
 #define epicsExportSharedSymbols
 #include "server.h"
 
+/* A run of bytes in the outgoing stream */
+struct send_segment {
+    char        *pBuf;
+    unsigned    len;
+};
+
+/*
+ * Append the part of a segment which has not been sent yet,
+ * *pSkip is the number of bytes of the stream still to skip.
+ */
+static unsigned cas_add_segment ( struct send_segment *pSeg, unsigned n,
+    char *pBuf, unsigned len, unsigned long *pSkip )
+{
+    if ( *pSkip >= len ) {
+        *pSkip -= len;
+        return n;
+    }
+    pSeg[n].pBuf = pBuf + *pSkip;
+    pSeg[n].len = len - *pSkip;
+    *pSkip = 0u;
+    return pSeg[n].len ? n + 1 : n;
+}
+
+/*
+ *  cas_stream_segments()
+ *
+ *  what is left of the send buffer, with the field log data queued
+ *  by cas_copy_in_ref() in their place, returns the number of segments
+ */
+static unsigned cas_stream_segments ( struct client *pclient,
+    struct send_segment *seg )
+{
+    unsigned long skip = pclient->sendDone;
+    unsigned pos = 0u;
+    unsigned n = 0u;
+    unsigned i;
+
+    for ( i = 0u; i <= pclient->nSendRef; i++ ) {
+        struct send_ref *pRef = &pclient->sendRef[i];
+        unsigned end = i < pclient->nSendRef ?
+            pRef->offset : pclient->send.stk;
+
+        n = cas_add_segment ( seg, n, &pclient->send.buf[pos],
+            end - pos, &skip );
+        pos = end;
+        if ( i < pclient->nSendRef ) {
+            n = cas_add_segment ( seg, n, pRef->fl.u.r.field,
+                pRef->size, &skip );
+        }
+    }
+    return n;
+}
+
+/*
+ *  cas_send_stream()
+ *
+ *  send what is left of the send buffer
+ */
+static int cas_send_stream ( struct client *pclient )
+{
+    struct send_segment seg[2 * CAS_SEND_REFS + 1];
+    unsigned n = cas_stream_segments ( pclient, seg );
+    unsigned i;
+
+    assert ( n > 0u );
+
+#ifdef CAS_USE_SENDMSG
+    {
+        struct iovec iov[2 * CAS_SEND_REFS + 1];
+        struct msghdr msg;
+
+        for ( i = 0u; i < n; i++ ) {
+            iov[i].iov_base = seg[i].pBuf;
+            iov[i].iov_len = seg[i].len;
+        }
+        memset ( &msg, 0, sizeof ( msg ) );
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        return sendmsg ( pclient->sock, &msg, 0 );
+    }
+#else
+    return send ( pclient->sock, seg[0].pBuf, seg[0].len, 0 );
+#endif
+}
+
+/*
+ *  cas_release_send_refs()
+ *
+ *  free the field logs queued by cas_copy_in_ref()
+ *
+ *  send lock must be on while in this routine
+ */
+void cas_release_send_refs ( struct client *pclient )
+{
+    unsigned i;
+
+    for ( i = 0u; i < pclient->nSendRef; i++ ) {
+        db_field_log *pfl = &pclient->sendRef[i].fl;
+        pfl->u.r.dtor ( pfl );
+    }
+    pclient->nSendRef = 0u;
+    pclient->sendDone = 0u;
+}
+
+/*
+ *  cas_send_failed()
+ *
+ *  disconnect a client whose socket failed
+ *
+ *  send lock must be on while in this routine
+ */
+static void cas_send_failed ( struct client *pclient, int anerrno )
+{
+    int causeWasSocketHangup = 0;
+    char buf[64];
+
+    ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
+
+    if (    
+        anerrno == SOCK_ECONNABORTED ||
+        anerrno == SOCK_ECONNRESET ||
+        anerrno == SOCK_EPIPE ||
+        anerrno == SOCK_ETIMEDOUT ) {
+        causeWasSocketHangup = 1;
+    }
+    else {
+        char sockErrBuf[64];
+        epicsSocketConvertErrorToString ( 
+            sockErrBuf, sizeof ( sockErrBuf ), anerrno );
+        errlogPrintf ( "CAS: TCP send to %s failed: %s\n",
+            buf, sockErrBuf);
+    }
+    pclient->disconnect = TRUE;
+    pclient->send.stk = 0u;
+    cas_release_send_refs ( pclient );
+
+    /*
+     * wakeup the receive thread
+     */
+    if ( ! causeWasSocketHangup ) {
+        enum epicsSocketSystemCallInterruptMechanismQueryInfo info  =
+            epicsSocketSystemCallInterruptMechanismQuery ();
+        switch ( info ) {
+        case esscimqi_socketCloseRequired:
+            if ( pclient->sock != INVALID_SOCKET ) {
+                epicsSocketDestroy ( pclient->sock );
+                pclient->sock = INVALID_SOCKET;
+            }
+            break;
+        case esscimqi_socketBothShutdownRequired:
+            {
+                int status = shutdown ( pclient->sock, SHUT_RDWR );
+                if ( status ) {
+                    char sockErrBuf[64];
+                    epicsSocketConvertErrnoToString ( 
+                        sockErrBuf, sizeof ( sockErrBuf ) );
+                    errlogPrintf ("CAS: Socket shutdown error: %s\n",
+                        sockErrBuf );
+                }
+            }
+            break;
+        case esscimqi_socketSigAlarmRequired:
+            epicsSignalRaiseSigAlarm ( pclient->tid );
+            break;
+        default:
+            break;
+        };
+    }
+}
+
+#ifdef CAS_USE_EPOLL
+
+/*
+ *  cas_backlog_stream()
+ *
+ *  keep what the non-blocking socket of a mux client didn't take,
+ *  the mux thread sends it once the socket is writable again
+ *
+ *  send lock must be on while in this routine
+ */
+static void cas_backlog_stream ( struct client *pclient )
+{
+    struct send_segment seg[2 * CAS_SEND_REFS + 1];
+    unsigned n = cas_stream_segments ( pclient, seg );
+    unsigned long size = pclient->backlogSize;
+    char *pBacklog;
+    unsigned i;
+
+    for ( i = 0u; i < n; i++ ) {
+        size += seg[i].len;
+    }
+    pBacklog = realloc ( pclient->pBacklog, size );
+    if ( pBacklog ) {
+        pclient->pBacklog = pBacklog;
+        for ( i = 0u; i < n; i++ ) {
+            memcpy ( &pBacklog[pclient->backlogSize],
+                seg[i].pBuf, seg[i].len );
+            pclient->backlogSize += seg[i].len;
+        }
+        pclient->send.stk = 0u;
+        cas_release_send_refs ( pclient );
+    }
+    else {
+        errlogPrintf ( "CAS: no memory for the replies to a slow client\n" );
+        cas_send_failed ( pclient, SOCK_ENOBUFS );
+    }
+}
+
+/*
+ *  cas_send_backlog()
+ *
+ *  send what the socket of a mux client didn't take before,
+ *  returns TRUE when nothing is left
+ *
+ *  send lock must be on while in this routine
+ */
+static int cas_send_backlog ( struct client *pclient )
+{
+    while ( pclient->backlogSent < pclient->backlogSize ) {
+        int status = send ( pclient->sock,
+            &pclient->pBacklog[pclient->backlogSent],
+            pclient->backlogSize - pclient->backlogSent, 0 );
+
+        if ( status >= 0 ) {
+            pclient->backlogSent += (unsigned) status;
+        }
+        else {
+            int anerrno = SOCKERRNO;
+
+            if ( anerrno == SOCK_EINTR ) {
+                continue;
+            }
+            if ( anerrno == SOCK_EWOULDBLOCK || anerrno == SOCK_ENOBUFS ) {
+                return FALSE;
+            }
+            cas_send_failed ( pclient, anerrno );
+            break;
+        }
+    }
+
+    free ( pclient->pBacklog );
+    pclient->pBacklog = NULL;
+    pclient->backlogSize = 0u;
+    pclient->backlogSent = 0u;
+    epicsTimeGetCurrent ( &pclient->time_at_last_send );
+    return TRUE;
+}
+
+#endif /* CAS_USE_EPOLL */
+
 /*
  *  cas_send_bs_msg()
  *
@@ -44,10 +294,16 @@
 void cas_send_bs_msg ( struct client *pclient, int lock_needed )
 {
     int status;
+#ifdef CAS_USE_EPOLL
+    int backlogged;
+#endif
 
     if ( lock_needed ) {
         SEND_LOCK ( pclient );
     }
+#ifdef CAS_USE_EPOLL
+    backlogged = pclient->backlogSize != 0u;
+#endif
 
     if ( CASDEBUG > 2 && pclient->send.stk ) {
         errlogPrintf ( "CAS: Sending a message of %d bytes\n", pclient->send.stk );
@@ -59,34 +315,49 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 pclient->sock, (unsigned) pclient->addr.sin_addr.s_addr );
         }
         pclient->send.stk = 0u;
+        cas_release_send_refs ( pclient );
         if(lock_needed)
             SEND_UNLOCK(pclient);
         return;
     }
 
+#ifdef CAS_USE_EPOLL
+    /* the backlog goes first */
+    if ( backlogged && ! cas_send_backlog ( pclient ) ) {
+        if ( pclient->send.stk ) {
+            cas_backlog_stream ( pclient );
+        }
+        if ( lock_needed ) {
+            SEND_UNLOCK(pclient);
+        }
+        return;
+    }
+#endif
+
     while ( pclient->send.stk && ! pclient->disconnect ) {
-        status = send ( pclient->sock, pclient->send.buf, pclient->send.stk, 0 );
+        status = cas_send_stream ( pclient );
         if ( status >= 0 ) {
-            unsigned transferSize = (unsigned) status;
-            if ( transferSize >= pclient->send.stk ) {
+            unsigned long streamSize = pclient->send.stk;
+            unsigned i;
+
+            for ( i = 0u; i < pclient->nSendRef; i++ ) {
+                streamSize += pclient->sendRef[i].size;
+            }
+            /* a partial send is resumed where it stopped */
+            pclient->sendDone += (unsigned) status;
+            if ( pclient->sendDone >= streamSize ) {
                 pclient->send.stk = 0;
+                cas_release_send_refs ( pclient );
                 epicsTimeGetCurrent ( &pclient->time_at_last_send );
                 break;
             }
-            else {
-                unsigned bytesLeft = pclient->send.stk - transferSize;
-                memmove ( pclient->send.buf, &pclient->send.buf[transferSize], 
-                    bytesLeft );
-                pclient->send.stk = bytesLeft;
-            }
         }
         else {
-            int causeWasSocketHangup = 0;
             int anerrno = SOCKERRNO;
-            char buf[64];
 
             if ( pclient->disconnect ) {
                 pclient->send.stk = 0u;
+                cas_release_send_refs ( pclient );
                 break;
             }
 
@@ -94,6 +365,15 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 continue;
             }
 
+#ifdef CAS_USE_EPOLL
+            /* never block the other clients of a mux thread */
+            if ( pclient->pMux && ( anerrno == SOCK_EWOULDBLOCK ||
+                    anerrno == SOCK_ENOBUFS ) ) {
+                cas_backlog_stream ( pclient );
+                break;
+            }
+#endif
+
             if ( anerrno == SOCK_ENOBUFS ) {
                 errlogPrintf (
                     "CAS: Out of network buffers, retrying send in 15 seconds\n" );
@@ -101,60 +381,21 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 continue;
             }
 
-            ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
+            cas_send_failed ( pclient, anerrno );
+            break;
+        }
+    }
 
-            if (    
-                anerrno == SOCK_ECONNABORTED ||
-                anerrno == SOCK_ECONNRESET ||
-                anerrno == SOCK_EPIPE ||
-                anerrno == SOCK_ETIMEDOUT ) {
-                causeWasSocketHangup = 1;
-            }
-            else {
-                char sockErrBuf[64];
-                epicsSocketConvertErrnoToString ( 
-                    sockErrBuf, sizeof ( sockErrBuf ) );
-                errlogPrintf ( "CAS: TCP send to %s failed: %s\n",
-                    buf, sockErrBuf);
-            }
-            pclient->disconnect = TRUE;
-            pclient->send.stk = 0u;
-
-            /*
-             * wakeup the receive thread
-             */
-            if ( ! causeWasSocketHangup ) {
-                enum epicsSocketSystemCallInterruptMechanismQueryInfo info  =
-                    epicsSocketSystemCallInterruptMechanismQuery ();
-                switch ( info ) {
-                case esscimqi_socketCloseRequired:
-                    if ( pclient->sock != INVALID_SOCKET ) {
-                        epicsSocketDestroy ( pclient->sock );
-                        pclient->sock = INVALID_SOCKET;
-                    }
-                    break;
-                case esscimqi_socketBothShutdownRequired:
-                    {
-                        int status = shutdown ( pclient->sock, SHUT_RDWR );
-                        if ( status ) {
-                            char sockErrBuf[64];
-                            epicsSocketConvertErrnoToString ( 
-                                sockErrBuf, sizeof ( sockErrBuf ) );
-                            errlogPrintf ("CAS: Socket shutdown error: %s\n",
-                                sockErrBuf );
-                        }
-                    }
-                    break;
-                case esscimqi_socketSigAlarmRequired:
-                    epicsSignalRaiseSigAlarm ( pclient->tid );
-                    break;
-                default:
-                    break;
-                };
-                break;
-            }
+#ifdef CAS_USE_EPOLL
+    if ( pclient->pMux && backlogged != ( pclient->backlogSize != 0u ) ) {
+        /* watch for the socket to become writable, or stop */
+        casMuxWatch ( pclient );
+        if ( backlogged ) {
+            /* the client's requests and events were held back */
+            casMuxWakeup ( pclient );
         }
     }
+#endif
 
     if ( lock_needed ) {
         SEND_UNLOCK(pclient);
@@ -165,14 +406,59 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
     return;
 }
 
+/*
+ *  cas_dg_error()
+ *
+ *  report a failed udp send
+ */
+static void cas_dg_error ( struct client * pclient,
+    const struct sockaddr_in * pAddr )
+{
+    char sockErrBuf[64];
+    char buf[128];
+
+    epicsSocketConvertErrnoToString (
+        sockErrBuf, sizeof ( sockErrBuf ) );
+    ipAddrToDottedIP ( pAddr, buf, sizeof(buf) );
+    errlogPrintf( "CAS: UDP send to %s failed: %s\n",
+        buf, sockErrBuf);
+    pclient->nDropped++;
+}
+
+/*
+ *  cas_send_dg()
+ */
+static void cas_send_dg ( struct client * pclient, const char * pDG,
+    int sizeDG, const struct sockaddr_in * pAddr )
+{
+    int status;
+
+    status = sendto ( pclient->sock, pDG, sizeDG, 0,
+       (const struct sockaddr *)pAddr, sizeof(*pAddr) );
+    if ( status >= 0 ) {
+        if ( status >= sizeDG ) {
+            epicsTimeGetCurrent ( &pclient->time_at_last_send );
+        }
+        else {
+            errlogPrintf ( 
+                "CAS: System failed to send entire udp frame?\n" );
+        }
+    }
+    else {
+        cas_dg_error ( pclient, pAddr );
+    }
+}
+
 /*
  *  cas_send_dg_msg()
  *
  *  (channel access server send udp message)
+ *
+ *  With a send batch the message is only queued,
+ *  cas_send_dg_batch() sends it.
  */
 void cas_send_dg_msg ( struct client * pclient )
 {
-    int status;
     int sizeDG;
     char * pDG; 
     caHdr * pMsg;
@@ -201,25 +487,18 @@ void cas_send_dg_msg ( struct client * pclient )
         sizeDG -= sizeof (caHdr);
     }
 
-    status = sendto ( pclient->sock, pDG, sizeDG, 0,
-       (struct sockaddr *)&pclient->addr, sizeof(pclient->addr) );
-    if ( status >= 0 ) {
-        if ( status >= sizeDG ) {
-            epicsTimeGetCurrent ( &pclient->time_at_last_send );
-        }
-        else {
-            errlogPrintf ( 
-                "CAS: System failed to send entire udp frame?\n" );
+    if ( pclient->pSendBatch ) {
+        struct udp_send_batch * pBatch = pclient->pSendBatch;
+
+        memcpy ( pBatch->buf[pBatch->count], pDG, sizeDG );
+        pBatch->len[pBatch->count] = sizeDG;
+        pBatch->addr[pBatch->count] = pclient->addr;
+        if ( ++pBatch->count >= CAS_UDP_BATCH ) {
+            cas_send_dg_batch ( pclient );
         }
     }
     else {
-        char sockErrBuf[64];
-        char buf[128];
-        epicsSocketConvertErrnoToString ( 
-            sockErrBuf, sizeof ( sockErrBuf ) );
-        ipAddrToDottedIP ( &pclient->addr, buf, sizeof(buf) );
-        errlogPrintf( "CAS: UDP send to %s failed: %s\n",
-            buf, sockErrBuf);
+        cas_send_dg ( pclient, pDG, sizeDG, &pclient->addr );
     }
 
     pclient->send.stk = 0u;
@@ -237,21 +516,77 @@ void cas_send_dg_msg ( struct client * pclient )
 }
 
 /*
+ *  cas_send_dg_batch()
  *
- *  cas_copy_in_header() 
+ *  send the udp messages queued by cas_send_dg_msg()
+ */
+void cas_send_dg_batch ( struct client * pclient )
+{
+    struct udp_send_batch * pBatch = pclient->pSendBatch;
+    unsigned i;
+
+    if ( ! pBatch ) {
+        return;
+    }
+
+    SEND_LOCK ( pclient );
+#ifdef CAS_USE_MMSG
+    {
+        struct mmsghdr msgs[CAS_UDP_BATCH];
+        struct iovec iov[CAS_UDP_BATCH];
+
+        memset ( msgs, 0, sizeof(msgs) );
+        for ( i = 0; i < pBatch->count; i++ ) {
+            iov[i].iov_base = pBatch->buf[i];
+            iov[i].iov_len = pBatch->len[i];
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &pBatch->addr[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof ( pBatch->addr[i] );
+        }
+        i = 0;
+        while ( i < pBatch->count ) {
+            int status = sendmmsg ( pclient->sock, &msgs[i],
+                pBatch->count - i, 0 );
+
+            if ( status > 0 ) {
+                epicsTimeGetCurrent ( &pclient->time_at_last_send );
+                i += status;
+            }
+            else if ( status < 0 && SOCKERRNO == SOCK_EINTR ) {
+                continue;
+            }
+            else {
+                /* skip the message which failed */
+                cas_dg_error ( pclient, &pBatch->addr[i] );
+                i++;
+            }
+        }
+    }
+#else
+    for ( i = 0; i < pBatch->count; i++ ) {
+        cas_send_dg ( pclient, pBatch->buf[i], pBatch->len[i],
+            &pBatch->addr[i] );
+    }
+#endif
+    pBatch->count = 0;
+    SEND_UNLOCK ( pclient );
+}
+
+/*
+ *  cas_reserve_msg()
  *
- *  Allocate space in the outgoing message buffer and
- *  copy in message header. Return pointer to message body.
+ *  Make room in the outgoing message buffer for a message and copy
+ *  in its header.  The last refSize bytes of the payload are sent
+ *  from elsewhere and get no room, unlike the pad bytes after them.
+ *  Sets *ppPayload to the first byte after the header.
  *
  *  send lock must be on while in this routine
- *
- *  Returns a valid ptr to message body or NULL if the msg 
- *  will not fit.
- */         
-int cas_copy_in_header ( 
+ */
+static int cas_reserve_msg (
     struct client *pclient, ca_uint16_t response, ca_uint32_t payloadSize,
-    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid, 
-    ca_uint32_t responseSpecific, void **ppPayload )
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, void **ppPayload, ca_uint32_t refSize )
 {
     unsigned    msgSize;
     ca_uint32_t alignedPayloadSize;
@@ -270,6 +605,7 @@ int cas_copy_in_header (
         }
         msgSize += 2 * sizeof ( ca_uint32_t );
     }
+    msgSize -= refSize;
 
     if ( msgSize > pclient->send.maxstk ) {
         casExpandSendBuffer ( pclient, msgSize );
@@ -278,9 +614,11 @@ int cas_copy_in_header (
         }
     }
 
-    if ( pclient->send.stk > pclient->send.maxstk - msgSize ) {
+    if ( pclient->send.stk > pclient->send.maxstk - msgSize ||
+        ( refSize && pclient->nSendRef >= CAS_SEND_REFS ) ) {
         if ( pclient->disconnect ) {
             pclient->send.stk = 0;
+            cas_release_send_refs ( pclient );
         }
         else{
             if ( pclient->proto == IPPROTO_TCP) {
@@ -303,8 +641,7 @@ int cas_copy_in_header (
     if (alignedPayloadSize < 0xffff && nElem < 0xffff) {
         pMsg->m_postsize = htons(((ca_uint16_t) alignedPayloadSize));
         pMsg->m_count = htons(((ca_uint16_t) nElem));
-        if (ppPayload)
-            *ppPayload = (void *) (pMsg + 1);
+        *ppPayload = (void *) (pMsg + 1);
     }
     else {
         ca_uint32_t *pW32 = (ca_uint32_t *) (pMsg + 1);
@@ -312,13 +649,45 @@ int cas_copy_in_header (
         pMsg->m_count = htons(0u);
         pW32[0] = htonl(alignedPayloadSize);
         pW32[1] = htonl(nElem);
-        if (ppPayload)
-            *ppPayload = (void *) (pW32 + 2);
+        *ppPayload = (void *) (pW32 + 2);
+    }
+
+    return ECA_NORMAL;
+}
+
+/*
+ *
+ *  cas_copy_in_header() 
+ *
+ *  Allocate space in the outgoing message buffer and
+ *  copy in message header. Return pointer to message body.
+ *
+ *  send lock must be on while in this routine
+ *
+ *  Returns a valid ptr to message body or NULL if the msg 
+ *  will not fit.
+ */         
+int cas_copy_in_header ( 
+    struct client *pclient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid, 
+    ca_uint32_t responseSpecific, void **ppPayload )
+{
+    ca_uint32_t alignedPayloadSize = CA_MESSAGE_ALIGN ( payloadSize );
+    void *pPayload;
+    int status;
+
+    status = cas_reserve_msg ( pclient, response, payloadSize, dataType,
+        nElem, cid, responseSpecific, &pPayload, 0u );
+    if ( status != ECA_NORMAL ) {
+        return status;
+    }
+    if ( ppPayload ) {
+        *ppPayload = pPayload;
     }
 
     /* zero out pad bytes */
     if ( alignedPayloadSize > payloadSize ) {
-        char *p = ( char * ) *ppPayload;
+        char *p = ( char * ) pPayload;
         memset ( p + payloadSize, '\0', 
             alignedPayloadSize - payloadSize );
     }
@@ -326,6 +695,56 @@ int cas_copy_in_header (
     return ECA_NORMAL;
 }
 
+/*
+ *
+ *  cas_copy_in_ref()
+ *
+ *  Queue a complete message whose payload ends with the array of a
+ *  dbfl_type_ref field log, already in the requested type and in
+ *  network byte order.  Only the header, the prefixSize bytes of
+ *  payload before the array and the pad bytes are copied into the
+ *  outgoing message buffer, the array is sent straight from the
+ *  field log.  On success the client takes over the array and
+ *  clears the field log's dtor.
+ *
+ *  send lock must be on while in this routine
+ */
+int cas_copy_in_ref (
+    struct client *pclient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pPrefix,
+    ca_uint32_t prefixSize, db_field_log *pfl )
+{
+    ca_uint32_t padSize = CA_MESSAGE_ALIGN ( payloadSize ) - payloadSize;
+    struct send_ref *pRef;
+    char *pPayload;
+    int status;
+
+    assert ( pclient->proto == IPPROTO_TCP );
+    assert ( pfl->type == dbfl_type_ref && pfl->u.r.dtor );
+    assert ( prefixSize <= payloadSize );
+
+    status = cas_reserve_msg ( pclient, response, payloadSize, dataType,
+        nElem, cid, responseSpecific, (void **) &pPayload,
+        payloadSize - prefixSize );
+    if ( status != ECA_NORMAL ) {
+        return status;
+    }
+
+    memcpy ( pPayload, pPrefix, prefixSize );
+
+    pRef = &pclient->sendRef[pclient->nSendRef++];
+    pRef->offset = ( unsigned ) ( pPayload + prefixSize - pclient->send.buf );
+    pRef->size = payloadSize - prefixSize;
+    pRef->fl = *pfl;
+    pfl->u.r.dtor = NULL;
+
+    memset ( &pclient->send.buf[pRef->offset], '\0', padSize );
+    pclient->send.stk = pRef->offset + padSize;
+
+    return ECA_NORMAL;
+}
+
 void cas_set_header_cid ( struct client *pClient, ca_uint32_t cid )
 {
     caHdr *pMsg = ( caHdr * ) &pClient->send.buf[pClient->send.stk];
@@ -56,7 +56,7 @@ epicsThreadPrivateId rsrvCurrentClient;
  *  CA server task
  *
  *  Waits for connections at the CA port and spawns a task to
- *  handle each of them
+ *  handle each of them, or hands them to the client multiplexer
  *
  */
 static void req_server (void *pParm)
@@ -115,6 +115,16 @@ static void req_server (void *pParm)
             ellAdd ( &clientQ, &pClient->node );
             UNLOCK_CLIENTQ;
 
+            if ( pClient->pMux ) {
+                if ( casMuxAttach ( pClient ) != RSRV_OK ) {
+                    LOCK_CLIENTQ;
+                    ellDelete ( &clientQ, &pClient->node );
+                    UNLOCK_CLIENTQ;
+                    destroy_tcp_client ( pClient );
+                }
+                continue;
+            }
+
             id = epicsThreadCreate ( "CAS-client", epicsThreadPriorityCAServerLow,
                     epicsThreadGetStackSize ( epicsThreadStackBig ),
                     camsgtask, pClient );
@@ -484,8 +494,10 @@ void rsrv_init (void)
     clientQlock = epicsMutexMustCreate();
 
     freeListInitPvt ( &rsrvClientFreeList, sizeof(struct client), 8 );
-    freeListInitPvt ( &rsrvChanFreeList, sizeof(struct channel_in_use), 512 );
-    freeListInitPvt ( &rsrvEventFreeList, sizeof(struct event_ext), 512 );
+    freeListInitCachedPvt ( &rsrvChanFreeList,
+        sizeof(struct channel_in_use), 512, 32 );
+    freeListInitCachedPvt ( &rsrvEventFreeList,
+        sizeof(struct event_ext), 512, 32 );
     freeListInitPvt ( &rsrvSmallBufFreeListTCP, MAX_TCP, 16 );
     initializePutNotifyFreeList ();
 
@@ -539,6 +551,18 @@ void rsrv_init (void)
     if(envGetBoolConfigParam(&EPICS_CA_AUTO_ARRAY_BYTES, &autoMaxBytes))
         autoMaxBytes = 1;
 
+    if ( envGetConfigParamPtr ( &EPICS_CAS_MUX_THREADS ) ) {
+        long nMux;
+
+        status = envGetLongConfigParam ( &EPICS_CAS_MUX_THREADS, &nMux );
+        if ( status || nMux < 0 ) {
+            errlogPrintf ( "CAS: EPICS_CAS_MUX_THREADS was not a positive integer\n" );
+        }
+        else if ( nMux > 0 ) {
+            casMuxThreads = casMuxStart ( (unsigned) nMux );
+        }
+    }
+
     if (!autoMaxBytes)
         freeListInitPvt ( &rsrvLargeBufFreeListTCP, rsrvSizeofLargeBufTCP, 1 );
     else
@@ -563,6 +587,8 @@ void rsrv_init (void)
      * Started later per TCP client
      *  TCP receiver: epicsThreadPriorityCAServerLow
      *  TCP sender : epicsThreadPriorityCAServerLow-1
+     * Or when multiplexed, all TCP clients
+     *  TCP mux: epicsThreadPriorityCAServerLow
      */
     {
         unsigned i;
@@ -866,7 +892,8 @@ static void log_one_client (struct client *client, unsigned level)
         printf(
         "\tUnprocessed request bytes = %u, Undelivered response bytes = %u\n",
             client->recv.cnt - client->recv.stk,
-            client->send.stk );
+            (unsigned) ( client->send.stk +
+                client->backlogSize - client->backlogSent ) );
         printf(
         "\tState = %s%s%s\n",
             state[client->disconnect?1:0],
@@ -900,6 +927,30 @@ static void log_one_client (struct client *client, unsigned level)
     }
 }
 
+/*
+ *  log_udp_stats()
+ */
+static void log_udp_stats ( struct client *client )
+{
+    epicsTimeStamp now;
+    double delay;
+    unsigned long n;
+
+    if ( ! client ) {
+        return;
+    }
+
+    epicsTimeGetCurrent ( &now );
+    delay = epicsTimeDiffInSeconds ( &now, &client->time_at_last_report );
+    n = client->nSearch - client->nSearchReported;
+    printf ( "        %lu searches (%.0f/s since last report), %lu found, "
+        "%lu datagrams dropped\n",
+        client->nSearch, delay > 0 ? n / delay : 0.0,
+        client->nSearchHit, client->nDropped );
+    client->nSearchReported = client->nSearch;
+    client->time_at_last_report = now;
+}
+
 /*
  *  casr()
  */
@@ -947,20 +998,24 @@ void casr (unsigned level)
             ipAddrToDottedIP (&iface->udpAddr.ia, buf, sizeof(buf));
 #if defined(_WIN32)
             printf("    CAS-UDP name server on %s\n", buf);
+            log_udp_stats(iface->client);
             if (level >= 2)
                 log_one_client(iface->client, level - 2);
 #else
             if (iface->udpbcast==INVALID_SOCKET) {
                 printf("    CAS-UDP name server on %s\n", buf);
+                log_udp_stats(iface->client);
                 if (level >= 2)
                     log_one_client(iface->client, level - 2);
             }
             else {
                 printf("    CAS-UDP unicast name server on %s\n", buf);
+                log_udp_stats(iface->client);
                 if (level >= 2)
                     log_one_client(iface->client, level - 2);
                 ipAddrToDottedIP (&iface->udpbcastAddr.ia, buf, sizeof(buf));
                 printf("    CAS-UDP broadcast name server on %s\n", buf);
+                log_udp_stats(iface->bclient);
                 if (level >= 2)
                     log_one_client(iface->bclient, level - 2);
             }
@@ -1059,7 +1114,10 @@ void destroy_client ( struct client *client )
         return;
     }
 
-    if ( client->tid != 0 ) {
+    if ( client->pMux ) {
+        casMuxDetach ( client );
+    }
+    else if ( client->tid != 0 ) {
         taskwdRemove ( client->tid );
     }
 
@@ -1068,6 +1126,7 @@ void destroy_client ( struct client *client )
     }
 
     if ( client->proto == IPPROTO_TCP ) {
+        cas_release_send_refs ( client );
         if ( client->send.buf ) {
             if ( client->send.type == mbtSmallTCP ) {
                 freeListFree ( rsrvSmallBufFreeListTCP,  client->send.buf );
@@ -1493,17 +1552,22 @@ struct client *create_tcp_client ( SOCKET sock )
         return NULL;
     }
 
-    {
+    if ( casMuxThreads ) {
+        casMuxAssign ( client );
+        status = db_start_events_polled ( client->evuser,
+                    casMuxWakeup, client );
+    }
+    else {
         epicsThreadBooleanStatus    tbs;
 
         tbs  = epicsThreadHighestPriorityLevelBelow ( epicsThreadPriorityCAServerLow, &priorityOfEvents );
         if ( tbs != epicsThreadBooleanStatusSuccess ) {
             priorityOfEvents = epicsThreadPriorityCAServerLow;
         }
-    }
 
-    status = db_start_events ( client->evuser, "CAS-event",
-                NULL, NULL, priorityOfEvents );
+        status = db_start_events ( client->evuser, "CAS-event",
+                    NULL, NULL, priorityOfEvents );
+    }
     if ( status != DB_EVENT_OK ) {
         errlogPrintf ( "CAS: unable to start the event facility\n" );
         destroy_tcp_client ( client );
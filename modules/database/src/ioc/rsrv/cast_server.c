@@ -107,25 +107,140 @@ static void clean_addrq(struct client *client)
 
 }
 
+/*
+ * cast_addr_cmp
+ *
+ * order datagrams by sender
+ */
+static int cast_addr_cmp(const struct sockaddr_in *pa,
+    const struct sockaddr_in *pb)
+{
+    epicsUInt32 a = ntohl(pa->sin_addr.s_addr);
+    epicsUInt32 b = ntohl(pb->sin_addr.s_addr);
+
+    if (a != b)
+        return a < b ? -1 : 1;
+    if (pa->sin_port != pb->sin_port)
+        return ntohs(pa->sin_port) < ntohs(pb->sin_port) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * cast_process
+ *
+ * handle one datagram already in client->recv.buf
+ */
+static void cast_process(struct client *client, unsigned nbytes,
+    const struct sockaddr_in *pAddr)
+{
+    int status;
+    int count = 0;
+
+    client->recv.cnt = nbytes;
+    client->recv.stk = 0ul;
+    epicsTimeGetCurrent(&client->time_at_last_recv);
+
+    client->minor_version_number = CA_UKN_MINOR_VERSION;
+    client->seqNoOfReq = 0;
+
+    /*
+     * If we are talking to a new client flush to the old one 
+     * in case we are holding UDP messages waiting to 
+     * see if the next message is for this same client.
+     */
+    if (client->send.stk>sizeof(caHdr)) {
+        status = memcmp(&client->addr, pAddr, sizeof(*pAddr));
+        if(status){     
+            /* 
+             * if the address is different 
+             */
+            cas_send_dg_msg(client);
+            client->addr = *pAddr;
+        }
+    }
+    else {
+        client->addr = *pAddr;
+    }
+
+    if (CASDEBUG>1) {
+        char    buf[40];
+
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+        errlogPrintf ("CAS: cast server msg of %d bytes from addr %s\n", 
+            client->recv.cnt, buf);
+    }
+
+    if (CASDEBUG>2)
+        count = ellCount (&client->chanList);
+
+    status = camessage ( client );
+    if(status == RSRV_OK){
+        if(client->recv.cnt !=
+            client->recv.stk){
+            char buf[40];
+
+            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+
+            epicsPrintf ("CAS: partial (damaged?) UDP msg of %d bytes from %s ?\n",
+                client->recv.cnt - client->recv.stk, buf);
+
+            epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
+                &client->time_at_last_recv);
+            epicsPrintf ("CAS: message received at %s\n", buf);
+        }
+    }
+    else {
+        client->nDropped++;
+        if (CASDEBUG>0){
+            char buf[40];
+
+            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+
+            epicsPrintf ("CAS: invalid (damaged?) UDP request from %s ?\n", buf);
+
+            epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
+                &client->time_at_last_recv);
+            epicsPrintf ("CAS: message received at %s\n", buf);
+        }
+    }
+
+    if (CASDEBUG>2) {
+        if ( ellCount (&client->chanList) ) {
+            errlogPrintf ("CAS: Fnd %d name matches (%d tot)\n",
+                ellCount(&client->chanList)-count,
+                ellCount(&client->chanList));
+        }
+    }
+}
+
 /*
  * CAST_SERVER
  *
  * service UDP messages
- * 
+ *
+ * Up to CAS_UDP_BATCH datagrams are read at once and handled
+ * grouped by sender, so that the replies to each sender are
+ * coalesced into as few datagrams as possible.
  */
 void cast_server(void *pParm)
 {
     rsrv_iface_config *conf = pParm;
     int                 status;
-    int                 count=0;
     int                 mysocket=0;
-    struct sockaddr_in  new_recv_addr;
-    osiSocklen_t        recv_addr_size;
+    struct sockaddr_in  addrs[CAS_UDP_BATCH];
+    char                *bufs[CAS_UDP_BATCH];
+    unsigned            lens[CAS_UDP_BATCH];
+    unsigned            order[CAS_UDP_BATCH];
+    unsigned            nbatch = 1;
+    char                *pRecvBuf;
     osiSockIoctl_t      nchars;
     SOCKET              recv_sock, reply_sock;
     struct client      *client;
-
-    recv_addr_size = sizeof(new_recv_addr);
+#ifdef CAS_USE_MMSG
+    struct mmsghdr      msgs[CAS_UDP_BATCH];
+    struct iovec        iovs[CAS_UDP_BATCH];
+    char                *pBatchBuf;
+#endif
 
     reply_sock = conf->udp;
 
@@ -151,6 +266,27 @@ void cast_server(void *pParm)
     }
     client->udpRecv = recv_sock;
 
+    pRecvBuf = bufs[0] = client->recv.buf;
+#ifdef CAS_USE_MMSG
+    pBatchBuf = malloc((CAS_UDP_BATCH - 1) * client->recv.maxstk);
+    if (pBatchBuf) {
+        for (nbatch = 1; nbatch < CAS_UDP_BATCH; nbatch++)
+            bufs[nbatch] = pBatchBuf + (nbatch - 1) * client->recv.maxstk;
+    }
+    memset(msgs, 0, sizeof(msgs));
+    for (status = 0; status < (int)nbatch; status++) {
+        iovs[status].iov_base = bufs[status];
+        iovs[status].iov_len = client->recv.maxstk;
+        msgs[status].msg_hdr.msg_iov = &iovs[status];
+        msgs[status].msg_hdr.msg_iovlen = 1;
+        msgs[status].msg_hdr.msg_name = &addrs[status];
+    }
+#endif
+    client->pSendBatch = malloc(sizeof(struct udp_send_batch));
+    if (client->pSendBatch)
+        client->pSendBatch->count = 0;
+    epicsTimeGetCurrent(&client->time_at_last_report);
+
     casAttachThreadToClient ( client );
 
     /*
@@ -164,13 +300,31 @@ void cast_server(void *pParm)
     epicsEventSignal(casudp_startStopEvent);
 
     while (TRUE) {
-        status = recvfrom (
-            recv_sock,
-            client->recv.buf,
-            client->recv.maxstk,
-            0,
-            (struct sockaddr *)&new_recv_addr, 
-            &recv_addr_size);
+        unsigned i, n, nkeep = 0;
+
+#ifdef CAS_USE_MMSG
+        for (i = 0; i < nbatch; i++)
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        status = recvmmsg(recv_sock, msgs, nbatch, MSG_WAITFORONE, NULL);
+        for (i = 0; status > 0 && i < (unsigned)status; i++)
+            lens[i] = msgs[i].msg_len;
+#else
+        {
+            osiSocklen_t recv_addr_size = sizeof(addrs[0]);
+
+            status = recvfrom (
+                recv_sock,
+                bufs[0],
+                client->recv.maxstk,
+                0,
+                (struct sockaddr *)&addrs[0], 
+                &recv_addr_size);
+            if (status >= 0) {
+                lens[0] = (unsigned) status;
+                status = 1;
+            }
+        }
+#endif
         if (status < 0) {
             if (SOCKERRNO != SOCK_EINTR) {
                 char sockErrBuf[64];
@@ -180,93 +334,38 @@ void cast_server(void *pParm)
                         sockErrBuf);
                 epicsThreadSleep(1.0);
             }
+            n = 0;
+        }
+        else {
+            n = (unsigned) status;
+        }
 
-        } else {
+        /* drop ignored senders, and order the rest by sender */
+        for (i = 0; i < n; i++) {
             size_t idx;
+            unsigned j;
+
             for(idx=0; casIgnoreAddrs[idx]; idx++)
             {
-                if(new_recv_addr.sin_addr.s_addr==casIgnoreAddrs[idx]) {
-                    status = -1; /* ignore */
+                if(addrs[i].sin_addr.s_addr==casIgnoreAddrs[idx])
                     break;
-                }
-            }
-        }
-
-        if (status >= 0 && casudp_ctl == ctlRun) {
-            client->recv.cnt = (unsigned) status;
-            client->recv.stk = 0ul;
-            epicsTimeGetCurrent(&client->time_at_last_recv);
-
-            client->minor_version_number = CA_UKN_MINOR_VERSION;
-            client->seqNoOfReq = 0;
-
-            /*
-             * If we are talking to a new client flush to the old one 
-             * in case we are holding UDP messages waiting to 
-             * see if the next message is for this same client.
-             */
-            if (client->send.stk>sizeof(caHdr)) {
-                status = memcmp(&client->addr,
-                    &new_recv_addr, recv_addr_size);
-                if(status){     
-                    /* 
-                     * if the address is different 
-                     */
-                    cas_send_dg_msg(client);
-                    client->addr = new_recv_addr;
-                }
-            }
-            else {
-                client->addr = new_recv_addr;
-            }
-
-            if (CASDEBUG>1) {
-                char    buf[40];
-    
-                ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-                errlogPrintf ("CAS: cast server msg of %d bytes from addr %s\n", 
-                    client->recv.cnt, buf);
-            }
-
-            if (CASDEBUG>2)
-                count = ellCount (&client->chanList);
-
-            status = camessage ( client );
-            if(status == RSRV_OK){
-                if(client->recv.cnt !=
-                    client->recv.stk){
-                    char buf[40];
-
-                    ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-
-                    epicsPrintf ("CAS: partial (damaged?) UDP msg of %d bytes from %s ?\n",
-                        client->recv.cnt - client->recv.stk, buf);
-
-                    epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
-                        &client->time_at_last_recv);
-                    epicsPrintf ("CAS: message received at %s\n", buf);
-                }
             }
-            else if (CASDEBUG>0){
-                char buf[40];
-
-                ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-
-                epicsPrintf ("CAS: invalid (damaged?) UDP request from %s ?\n", buf);
-
-                epicsTimeToStrftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
-                    &client->time_at_last_recv);
-                epicsPrintf ("CAS: message received at %s\n", buf);
+            if (casIgnoreAddrs[idx]) {
+                client->nDropped++;
+                continue;
             }
+            for (j = nkeep; j > 0 &&
+                 cast_addr_cmp(&addrs[order[j-1]], &addrs[i]) > 0; j--)
+                order[j] = order[j-1];
+            order[j] = i;
+            nkeep++;
+        }
 
-            if (CASDEBUG>2) {
-                if ( ellCount (&client->chanList) ) {
-                    errlogPrintf ("CAS: Fnd %d name matches (%d tot)\n",
-                        ellCount(&client->chanList)-count,
-                        ellCount(&client->chanList));
-                }
-            }
+        for (i = 0; i < nkeep && casudp_ctl == ctlRun; i++) {
+            client->recv.buf = bufs[order[i]];
+            cast_process(client, lens[order[i]], &addrs[order[i]]);
         }
+        client->recv.buf = pRecvBuf;
 
         /*
          * allow messages to batch up if more are comming
@@ -276,16 +375,23 @@ void cast_server(void *pParm)
         if (status<0) {
             errlogPrintf ("CA cast server: Unable to fetch N characters pending\n");
             cas_send_dg_msg (client);
+            cas_send_dg_batch (client);
             clean_addrq (client);
         }
         else if (nchars == 0) {
             cas_send_dg_msg (client);
+            cas_send_dg_batch (client);
             clean_addrq (client);
         }
     }
 
     /* ATM never reached, just a placeholder */
 
+#ifdef CAS_USE_MMSG
+    free(pBatchBuf);
+#endif
+    free(client->pSendBatch);
+    client->pSendBatch = NULL;
     if(!mysocket)
         client->sock = INVALID_SOCKET; /* only one cast_server should destroy the reply socket */
     destroy_client(client);
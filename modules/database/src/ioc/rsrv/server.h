@@ -73,6 +73,43 @@ struct message_buffer {
 
 extern epicsThreadPrivateId rsrvCurrentClient;
 
+/* Datagrams the UDP name server reads or sends with one system call */
+#define CAS_UDP_BATCH 8
+
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#   define CAS_USE_MMSG /* recvmmsg() and sendmmsg() */
+#endif
+
+/* UDP replies waiting to be sent by cas_send_dg_batch() */
+struct udp_send_batch {
+  unsigned                  count;
+  unsigned                  len[CAS_UDP_BATCH];
+  struct sockaddr_in        addr[CAS_UDP_BATCH];
+  char                      buf[CAS_UDP_BATCH][MAX_UDP_SEND];
+};
+
+/* Array payloads of at least this many bytes are sent from the field log */
+#define CAS_SEND_REF_MIN 16384u
+/* Field logs a client may hold waiting to be sent */
+#define CAS_SEND_REFS 16
+
+#if defined(__unix__) || defined(__APPLE__)
+#   define CAS_USE_SENDMSG /* gather writes with sendmsg() */
+#endif
+
+#if defined(__linux__)
+#   define CAS_USE_EPOLL /* multiplexed TCP clients, see camuxtask.c */
+#endif
+
+struct casMuxThread;
+
+/* Payload queued by cas_copy_in_ref(), sent after send.buf[offset-1] */
+struct send_ref {
+  unsigned                  offset;
+  ca_uint32_t               size;
+  db_field_log              fl; /* owns fl.u.r.field */
+};
+
 typedef struct client {
   ELLNODE               node;
   /*! guarded by SEND_LOCK()  aka. client::lock */
@@ -101,6 +138,26 @@ typedef struct client {
   unsigned              recvBytesToDrain;
   unsigned              priority;
   char                  disconnect; /* disconnect detected */
+  /*! guarded by SEND_LOCK(), tcp only */
+  struct send_ref       sendRef[CAS_SEND_REFS];
+  unsigned              nSendRef;
+  unsigned long         sendDone; /* bytes of send.buf and sendRef sent */
+  struct udp_send_batch *pSendBatch; /* udp only, may be NULL */
+  /* udp name server statistics, see casr() */
+  unsigned long         nSearch, nSearchHit, nDropped;
+  unsigned long         nSearchReported;
+  epicsTimeStamp        time_at_last_report;
+  /* tcp clients served by a casMuxThread, otherwise NULL */
+  struct casMuxThread   *pMux;
+  ELLNODE               muxNode; /* on casMuxThread::pending */
+  ELLNODE               muxStallNode; /* on casMuxThread::stalled */
+  char                  muxPending;
+  /*! guarded by SEND_LOCK(), the socket of a mux client doesn't block */
+  char                  muxStalled; /* requests wait in recv.buf */
+  unsigned              muxEvents; /* epoll events watched */
+  epicsTimeStamp        muxStallTime;
+  char                  *pBacklog; /* bytes the socket didn't take */
+  unsigned long         backlogSize, backlogSent;
 } client;
 
 /* Channel state shows which struct client list a
@@ -214,9 +271,13 @@ GLBLTYPE volatile enum ctl  beacon_ctl;
 GLBLTYPE volatile enum ctl  castcp_ctl;
 
 GLBLTYPE unsigned int       threadPrios[5];
+GLBLTYPE unsigned           casMuxThreads; /* 0 unless TCP clients are multiplexed */
 
 #define CAS_HASH_TABLE_SIZE 4096
 
+/* a request of a mux client has to wait, camessage() stops at it */
+#define RSRV_BLOCKED 1
+
 #define SEND_LOCK(CLIENT) epicsMutexMustLock((CLIENT)->lock)
 #define SEND_UNLOCK(CLIENT) epicsMutexUnlock((CLIENT)->lock)
 
@@ -224,8 +285,20 @@ GLBLTYPE unsigned int       threadPrios[5];
 #define UNLOCK_CLIENTQ  epicsMutexUnlock (clientQlock);
 
 void camsgtask (void *client);
+int casRecvMessages ( struct client *client );
+int casProcessMessages ( struct client *client );
+void casFlushIfIdle ( struct client *client );
+unsigned casMuxStart ( unsigned nThreads );
+void casMuxAssign ( struct client *client );
+int casMuxAttach ( struct client *client );
+void casMuxDetach ( struct client *client );
+void casMuxWakeup ( void *pArg );
+void casMuxWatch ( struct client *client );
+double casMuxStall ( struct client *client );
+void casMuxUnstall ( struct client *client );
 void cas_send_bs_msg ( struct client *pclient, int lock_needed );
 void cas_send_dg_msg ( struct client *pclient );
+void cas_send_dg_batch ( struct client *pclient );
 void rsrv_online_notify_task (void *);
 void cast_server (void *);
 struct client *create_client ( SOCKET sock, int proto );
@@ -258,5 +331,11 @@ int cas_copy_in_header (
 void cas_set_header_cid ( struct client *pClient, ca_uint32_t );
 void cas_set_header_count (struct client *pClient, ca_uint32_t count);
 void cas_commit_msg ( struct client *pClient, ca_uint32_t size );
+int cas_copy_in_ref (
+    struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pPrefix,
+    ca_uint32_t prefixSize, db_field_log *pfl );
+void cas_release_send_refs ( struct client *pClient );
 
 #endif /*INCLserverh*/
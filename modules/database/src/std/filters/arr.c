@@ -120,6 +120,17 @@ static db_field_log* filter(void* pvt, dbChannel *chan, db_field_log *pfl)
             dbScanLock(prec);
             prset->get_array_info(&chan->addr, &nSource, &offset);
             nTarget = wrapArrayIndices(&start, my->incr, &end, nSource);
+            if (my->incr == 1 && nTarget > 0 && 2 * nTarget >= nSource) {
+                /* A large contiguous block, use the array copy that
+                 * other subscriptions share and take a slice of it.
+                 */
+                chan->addr.pfield = pfieldsave;
+                dbChannelMakeArrayCopy(NULL, pfl, chan);
+                dbScanUnlock(prec);
+                if (pfl->u.r.field)
+                    return filter(pvt, chan, pfl);
+                break;
+            }
             pfl->type = dbfl_type_ref;
             pfl->stat = prec->stat;
             pfl->sevr = prec->sevr;
@@ -148,6 +159,10 @@ static db_field_log* filter(void* pvt, dbChannel *chan, db_field_log *pfl)
         pdst = NULL;
         nSource = pfl->no_elements;
         nTarget = wrapArrayIndices(&start, my->incr, &end, nSource);
+        /* Shared copies can be sliced in place */
+        if (my->incr == 1 && nTarget > 0 &&
+            !dbChannelArraySlice(pfl, start, nTarget))
+            break;
         pfl->no_elements = nTarget;
         if (nTarget) {
             /* Copy the data out */
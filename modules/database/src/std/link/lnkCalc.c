@@ -63,6 +63,9 @@ typedef struct calc_link {
     char *post_expr;
     char *post_major;
     char *post_minor;
+    calcProgram *prog_expr;
+    calcProgram *prog_major;
+    calcProgram *prog_minor;
     char *units;
     short tinp;
     struct link inp[CALCPERFORM_NARGS];
@@ -110,6 +113,9 @@ static void lnkCalc_free(jlink *pjlink)
     free(clink->post_expr);
     free(clink->post_major);
     free(clink->post_minor);
+    calcProgramFree(clink->prog_expr);
+    calcProgramFree(clink->prog_major);
+    calcProgramFree(clink->prog_minor);
     free(clink->units);
     free(clink);
 }
@@ -169,6 +175,7 @@ static jlif_result lnkCalc_string(jlink *pjlink, const char *val, size_t len)
 {
     calc_link *clink = CONTAINER(pjlink, struct calc_link, jlink);
     char *inbuf, *postbuf;
+    calcProgram *prog;
     short err;
 
     IFDEBUG(10)
@@ -227,6 +234,18 @@ static jlif_result lnkCalc_string(jlink *pjlink, const char *val, size_t len)
         return jlif_stop;
     }
 
+    prog = calcCompile(postbuf);
+    if (!prog) {
+        errlogPrintf("lnkCalc: Out of memory\n");
+        return jlif_stop;
+    }
+    if (clink->pstate == ps_major)
+        clink->prog_major = prog;
+    else if (clink->pstate == ps_minor)
+        clink->prog_minor = prog;
+    else
+        clink->prog_expr = prog;
+
     return jlif_continue;
 }
 
@@ -465,6 +484,9 @@ static void lnkCalc_remove(struct dbLocker *locker, struct link *plink)
     free(clink->post_expr);
     free(clink->post_major);
     free(clink->post_minor);
+    calcProgramFree(clink->prog_expr);
+    calcProgramFree(clink->prog_major);
+    calcProgramFree(clink->prog_minor);
     free(clink->units);
     free(clink);
     plink->value.json.jlink = NULL;
@@ -576,7 +598,8 @@ static long lnkCalc_getValue(struct link *plink, short dbrType, void *pbuffer,
     clink->sevr = 0;
 
     if (clink->post_expr) {
-        status = calcPerform(clink->arg, &clink->val, clink->post_expr);
+        status = calcPerformCompiled(clink->arg, &clink->val,
+            clink->prog_expr);
         if (!status)
             status = conv(&clink->val, pbuffer, NULL);
         if (!status && pnRequest)
@@ -591,7 +614,7 @@ static long lnkCalc_getValue(struct link *plink, short dbrType, void *pbuffer,
     if (!status && clink->post_major) {
         double alval = clink->val;
 
-        status = calcPerform(clink->arg, &alval, clink->post_major);
+        status = calcPerformCompiled(clink->arg, &alval, clink->prog_major);
         if (!status && alval) {
             clink->stat = LINK_ALARM;
             clink->sevr = MAJOR_ALARM;
@@ -602,7 +625,7 @@ static long lnkCalc_getValue(struct link *plink, short dbrType, void *pbuffer,
     if (!status && clink->post_minor) {
         double alval = clink->val;
 
-        status = calcPerform(clink->arg, &alval, clink->post_minor);
+        status = calcPerformCompiled(clink->arg, &alval, clink->prog_minor);
         if (!status && alval) {
             clink->stat = LINK_ALARM;
             clink->sevr = MINOR_ALARM;
@@ -0,0 +1,350 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Record Support Routines for Array Calculation records
+ *
+ * The CALC expression is evaluated element-wise over the input arrays
+ * A-L by calcPerformArray(). Inputs with a single element act as
+ * scalars, and the result is as long as the shortest array input that
+ * CALC uses.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "errlog.h"
+#include "alarm.h"
+#include "cantProceed.h"
+#include "dbAccess.h"
+#include "dbEvent.h"
+#include "dbFldTypes.h"
+#include "dbLink.h"
+#include "epicsMath.h"
+#include "errMdef.h"
+#include "recSup.h"
+#include "recGbl.h"
+#include "special.h"
+
+#define GEN_SIZE_OFFSET
+#include "acalcRecord.h"
+#undef  GEN_SIZE_OFFSET
+#include "epicsExport.h"
+
+/* Create RSET - Record Support Entry Table */
+
+#define report NULL
+#define initialize NULL
+static long init_record(struct dbCommon *prec, int pass);
+static long process(struct dbCommon *prec);
+static long special(DBADDR *paddr, int after);
+#define get_value NULL
+static long cvt_dbaddr(DBADDR *paddr);
+static long get_array_info(DBADDR *paddr, long *no_elements, long *offset);
+static long put_array_info(DBADDR *paddr, long nNew);
+static long get_units(DBADDR *paddr, char *units);
+static long get_precision(const DBADDR *paddr, long *precision);
+#define get_enum_str NULL
+#define get_enum_strs NULL
+#define put_enum_str NULL
+static long get_graphic_double(DBADDR *paddr, struct dbr_grDouble *pgd);
+static long get_control_double(DBADDR *paddr, struct dbr_ctrlDouble *pcd);
+#define get_alarm_double NULL
+
+rset acalcRSET={
+    RSETNUMBER,
+    report,
+    initialize,
+    init_record,
+    process,
+    special,
+    get_value,
+    cvt_dbaddr,
+    get_array_info,
+    put_array_info,
+    get_units,
+    get_precision,
+    get_enum_str,
+    get_enum_strs,
+    put_enum_str,
+    get_graphic_double,
+    get_control_double,
+    get_alarm_double
+};
+epicsExportAddress(rset, acalcRSET);
+
+/* Argument usage of RPCL, found when CALC is compiled */
+typedef struct rpvtStruct {
+    unsigned long inputs;
+    unsigned long stores;
+} rpvtStruct;
+
+static long compile(acalcRecord *prec);
+static void monitor(acalcRecord *prec, epicsUInt32 nord);
+static int fetch_values(acalcRecord *prec);
+
+
+static long init_record(struct dbCommon *pcommon, int pass)
+{
+    struct acalcRecord *prec = (struct acalcRecord *)pcommon;
+    int i;
+
+    if (pass==0) {
+        if (prec->nelm == 0)
+            prec->nelm = 1;
+        prec->val = callocMustSucceed(prec->nelm, sizeof(double),
+            "acalc::init_record");
+        prec->rpvt = callocMustSucceed(1, sizeof(rpvtStruct),
+            "acalc::init_record");
+        for (i = 0; i < CALCPERFORM_NARGS; i++)
+            (&prec->a)[i] = callocMustSucceed(prec->nelm, sizeof(double),
+                "acalc::init_record");
+        return 0;
+    }
+
+    for (i = 0; i < CALCPERFORM_NARGS; i++) {
+        long n = prec->nelm;
+
+        dbLoadLinkArray(&prec->inpa + i, DBF_DOUBLE, (&prec->a)[i], &n);
+        if (n > 0)
+            (&prec->nea)[i] = n;
+    }
+    compile(prec);
+    return 0;
+}
+
+static long process(struct dbCommon *pcommon)
+{
+    struct acalcRecord *prec = (struct acalcRecord *)pcommon;
+    epicsUInt32 nord = prec->nord;
+
+    prec->pact = TRUE;
+    if (fetch_values(prec) == 0) {
+        unsigned long inputs = prec->rpvt->inputs;
+        epicsUInt32 n = 0;
+        int i;
+
+        /* The shortest array input sets the length of the result */
+        for (i = 0; i < CALCPERFORM_NARGS; i++) {
+            epicsUInt32 ne = (&prec->nea)[i];
+
+            if ((inputs & (1 << i)) && ne > 1 && (n == 0 || ne < n))
+                n = ne;
+        }
+        if (n == 0)
+            n = 1;
+        if (nord < n)
+            memset(prec->val + nord, 0, (n - nord) * sizeof(double));
+
+        if (calcPerformArray(&prec->a, &prec->nea, prec->val, n,
+                prec->rpcp)) {
+            recGblSetSevr(prec, CALC_ALARM, INVALID_ALARM);
+        } else {
+            prec->nord = n;
+            prec->udf = FALSE;
+        }
+    }
+
+    recGblGetTimeStamp(prec);
+    if (prec->udf)
+        recGblSetSevr(prec, UDF_ALARM, prec->udfs);
+    monitor(prec, nord);
+    recGblFwdLink(prec);
+    prec->pact = FALSE;
+    return 0;
+}
+
+static long special(DBADDR *paddr, int after)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+
+    if (!after) return 0;
+    if (paddr->special == SPC_CALC)
+        return compile(prec);
+    recGblDbaddrError(S_db_badChoice, paddr, "acalc::special - bad special value!");
+    return S_db_badChoice;
+}
+
+#define indexof(field) acalcRecord##field
+
+static long cvt_dbaddr(DBADDR *paddr)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+
+    if (fieldIndex == indexof(VAL))
+        paddr->pfield = prec->val;
+    else if (fieldIndex >= indexof(A) && fieldIndex <= indexof(L))
+        paddr->pfield = (&prec->a)[fieldIndex - indexof(A)];
+    else {
+        errlogPrintf("acalc::cvt_dbaddr called for %s.%s\n",
+            prec->name, paddr->pfldDes->name);
+        return 0;
+    }
+    paddr->no_elements = prec->nelm;
+    paddr->field_type = DBF_DOUBLE;
+    paddr->field_size = sizeof(double);
+    paddr->dbr_field_type = DBF_DOUBLE;
+    return 0;
+}
+
+static long get_array_info(DBADDR *paddr, long *no_elements, long *offset)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+
+    if (fieldIndex == indexof(VAL))
+        *no_elements = prec->nord;
+    else if (fieldIndex >= indexof(A) && fieldIndex <= indexof(L))
+        *no_elements = (&prec->nea)[fieldIndex - indexof(A)];
+    *offset = 0;
+    return 0;
+}
+
+static long put_array_info(DBADDR *paddr, long nNew)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+
+    if (fieldIndex == indexof(VAL))
+        prec->nord = nNew;
+    else if (fieldIndex >= indexof(A) && fieldIndex <= indexof(L))
+        (&prec->nea)[fieldIndex - indexof(A)] = nNew;
+    return 0;
+}
+
+static long get_linkNumber(int fieldIndex) {
+    if (fieldIndex >= indexof(A) && fieldIndex <= indexof(L))
+        return fieldIndex - indexof(A);
+    return -1;
+}
+
+static long get_units(DBADDR *paddr, char *units)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int linkNumber = get_linkNumber(dbGetFieldIndex(paddr));
+
+    if (linkNumber >= 0)
+        dbGetUnits(&prec->inpa + linkNumber, units, DB_UNITS_SIZE);
+    else if (paddr->field_type == DBF_DOUBLE)
+        strncpy(units, prec->egu, DB_UNITS_SIZE);
+    return 0;
+}
+
+static long get_precision(const DBADDR *paddr, long *pprecision)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+    int linkNumber;
+
+    *pprecision = prec->prec;
+    if (fieldIndex == indexof(VAL))
+        return 0;
+
+    linkNumber = get_linkNumber(fieldIndex);
+    if (linkNumber >= 0) {
+        short precision;
+
+        if (dbGetPrecision(&prec->inpa + linkNumber, &precision) == 0)
+            *pprecision = precision;
+    } else
+        recGblGetPrec(paddr, pprecision);
+    return 0;
+}
+
+static long get_graphic_double(DBADDR *paddr, struct dbr_grDouble *pgd)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+    int linkNumber;
+
+    if (fieldIndex == indexof(VAL)) {
+        pgd->lower_disp_limit = prec->lopr;
+        pgd->upper_disp_limit = prec->hopr;
+        return 0;
+    }
+    linkNumber = get_linkNumber(fieldIndex);
+    if (linkNumber >= 0)
+        dbGetGraphicLimits(&prec->inpa + linkNumber,
+            &pgd->lower_disp_limit,
+            &pgd->upper_disp_limit);
+    else
+        recGblGetGraphicDouble(paddr, pgd);
+    return 0;
+}
+
+static long get_control_double(DBADDR *paddr, struct dbr_ctrlDouble *pcd)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+
+    if (dbGetFieldIndex(paddr) == indexof(VAL)) {
+        pcd->lower_ctrl_limit = prec->lopr;
+        pcd->upper_ctrl_limit = prec->hopr;
+    } else
+        recGblGetControlDouble(paddr, pcd);
+    return 0;
+}
+
+/* Convert CALC to RPCL and RPCP. Assignments can't be evaluated
+ * element-wise, so those are rejected.
+ */
+static long compile(acalcRecord *prec)
+{
+    rpvtStruct *prpvt = prec->rpvt;
+    short error_number;
+
+    calcProgramFree(prec->rpcp);
+    prec->rpcp = NULL;
+    prpvt->inputs = prpvt->stores = 0;
+
+    if (postfix(prec->calc, prec->rpcl, &error_number)) {
+        recGblRecordError(S_db_badField, (void *)prec,
+                          "acalc: Illegal CALC field");
+        errlogPrintf("%s.CALC: %s in expression \"%s\"\n",
+                     prec->name, calcErrorStr(error_number), prec->calc);
+        return S_db_badField;
+    }
+    if (calcArgUsage(prec->rpcl, &prpvt->inputs, &prpvt->stores))
+        prpvt->inputs = prpvt->stores = 0;
+    if (prpvt->stores) {
+        recGblRecordError(S_db_badField, (void *)prec,
+                          "acalc: Illegal CALC field");
+        errlogPrintf("%s.CALC: Assignments not supported in expression \"%s\"\n",
+                     prec->name, prec->calc);
+        return S_db_badField;
+    }
+    prec->rpcp = calcCompile(prec->rpcl);
+    return 0;
+}
+
+static void monitor(acalcRecord *prec, epicsUInt32 nord)
+{
+    unsigned monitor_mask = recGblResetAlarms(prec);
+
+    /* Arrays don't have deadbands, post VAL every time */
+    db_post_events(prec, prec->val, monitor_mask | DBE_VALUE | DBE_LOG);
+    if (nord != prec->nord)
+        db_post_events(prec, &prec->nord, monitor_mask | DBE_VALUE | DBE_LOG);
+}
+
+static int fetch_values(acalcRecord *prec)
+{
+    long status = 0;
+    int i;
+
+    for (i = 0; i < CALCPERFORM_NARGS; i++) {
+        long nRequest = prec->nelm;
+        long newStatus;
+
+        newStatus = dbGetLink(&prec->inpa + i, DBR_DOUBLE, (&prec->a)[i], 0,
+            &nRequest);
+        if (nRequest > 0)
+            (&prec->nea)[i] = nRequest;
+        if (status == 0) status = newStatus;
+    }
+    return status;
+}
@@ -107,6 +107,7 @@ static long init_record(struct dbCommon *pcommon, int pass)
         errlogPrintf("%s.CALC: %s in expression \"%s\"\n",
                      prec->name, calcErrorStr(error_number), prec->calc);
     }
+    prec->rpcp = calcCompile(prec->rpcl);
     return 0;
 }
 
@@ -117,7 +118,7 @@ static long process(struct dbCommon *pcommon)
 
     prec->pact = TRUE;
     if (fetch_values(prec) == 0) {
-        if (calcPerform(&prec->a, &prec->val, prec->rpcl)) {
+        if (calcPerformCompiled(&prec->a, &prec->val, prec->rpcp)) {
             recGblSetSevr(prec, CALC_ALARM, INVALID_ALARM);
         } else
             prec->udf = isnan(prec->val);
@@ -142,14 +143,18 @@ static long special(DBADDR *paddr, int after)
 
     if (!after) return 0;
     if (paddr->special == SPC_CALC) {
+        long status = 0;
+
         if (postfix(prec->calc, prec->rpcl, &error_number)) {
             recGblRecordError(S_db_badField, (void *)prec,
                               "calc: Illegal CALC field");
             errlogPrintf("%s.CALC: %s in expression \"%s\"\n",
                          prec->name, calcErrorStr(error_number), prec->calc);
-            return S_db_badField;
+            status = S_db_badField;
         }
-        return 0;
+        calcProgramFree(prec->rpcp);
+        prec->rpcp = calcCompile(prec->rpcl);
+        return status;
     }
     recGblDbaddrError(S_db_badChoice, paddr, "calc::special - bad special value!");
     return S_db_badChoice;
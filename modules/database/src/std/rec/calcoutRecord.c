@@ -121,6 +121,8 @@ typedef struct rpvtStruct {
     CALLBACK checkLinkCb;
     short    cbScheduled;
     short    caLinkStat; /* NO_CA_LINKS, CA_LINKS_ALL_OK, CA_LINKS_NOT_OK */
+    calcProgram *calc;   /* compiled RPCL */
+    calcProgram *ocal;   /* compiled ORPC */
 } rpvtStruct;
 
 static void checkAlarms(calcoutRecord *prec);
@@ -214,6 +216,9 @@ static long init_record(struct dbCommon *pcommon, int pass)
     }
 
     prpvt = prec->rpvt;
+    prpvt->calc = calcCompile(prec->rpcl);
+    prpvt->ocal = calcCompile(prec->orpc);
+
     callbackSetCallback(checkLinksCallback, &prpvt->checkLinkCb);
     callbackSetPriority(0, &prpvt->checkLinkCb);
     callbackSetUser(prec, &prpvt->checkLinkCb);
@@ -243,7 +248,7 @@ static long process(struct dbCommon *pcommon)
             checkLinks(prec);
         }
         if (fetch_values(prec) == 0) {
-            if (calcPerform(&prec->a, &prec->val, prec->rpcl)) {
+            if (calcPerformCompiled(&prec->a, &prec->val, prpvt->calc)) {
                 recGblSetSevr(prec, CALC_ALARM, INVALID_ALARM);
             } else {
                 prec->udf = isnan(prec->val);
@@ -333,6 +338,8 @@ static long special(DBADDR *paddr, int after)
             errlogPrintf("%s.CALC: %s in expression \"%s\"\n",
                          prec->name, calcErrorStr(error_number), prec->calc);
         }
+        calcProgramFree(prpvt->calc);
+        prpvt->calc = calcCompile(prec->rpcl);
         db_post_events(prec, &prec->clcv, DBE_VALUE);
         return 0;
 
@@ -344,6 +351,8 @@ static long special(DBADDR *paddr, int after)
             errlogPrintf("%s.OCAL: %s in expression \"%s\"\n",
                          prec->name, calcErrorStr(error_number), prec->ocal);
         }
+        calcProgramFree(prpvt->ocal);
+        prpvt->ocal = calcCompile(prec->orpc);
         db_post_events(prec, &prec->oclv, DBE_VALUE);
         return 0;
       case(calcoutRecordINPA):
@@ -612,7 +621,8 @@ static void execOutput(calcoutRecord *prec)
         prec->oval = prec->val;
         break;
     case calcoutDOPT_Use_OVAL:
-        if (calcPerform(&prec->a, &prec->oval, prec->orpc)) {
+        if (calcPerformCompiled(&prec->a, &prec->oval,
+                prec->rpvt->ocal)) {
             recGblSetSevr(prec, CALC_ALARM, INVALID_ALARM);
         } else {
             prec->udf = isnan(prec->oval);
@@ -108,27 +108,52 @@ static void monitor(compressRecord *prec)
     db_post_events(prec, prec->bptr, monitor_mask);
 }
 
-static void put_value(compressRecord *prec, double *psource, int n)
+/* Append n values to the circular buffer, whole runs at a time */
+static void put_value(compressRecord *prec, double *psource, epicsUInt32 n)
 {
     int fifo = (prec->balg == bufferingALG_FIFO);
     epicsUInt32 offset = prec->off;
     epicsUInt32 nuse = prec->nuse;
     epicsUInt32 nsam = prec->nsam;
+    double *pdest = prec->bptr;
 
     nuse += n;
     if (nuse > nsam)
         nuse = nsam;
 
-    while (n--) {
-        /* for LIFO, pre-decrement modulo nsam */
-        if (!fifo)
-            offset = (offset + nsam - 1) % nsam;
+    /* only the last nsam values survive */
+    if (n > nsam) {
+        epicsUInt32 skip = (n - nsam) % nsam;
 
-        prec->bptr[offset] = *psource++;
+        offset = fifo ? (offset + skip) % nsam : (offset + nsam - skip) % nsam;
+        psource += n - nsam;
+        n = nsam;
+    }
+
+    while (n) {
+        epicsUInt32 i, run;
 
-        /* for FIFO, post-increment modulo nsam */
-        if (fifo)
-            offset = (offset + 1) % nsam;
+        if (fifo) {
+            /* post-increment modulo nsam */
+            run = nsam - offset;
+            if (run > n)
+                run = n;
+            memcpy(pdest + offset, psource, run * sizeof(double));
+            offset = (offset + run) % nsam;
+        }
+        else {
+            /* pre-decrement modulo nsam, so the run goes backwards */
+            if (offset == 0)
+                offset = nsam;
+            run = offset;
+            if (run > n)
+                run = n;
+            for (i = 0; i < run; i++)
+                pdest[offset - 1 - i] = psource[i];
+            offset -= run;
+        }
+        psource += run;
+        n -= run;
     }
 
     prec->off = offset;
@@ -136,24 +161,102 @@ static void put_value(compressRecord *prec, double *psource, int n)
 }
 
 
-/* qsort comparison function (for median calculation) */
-static int compare(const void *arg1, const void *arg2)
+/* N to 1 reductions. These use 4 independent accumulators so the loops
+ * pipeline and vectorize; the minimum and maximum start each one with the
+ * first value, so a NaN there still poisons the result as before.
+ */
+static double window_low(const double *psource, epicsInt32 n)
 {
-    double a = *(double *)arg1;
-    double b = *(double *)arg2;
+    double v0, v1, v2, v3;
+    epicsInt32 j;
+
+    v0 = v1 = v2 = v3 = psource[0];
+    for (j = 0; j + 4 <= n; j += 4) {
+        v0 = (v0 > psource[j])     ? psource[j]     : v0;
+        v1 = (v1 > psource[j + 1]) ? psource[j + 1] : v1;
+        v2 = (v2 > psource[j + 2]) ? psource[j + 2] : v2;
+        v3 = (v3 > psource[j + 3]) ? psource[j + 3] : v3;
+    }
+    for (; j < n; j++)
+        v0 = (v0 > psource[j]) ? psource[j] : v0;
+    v0 = (v0 > v1) ? v1 : v0;
+    v2 = (v2 > v3) ? v3 : v2;
+    return (v0 > v2) ? v2 : v0;
+}
+
+static double window_high(const double *psource, epicsInt32 n)
+{
+    double v0, v1, v2, v3;
+    epicsInt32 j;
+
+    v0 = v1 = v2 = v3 = psource[0];
+    for (j = 0; j + 4 <= n; j += 4) {
+        v0 = (v0 < psource[j])     ? psource[j]     : v0;
+        v1 = (v1 < psource[j + 1]) ? psource[j + 1] : v1;
+        v2 = (v2 < psource[j + 2]) ? psource[j + 2] : v2;
+        v3 = (v3 < psource[j + 3]) ? psource[j + 3] : v3;
+    }
+    for (; j < n; j++)
+        v0 = (v0 < psource[j]) ? psource[j] : v0;
+    v0 = (v0 < v1) ? v1 : v0;
+    v2 = (v2 < v3) ? v3 : v2;
+    return (v0 < v2) ? v2 : v0;
+}
+
+static double window_sum(const double *psource, epicsInt32 n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    epicsInt32 j;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        s0 += psource[j];
+        s1 += psource[j + 1];
+        s2 += psource[j + 2];
+        s3 += psource[j + 3];
+    }
+    for (; j < n; j++)
+        s0 += psource[j];
+    return (s0 + s1) + (s2 + s3);
+}
 
-    if      ( a <  b ) return -1;
-    else if ( a == b ) return  0;
-    else               return  1;
+/* The k-th smallest of n values, partially reordering them; this is
+ * Wirth's selection algorithm, O(n) on average.
+ */
+static double window_select(double *psource, epicsInt32 n, epicsInt32 k)
+{
+    epicsInt32 l = 0, m = n - 1;
+
+    while (l < m) {
+        double x = psource[k];
+        epicsInt32 i = l, j = m;
+
+        do {
+            while (psource[i] < x)
+                i++;
+            while (x < psource[j])
+                j--;
+            if (i <= j) {
+                double t = psource[i];
+
+                psource[i++] = psource[j];
+                psource[j--] = t;
+            }
+        } while (i <= j);
+        if (j < k)
+            l = i;
+        if (k < i)
+            m = j;
+    }
+    return psource[k];
 }
 
 static int compress_array(compressRecord *prec,
     double *psource, int no_elements)
 {
-    epicsInt32 i,j;
+    double block[64];
+    epicsInt32 i, j, nblock;
     epicsInt32 n, nnew;
     epicsInt32 nsam = prec->nsam;
-    double value;
 
     /* skip out of limit data */
     if (prec->ilil < prec->ihil) {
@@ -174,50 +277,30 @@ static int compress_array(compressRecord *prec,
         nnew = (no_elements / n);
     else nnew = nsam;
 
-    /* compress according to specified algorithm */
-    switch (prec->alg){
-    case compressALG_N_to_1_Low_Value:
-        /* compress N to 1 keeping the lowest value */
-        for (i = 0; i < nnew; i++) {
-            value = *psource++;
-            for (j = 1; j < n; j++, psource++) {
-                if (value > *psource)
-                    value = *psource;
+    /* compress according to specified algorithm, a block at a time */
+    for (i = 0; i < nnew; i += nblock) {
+        nblock = nnew - i;
+        if (nblock > (epicsInt32) NELEMENTS(block))
+            nblock = NELEMENTS(block);
+
+        for (j = 0; j < nblock; j++, psource += n) {
+            switch (prec->alg) {
+            case compressALG_N_to_1_Low_Value:
+                block[j] = window_low(psource, n);
+                break;
+            case compressALG_N_to_1_High_Value:
+                block[j] = window_high(psource, n);
+                break;
+            case compressALG_N_to_1_Average:
+                block[j] = window_sum(psource, n) / n;
+                break;
+            case compressALG_N_to_1_Median:
+                /* note: reorders source array (OK; it's a work pointer) */
+                block[j] = window_select(psource, n, n / 2);
+                break;
             }
-            put_value(prec, &value, 1);
         }
-        break;
-    case compressALG_N_to_1_High_Value:
-        /* compress N to 1 keeping the highest value */
-        for (i = 0; i < nnew; i++){
-            value = *psource++;
-            for (j = 1; j < n; j++, psource++) {
-                if (value < *psource)
-                    value = *psource;
-            }
-            put_value(prec, &value, 1);
-        }
-        break;
-    case compressALG_N_to_1_Average:
-        /* compress N to 1 keeping the average value */
-        for (i = 0; i < nnew; i++) {
-            value = 0;
-            for (j = 0; j < n; j++, psource++)
-                value += *psource;
-            value /= n;
-            put_value(prec, &value, 1);
-        }
-        break;
-
-    case compressALG_N_to_1_Median:
-        /* compress N to 1 keeping the median value */
-        /* note: sorts source array (OK; it's a work pointer) */
-        for (i = 0; i < nnew; i++, psource += nnew) {
-            qsort(psource, n, sizeof(double), compare);
-            value = psource[n / 2];
-            put_value(prec, &value, 1);
-        }
-        break;
+        put_value(prec, block, nblock);
     }
     return 0;
 }
@@ -0,0 +1,157 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure how long a CA client takes to connect to every one of a
+ * large number of records, which it must all find by UDP search.
+ * The IOC and its CA server run in this process, so the searches
+ * only go through the loopback interface.  This is done first with
+ * one ca_create_channels() call for all of them, then with
+ * ca_create_channel() for each record.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cadef.h"
+#include "epicsAtomic.h"
+#include "envDefs.h"
+#include "epicsEvent.h"
+#include "epicsString.h"
+#include "epicsTime.h"
+#include "db_access_routines.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "rsrv.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NRECORDS 100000
+
+static size_t nConnected;
+static epicsEventId allConnected;
+
+static void connectcb(struct connection_handler_args args)
+{
+    if (args.op == CA_OP_CONN_UP &&
+        epicsAtomicIncrSizeT(&nConnected) == NRECORDS)
+        epicsEventMustTrigger(allConnected);
+}
+
+static void batchcb(struct connection_batch_handler_args args)
+{
+    size_t n = 0;
+    unsigned i;
+
+    for (i = 0; i < args.count; i++)
+        n += args.ops[i] == CA_OP_CONN_UP;
+    if (epicsAtomicAddSizeT(&nConnected, n) == NRECORDS)
+        epicsEventMustTrigger(allConnected);
+}
+
+static void connectAll(chid *pChans, char **pNames, int batch)
+{
+    epicsTimeStamp start, created, stop;
+    int i;
+
+    nConnected = 0;
+    epicsTimeGetCurrent(&start);
+    if (batch) {
+        if (ca_create_channels(NRECORDS, (const char * const *)pNames,
+                               batchcb, NULL, 0, pChans) != ECA_NORMAL)
+            testAbort("Failed to create channels");
+    }
+    else {
+        for (i = 0; i < NRECORDS; i++) {
+            if (ca_create_channel(pNames[i], connectcb, NULL, 0,
+                                  &pChans[i]) != ECA_NORMAL)
+                testAbort("Failed to create channel %s", pNames[i]);
+        }
+    }
+    epicsTimeGetCurrent(&created);
+    ca_flush_io();
+    epicsEventWaitWithTimeout(allConnected, 600.0);
+    epicsTimeGetCurrent(&stop);
+
+    testOk(epicsAtomicGetSizeT(&nConnected) == NRECORDS,
+           "%s connected %lu of %d channels",
+           batch ? "ca_create_channels()" : "ca_create_channel()",
+           (unsigned long)epicsAtomicGetSizeT(&nConnected), NRECORDS);
+    testDiag("%d channels created after %.03f s, connected after %.03f s",
+             NRECORDS, epicsTimeDiffInSeconds(&created, &start),
+             epicsTimeDiffInSeconds(&stop, &start));
+    ca_client_status(3);
+
+    for (i = 0; i < NRECORDS; i++)
+        ca_clear_channel(pChans[i]);
+}
+
+MAIN(benchcaSearch)
+{
+    chid *pChans;
+    char **pNames;
+    int i;
+
+    testPlan(2);
+
+    /* only talk to ourselves */
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_SERVER_PORT", "15064");
+    epicsEnvSet("EPICS_CA_REPEATER_PORT", "15065");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    rsrv_register_server();
+
+    for (i = 0; i < NRECORDS; i++) {
+        char buf[40];
+
+        sprintf(buf, "N=%d", i);
+        testdbReadDatabase("benchcaSearch.db", NULL, buf);
+    }
+
+    /* before iocInit(), which makes later contexts use dbContext */
+    if (ca_context_create(ca_enable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Failed to create CA context");
+
+    /* not testIocInitOk(), which doesn't start the CA server */
+    eltc(0);
+    if (iocInit())
+        testAbort("Failed to start up test database");
+    eltc(1);
+
+    allConnected = epicsEventMustCreate(epicsEventEmpty);
+    pChans = calloc(NRECORDS, sizeof(chid));
+    pNames = calloc(NRECORDS, sizeof(char *));
+    if (!pChans || !pNames)
+        testAbort("No memory");
+    for (i = 0; i < NRECORDS; i++) {
+        char name[40];
+
+        sprintf(name, "bench%d", i);
+        pNames[i] = epicsStrDup(name);
+    }
+
+    connectAll(pChans, pNames, 1);
+    connectAll(pChans, pNames, 0);
+
+    ca_context_destroy();
+    for (i = 0; i < NRECORDS; i++)
+        free(pNames[i]);
+    free(pNames);
+    free(pChans);
+    epicsEventDestroy(allConnected);
+
+    /* The CA server can't be stopped, so the IOC isn't shut down */
+
+    return testDone();
+}
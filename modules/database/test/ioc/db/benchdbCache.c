@@ -0,0 +1,89 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure the time to load many instances of a template by parsing it,
+ * and from the cache written by dbCacheOpen() and dbCacheClose().
+ */
+
+#include <stdio.h>
+
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbStaticLib.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NLOADS 10000
+#define NRECS 10
+
+static const char cacheFile[] = "benchdbCache.dbc";
+
+static double load(void)
+{
+    epicsTimeStamp start, stop;
+    unsigned hits, misses;
+    int i;
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    dbCacheOpen(cacheFile);
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NLOADS; i++) {
+        char buf[40];
+
+        sprintf(buf, "P=dev%d:,DESC=Device %d", i, i);
+        testdbReadDatabase("benchdbCache.db", ".", buf);
+    }
+    epicsTimeGetCurrent(&stop);
+
+    dbCacheCounts(&hits, &misses);
+    testOk(hits + misses == NLOADS, "%u loads from the cache, %u parsed",
+        hits, misses);
+    dbCacheClose();
+    testdbCleanup();
+    return epicsTimeDiffInSeconds(&stop, &start);
+}
+
+MAIN(benchdbCache)
+{
+    FILE *fp;
+    double parse, replay;
+    int i;
+
+    testPlan(3);
+
+    fp = fopen("benchdbCache.db", "w");
+    if (!fp)
+        testAbort("Can't create benchdbCache.db");
+    for (i = 0; i < NRECS; i++)
+        fprintf(fp, "record(x, \"$(P)rec%d\") {\n"
+            "  field(DESC, \"$(DESC) record %d\")\n"
+            "  field(SCAN, \"1 second\")\n"
+            "  field(PHAS, \"%d\")\n"
+            "  field(INP, \"$(P)rec%d NPP MS\")\n"
+            "  field(FLNK, \"$(P)rec%d\")\n"
+            "  field(VAL, \"%d\")\n"
+            "  info(autosaveFields, \"VAL DESC\")\n"
+            "}\n", i, i, i, (i + 1) % NRECS, (i + 1) % NRECS, i);
+    fclose(fp);
+    remove(cacheFile);
+
+    parse = load();
+    replay = load();
+    testDiag("%d records: %.3f s parsing, %.3f s from the cache",
+        NLOADS * NRECS, parse, replay);
+    testOk(replay < parse, "The cache is faster");
+
+    remove(cacheFile);
+    remove("benchdbCache.db");
+    return testDone();
+}
@@ -0,0 +1,182 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure db_post_events() throughput with several threads
+ * posting to records monitored through a single event context,
+ * as when one CA client monitors records processed by several
+ * scan and callback threads.
+ */
+
+#include <string.h>
+
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+#include "xRecord.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NRECORDS 30
+#define NPOSTS 200000
+
+static size_t nDelivered;
+
+typedef struct {
+    xRecord *prec[NRECORDS];
+    unsigned nrec;
+    epicsEventId start;
+    epicsEventId done;
+} poster;
+
+static void deliver(void *user_arg, struct dbChannel *chan,
+                    int eventsRemaining, struct db_field_log *pfl)
+{
+    epicsAtomicIncrSizeT(&nDelivered);
+}
+
+static void postThread(void *raw)
+{
+    poster *pp = raw;
+    unsigned i;
+
+    epicsEventMustWait(pp->start);
+    for(i=0; i<NPOSTS; i++) {
+        xRecord *prec = pp->prec[i % pp->nrec];
+
+        dbScanLock((dbCommon*)prec);
+        prec->val++;
+        db_post_events(prec, &prec->val, DBE_VALUE);
+        dbScanUnlock((dbCommon*)prec);
+    }
+    epicsEventMustTrigger(pp->done);
+}
+
+static void runBench(dbCommon **precs, evSubscrip **subs, unsigned nthreads)
+{
+    poster pp[16];
+    epicsTimeStamp start, stop;
+    unsigned long nreplace = 0;
+    double dt;
+    unsigned i;
+
+    memset(pp, 0, sizeof(pp));
+    epicsAtomicSetSizeT(&nDelivered, 0);
+    for(i=0; i<NRECORDS; i++)
+        subs[i]->nreplace = 0;
+
+    /* each record is posted to by a single thread */
+    for(i=0; i<NRECORDS; i++) {
+        poster *p = &pp[i % nthreads];
+        p->prec[p->nrec++] = (xRecord*)precs[i];
+    }
+    for(i=0; i<nthreads; i++) {
+        pp[i].start = epicsEventMustCreate(epicsEventEmpty);
+        pp[i].done = epicsEventMustCreate(epicsEventEmpty);
+        epicsThreadMustCreate("poster", epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              &postThread, &pp[i]);
+    }
+
+    epicsTimeGetCurrent(&start);
+    for(i=0; i<nthreads; i++)
+        epicsEventMustTrigger(pp[i].start);
+    for(i=0; i<nthreads; i++)
+        epicsEventMustWait(pp[i].done);
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    /* let the event task catch up */
+    for(i=0; i<100; i++) {
+        unsigned j;
+        nreplace = 0;
+        for(j=0; j<NRECORDS; j++)
+            nreplace += subs[j]->nreplace;
+        if(epicsAtomicGetSizeT(&nDelivered) + nreplace
+                == (size_t)nthreads*NPOSTS)
+            break;
+        epicsThreadSleep(0.1);
+    }
+
+    testDiag("%2u threads: %lu posts in %.03f s, %.0f posts/s,"
+             " %lu delivered, %lu replaced",
+             nthreads, (unsigned long)nthreads*NPOSTS, dt,
+             nthreads*NPOSTS/dt,
+             (unsigned long)epicsAtomicGetSizeT(&nDelivered), nreplace);
+    testOk(epicsAtomicGetSizeT(&nDelivered) + nreplace
+           == (size_t)nthreads*NPOSTS,
+           "every post delivered or replaced");
+
+    for(i=0; i<nthreads; i++) {
+        epicsEventDestroy(pp[i].start);
+        epicsEventDestroy(pp[i].done);
+    }
+}
+
+MAIN(benchdbEvent)
+{
+    static const unsigned nthreads[] = {1, 2, 4, 8, 16};
+    dbCommon *precs[NRECORDS];
+    dbChannel *chans[NRECORDS];
+    evSubscrip *subs[NRECORDS];
+    dbEventCtx ctx;
+    unsigned i;
+
+    testPlan(NELEMENTS(nthreads));
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbStressLock.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    ctx = db_init_events();
+    if(!ctx || db_start_events(ctx, "benchEvent", NULL, NULL,
+                               epicsThreadPriorityMedium+1))
+        testAbort("Failed to start event task");
+
+    for(i=0; i<NRECORDS; i++) {
+        char name[10];
+        epicsSnprintf(name, sizeof(name), "rec%02u", i+1);
+        precs[i] = testdbRecordPtr(name);
+        chans[i] = dbChannelCreate(name);
+        if(!chans[i] || dbChannelOpen(chans[i]))
+            testAbort("Failed to open channel %s", name);
+        subs[i] = db_add_event(ctx, chans[i], &deliver, NULL, DBE_VALUE);
+        if(!subs[i])
+            testAbort("Failed to subscribe to %s", name);
+        db_event_enable(subs[i]);
+    }
+
+    for(i=0; i<NELEMENTS(nthreads); i++)
+        runBench(precs, subs, nthreads[i]);
+
+    for(i=0; i<NRECORDS; i++) {
+        db_cancel_event(subs[i]);
+        dbChannelDelete(chans[i]);
+    }
+    db_close_events(ctx);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
@@ -0,0 +1,201 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure record name lookups in the process variable directory,
+ * against the chained hash table with per-bucket locks it replaced.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ellLib.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsStdio.h"
+#include "epicsString.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbStaticLib.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NRECORDS 500000
+#define NLOOKUPS 2000000
+#define OLD_SIZE 65536
+
+static char (*names)[16];
+
+/* The old directory, at its largest size */
+
+typedef struct {
+    ELLNODE node;
+    const char *name;
+} oldEntry;
+
+typedef struct {
+    ELLLIST list;
+    epicsMutexId lock;
+} oldBucket;
+
+static oldBucket *oldBuckets;
+
+static void oldAdd(const char *name)
+{
+    oldBucket *pbucket = &oldBuckets[epicsStrHash(name, 0) & (OLD_SIZE - 1)];
+    oldEntry *pentry = calloc(1, sizeof(oldEntry));
+
+    if (!pbucket->lock)
+        pbucket->lock = epicsMutexMustCreate();
+    pentry->name = name;
+    ellAdd(&pbucket->list, &pentry->node);
+}
+
+static const char *oldFind(const char *name, size_t lenName)
+{
+    oldBucket *pbucket =
+        &oldBuckets[epicsMemHash(name, lenName, 0) & (OLD_SIZE - 1)];
+    oldEntry *pentry;
+
+    epicsMutexMustLock(pbucket->lock);
+    pentry = (oldEntry *)ellFirst(&pbucket->list);
+    while (pentry) {
+        if (strncmp(name, pentry->name, lenName) == 0 &&
+            strlen(pentry->name) == lenName)
+            break;
+        pentry = (oldEntry *)ellNext(&pentry->node);
+    }
+    epicsMutexUnlock(pbucket->lock);
+    return pentry ? pentry->name : NULL;
+}
+
+static void oldFree(void)
+{
+    unsigned i;
+
+    for (i = 0; i < OLD_SIZE; i++) {
+        ellFree(&oldBuckets[i].list);
+        if (oldBuckets[i].lock)
+            epicsMutexDestroy(oldBuckets[i].lock);
+    }
+    free(oldBuckets);
+}
+
+typedef struct {
+    int useOld;
+    unsigned seed;
+    unsigned long found;
+    epicsEventId done;
+} looker;
+
+static void lookThread(void *raw)
+{
+    looker *pl = raw;
+    DBENTRY entry;
+    unsigned i, n = pl->seed;
+
+    dbInitEntry(pdbbase, &entry);
+    for (i = 0; i < NLOOKUPS; i++) {
+        const char *name;
+
+        n = n * 1103515245u + 12345u;
+        name = names[(n >> 8) % NRECORDS];
+        if (pl->useOld) {
+            if (oldFind(name, strlen(name)))
+                pl->found++;
+        }
+        else if (!dbFindRecord(&entry, name))
+            pl->found++;
+    }
+    dbFinishEntry(&entry);
+    epicsEventMustTrigger(pl->done);
+}
+
+static void runBench(int useOld, unsigned nthreads)
+{
+    looker lk[8];
+    epicsTimeStamp start, stop;
+    unsigned long found = 0;
+    double dt;
+    unsigned i;
+
+    memset(lk, 0, sizeof(lk));
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < nthreads; i++) {
+        lk[i].useOld = useOld;
+        lk[i].seed = i + 1;
+        lk[i].done = epicsEventMustCreate(epicsEventEmpty);
+        epicsThreadMustCreate("looker", epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              &lookThread, &lk[i]);
+    }
+    for (i = 0; i < nthreads; i++) {
+        epicsEventMustWait(lk[i].done);
+        epicsEventDestroy(lk[i].done);
+        found += lk[i].found;
+    }
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%s, %u threads: %lu lookups in %.03f s, %.0f ns per lookup,"
+             " %.0f lookups/s", useOld ? "chained " : "dbPvdFind", nthreads,
+             (unsigned long)nthreads * NLOOKUPS, dt,
+             dt * 1e9 / NLOOKUPS, nthreads * NLOOKUPS / dt);
+    testOk(found == (unsigned long)nthreads * NLOOKUPS,
+           "found %lu of %lu", found, (unsigned long)nthreads * NLOOKUPS);
+}
+
+MAIN(benchdbPvd)
+{
+    static const unsigned nthreads[] = {1, 4};
+    epicsTimeStamp start, stop;
+    DBENTRY entry;
+    unsigned i;
+
+    testPlan(2 * NELEMENTS(nthreads));
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    names = calloc(NRECORDS, sizeof(*names));
+    oldBuckets = calloc(OLD_SIZE, sizeof(oldBucket));
+    if (!names || !oldBuckets)
+        testAbort("Out of memory");
+
+    dbInitEntry(pdbbase, &entry);
+    if (dbFindRecordType(&entry, "x"))
+        testAbort("No record type x");
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NRECORDS; i++) {
+        epicsSnprintf(names[i], sizeof(names[i]), "pvd:%06u", i);
+        if (dbCreateRecord(&entry, names[i]))
+            testAbort("Failed to create %s", names[i]);
+    }
+    epicsTimeGetCurrent(&stop);
+    dbFinishEntry(&entry);
+    testDiag("Created %d records in %.03f s", NRECORDS,
+             epicsTimeDiffInSeconds(&stop, &start));
+
+    for (i = 0; i < NRECORDS; i++)
+        oldAdd(names[i]);
+
+    for (i = 0; i < NELEMENTS(nthreads); i++) {
+        runBench(0, nthreads[i]);
+        runBench(1, nthreads[i]);
+    }
+
+    oldFree();
+    testdbCleanup();
+    free(names);
+
+    return testDone();
+}
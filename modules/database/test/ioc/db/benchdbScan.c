@@ -0,0 +1,109 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure the cost of scanning a large scan list, and of changing
+ * the SCAN field of one of its records.
+ */
+
+#include <stdio.h>
+
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbScan.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+#include "devx.h"
+#include "xRecord.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NRECORDS 100000
+#define NPASS 10
+#define NCHANGE 100
+
+static size_t nProcessed;
+
+static void countcb(xpriv *priv, void *raw)
+{
+    nProcessed++;
+}
+
+MAIN(benchdbScan)
+{
+    epicsTimeStamp start, stop;
+    xdrv *drv;
+    double dt;
+    int i;
+
+    testPlan(2);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    drv = xdrv_add(0, &countcb, NULL);
+
+    for (i = 0; i < NRECORDS; i++) {
+        char buf[40];
+
+        sprintf(buf, "GROUP=0,MEMBER=%d,PRIO=LOW", i);
+        testdbReadDatabase("scanIoTest.db", NULL, buf);
+    }
+
+    eltc(0);
+    epicsTimeGetCurrent(&start);
+    testIocInitOk();
+    epicsTimeGetCurrent(&stop);
+    eltc(1);
+    testDiag("iocInit with %d I/O Intr records took %.03f s",
+             NRECORDS, epicsTimeDiffInSeconds(&stop, &start));
+
+    nProcessed = 0;
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NPASS; i++)
+        scanIoImmediate(drv->scan, 0);
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%d passes over %d records in %.03f s, %.03f ms per pass,"
+             " %.0f ns per record", NPASS, NRECORDS, dt, dt * 1e3 / NPASS,
+             dt * 1e9 / NPASS / NRECORDS);
+    testOk(nProcessed == (size_t)NPASS * NRECORDS,
+           "processed %lu of %lu", (unsigned long)nProcessed,
+           (unsigned long)NPASS * NRECORDS);
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NCHANGE; i++) {
+        char name[40];
+        DBADDR addr;
+
+        sprintf(name, "g0m%d.SCAN", i * (NRECORDS / NCHANGE));
+        if (dbNameToAddr(name, &addr))
+            testAbort("Missing record %s", name);
+        dbPutField(&addr, DBR_STRING, "Passive", 1);
+        dbPutField(&addr, DBR_STRING, "I/O Intr", 1);
+    }
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+    testDiag("%d SCAN changes in %.03f s, %.03f ms per change",
+             2 * NCHANGE, dt, dt * 1e3 / (2 * NCHANGE));
+
+    nProcessed = 0;
+    scanIoImmediate(drv->scan, 0);
+    testOk(nProcessed == NRECORDS, "processed %lu of %d after changes",
+           (unsigned long)nProcessed, NRECORDS);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    xdrv_reset();
+
+    return testDone();
+}
@@ -19,6 +19,8 @@
 
 #include "callback.h"
 #include "cantProceed.h"
+#include "dbAccessDefs.h"
+#include "epicsAtomic.h"
 #include "epicsThread.h"
 #include "epicsEvent.h"
 #include "epicsTime.h"
@@ -36,6 +38,10 @@
  * the immediate callbacks, and the actual delay of the delayed callback.
  *
  * Slow callbacks no longer fail the test, they just emit a diagnostic.
+ *
+ * Then requests queued to a busy worker must be run by the others, and
+ * with every worker busy each request accepted before the queues
+ * overflowed must still be run once.
  */
 
 #define NCALLBACKS 169
@@ -80,6 +86,122 @@ static void finalCallback(CALLBACK *pCallback)
     epicsEventSignal(finished);
 }
 
+/* Workers held in blockCallback() until release is signalled */
+static epicsEventId blockStarted, release;
+static int nBlocked;
+static epicsThreadId blockedThread;
+
+static void blockCallback(CALLBACK *pCallback)
+{
+    blockedThread = epicsThreadGetIdSelf();
+    epicsAtomicIncrIntT(&nBlocked);
+    epicsEventSignal(blockStarted);
+    epicsEventMustWait(release);
+    /* pass the release on to the next blocked worker */
+    epicsEventSignal(release);
+    epicsAtomicDecrIntT(&nBlocked);
+}
+
+/* Counts runs, and those on the blocked worker's thread */
+static int nRun, nRunBlocked;
+
+static void countCallback(CALLBACK *pCallback)
+{
+    if (epicsThreadGetIdSelf() == blockedThread)
+        epicsAtomicIncrIntT(&nRunBlocked);
+    epicsAtomicIncrIntT(&nRun);
+}
+
+/* Wait up to 5 seconds for *pcount to reach n */
+static int waitCount(int *pcount, int n)
+{
+    int i;
+
+    for (i = 0; i < 500 && epicsAtomicGetIntT(pcount) < n; i++)
+        epicsThreadSleep(0.01);
+    return epicsAtomicGetIntT(pcount) >= n;
+}
+
+static void releaseBlocked(void)
+{
+    epicsEventSignal(release);
+    while (epicsAtomicGetIntT(&nBlocked) > 0)
+        epicsThreadSleep(0.01);
+    epicsEventTryWait(release);
+}
+
+#define NSTEAL 20
+
+static void testSteal(void)
+{
+    CALLBACK blocker, cb[NSTEAL];
+    int i;
+
+    testDiag("Requests queued to a busy worker");
+
+    nRun = nRunBlocked = 0;
+    callbackSetCallback(blockCallback, &blocker);
+    callbackSetPriority(priorityHigh, &blocker);
+    callbackSetUser(&blocker, &blocker);
+    callbackRequest(&blocker);
+    if (epicsEventWaitWithTimeout(blockStarted, 5.0) != epicsEventOK)
+        testAbort("blockCallback() didn't start");
+
+    /* the same user argument queues them all behind the blocker */
+    for (i = 0; i < NSTEAL; i++) {
+        callbackSetCallback(countCallback, &cb[i]);
+        callbackSetPriority(priorityHigh, &cb[i]);
+        callbackSetUser(&blocker, &cb[i]);
+        callbackRequest(&cb[i]);
+    }
+    testOk(waitCount(&nRun, NSTEAL) && epicsAtomicGetIntT(&nBlocked) == 1,
+        "%d of %d requests run while their worker was busy",
+        epicsAtomicGetIntT(&nRun), NSTEAL);
+    testOk(nRunBlocked == 0, "%d run by the busy worker", nRunBlocked);
+
+    releaseBlocked();
+}
+
+static void testOverflow(int nThreads)
+{
+    CALLBACK *blockers = callocMustSucceed(nThreads, sizeof(CALLBACK),
+        "blockers");
+    CALLBACK cb;
+    int i, accepted = 0, status;
+
+    testDiag("Requests with every worker busy");
+
+    nRun = 0;
+    for (i = 0; i < nThreads; i++) {
+        callbackSetCallback(blockCallback, &blockers[i]);
+        callbackSetPriority(priorityMedium, &blockers[i]);
+        callbackSetUser(&blockers[i], &blockers[i]);
+        callbackRequest(&blockers[i]);
+    }
+    if (!waitCount(&nBlocked, nThreads))
+        testAbort("Only %d of %d workers blocked",
+            epicsAtomicGetIntT(&nBlocked), nThreads);
+    blockedThread = NULL;   /* not counting runs by thread here */
+
+    callbackSetCallback(countCallback, &cb);
+    callbackSetPriority(priorityMedium, &cb);
+    while ((status = callbackRequest(&cb)) == 0)
+        accepted++;
+    testOk(status == S_db_bufFull, "Queues full after %d requests",
+        accepted);
+
+    releaseBlocked();
+    waitCount(&nRun, accepted);
+    epicsThreadSleep(0.1);
+    testOk(nRun == accepted, "%d of %d accepted requests run", epicsAtomicGetIntT(&nRun),
+        accepted);
+
+    status = callbackRequest(&cb);
+    testOk(status == 0, "Requests accepted again once the queues drain");
+    waitCount(&nRun, accepted + 1);
+    free(blockers);
+}
+
 static void updateStats(double *stats, double val)
 {
     if (stats[0] > val) stats[0] = val;
@@ -100,6 +222,7 @@ MAIN(callbackParallelTest)
     myPvt *pcbt[NCALLBACKS];
     epicsTimeStamp start;
     int noCpus = epicsThreadGetCPUs();
+    int nThreads = noCpus < 2 ? 2 : noCpus;
     int i, j, slowups, faults;
     /* Statistics: min/max/sum/sum^2/n for each priority */
     double setupError[NUM_CALLBACK_PRIORITIES][5];
@@ -110,11 +233,11 @@ MAIN(callbackParallelTest)
         for (j = 0; j < 5; j++)
             setupError[i][j] = timeError[i][j] = defaultError[j];
 
-    testPlan(2);
+    testPlan(7);
 
-    testDiag("Starting %d parallel callback threads", noCpus);
+    testDiag("Starting %d parallel callback threads", nThreads);
 
-    callbackParallelThreads(noCpus, "");
+    callbackParallelThreads(nThreads, "");
     callbackInit();
     epicsThreadSleep(1.0);
 
@@ -202,6 +325,11 @@ MAIN(callbackParallelTest)
         free(pcbt[i]);
     }
 
+    blockStarted = epicsEventMustCreate(epicsEventEmpty);
+    release = epicsEventMustCreate(epicsEventEmpty);
+    testSteal();
+    testOverflow(nThreads);
+
     callbackStop();
     callbackCleanup();
 
@@ -562,6 +562,9 @@ static void testreTargetTypeChange(void)
 
     testIocShutdownOk();
 
+    epicsEventDestroy(waitEvent);
+    waitEvent = NULL;
+
     testdbCleanup();
 
     /* records don't cleanup after themselves
@@ -615,9 +618,21 @@ static void testCAC(void)
     free(buftarg2);
 }
 
+static void testShards(void)
+{
+    testDiag("Links shared between 4 dbCa threads");
+    testOk1(dbCaLinkThreads(4)==0);
+    testNativeLink();
+    testCP();
+    testArrayLink(10,10);
+    testreTargetTypeChange();
+    testCAC();
+    testOk1(dbCaLinkThreads(1)==0);
+}
+
 MAIN(dbCaLinkTest)
 {
-    testPlan(101);
+    testPlan(164);
     testNativeLink();
     testStringLink();
     testCP();
@@ -627,5 +642,6 @@ MAIN(dbCaLinkTest)
     testArrayLink(10,10);
     testreTargetTypeChange();
     testCAC();
+    testShards();
     return testDone();
 }
@@ -0,0 +1,182 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Load records through dbCacheOpen(), and check that the cache is used
+ * only while the files and macros are the same, and that records loaded
+ * from it are the same as those parsed. DBD files are never cached.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <errlog.h>
+#include <dbAccess.h>
+#include <dbStaticLib.h>
+#include <dbUnitTest.h>
+#include <testMain.h>
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static const char cacheFile[] = "dbCacheTest.dbc";
+
+static void writeFile(const char *name, const char *text)
+{
+    FILE *fp = fopen(name, "w");
+
+    if (!fp)
+        testAbort("Can't create %s", name);
+    fputs(text, fp);
+    fclose(fp);
+}
+
+static void testField(const char *rec, const char *field, const char *value)
+{
+    DBENTRY entry;
+    const char *actual = "";
+
+    dbInitEntry(pdbbase, &entry);
+    if (!dbFindRecord(&entry, rec) && !dbFindField(&entry, field))
+        actual = dbGetString(&entry);
+    testOk(strcmp(actual, value) == 0, "%s.%s is \"%s\" (\"%s\")",
+        rec, field, actual, value);
+    dbFinishEntry(&entry);
+}
+
+static void testRecords(const char *p, const char *v, const char *desc)
+{
+    DBENTRY entry;
+    char a[32], b[32], c[32], d[32];
+
+    sprintf(a, "%sa", p);
+    sprintf(b, "%sb", p);
+    sprintf(c, "%sc", p);
+    sprintf(d, "%sd", p);
+    testField(a, "VAL", v);
+    testField(d, "DESC", desc);
+
+    dbInitEntry(pdbbase, &entry);
+    testOk(!dbFindRecord(&entry, b) && dbIsAlias(&entry) &&
+           !dbFindRecord(&entry, c) && dbIsAlias(&entry),
+           "Aliases %s and %s exist", b, c);
+    testOk(!dbFindRecord(&entry, a) && !dbFindInfo(&entry, "test") &&
+           strcmp(dbGetInfoString(&entry), a) == 0,
+           "Info item of %s", a);
+    dbFinishEntry(&entry);
+}
+
+static void load(const char *v2, unsigned hits, unsigned misses)
+{
+    unsigned actualHits, actualMisses;
+    char macros[32];
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testOk1(dbCacheOpen(cacheFile) == 0);
+    testdbReadDatabase("dbCacheTest.db", ".", "P=r1:,V=1");
+    sprintf(macros, "P=r2:,V=%s", v2);
+    testdbReadDatabase("dbCacheTest.db", ".", macros);
+
+    dbCacheCounts(&actualHits, &actualMisses);
+    testOk(actualHits == hits && actualMisses == misses,
+        "%u loads from the cache (%u), %u parsed (%u)",
+        actualHits, hits, actualMisses, misses);
+}
+
+static void unload(void)
+{
+    testOk1(dbCacheClose() == 0);
+    testdbCleanup();
+}
+
+static void testDbd(void)
+{
+    unsigned hits, misses;
+    int pass;
+
+    writeFile("dbCacheTest.dbd",
+        "menu(dbCacheTestMenu) {\n"
+        "  choice(dbCacheTestA, \"A\")\n"
+        "}\n");
+
+    for (pass = 1; pass <= 2; pass++) {
+        testdbPrepare();
+        testOk1(dbCacheOpen(cacheFile) == 0);
+        testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+        testdbReadDatabase("dbCacheTest.dbd", ".", NULL);
+
+        dbCacheCounts(&hits, &misses);
+        testOk(hits == 0 && misses == 0,
+            "Pass %d, %u loads from the cache, %u parsed", pass, hits, misses);
+        testOk(dbFindMenu(pdbbase, "dbCacheTestMenu") != NULL,
+            "Pass %d, menu was loaded", pass);
+        unload();
+    }
+}
+
+MAIN(dbCacheTest)
+{
+    testPlan(51);
+
+    remove(cacheFile);
+    writeFile("dbCacheTest.db",
+        "record(x, \"$(P)a\") {\n"
+        "  field(VAL, \"$(V)\")\n"
+        "  alias(\"$(P)b\")\n"
+        "  info(test, \"$(P)a\")\n"
+        "}\n"
+        "include \"dbCacheTestInc.db\"\n"
+        "alias(\"$(P)a\", \"$(P)c\")\n");
+    writeFile("dbCacheTestInc.db",
+        "record(x, \"$(P)d\") {\n"
+        "  field(DESC, \"first\\t$(V)\")\n"
+        "}\n");
+
+    testDiag("No cache file yet");
+    load("2", 0, 2);
+    testRecords("r1:", "1", "first\t1");
+    testRecords("r2:", "2", "first\t2");
+    unload();
+
+    testDiag("Everything from the cache");
+    load("2", 2, 0);
+    testRecords("r1:", "1", "first\t1");
+    testRecords("r2:", "2", "first\t2");
+    unload();
+
+    testDiag("Included file changed");
+    writeFile("dbCacheTestInc.db",
+        "record(x, \"$(P)d\") {\n"
+        "  field(DESC, \"second $(V)\")\n"
+        "}\n");
+    load("2", 0, 2);
+    testRecords("r1:", "1", "second 1");
+    testRecords("r2:", "2", "second 2");
+    unload();
+
+    testDiag("Macros changed");
+    load("3", 1, 1);
+    testRecords("r2:", "3", "second 3");
+    unload();
+
+    testDiag("Invalid cache file");
+    writeFile(cacheFile, "not a cache\n");
+    eltc(0);
+    load("3", 0, 2);
+    eltc(1);
+    unload();
+
+    testDiag("DBD files");
+    remove(cacheFile);
+    testDbd();
+
+    remove(cacheFile);
+    remove("dbCacheTest.db");
+    remove("dbCacheTestInc.db");
+    remove("dbCacheTest.dbd");
+    return testDone();
+}
@@ -0,0 +1,100 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Initialize records with and without iocInitThreads(), and check that
+ * the records and their links are initialized the same way.
+ */
+
+#include <stdio.h>
+
+#include "dbAccess.h"
+#include "dbLock.h"
+#include "dbUnitTest.h"
+#include "errlog.h"
+#include "epicsThread.h"
+#include "iocInit.h"
+#include "link.h"
+
+#include "xRecord.h"
+
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NRECS 500
+
+static void cycle(int nThreads)
+{
+    epicsThreadId me = epicsThreadGetIdSelf();
+    int inits = 0, links = 0, locks = 0, other = 0;
+    int i;
+
+    testDiag("iocInitThreads(%d)", nThreads);
+    testOk1(iocInitThreads(nThreads) == 0);
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    for (i = 0; i < NRECS; i++) {
+        char macros[16];
+
+        sprintf(macros, "N=%d", i);
+        testdbReadDatabase("dbInitThreadsTest.db", NULL, macros);
+    }
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk1(iocInitThreads(nThreads) == -1);
+
+    for (i = 0; i < NRECS; i++) {
+        char name[16];
+        xRecord *psafe, *psoft, *pca;
+
+        sprintf(name, "safe%d", i);
+        psafe = (xRecord *)testdbRecordPtr(name);
+        sprintf(name, "soft%d", i);
+        psoft = (xRecord *)testdbRecordPtr(name);
+        sprintf(name, "ca%d", i);
+        pca = (xRecord *)testdbRecordPtr(name);
+
+        inits += psafe->dpvt != NULL;
+        other += psafe->dpvt != NULL && psafe->dpvt != (void *)me;
+        links += psafe->lnk.type == DB_LINK &&
+                 psoft->inp.type == DB_LINK &&
+                 pca->lnk.type == CA_LINK;
+        locks += dbLockGetLockId((dbCommon *)psafe) ==
+                 dbLockGetLockId((dbCommon *)psoft) &&
+                 dbLockGetLockId((dbCommon *)psafe) !=
+                 dbLockGetLockId((dbCommon *)pca);
+    }
+    testOk(inits == NRECS, "%d of %d thread safe records initialized",
+           inits, NRECS);
+    testOk(links == NRECS, "%d of %d link sets resolved", links, NRECS);
+    testOk(locks == NRECS, "%d of %d lock sets merged", locks, NRECS);
+    if (nThreads <= 1)
+        testOk(other == 0, "%d records initialized by other threads", other);
+    else
+        testDiag("%d records initialized by other threads", other);
+
+    iocInitTimes();
+
+    testIocShutdownOk();
+    testdbCleanup();
+}
+
+MAIN(dbInitThreadsTest)
+{
+    testPlan(17);
+
+    cycle(0);
+    cycle(4);
+    cycle(1);
+
+    iocInitThreads(0);
+    return testDone();
+}
@@ -13,6 +13,7 @@
 
 #include "dbScan.h"
 #include "epicsEvent.h"
+#include "epicsThread.h"
 
 #include "dbUnitTest.h"
 #include "testMain.h"
@@ -20,6 +21,8 @@
 #include "dbAccess.h"
 #include "errlog.h"
 
+#include "xRecord.h"
+
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
 static epicsEventId waiter;
@@ -65,9 +68,76 @@ static void testOnce(void)
     epicsEventDestroy(waiter);
 }
 
+static void countProc(xRecord *prec)
+{
+    prec->val++;
+}
+
+static void testParallel(void)
+{
+    static const char *names[] = {"reca", "recb", "recd", "recg"};
+    xRecord *precs[NELEMENTS(names)];
+    unsigned i;
+
+    testDiag("check periodic scan with several threads");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    testOk1(scanParallelThreads(3, 0.1)==0);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk1(scanParallelThreads(3, 0.1)==-1);
+
+    for (i = 0; i < NELEMENTS(names); i++) {
+        precs[i] = (xRecord*)testdbRecordPtr(names[i]);
+        dbScanLock((dbCommon*)precs[i]);
+        precs[i]->clbk = countProc;
+        precs[i]->val = 0;
+        dbScanUnlock((dbCommon*)precs[i]);
+    }
+    testdbPutFieldOk("recg.PHAS", DBF_SHORT, 1);
+    for (i = 0; i < NELEMENTS(names); i++) {
+        char field[20];
+
+        sprintf(field, "%s.SCAN", names[i]);
+        testdbPutFieldOk(field, DBF_STRING, ".1 second");
+    }
+
+    epicsThreadSleep(1.0);
+
+    for (i = 0; i < NELEMENTS(names); i++) {
+        char field[20];
+
+        sprintf(field, "%s.SCAN", names[i]);
+        testdbPutFieldOk(field, DBF_STRING, "Passive");
+    }
+
+    for (i = 0; i < NELEMENTS(names); i++) {
+        epicsInt32 val;
+
+        dbScanLock((dbCommon*)precs[i]);
+        val = precs[i]->val;
+        precs[i]->clbk = NULL;
+        dbScanUnlock((dbCommon*)precs[i]);
+        testOk(val >= 5, "%s processed %d times", names[i], (int)val);
+    }
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
 MAIN(dbScanTest)
 {
-    testPlan(3);
+    testPlan(18);
     testOnce();
+    testParallel();
     return testDone();
 }
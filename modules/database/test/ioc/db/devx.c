@@ -9,6 +9,7 @@
 #include <stdio.h>
 
 #include <epicsAssert.h>
+#include <epicsThread.h>
 #include <cantProceed.h>
 #include <ellLib.h>
 #include <dbDefs.h>
@@ -157,3 +158,29 @@ static struct xdset devxSoft = {
     &xsoft_read
 };
 epicsExportAddress(dset, devxSoft);
+
+/* DTYP="Thread Safe"
+ *
+ * Declares that its init_record() may be called in parallel with other
+ * records, which saves the thread that called it in DPVT.
+ */
+static long xsafe_init(int after)
+{
+    if(!after)
+        devInitThreadSafe();
+    return 0;
+}
+
+static long xsafe_init_record(xRecord *prec)
+{
+    prec->dpvt = epicsThreadGetIdSelf();
+    return 0;
+}
+
+static struct xdset devxThreadSafe = {
+    5, NULL, &xsafe_init,
+    &xsafe_init_record,
+    NULL,
+    NULL
+};
+epicsExportAddress(dset, devxThreadSafe);
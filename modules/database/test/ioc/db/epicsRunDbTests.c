@@ -23,11 +23,13 @@ int dbStateTest(void);
 int dbServerTest(void);
 int dbCaStatsTest(void);
 int dbShutdownTest(void);
+int dbInitThreadsTest(void);
 int dbScanTest(void);
 int scanIoTest(void);
 int dbLockTest(void);
 int dbPutLinkTest(void);
 int dbStaticTest(void);
+int dbCacheTest(void);
 int dbCaLinkTest(void);
 int testDbChannel(void);
 int chfPluginTest(void);
@@ -45,11 +47,13 @@ void epicsRunDbTests(void)
     runTest(dbServerTest);
     runTest(dbCaStatsTest);
     runTest(dbShutdownTest);
+    runTest(dbInitThreadsTest);
     runTest(dbScanTest);
     runTest(scanIoTest);
     runTest(dbLockTest);
     runTest(dbPutLinkTest);
     runTest(dbStaticTest);
+    runTest(dbCacheTest);
     runTest(dbCaLinkTest);
     runTest(testDbChannel);
     runTest(arrShorthandTest);
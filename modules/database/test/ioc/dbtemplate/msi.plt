@@ -11,7 +11,7 @@
 use strict;
 use Test;
 
-BEGIN {plan tests => 9}
+BEGIN {plan tests => 14}
 
 # Check include/substitute command model
 ok(msi('-I .. ../t1-template.txt'),             slurp('../t1-result.txt'));
@@ -50,6 +50,13 @@ ok(msi('-I.. -D -o t8.txt ../t1-template.txt'), slurp('../t8-result.txt'));
 # Dependency generation, dbLoadTemplate format
 ok(msi('-I.. -D -ot9.txt -S ../t2-substitution.txt'), slurp('../t9-result.txt'));
 
+# Substitution files expanded in several threads
+ok(msi('-j4 -I.. -S ../t2-substitution.txt'),   slurp('../t2-result.txt'));
+ok(msi('-j4 -I. -I.. -S ../t3-substitution.txt'), slurp('../t3-result.txt'));
+ok(msi('-j4 -g -I.. -S ../t4-substitution.txt'), slurp('../t4-result.txt'));
+ok(msi('-j4 -S ../t5-substitute.txt ../t5-template.txt'), slurp('../t5-result.txt'));
+ok(msi('-j4 -S../t6-substitute.txt ../t6-template.txt'), slurp('../t6-result.txt'));
+
 
 # Test support routines
 
@@ -37,6 +37,8 @@
 #include "iocInit.h"
 #include "iocsh.h"
 #include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
 #include "epicsUnitTest.h"
 #include "dbUnitTest.h"
 #include "testMain.h"
@@ -292,13 +294,104 @@ static void check(short dbr_type) {
     TEST5B(3, -8, -4, "both sides from-end");
 }
 
+static db_field_log* eventLog(dbChannel *pch) {
+    db_field_log *pfl = db_create_read_log(pch);
+
+    pfl->ctx = dbfl_context_event;
+    return dbChannelRunPostChain(pch, pfl);
+}
+
+/* Changes the array during processing without posting it */
+static void reverseArray(arrRecord *prec) {
+    epicsInt32 *pval = (epicsInt32 *) prec->bptr;
+
+    for (epicsUInt32 i = 0; i < prec->nelm / 2; i++) {
+        epicsInt32 tmp = pval[i];
+
+        pval[i] = pval[prec->nelm - 1 - i];
+        pval[prec->nelm - 1 - i] = tmp;
+    }
+}
+
+static void checkShared(void) {
+    dbChannel *pch1, *pch2;
+    db_field_log *pfl1, *pfl2, *pfl3;
+    dbAddr offaddr, valaddr;
+    arrRecord *prec;
+    epicsInt32 ar[10] = {10,11,12,13,14,15,16,17,18,19};
+    epicsInt32 put[10] = {20,21,22,23,24,25,26,27,28,29};
+    epicsInt32 rev[10] = {29,28,27,26,25,24,23,22,21,20};
+    epicsInt32 *ar10_0_1 = ar;
+    epicsInt32 ar5_0_1[10] = {12,13,14,15,16};
+    epicsInt32 off = 0;
+
+    testHead("Array copies shared by subscriptions");
+
+    (void) dbNameToAddr("x.OFF", &offaddr);
+    (void) dbPutField(&offaddr, DBR_LONG, &off, 1);
+    createAndOpen("x.VAL", "{\"arr\":{}}", "(default)", &pch1, 1);
+    createAndOpen("x.VAL", "{\"arr\":{\"s\":2,\"e\":6}}", "(2:1:6)", &pch2, 1);
+
+    pfl1 = eventLog(pch1);
+    pfl2 = eventLog(pch2);
+    testOk(fl_equals_array(DBR_LONG, pfl1, ar10_0_1), "full array correct");
+    testOk(fl_equals_array(DBR_LONG, pfl2, ar5_0_1), "slice correct");
+    testOk(pfl2->u.r.field == (char *) pfl1->u.r.field + 2 * pfl1->field_size,
+           "slice shares the buffer of the full array");
+
+    pfl3 = dbChannelRunPostChain(pch1, db_create_read_log(pch1));
+    testOk(pfl3->u.r.field != pfl1->u.r.field, "read reply gets its own copy");
+    db_delete_field_log(pfl3);
+
+    dbScanLock(dbChannelRecord(pch1));
+    db_post_events(dbChannelRecord(pch1), NULL, DBE_VALUE);
+    dbScanUnlock(dbChannelRecord(pch1));
+    pfl3 = eventLog(pch1);
+    testOk(pfl3->u.r.field != pfl1->u.r.field, "new copy after the record posts");
+    testOk(fl_equals_array(DBR_LONG, pfl3, ar10_0_1), "new copy correct");
+    db_delete_field_log(pfl3);
+
+    /* Neither of these posts the array */
+    (void) dbNameToAddr("x.VAL", &valaddr);
+    prec = (arrRecord *) valaddr.precord;
+    pfl3 = eventLog(pch1);
+    dbScanLock((dbCommon *) prec);
+    (void) dbPut(&valaddr, DBR_LONG, put, 10);
+    dbScanUnlock((dbCommon *) prec);
+    db_delete_field_log(pfl3);
+    pfl3 = eventLog(pch1);
+    testOk(fl_equals_array(DBR_LONG, pfl3, put), "new copy after dbPut()");
+    db_delete_field_log(pfl3);
+
+    prec->clbk = reverseArray;
+    dbScanLock((dbCommon *) prec);
+    dbProcess((dbCommon *) prec);
+    dbScanUnlock((dbCommon *) prec);
+    prec->clbk = NULL;
+    pfl3 = eventLog(pch1);
+    testOk(fl_equals_array(DBR_LONG, pfl3, rev), "new copy after processing");
+    db_delete_field_log(pfl3);
+
+    dbScanLock((dbCommon *) prec);
+    (void) dbPut(&valaddr, DBR_LONG, ar, 10);
+    dbScanUnlock((dbCommon *) prec);
+
+    db_delete_field_log(pfl1);
+    testOk(fl_equals_array(DBR_LONG, pfl2, ar5_0_1),
+           "slice still correct after the full array is released");
+    db_delete_field_log(pfl2);
+
+    dbChannelDelete(pch1);
+    dbChannelDelete(pch2);
+}
+
 MAIN(arrTest)
 {
     dbEventCtx evtctx;
     const chFilterPlugin *plug;
     char arr[] = "arr";
 
-    testPlan(1402);
+    testPlan(1421);
 
     /* Prepare the IOC */
 
@@ -325,6 +418,7 @@ MAIN(arrTest)
     check(DBR_LONG);
     check(DBR_DOUBLE);
     check(DBR_STRING);
+    checkShared();
 
     db_close_events(evtctx);
 
@@ -0,0 +1,134 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure the cost of posting a large array to several subscriptions
+ * which each need a copy of it, through the ts filter (copied when
+ * posted) and the arr filter (copied by the event task).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsAtomic.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void filterTest_registerRecordDeviceDriver(struct dbBase *);
+
+#define NSUBS 8
+#define NPOSTS 200
+
+static size_t nDelivered;
+
+static void deliver(void *user_arg, struct dbChannel *chan,
+                    int eventsRemaining, struct db_field_log *pfl)
+{
+    epicsAtomicIncrSizeT(&nDelivered);
+}
+
+static void runBench(dbEventCtx ctx, const char *json)
+{
+    dbChannel *chans[NSUBS];
+    dbEventSubscription subs[NSUBS];
+    dbCommon *prec = testdbRecordPtr("big");
+    epicsTimeStamp start, stop;
+    double dt;
+    unsigned i;
+
+    for (i = 0; i < NSUBS; i++) {
+        char name[80];
+
+        epicsSnprintf(name, sizeof(name), "big.VAL%s", json);
+        chans[i] = dbChannelCreate(name);
+        if (!chans[i] || dbChannelOpen(chans[i]))
+            testAbort("Failed to open channel %s", name);
+        subs[i] = db_add_event(ctx, chans[i], &deliver, NULL, DBE_VALUE);
+        if (!subs[i])
+            testAbort("Failed to subscribe to %s", name);
+        db_event_enable(subs[i]);
+    }
+    db_flush_extra_labor_event(ctx);
+    epicsAtomicSetSizeT(&nDelivered, 0);
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NPOSTS; i++) {
+        dbScanLock(prec);
+        db_post_events(prec, NULL, DBE_VALUE);
+        dbScanUnlock(prec);
+        /* Wait for delivery, so nothing is dropped from the queue */
+        while (epicsAtomicGetSizeT(&nDelivered) < (i + 1) * NSUBS)
+            epicsThreadSleep(0.0);
+    }
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%-24s %u posts to %u subscriptions: %.3f ms per post",
+             json, NPOSTS, NSUBS, dt * 1e3 / NPOSTS);
+    testOk(epicsAtomicGetSizeT(&nDelivered) == NPOSTS * NSUBS,
+           "every post delivered");
+
+    for (i = 0; i < NSUBS; i++) {
+        db_cancel_event(subs[i]);
+        dbChannelDelete(chans[i]);
+    }
+}
+
+MAIN(benchArrCopy)
+{
+    dbEventCtx ctx;
+    dbAddr addr;
+    long nelm;
+    double *pval;
+    long i;
+
+    testPlan(3);
+
+    testdbPrepare();
+
+    testdbReadDatabase("filterTest.dbd", NULL, NULL);
+    filterTest_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("benchArrCopy.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    if (dbNameToAddr("big", &addr))
+        testAbort("No record big");
+    nelm = addr.no_elements;
+    pval = calloc(nelm, sizeof(double));
+    for (i = 0; i < nelm; i++)
+        pval[i] = i;
+    if (dbPutField(&addr, DBR_DOUBLE, pval, nelm))
+        testAbort("Failed to fill big");
+    free(pval);
+
+    ctx = db_init_events();
+    if (!ctx || db_start_events(ctx, "benchArrCopy", NULL, NULL,
+                                epicsThreadPriorityMedium))
+        testAbort("Failed to start event task");
+
+    runBench(ctx, "{\"ts\":{}}");
+    runBench(ctx, "{\"arr\":{\"s\":1}}");
+    runBench(ctx, "{\"arr\":{\"s\":1,\"e\":9}}");
+
+    db_close_events(ctx);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
@@ -0,0 +1,109 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#include "dbAccess.h"
+#include "alarm.h"
+#include "dbUnitTest.h"
+#include "errlog.h"
+
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static void testArrays(void)
+{
+    static const double wf[] = {1, 2, 3, 4, 5};
+    static const double sum[] = {5, 7, 9, 11, 13};
+    static const double cond[] = {-1, -2, 3, 4, 5};
+    static const double shrt[] = {11, 22, 33};
+    static const double diff[] = {-2, -1, 0, 1, 2};
+    static const double dbl[] = {2, 4, 6, 8, 10};
+
+    testDiag("testArrays");
+
+    testdbPutArrFieldOk("wf", DBF_DOUBLE, NELEMENTS(wf), wf);
+
+    testdbPutFieldOk("sum.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("sum.NORD", DBR_LONG, 5);
+    testdbGetArrFieldEqual("sum", DBF_DOUBLE, 10, NELEMENTS(sum), sum);
+    testdbGetFieldEqual("sum.SEVR", DBR_LONG, NO_ALARM);
+
+    testdbPutFieldOk("cond.PROC", DBF_LONG, 1);
+    testdbGetArrFieldEqual("cond", DBF_DOUBLE, 10, NELEMENTS(cond), cond);
+
+    /* The constant input only has 3 elements */
+    testdbPutFieldOk("short.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("short.NORD", DBR_LONG, 3);
+    testdbGetArrFieldEqual("short", DBF_DOUBLE, 10, NELEMENTS(shrt), shrt);
+
+    /* Changing CALC recompiles */
+    testdbPutFieldOk("sum.CALC", DBF_STRING, "A-B");
+    testdbGetArrFieldEqual("sum", DBF_DOUBLE, 10, NELEMENTS(diff), diff);
+
+    /* Inputs no longer used don't limit the length */
+    testdbPutFieldOk("short.CALC", DBF_STRING, "A*2");
+    testdbGetFieldEqual("short.NORD", DBR_LONG, 5);
+    testdbGetArrFieldEqual("short", DBF_DOUBLE, 10, NELEMENTS(dbl), dbl);
+}
+
+static void testScalars(void)
+{
+    static const double one[] = {1};
+    static const double two[] = {2};
+    static const double a[] = {1, 2, 3, 4};
+    static const double squares[] = {1, 4, 9, 16};
+
+    testDiag("testScalars");
+
+    /* Without array inputs the result has one element */
+    testdbPutFieldOk("count.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("count.NORD", DBR_LONG, 1);
+    testdbGetArrFieldEqual("count", DBF_DOUBLE, 5, 1, one);
+    testdbPutFieldOk("count.PROC", DBF_LONG, 1);
+    testdbGetArrFieldEqual("count", DBF_DOUBLE, 5, 1, two);
+
+    /* Inputs can be written directly */
+    testdbPutArrFieldOk("direct.A", DBF_DOUBLE, NELEMENTS(a), a);
+    testdbGetFieldEqual("direct.NEA", DBR_LONG, 4);
+    testdbGetArrFieldEqual("direct", DBF_DOUBLE, 4, NELEMENTS(squares),
+        squares);
+}
+
+static void testAssignments(void)
+{
+    testDiag("testAssignments");
+
+    testdbPutFieldOk("store.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("store.STAT", DBR_LONG, CALC_ALARM);
+    testdbGetFieldEqual("store.SEVR", DBR_LONG, INVALID_ALARM);
+
+    eltc(0);
+    testdbPutFieldOk("direct.CALC", DBF_STRING, "A:=2;A");
+    eltc(1);
+    testdbPutFieldOk("direct.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("direct.SEVR", DBR_LONG, INVALID_ALARM);
+}
+
+MAIN(acalcTest)
+{
+    testPlan(29);
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("acalcTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testArrays();
+    testScalars();
+    testAssignments();
+
+    testIocShutdownOk();
+    testdbCleanup();
+    return testDone();
+}
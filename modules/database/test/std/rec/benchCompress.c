@@ -0,0 +1,94 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure the compress record algorithms on large input arrays, like
+ * those from a digitizer, using the compressTest.db fixtures.
+ */
+
+#include <stdlib.h>
+
+#include "epicsTime.h"
+#include "dbAccess.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+#include "compressRecord.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NELM 1000000
+#define NPASS 10
+
+static const char * const algs[] = {
+    "N to 1 Low Value",
+    "N to 1 High Value",
+    "N to 1 Average",
+    "N to 1 Median",
+    "Average",
+    "Circular Buffer",
+};
+
+static void measure(dbCommon *prec, const char *alg)
+{
+    epicsTimeStamp start, stop;
+    double dt;
+    int i;
+
+    testdbPutFieldOk("compwf.ALG", DBF_STRING, alg);
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NPASS; i++) {
+        dbScanLock(prec);
+        dbProcess(prec);
+        dbScanUnlock(prec);
+    }
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%-18s %8.2f ms per %d element array", alg,
+             dt * 1e3 / NPASS, NELM);
+}
+
+MAIN(benchCompress)
+{
+    double *values = malloc(NELM * sizeof(double));
+    unsigned seed = 1;
+    dbCommon *prec;
+    int i;
+
+    testPlan(2 + NELEMENTS(algs));
+
+    testdbPrepare();
+
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("compressTest.db", NULL,
+        "ALG=N to 1 Low Value,BALG=FIFO Buffer,NSAM=10000,NELM=1000000,N=100");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    for (i = 0; i < NELM; i++) {
+        seed = seed * 1103515245 + 12345;
+        values[i] = (seed >> 8) / 65536.0;
+    }
+    testdbPutArrFieldOk("wf", DBF_DOUBLE, NELM, values);
+    free(values);
+
+    prec = testdbRecordPtr("compwf");
+    for (i = 0; i < NELEMENTS(algs); i++)
+        measure(prec, algs[i]);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    return testDone();
+}
@@ -345,10 +345,72 @@ void testLIFOCirc(void)
     testdbCleanup();
 }
 
+static
+void pushArray(const char *alg, long n, const double *values)
+{
+    if (alg)
+        testdbPutFieldOk("compwf.ALG", DBF_STRING, alg);
+    testdbPutArrFieldOk("wf", DBF_DOUBLE, n, values);
+    testdbPutFieldOk("compwf.PROC", DBF_LONG, 1);
+}
+
+static
+void testArrayAlgs(void)
+{
+    static const double groups[] = {3, 1, 2,  9, 7, 8,  -1, -5, 0,  4, 4, 6};
+    static const double first[] = {1, 2, 3, 4, 5, 6};
+    static const double second[] = {7, 8, 9};
+
+    testDiag("Test N to 1 algorithms on arrays");
+
+    testdbPrepare();
+
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("compressTest.db", NULL,
+        "ALG=N to 1 Low Value,BALG=FIFO Buffer,NSAM=4,NELM=12,N=3");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    pushArray("N to 1 Low Value", NELEMENTS(groups), groups);
+    checkArrD("compwf", 4, 1, 7, -5, 4);
+
+    pushArray("N to 1 High Value", NELEMENTS(groups), groups);
+    checkArrD("compwf", 4, 3, 9, 0, 6);
+
+    pushArray("N to 1 Average", NELEMENTS(groups), groups);
+    checkArrD("compwf", 4, 2, 8, -2, 14.0/3);
+
+    pushArray("N to 1 Median", NELEMENTS(groups), groups);
+    checkArrD("compwf", 4, 2, 8, -1, 4);
+
+    testDiag("Circular buffer wrapping around");
+
+    pushArray("Circular Buffer", NELEMENTS(first), first);
+    checkArrD("compwf", 4, 3, 4, 5, 6);
+    pushArray(NULL, NELEMENTS(second), second);
+    checkArrD("compwf", 4, 6, 7, 8, 9);
+
+    testdbPutFieldOk("compwf.BALG", DBF_STRING, "LIFO Buffer");
+    pushArray(NULL, NELEMENTS(first), first);
+    checkArrD("compwf", 4, 6, 5, 4, 3);
+    pushArray(NULL, NELEMENTS(second), second);
+    checkArrD("compwf", 4, 9, 8, 7, 6);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
 MAIN(compressTest)
 {
-    testPlan(116);
+    testPlan(146);
     testFIFOCirc();
     testLIFOCirc();
+    testArrayAlgs();
     return testDone();
 }
@@ -14,6 +14,7 @@
 
 int analogMonitorTest(void);
 int compressTest(void);
+int acalcTest(void);
 int recMiscTest(void);
 int arrayOpTest(void);
 int asTest(void);
@@ -32,6 +33,8 @@ void epicsRunRecordTests(void)
 
     runTest(compressTest);
 
+    runTest(acalcTest);
+
     runTest(recMiscTest);
 
     runTest(arrayOpTest);
@@ -0,0 +1,282 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Talk to the IOC's CA server with EPICS_CAS_MUX_THREADS set, through
+ * two CA clients in this process which share the one CAS-mux thread.
+ * Neither a put notify which has to wait for an earlier one nor a
+ * client which doesn't read its monitor updates may hold up the other
+ * client.  The casr output must look as it does for ordinary clients.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cadef.h"
+#include "db_access_routines.h"
+#include "envDefs.h"
+#include "epicsEvent.h"
+#include "epicsStdio.h"
+#include "epicsTempFile.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "rsrv.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NELM 200000
+#define NUPDATES 10
+
+static struct ca_client_context *ctxA, *ctxB;
+static epicsEventId putDone, lastUpdate;
+static epicsTimeStamp putTime[2];
+static int nPutDone;
+static double wfFirst;
+
+static void useContext(struct ca_client_context *ctx)
+{
+    ca_detach_context();
+    if (ca_attach_context(ctx) != ECA_NORMAL)
+        testAbort("Failed to attach CA context");
+}
+
+static chid connectChan(const char *name)
+{
+    chid chan;
+
+    if (ca_create_channel(name, NULL, NULL, 0, &chan) != ECA_NORMAL ||
+        ca_pend_io(5.0) != ECA_NORMAL)
+        testAbort("Failed to connect to %s", name);
+    return chan;
+}
+
+static void putcb(struct event_handler_args args)
+{
+    if (nPutDone < 2)
+        epicsTimeGetCurrent(&putTime[nPutDone]);
+    if (++nPutDone == 2)
+        epicsEventMustTrigger(putDone);
+}
+
+static void monitorcb(struct event_handler_args args)
+{
+    const double *pValue = (const double *) args.dbr;
+
+    if (args.status != ECA_NORMAL)
+        return;
+    wfFirst = pValue[0];
+    if (wfFirst == NUPDATES)
+        epicsEventMustTrigger(lastUpdate);
+    /* a slow client, its socket fills up */
+    epicsThreadSleep(0.1);
+}
+
+/* time a get through client B */
+static double timeGet(chid chan, double *pValue)
+{
+    epicsTimeStamp start, stop;
+
+    epicsTimeGetCurrent(&start);
+    if (ca_get(DBR_DOUBLE, chan, pValue) != ECA_NORMAL ||
+        ca_pend_io(10.0) != ECA_NORMAL)
+        return 10.0;
+    epicsTimeGetCurrent(&stop);
+    return epicsTimeDiffInSeconds(&stop, &start);
+}
+
+static void testPutNotify(chid delayA, chid aoB)
+{
+    double value = 1.0, delay;
+
+    testDiag("Two put notifies to a record with ODLY=1");
+
+    useContext(ctxA);
+    ca_put_callback(DBR_DOUBLE, delayA, &value, putcb, NULL);
+    value = 2.0;
+    ca_put_callback(DBR_DOUBLE, delayA, &value, putcb, NULL);
+    ca_flush_io();
+    epicsThreadSleep(0.2);
+
+    useContext(ctxB);
+    delay = timeGet(aoB, &value);
+    testOk(delay < 0.5, "get of another client took %.3f s", delay);
+
+    testOk(epicsEventWaitWithTimeout(putDone, 10.0) == epicsEventWaitOK,
+           "both put notifies completed");
+    delay = epicsTimeDiffInSeconds(&putTime[1], &putTime[0]);
+    testOk(delay > 0.8, "the second one %.3f s after the first", delay);
+    timeGet(aoB, &value);
+    testOk(value == 2.0, "the second one was written last, got %g", value);
+}
+
+static void testSlowClient(chid wfA, chid wfB, chid aoB)
+{
+    double *pValue = calloc(NELM, sizeof(double));
+    double delay;
+    evid id;
+    int i, ok = 1;
+
+    testDiag("Client A is slow to read %d large monitor updates", NUPDATES);
+
+    if (!pValue)
+        testAbort("No memory");
+
+    useContext(ctxA);
+    if (ca_create_subscription(DBR_DOUBLE, NELM, wfA, DBE_VALUE,
+                               monitorcb, NULL, &id) != ECA_NORMAL)
+        testAbort("Failed to subscribe");
+    ca_flush_io();
+
+    useContext(ctxB);
+    for (i = 1; i <= NUPDATES; i++) {
+        pValue[0] = i;
+        ok &= ca_array_put(DBR_DOUBLE, NELM, wfB, pValue) == ECA_NORMAL;
+        ok &= ca_flush_io() == ECA_NORMAL;
+    }
+    testOk(ok, "client B wrote the waveform %d times", NUPDATES);
+
+    delay = timeGet(aoB, pValue);
+    testOk(delay < 0.5, "get of another client took %.3f s", delay);
+
+    testOk(epicsEventWaitWithTimeout(lastUpdate, 30.0) == epicsEventWaitOK,
+           "client A got the last update");
+
+    useContext(ctxA);
+    ca_clear_subscription(id);
+    ca_flush_io();
+    free(pValue);
+}
+
+static void testCasr(void)
+{
+    FILE *stream = epicsTempFile();
+    char line[256];
+    unsigned nLines = 0, nClients = 0, nUsers = 0, nIdle = 0, nUp = 0;
+    int haveVersion = 0, haveCount = 0;
+
+    testDiag("casr output");
+
+    if (!stream)
+        testAbort("Failed to create a temporary file");
+
+    /* let the replies to the clear subscription go out */
+    epicsThreadSleep(1.0);
+
+    epicsSetThreadStdout(stream);
+    casr(4);
+    epicsSetThreadStdout(NULL);
+
+    rewind(stream);
+    while (fgets(line, sizeof(line), stream)) {
+        unsigned major, minor, priority;
+        int nChan;
+
+        line[strcspn(line, "\n")] = '\0';
+        testDiag("%s", line);
+        if (nLines++ == 0)
+            haveVersion = strncmp(line, "Channel Access Server V4.", 25) == 0;
+        if (strcmp(line, "2 clients connected:") == 0)
+            haveCount = 1;
+        if (strncmp(line, "    TCP client at 127.0.0.1:", 28) == 0)
+            nClients++;
+        if (sscanf(line, "\tUser '%*[^']', V%u.%u, Priority = %u, %d Channel",
+                   &major, &minor, &priority, &nChan) == 4 &&
+            major == 4 && priority == 0 && (nChan == 2 || nChan == 3))
+            nUsers++;
+        if (strcmp(line, "\tUnprocessed request bytes = 0, "
+                   "Undelivered response bytes = 0") == 0)
+            nIdle++;
+        if (strncmp(line, "\tState = up", 11) == 0)
+            nUp++;
+    }
+    fclose(stream);
+
+    testOk(haveVersion, "server version");
+    testOk(haveCount, "2 clients connected");
+    testOk(nClients == 2, "%u TCP clients at 127.0.0.1", nClients);
+    testOk(nUsers == 2, "%u client user lines", nUsers);
+    testOk(nIdle == 2, "%u clients have nothing left to send", nIdle);
+    testOk(nUp == 2, "%u clients are up", nUp);
+}
+
+MAIN(rsrvMuxTest)
+{
+    chid delayA, wfA, aoA, wfB, aoB;
+    double value = 5.0;
+
+    testPlan(15);
+
+    /* only talk to ourselves, through one CAS-mux thread */
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_SERVER_PORT", "15066");
+    epicsEnvSet("EPICS_CA_REPEATER_PORT", "15067");
+    epicsEnvSet("EPICS_CA_MAX_ARRAY_BYTES", "2000000");
+    epicsEnvSet("EPICS_CAS_MUX_THREADS", "1");
+
+    testdbPrepare();
+
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("rsrvMuxTest.db", NULL, NULL);
+
+    /* before iocInit(), which makes later contexts use dbContext */
+    if (ca_context_create(ca_enable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Failed to create CA context");
+    ctxB = ca_current_context();
+    ca_detach_context();
+    if (ca_context_create(ca_enable_preemptive_callback) != ECA_NORMAL)
+        testAbort("Failed to create CA context");
+    ctxA = ca_current_context();
+
+    /* not testIocInitOk(), which doesn't start the CA server */
+    eltc(0);
+    if (iocInit())
+        testAbort("Failed to start up test database");
+    eltc(1);
+
+    putDone = epicsEventMustCreate(epicsEventEmpty);
+    lastUpdate = epicsEventMustCreate(epicsEventEmpty);
+
+    delayA = connectChan("mux:delay.A");
+    wfA = connectChan("mux:wf");
+    aoA = connectChan("mux:ao");
+    /* the get waits for the put, on the same circuit */
+    testOk(ca_put(DBR_DOUBLE, aoA, &value) == ECA_NORMAL &&
+           ca_get(DBR_DOUBLE, aoA, &value) == ECA_NORMAL &&
+           ca_pend_io(5.0) == ECA_NORMAL && value == 5.0,
+           "put and get through client A");
+
+    useContext(ctxB);
+    aoB = connectChan("mux:ao");
+    wfB = connectChan("mux:wf");
+    value = 0.0;
+    if (ca_get(DBR_DOUBLE, aoB, &value) != ECA_NORMAL ||
+        ca_pend_io(5.0) != ECA_NORMAL)
+        value = -1.0;
+    testOk(value == 5.0, "get through client B returned %g", value);
+
+    testPutNotify(delayA, aoB);
+    testSlowClient(wfA, wfB, aoB);
+    testCasr();
+
+    useContext(ctxB);
+    ca_context_destroy();
+    useContext(ctxA);
+    ca_context_destroy();
+    epicsEventDestroy(putDone);
+    epicsEventDestroy(lastUpdate);
+
+    /* The CA server can't be stopped, so the IOC isn't shut down */
+
+    return testDone();
+}
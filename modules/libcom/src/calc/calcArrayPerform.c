@@ -0,0 +1,310 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ * Element-wise evaluation of compiled calc expressions over arrays.
+ *
+ * The program is run once for each block of up to CALC_BLOCK elements,
+ * with a stack of blocks instead of a stack of doubles, so each operator
+ * is one simple loop over the block that the compiler can vectorize.
+ * A conditional whose test is true for some elements of a block and
+ * false for others can't be done that way, so that block is evaluated
+ * one element at a time with calcPerformCompiled().
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#define epicsExportSharedSymbols
+#include "dbDefs.h"
+#include "epicsMath.h"
+#include "epicsTypes.h"
+#include "postfix.h"
+#include "postfixPvt.h"
+
+#define CALC_BLOCK 64       /* elements evaluated together */
+#define LOCAL_DEPTH 4       /* stack blocks that don't need malloc() */
+
+/* Element i of an argument, arrays shorter than the result repeat their
+ * last element, empty ones read as zero.
+ */
+static double argElement(const double *parg, epicsUInt32 count, epicsUInt32 i)
+{
+    if (i < count)
+        return parg[i];
+    return count ? parg[count - 1] : 0.0;
+}
+
+static void fetchArg(double *pdest, const double *parg, epicsUInt32 count,
+    epicsUInt32 base, int m)
+{
+    int i = 0;
+
+    if (base < count) {
+        i = count - base < (epicsUInt32) m ? count - base : m;
+        memcpy(pdest, parg + base, i * sizeof(double));
+    }
+    if (i < m) {
+        double last = count ? parg[count - 1] : 0.0;
+
+        for (; i < m; i++)
+            pdest[i] = last;
+    }
+}
+
+/* The operators, with x the left and y the right operand; the casts
+ * follow calcPerform() exactly.
+ */
+#define UNARY(opcode, expr) \
+    case opcode: \
+        for (i = 0; i < m; i++) { \
+            double x = ptop[i]; \
+            ptop[i] = expr; \
+        } \
+        break;
+
+#define BINARY(opcode, expr) \
+    case opcode: \
+        ptop -= CALC_BLOCK; \
+        for (i = 0; i < m; i++) { \
+            double x = ptop[i], y = ptop[i + CALC_BLOCK]; \
+            ptop[i] = expr; \
+        } \
+        break;
+
+/* Evaluate elements base to base+m-1. Returns 0 when done, -1 on error,
+ * or 1 if a conditional goes different ways for different elements.
+ */
+static int performBlock(double * const *pargs, const epicsUInt32 *pcounts,
+    double *presult, epicsUInt32 base, int m, const calcProgram *pprog,
+    double *stack)
+{
+    const calcInst *pc = pprog->inst;
+    double *ptop = stack;   /* the first block is not used */
+    int i, nargs;
+
+    for (;;) {
+        int op = pc->op;
+
+        /* A fused right operand goes on the stack first */
+        if (op & RIGHT_ARG) {
+            ptop += CALC_BLOCK;
+            fetchArg(ptop, pargs[pc->arg], pcounts[pc->arg], base, m);
+        }
+        else if (op & RIGHT_LIT) {
+            ptop += CALC_BLOCK;
+            for (i = 0; i < m; i++)
+                ptop[i] = pc->val;
+        }
+
+        switch (op & 0xff) {
+        case END_EXPRESSION:
+            if (ptop != stack + CALC_BLOCK)
+                return -1;
+            memcpy(presult + base, ptop, m * sizeof(double));
+            return 0;
+
+        case LITERAL_DOUBLE:
+            ptop += CALC_BLOCK;
+            for (i = 0; i < m; i++)
+                ptop[i] = pc->val;
+            break;
+
+        case FETCH_VAL:
+            ptop += CALC_BLOCK;
+            memcpy(ptop, presult + base, m * sizeof(double));
+            break;
+
+        case FETCH_A:
+            ptop += CALC_BLOCK;
+            fetchArg(ptop, pargs[pc->arg], pcounts[pc->arg], base, m);
+            break;
+
+        case RANDOM:
+            ptop += CALC_BLOCK;
+            for (i = 0; i < m; i++)
+                ptop[i] = calcPvtRandom();
+            break;
+
+        UNARY(UNARY_NEG, -x)
+        BINARY(ADD, x + y)
+        BINARY(SUB, x - y)
+        BINARY(MULT, x * y)
+        BINARY(DIV, x / y)
+        BINARY(MODULO, (epicsInt32) y ?
+            (epicsInt32) x % (epicsInt32) y : epicsNAN)
+        BINARY(POWER, pow(x, y))
+
+        UNARY(ABS_VAL, fabs(x))
+        UNARY(EXP, exp(x))
+        UNARY(LOG_10, log10(x))
+        UNARY(LOG_E, log(x))
+        UNARY(SQU_RT, sqrt(x))
+
+        case MAX:
+            nargs = pc->arg;
+            while (--nargs) {
+                ptop -= CALC_BLOCK;
+                for (i = 0; i < m; i++) {
+                    double top = ptop[i + CALC_BLOCK];
+
+                    if (ptop[i] < top || isnan(top))
+                        ptop[i] = top;
+                }
+            }
+            break;
+
+        case MIN:
+            nargs = pc->arg;
+            while (--nargs) {
+                ptop -= CALC_BLOCK;
+                for (i = 0; i < m; i++) {
+                    double top = ptop[i + CALC_BLOCK];
+
+                    if (ptop[i] > top || isnan(top))
+                        ptop[i] = top;
+                }
+            }
+            break;
+
+        UNARY(ACOS, acos(x))
+        UNARY(ASIN, asin(x))
+        UNARY(ATAN, atan(x))
+        BINARY(ATAN2, atan2(y, x))
+        UNARY(COS, cos(x))
+        UNARY(SIN, sin(x))
+        UNARY(TAN, tan(x))
+        UNARY(COSH, cosh(x))
+        UNARY(SINH, sinh(x))
+        UNARY(TANH, tanh(x))
+        UNARY(CEIL, ceil(x))
+        UNARY(FLOOR, floor(x))
+
+        case FINITE:
+            nargs = pc->arg;
+            for (i = 0; i < m; i++)
+                ptop[i] = finite(ptop[i]);
+            while (--nargs) {
+                ptop -= CALC_BLOCK;
+                for (i = 0; i < m; i++)
+                    ptop[i] = ptop[i + CALC_BLOCK] && finite(ptop[i]);
+            }
+            break;
+
+        UNARY(ISINF, isinf(x))
+
+        case ISNAN:
+            nargs = pc->arg;
+            for (i = 0; i < m; i++)
+                ptop[i] = isnan(ptop[i]);
+            while (--nargs) {
+                ptop -= CALC_BLOCK;
+                for (i = 0; i < m; i++)
+                    ptop[i] = ptop[i + CALC_BLOCK] || isnan(ptop[i]);
+            }
+            break;
+
+        UNARY(NINT, (epicsInt32) (x >= 0 ? x + 0.5 : x - 0.5))
+
+        BINARY(REL_OR, x || y)
+        BINARY(REL_AND, x && y)
+        UNARY(REL_NOT, !x)
+
+        BINARY(BIT_OR, (epicsInt32) ((epicsUInt32) x | (epicsUInt32) y))
+        BINARY(BIT_AND, (epicsInt32) ((epicsUInt32) x & (epicsUInt32) y))
+        BINARY(BIT_EXCL_OR, (epicsInt32) ((epicsUInt32) x ^ (epicsUInt32) y))
+        UNARY(BIT_NOT, (epicsInt32) ~(epicsUInt32) x)
+        BINARY(RIGHT_SHIFT,
+            ((epicsInt32) (epicsUInt32) x) >> ((epicsUInt32) y & 31))
+        BINARY(LEFT_SHIFT,
+            ((epicsInt32) (epicsUInt32) x) << ((epicsUInt32) y & 31))
+
+        BINARY(NOT_EQ, x != y)
+        BINARY(LESS_THAN, x < y)
+        BINARY(LESS_OR_EQ, x <= y)
+        BINARY(EQUAL, x == y)
+        BINARY(GR_OR_EQ, x >= y)
+        BINARY(GR_THAN, x > y)
+
+        case COND_IF:       /* below */
+            break;
+
+        case COND_ELSE:
+            pc = pc->jump;
+            continue;
+
+        default:            /* COND_FAIL, or STORE which we refused */
+            return -1;
+        }
+
+        if (op == COND_IF || (op & BRANCH)) {
+            int ntrue = 0;
+
+            for (i = 0; i < m; i++)
+                ntrue += ptop[i] != 0.0;
+            ptop -= CALC_BLOCK;
+            if (ntrue == 0) {
+                pc = pc->jump;
+                continue;
+            }
+            if (ntrue < m)
+                return 1;
+        }
+        pc++;
+    }
+}
+
+static long performElements(double * const *pargs, const epicsUInt32 *pcounts,
+    double *presult, epicsUInt32 base, int m, const calcProgram *pprog)
+{
+    double args[CALCPERFORM_NARGS];
+    int i, k;
+
+    for (i = 0; i < m; i++) {
+        for (k = 0; k < CALCPERFORM_NARGS; k++)
+            args[k] = argElement(pargs[k], pcounts[k], base + i);
+        if (calcPerformCompiled(args, &presult[base + i], pprog))
+            return -1;
+    }
+    return 0;
+}
+
+/* calcPerformArray
+ *
+ * Evaluate a compiled expression for each of the nresult elements of
+ * presult. Argument k has pcounts[k] elements at pargs[k]; an argument
+ * with fewer elements than the result repeats its last one, so a single
+ * element acts as a scalar. VAL reads the current element of presult.
+ * Expressions that assign to an argument are not supported.
+ */
+epicsShareFunc long
+    calcPerformArray(double * const *pargs, const epicsUInt32 *pcounts,
+        double *presult, epicsUInt32 nresult, const calcProgram *pprog)
+{
+    double local[(LOCAL_DEPTH + 1) * CALC_BLOCK];
+    double *stack = local;
+    epicsUInt32 base;
+    long status = 0;
+
+    if (!pprog || pprog->stores)
+        return -1;
+
+    if (pprog->depth > LOCAL_DEPTH) {
+        stack = malloc((pprog->depth + 1) * CALC_BLOCK * sizeof(double));
+        if (!stack)
+            return -1;
+    }
+
+    for (base = 0; base < nresult && !status; base += CALC_BLOCK) {
+        int m = nresult - base < CALC_BLOCK ? nresult - base : CALC_BLOCK;
+
+        status = performBlock(pargs, pcounts, presult, base, m, pprog, stack);
+        if (status > 0)
+            status = performElements(pargs, pcounts, presult, base, m, pprog);
+    }
+
+    if (stack != local)
+        free(stack);
+    return status;
+}
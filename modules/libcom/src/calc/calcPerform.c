@@ -25,7 +25,6 @@
 #include "postfix.h"
 #include "postfixPvt.h"
 
-static double calcRandom(void);
 static int cond_search(const char **ppinst, int match);
 
 #ifndef PI
@@ -270,7 +269,7 @@ epicsShareFunc long
 	    break;
 
 	case RANDOM:
-	    *++ptop = calcRandom();
+	    *++ptop = calcPvtRandom();
 	    break;
 
 	case REL_OR:
@@ -382,10 +381,535 @@ epicsShareFunc long
     *presult = *ptop;
     return 0;
 }
+
+/* Apply a binary operator to *ptop and its right operand top (or utop),
+ * which comes off the stack or from the instruction.
+ */
+#define BINARY(opcode, top, expr) \
+	case opcode: \
+	    top = *ptop--; \
+	    expr; \
+	    break; \
+	case opcode | RIGHT_ARG: \
+	    top = parg[pc->arg]; \
+	    expr; \
+	    break; \
+	case opcode | RIGHT_LIT: \
+	    top = pc->val; \
+	    expr; \
+	    break;
+
+/* Relational operators can also be fused with a following COND_IF */
+#define RELATIONAL(opcode, rel) \
+	BINARY(opcode, top, *ptop = *ptop rel top) \
+	case opcode | BRANCH: \
+	    top = *ptop--; \
+	    if (!(*ptop-- rel top)) { pc = pc->jump; continue; } \
+	    break; \
+	case opcode | RIGHT_ARG | BRANCH: \
+	    top = parg[pc->arg]; \
+	    if (!(*ptop-- rel top)) { pc = pc->jump; continue; } \
+	    break; \
+	case opcode | RIGHT_LIT | BRANCH: \
+	    top = pc->val; \
+	    if (!(*ptop-- rel top)) { pc = pc->jump; continue; } \
+	    break;
+
+/* calcPerformCompiled
+ *
+ * Evaluate a program from calcCompile(), with the same results as
+ * calcPerform() gives for the RPN it was compiled from.
+ */
+epicsShareFunc long
+    calcPerformCompiled(double *parg, double *presult, const calcProgram *pprog)
+{
+    double stack[CALCPERFORM_STACK+1];	/* zero'th entry not used */
+    double *ptop;			/* stack pointer */
+    double top; 			/* value from top of stack */
+    epicsInt32 itop;			/* integer from top of stack */
+    epicsUInt32 utop;			/* unsigned integer from top of stack */
+    const calcInst *pc;
+    int nargs;
+
+    if (!pprog)
+	return -1;
+
+    /* initialize */
+    ptop = stack;
+    pc = pprog->inst;
+
+    /* Evaluation loop, conditionals continue at their destination */
+    for (;;) {
+	switch (pc->op){
+
+	case END_EXPRESSION:
+	    /* The stack should now have one item on it, the expression value */
+	    if (ptop != stack + 1)
+		return -1;
+	    *presult = *ptop;
+	    return 0;
+
+	case LITERAL_DOUBLE:
+	    *++ptop = pc->val;
+	    break;
+
+	case FETCH_VAL:
+	    *++ptop = *presult;
+	    break;
+
+	case FETCH_A:
+	    *++ptop = parg[pc->arg];
+	    break;
+
+	case STORE_A:
+	    parg[pc->arg] = *ptop--;
+	    break;
+
+	case UNARY_NEG:
+	    *ptop = - *ptop;
+	    break;
+
+	BINARY(ADD, top, *ptop += top)
+	BINARY(SUB, top, *ptop -= top)
+	BINARY(MULT, top, *ptop *= top)
+	BINARY(DIV, top, *ptop /= top)
+
+	case MODULO:
+	    itop = (epicsInt32) *ptop--;
+	    if (itop)
+		*ptop = (epicsInt32) *ptop % itop;
+	    else
+		*ptop = epicsNAN;
+	    break;
+
+	case POWER:
+	    top = *ptop--;
+	    *ptop = pow(*ptop, top);
+	    break;
+
+	case ABS_VAL:
+	    *ptop = fabs(*ptop);
+	    break;
+
+	case EXP:
+	    *ptop = exp(*ptop);
+	    break;
+
+	case LOG_10:
+	    *ptop = log10(*ptop);
+	    break;
+
+	case LOG_E:
+	    *ptop = log(*ptop);
+	    break;
+
+	case MAX:
+	    nargs = pc->arg;
+	    while (--nargs) {
+		top = *ptop--;
+		if (*ptop < top || isnan(top))
+		    *ptop = top;
+	    }
+	    break;
+
+	case MIN:
+	    nargs = pc->arg;
+	    while (--nargs) {
+		top = *ptop--;
+		if (*ptop > top || isnan(top))
+		    *ptop = top;
+	    }
+	    break;
+
+	case SQU_RT:
+	    *ptop = sqrt(*ptop);
+	    break;
+
+	case ACOS:
+	    *ptop = acos(*ptop);
+	    break;
+
+	case ASIN:
+	    *ptop = asin(*ptop);
+	    break;
+
+	case ATAN:
+	    *ptop = atan(*ptop);
+	    break;
+
+	case ATAN2:
+	    top = *ptop--;
+	    *ptop = atan2(top, *ptop);	/* Ouch!: Args backwards! */
+	    break;
+
+	case COS:
+	    *ptop = cos(*ptop);
+	    break;
+
+	case SIN:
+	    *ptop = sin(*ptop);
+	    break;
+
+	case TAN:
+	    *ptop = tan(*ptop);
+	    break;
+
+	case COSH:
+	    *ptop = cosh(*ptop);
+	    break;
+
+	case SINH:
+	    *ptop = sinh(*ptop);
+	    break;
+
+	case TANH:
+	    *ptop = tanh(*ptop);
+	    break;
+
+	case CEIL:
+	    *ptop = ceil(*ptop);
+	    break;
+
+	case FLOOR:
+	    *ptop = floor(*ptop);
+	    break;
+
+	case FINITE:
+	    nargs = pc->arg;
+	    top = finite(*ptop);
+	    while (--nargs) {
+		--ptop;
+		top = top && finite(*ptop);
+	    }
+	    *ptop = top;
+	    break;
+
+	case ISINF:
+	    *ptop = isinf(*ptop);
+	    break;
+
+	case ISNAN:
+	    nargs = pc->arg;
+	    top = isnan(*ptop);
+	    while (--nargs) {
+		--ptop;
+		top = top || isnan(*ptop);
+	    }
+	    *ptop = top;
+	    break;
+
+	case NINT:
+	    top = *ptop;
+	    *ptop = (epicsInt32) (top >= 0 ? top + 0.5 : top - 0.5);
+	    break;
+
+	case RANDOM:
+	    *++ptop = calcPvtRandom();
+	    break;
+
+	case REL_OR:
+	    top = *ptop--;
+	    *ptop = *ptop || top;
+	    break;
+
+	case REL_AND:
+	    top = *ptop--;
+	    *ptop = *ptop && top;
+	    break;
+
+	case REL_NOT:
+	    *ptop = ! *ptop;
+	    break;
+
+	/* See calcPerform() for the casts in the bitwise operators */
+
+	BINARY(BIT_OR, utop, *ptop = (epicsInt32) ((epicsUInt32) *ptop | utop))
+	BINARY(BIT_AND, utop, *ptop = (epicsInt32) ((epicsUInt32) *ptop & utop))
+	BINARY(BIT_EXCL_OR, utop,
+	    *ptop = (epicsInt32) ((epicsUInt32) *ptop ^ utop))
+
+	case BIT_NOT:
+	    utop = *ptop;
+	    *ptop = (epicsInt32) ~utop;
+	    break;
+
+	BINARY(RIGHT_SHIFT, utop,
+	    *ptop = ((epicsInt32) (epicsUInt32) *ptop) >> (utop & 31))
+	BINARY(LEFT_SHIFT, utop,
+	    *ptop = ((epicsInt32) (epicsUInt32) *ptop) << (utop & 31))
+
+	RELATIONAL(NOT_EQ, !=)
+	RELATIONAL(LESS_THAN, <)
+	RELATIONAL(LESS_OR_EQ, <=)
+	RELATIONAL(EQUAL, ==)
+	RELATIONAL(GR_OR_EQ, >=)
+	RELATIONAL(GR_THAN, >)
+
+	case COND_IF:
+	    if (*ptop-- == 0.0) {
+		pc = pc->jump;
+		continue;
+	    }
+	    break;
+
+	case COND_ELSE:
+	    pc = pc->jump;
+	    continue;
+
+	case COND_FAIL:
+	    return -1;
+
+	default:
+	    errlogPrintf("calcPerformCompiled: Bad Opcode %d at %p\n",
+		pc->op, pc);
+	    return -1;
+	}
+	pc++;
+    }
+}
 #if defined(_WIN32) && defined(_M_X64) && !defined(_MINGW)
 #  pragma optimize("", on)
 #endif
 
+
+/* Binary operators that calcCompile() will fuse with a preceding operand */
+static int fusable(int op)
+{
+    switch (op) {
+    case ADD: case SUB: case MULT: case DIV:
+    case BIT_OR: case BIT_AND: case BIT_EXCL_OR:
+    case RIGHT_SHIFT: case LEFT_SHIFT:
+    case NOT_EQ: case LESS_THAN: case LESS_OR_EQ:
+    case EQUAL: case GR_OR_EQ: case GR_THAN:
+	return 1;
+    }
+    return 0;
+}
+
+static int relational(int op)
+{
+    return op >= NOT_EQ && op <= GR_THAN;
+}
+
+/* Change in stack depth from a decoded instruction. Both sides of a
+ * conditional leave one value, so COND_ELSE drops the first one.
+ */
+static int stack_effect(const calcInst *pi)
+{
+    switch (pi->op) {
+    case LITERAL_DOUBLE: case FETCH_VAL: case FETCH_A: case RANDOM:
+	return 1;
+    case MIN: case MAX: case FINITE: case ISNAN:
+	return 1 - pi->arg;
+    case STORE_A: case MODULO: case POWER: case ATAN2:
+    case REL_OR: case REL_AND: case COND_IF: case COND_ELSE:
+	return -1;
+    }
+    return fusable(pi->op) ? -1 : 0;
+}
+
+/* Find the instruction after the op matching the conditional at inst[i],
+ * the same way cond_search() does, or return n if there isn't one.
+ */
+static int cond_dest(const calcInst *inst, int n, int i, int match)
+{
+    int count = 1;
+
+    while (++i < n) {
+	if (inst[i].op == match && --count == 0)
+	    return i + 1;
+	if (inst[i].op == COND_IF)
+	    count++;
+    }
+    return n;
+}
+
+/* calcCompile
+ *
+ * Translate the output of postfix() into a program for
+ * calcPerformCompiled(), to be released with calcProgramFree().
+ * Returns NULL if out of memory or the RPN contains a bad opcode.
+ */
+epicsShareFunc calcProgram *
+    calcCompile(const char *pinst)
+{
+    const char *pnext = pinst;
+    calcProgram *pprog;
+    calcInst *inst;
+    int *dest, *map;
+    char *target;
+    int i, j, n = 0, depth = 0;
+    char op;
+
+    /* Count the instructions, END_EXPRESSION included */
+    do {
+	op = *pnext++;
+	n++;
+	switch (op) {
+	case LITERAL_DOUBLE:
+	    pnext += sizeof(double);
+	    break;
+	case LITERAL_INT:
+	    pnext += sizeof(epicsInt32);
+	    break;
+	case MIN:
+	case MAX:
+	case FINITE:
+	case ISNAN:
+	    pnext++;
+	    break;
+	}
+    } while (op != END_EXPRESSION);
+
+    /* One more for a COND_FAIL at the end */
+    pprog = malloc(sizeof(calcProgram) + n * sizeof(calcInst));
+    dest = malloc(n * sizeof(int));
+    map = malloc((n + 1) * sizeof(int));
+    target = calloc(n + 1, 1);
+    if (!pprog || !dest || !map || !target) {
+	free(pprog);
+	free(dest);
+	free(map);
+	free(target);
+	return NULL;
+    }
+    inst = pprog->inst;
+    pprog->depth = 0;
+    pprog->stores = 0;
+
+    /* Decode */
+    for (i = 0; i < n; i++) {
+	epicsInt32 itop;
+	calcInst *pi = &inst[i];
+
+	op = *pinst++;
+	pi->op = op;
+	pi->arg = 0;
+	pi->jump = NULL;
+	pi->val = 0.0;
+	dest[i] = n;
+	switch (op) {
+	case LITERAL_DOUBLE:
+	    memcpy(&pi->val, pinst, sizeof(double));
+	    pinst += sizeof(double);
+	    break;
+	case LITERAL_INT:
+	    memcpy(&itop, pinst, sizeof(epicsInt32));
+	    pinst += sizeof(epicsInt32);
+	    pi->op = LITERAL_DOUBLE;
+	    pi->val = itop;
+	    break;
+	case CONST_PI:
+	    pi->op = LITERAL_DOUBLE;
+	    pi->val = PI;
+	    break;
+	case CONST_D2R:
+	    pi->op = LITERAL_DOUBLE;
+	    pi->val = PI/180.;
+	    break;
+	case CONST_R2D:
+	    pi->op = LITERAL_DOUBLE;
+	    pi->val = 180./PI;
+	    break;
+	case MIN:
+	case MAX:
+	case FINITE:
+	case ISNAN:
+	    pi->arg = *pinst++;
+	    break;
+	default:
+	    if (op >= FETCH_A && op <= FETCH_L) {
+		pi->op = FETCH_A;
+		pi->arg = op - FETCH_A;
+	    }
+	    else if (op >= STORE_A && op <= STORE_L) {
+		pi->op = STORE_A;
+		pi->arg = op - STORE_A;
+		pprog->stores = 1;
+	    }
+	    else if (op < END_EXPRESSION || op >= NOT_GENERATED) {
+		errlogPrintf("calcCompile: Bad Opcode %d at %p\n", op, pinst-1);
+		free(pprog);
+		free(dest);
+		free(map);
+		free(target);
+		return NULL;
+	    }
+	}
+	depth += stack_effect(pi);
+	if (depth > pprog->depth)
+	    pprog->depth = depth;
+    }
+
+    /* Resolve conditionals, and mark the instructions they jump to.
+     * A jump to a COND_END really goes to the instruction after it.
+     */
+    for (i = 0; i < n; i++) {
+	if (inst[i].op == COND_IF)
+	    dest[i] = cond_dest(inst, n, i, COND_ELSE);
+	else if (inst[i].op == COND_ELSE)
+	    dest[i] = cond_dest(inst, n, i, COND_END);
+	else
+	    continue;
+	target[dest[i]] = 1;
+    }
+    for (i = 0; i < n; i++) {
+	if (inst[i].op == COND_END && target[i])
+	    target[i + 1] = 1;
+    }
+
+    /* Compact and fuse in place, map[] gives the new index of each old
+     * instruction and dest[] moves along with the instructions.
+     */
+    for (i = j = 0; i < n; i++) {
+	calcInst ci = inst[i];
+	int di = dest[i];
+
+	map[i] = j;
+	if (ci.op == COND_END)
+	    continue;
+
+	if ((ci.op == FETCH_A || ci.op == LITERAL_DOUBLE) &&
+	    !target[i + 1] && fusable(inst[i + 1].op)) {
+	    int flag = ci.op == FETCH_A ? RIGHT_ARG : RIGHT_LIT;
+
+	    ci.op = inst[++i].op | flag;
+	    map[i] = j;
+	}
+	if (relational(ci.op & 0xff) &&
+	    !target[i + 1] && inst[i + 1].op == COND_IF) {
+	    ci.op |= BRANCH;
+	    di = dest[++i];
+	    map[i] = j;
+	}
+	dest[j] = di;
+	inst[j++] = ci;
+    }
+    map[n] = j;
+    inst[j].op = COND_FAIL;
+    inst[j].arg = 0;
+    inst[j].jump = NULL;
+    inst[j].val = 0.0;
+    pprog->ninst = j + 1;
+
+    for (i = 0; i < j; i++) {
+	if (inst[i].op == COND_IF || inst[i].op == COND_ELSE ||
+	    (inst[i].op & BRANCH))
+	    inst[i].jump = &inst[map[dest[i]]];
+    }
+
+    free(dest);
+    free(map);
+    free(target);
+    return pprog;
+}
+
+epicsShareFunc void
+    calcProgramFree(calcProgram *pprog)
+{
+    free(pprog);
+}
+
 
 epicsShareFunc long
 calcArgUsage(const char *pinst, unsigned long *pinputs, unsigned long *pstores)
@@ -459,7 +983,7 @@ static unsigned short seed = 0xa3bf;
 static unsigned short multy = 191 * 8 + 5;  /* 191 % 8 == 5 */
 static unsigned short addy = 0x3141;
 
-static double calcRandom(void)
+double calcPvtRandom(void)
 {
     seed = (seed * multy) + addy;
 
@@ -14,6 +14,7 @@
 #ifndef INCpostfixh
 #define INCpostfixh
 
+#include "epicsTypes.h"
 #include "shareLib.h"
 
 #define CALCPERFORM_NARGS 12
@@ -63,6 +64,12 @@
 /* Changes in the above errors must also be made in calcErrorStr() */
 
 
+/* A postfix expression compiled by calcCompile() for faster evaluation
+ * by calcPerformCompiled(), which gives the same results as calcPerform().
+ * calcPerformArray() evaluates one element-wise over arrays.
+ */
+typedef struct calcProgram calcProgram;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -73,6 +80,20 @@ epicsShareFunc long
 epicsShareFunc long
     calcPerform(double *parg, double *presult, const char *ppostfix);
 
+epicsShareFunc calcProgram *
+    calcCompile(const char *ppostfix);
+
+epicsShareFunc long
+    calcPerformCompiled(double *parg, double *presult,
+        const calcProgram *pprogram);
+
+epicsShareFunc long
+    calcPerformArray(double * const *pargs, const epicsUInt32 *pcounts,
+        double *presult, epicsUInt32 nresult, const calcProgram *pprogram);
+
+epicsShareFunc void
+    calcProgramFree(calcProgram *pprogram);
+
 epicsShareFunc long
     calcArgUsage(const char *ppostfix, unsigned long *pinputs, unsigned long *pstores);
 
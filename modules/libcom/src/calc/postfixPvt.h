@@ -101,4 +101,41 @@ typedef enum {
 	NOT_GENERATED
 } rpn_opcode;
 
+
+/* Compiled programs
+ *
+ * calcCompile() decodes the RPN byte stream once into an array of
+ * fixed size instructions: literals and constants are converted to
+ * doubles, the FETCH and STORE opcodes carry the argument index, and
+ * conditionals carry a pointer to the instruction they jump to, so
+ * COND_END disappears. An operand pushed just before a binary operator
+ * is folded into the operator (RIGHT_ARG, RIGHT_LIT), and a relational
+ * operator followed by COND_IF becomes a compare-and-branch (BRANCH).
+ */
+typedef struct calcInst {
+    int op;             /* rpn_opcode, possibly with the flags below */
+    int arg;            /* argument index, or number of var-args */
+    const struct calcInst *jump;    /* destination of conditionals */
+    double val;         /* literal value */
+} calcInst;
+
+struct calcProgram {
+    int ninst;
+    int depth;          /* deepest stack needed */
+    int stores;         /* contains STORE instructions */
+    calcInst inst[1];   /* actually ninst */
+};
+
+#define RIGHT_ARG 0x100 /* right operand is parg[arg] */
+#define RIGHT_LIT 0x200 /* right operand is val */
+#define BRANCH    0x400 /* COND_IF on the result follows */
+
+/* Opcode only found in compiled programs: COND_IF or COND_ELSE that had
+ * no match, calcPerform() fails when it reaches one of those.
+ */
+#define COND_FAIL NOT_GENERATED
+
+/* Shared by the evaluators, so rndm gives one sequence */
+double calcPvtRandom(void);
+
 #endif /* INCpostfixPvth */
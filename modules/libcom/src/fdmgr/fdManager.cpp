@@ -20,6 +20,17 @@
 //
 
 #include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined ( __linux__ ) && ! defined ( FDMGR_USE_SELECT )
+#   define FDMGR_EPOLL
+#   include <errno.h>
+#   include <unistd.h>
+#   include <sys/epoll.h>
+#endif
 
 #define instantiateRecourceLib
 #define epicsExportSharedSymbols
@@ -35,6 +46,27 @@ epicsShareDef fdManager fileDescriptorManager;
 const unsigned mSecPerSec = 1000u;
 const unsigned uSecPerSec = 1000u * mSecPerSec;
 
+#ifdef FDMGR_EPOLL
+// ready file descriptors fetched per epoll_wait() call, any others
+// are reported by the next call
+const int epollEventsMax = 256;
+
+// events reported as activity for each fdRegType, as select() would,
+// except that an error or hangup also activates fdrException since the
+// kernel reports those whatever was asked for, and epoll_wait() would
+// otherwise return at once on every pass for an exception-only fd
+static const uint32_t readyEvents[fdrNEnums] = {
+    EPOLLIN | EPOLLERR | EPOLLHUP,      // fdrRead
+    EPOLLOUT | EPOLLERR | EPOLLHUP,     // fdrWrite
+    EPOLLPRI | EPOLLERR | EPOLLHUP      // fdrException
+};
+
+// events requested for each fdRegType
+static const uint32_t interestEvents[fdrNEnums] = {
+    EPOLLIN, EPOLLOUT, EPOLLPRI
+};
+#endif
+
 //
 // fdManager::fdManager()
 //
@@ -45,7 +77,7 @@ epicsShareFunc fdManager::fdManager () :
     sleepQuantum ( epicsThreadSleepQuantum () ), 
         fdSetsPtr ( new fd_set [fdrNEnums] ),
         pTimerQueue ( 0 ), maxFD ( 0 ), processInProg ( false ), 
-        pCBReg ( 0 )
+        pCBReg ( 0 ), epollFD ( -1 ), pEpollEvents ( 0 )
 {
     int status = osiSockAttach ();
     assert (status);
@@ -53,6 +85,16 @@ epicsShareFunc fdManager::fdManager () :
     for ( size_t i = 0u; i < fdrNEnums; i++ ) {
         FD_ZERO ( &fdSetsPtr[i] ); 
     }
+
+#ifdef FDMGR_EPOLL
+    const char * pUseSelect = getenv ( "EPICS_FDMGR_USE_SELECT" );
+    if ( ! pUseSelect || ! *pUseSelect ) {
+        this->epollFD = epoll_create1 ( EPOLL_CLOEXEC );
+        if ( this->epollFD >= 0 ) {
+            this->pEpollEvents = new epoll_event [epollEventsMax];
+        }
+    }
+#endif
 }
 
 //
@@ -72,6 +114,7 @@ epicsShareFunc fdManager::~fdManager()
     }
     delete this->pTimerQueue;
     delete [] this->fdSetsPtr;
+    this->abandonEpoll ();
     osiSockRelease();
 }
 
@@ -103,45 +146,13 @@ epicsShareFunc void fdManager::process (double delay)
         minDelay = delay;
     }
 
-    bool ioPending = false;
-    tsDLIter < fdReg > iter = this->regList.firstIter ();
-    while ( iter.valid () ) {
-        FD_SET(iter->getFD(), &this->fdSetsPtr[iter->getType()]); 
-        ioPending = true;
-        ++iter;
-    }
-
-    if ( ioPending ) {
-        struct timeval tv;
-        tv.tv_sec = static_cast<time_t> ( minDelay );
-        tv.tv_usec = static_cast<long> ( (minDelay-tv.tv_sec) * uSecPerSec );
-
-        fd_set * pReadSet = & this->fdSetsPtr[fdrRead];
-        fd_set * pWriteSet = & this->fdSetsPtr[fdrWrite];
-        fd_set * pExceptSet = & this->fdSetsPtr[fdrException];
-        int status = select (this->maxFD, pReadSet, pWriteSet, pExceptSet, &tv);
+    if ( this->regList.count () ) {
+        int status = this->epollFD >= 0 ?
+            this->waitEpoll ( minDelay ) : this->waitSelect ( minDelay );
 
         this->pTimerQueue->process(epicsTime::getCurrent());
 
         if ( status > 0 ) {
-
-            //
-            // Look for activity
-            //
-            iter=this->regList.firstIter ();
-            while ( iter.valid () && status > 0 ) {
-                tsDLIter < fdReg > tmp = iter;
-                tmp++;
-                if (FD_ISSET(iter->getFD(), &this->fdSetsPtr[iter->getType()])) {
-                    FD_CLR(iter->getFD(), &this->fdSetsPtr[iter->getType()]);
-                    this->regList.remove(*iter);
-                    this->activeList.add(*iter);
-                    iter->state = fdReg::active;
-                    status--;
-                }
-                iter = tmp;
-            }
-
             //
             // I am careful to prevent problems if they access the
             // above list while in a "callBack()" routine
@@ -175,27 +186,6 @@ epicsShareFunc void fdManager::process (double delay)
                 }
             }
         }
-        else if ( status < 0 ) {
-            int errnoCpy = SOCKERRNO;
-            
-            // dont depend on flags being properly set if 
-            // an error is retuned from select
-            for ( size_t i = 0u; i < fdrNEnums; i++ ) {
-                FD_ZERO ( &fdSetsPtr[i] );
-            }
-
-            //
-            // print a message if its an unexpected error
-            //
-            if ( errnoCpy != SOCK_EINTR ) {
-                char sockErrBuf[64];
-                epicsSocketConvertErrnoToString ( 
-                    sockErrBuf, sizeof ( sockErrBuf ) );
-                fprintf ( stderr, 
-                "fdManager: select failed because \"%s\"\n",
-                    sockErrBuf );
-            }
-        }
     }
     else {
         /*
@@ -210,6 +200,215 @@ epicsShareFunc void fdManager::process (double delay)
     return;
 }
 
+//
+// fdManager::activate()
+//
+// move a pending fdReg to the list of those to be called back
+//
+void fdManager::activate ( fdReg & reg )
+{
+    this->regList.remove ( reg );
+    this->activeList.add ( reg );
+    reg.state = fdReg::active;
+}
+
+//
+// fdManager::waitSelect()
+//
+// returns the number of fdReg activated
+//
+int fdManager::waitSelect ( double delay )
+{
+    tsDLIter < fdReg > iter = this->regList.firstIter ();
+    while ( iter.valid () ) {
+        if ( FD_IN_FDSET ( iter->getFD() ) ) {
+            FD_SET(iter->getFD(), &this->fdSetsPtr[iter->getType()]); 
+        }
+        ++iter;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = static_cast<time_t> ( delay );
+    tv.tv_usec = static_cast<long> ( (delay-tv.tv_sec) * uSecPerSec );
+
+    fd_set * pReadSet = & this->fdSetsPtr[fdrRead];
+    fd_set * pWriteSet = & this->fdSetsPtr[fdrWrite];
+    fd_set * pExceptSet = & this->fdSetsPtr[fdrException];
+    // fds registered while epoll was in use may be above FD_SETSIZE
+    SOCKET nfds = this->maxFD;
+    if ( nfds > 0 && ! FD_IN_FDSET ( nfds - 1 ) ) {
+        nfds = FD_SETSIZE;
+    }
+    int status = select (nfds, pReadSet, pWriteSet, pExceptSet, &tv);
+
+    if ( status > 0 ) {
+        int nActive = 0;
+
+        //
+        // Look for activity
+        //
+        iter=this->regList.firstIter ();
+        while ( iter.valid () && status > 0 ) {
+            tsDLIter < fdReg > tmp = iter;
+            tmp++;
+            if ( FD_IN_FDSET ( iter->getFD() ) &&
+                    FD_ISSET(iter->getFD(), &this->fdSetsPtr[iter->getType()])) {
+                FD_CLR(iter->getFD(), &this->fdSetsPtr[iter->getType()]);
+                this->activate ( *iter );
+                nActive++;
+                status--;
+            }
+            iter = tmp;
+        }
+        return nActive;
+    }
+    else if ( status < 0 ) {
+        int errnoCpy = SOCKERRNO;
+        
+        // dont depend on flags being properly set if 
+        // an error is retuned from select
+        for ( size_t i = 0u; i < fdrNEnums; i++ ) {
+            FD_ZERO ( &fdSetsPtr[i] );
+        }
+
+        //
+        // print a message if its an unexpected error
+        //
+        if ( errnoCpy != SOCK_EINTR ) {
+            char sockErrBuf[64];
+            epicsSocketConvertErrnoToString ( 
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            fprintf ( stderr, 
+            "fdManager: select failed because \"%s\"\n",
+                sockErrBuf );
+        }
+    }
+    return 0;
+}
+
+#ifdef FDMGR_EPOLL
+
+//
+// fdManager::waitEpoll()
+//
+// The interest set is kept in the kernel, so only the file descriptors
+// that are ready are looked at. Registrations are level triggered like
+// select(), since a callBack() isn't required to drain its socket.
+//
+int fdManager::waitEpoll ( double delay )
+{
+    int timeout = INT_MAX;
+    if ( delay * mSecPerSec < INT_MAX ) {
+        timeout = static_cast < int > ( std::ceil ( delay * mSecPerSec ) );
+    }
+
+    int status = epoll_wait ( this->epollFD, this->pEpollEvents,
+        epollEventsMax, timeout );
+
+    if ( status < 0 ) {
+        if ( errno != EINTR ) {
+            char sockErrBuf[64];
+            epicsSocketConvertErrnoToString ( 
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            fprintf ( stderr, 
+            "fdManager: epoll_wait failed because \"%s\"\n",
+                sockErrBuf );
+        }
+        return 0;
+    }
+
+    int nActive = 0;
+    for ( int i = 0; i < status; i++ ) {
+        const SOCKET fd = this->pEpollEvents[i].data.fd;
+        const uint32_t events = this->pEpollEvents[i].events;
+
+        for ( unsigned type = 0u; type < fdrNEnums; type++ ) {
+            if ( events & readyEvents[type] ) {
+                fdReg * pReg = this->lookUpFD ( fd,
+                    static_cast < fdRegType > ( type ) );
+                if ( pReg && pReg->state == fdReg::pending ) {
+                    this->activate ( *pReg );
+                    nActive++;
+                }
+            }
+        }
+    }
+    return nActive;
+}
+
+//
+// fdManager::updateInterest()
+//
+// tell the kernel which events are now registered for fd
+//
+void fdManager::updateInterest ( const SOCKET fd )
+{
+    struct epoll_event ev;
+
+    memset ( & ev, 0, sizeof ( ev ) );
+    for ( unsigned type = 0u; type < fdrNEnums; type++ ) {
+        if ( this->lookUpFD ( fd, static_cast < fdRegType > ( type ) ) ) {
+            ev.events |= interestEvents[type];
+        }
+    }
+    ev.data.fd = fd;
+
+    if ( ! ev.events ) {
+        // fails harmlessly if fd was closed first
+        epoll_ctl ( this->epollFD, EPOLL_CTL_DEL, fd, & ev );
+    }
+    else if ( epoll_ctl ( this->epollFD, EPOLL_CTL_MOD, fd, & ev ) < 0 &&
+            epoll_ctl ( this->epollFD, EPOLL_CTL_ADD, fd, & ev ) < 0 ) {
+        //
+        // epoll can't watch some kinds of file (for example regular
+        // files) that select() always finds ready
+        //
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString ( 
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        fprintf ( stderr,
+            "fdManager: epoll_ctl failed because \"%s\", using select()\n",
+            sockErrBuf );
+        this->abandonEpoll ();
+    }
+}
+
+#else /* FDMGR_EPOLL */
+
+int fdManager::waitEpoll ( double )
+{
+    return 0;
+}
+
+void fdManager::updateInterest ( const SOCKET )
+{
+}
+
+#endif /* FDMGR_EPOLL */
+
+//
+// fdManager::abandonEpoll()
+//
+void fdManager::abandonEpoll ()
+{
+#ifdef FDMGR_EPOLL
+    if ( this->epollFD >= 0 ) {
+        close ( this->epollFD );
+        this->epollFD = -1;
+    }
+#endif
+    delete [] this->pEpollEvents;
+    this->pEpollEvents = 0;
+}
+
+//
+// fdManager::fdAccepted()
+//
+bool fdManager::fdAccepted ( const SOCKET fd ) const
+{
+    return this->epollFD >= 0 || FD_IN_FDSET ( fd );
+}
+
 //
 // fdReg::destroy()
 // (default destroy method)
@@ -270,6 +469,9 @@ void fdManager::installReg (fdReg &reg)
     if ( status != 0 ) {
         throwWithLocation ( fdInterestSubscriptionAlreadyExits () );
     }
+    if ( this->epollFD >= 0 ) {
+        this->updateInterest ( reg.getFD () );
+    }
 }
 
 //
@@ -311,7 +513,12 @@ void fdManager::removeReg (fdReg &regIn)
     }
     regIn.state = fdReg::limbo;
 
-    FD_CLR(regIn.getFD(), &this->fdSetsPtr[regIn.getType()]);
+    if ( this->epollFD >= 0 ) {
+        this->updateInterest ( regIn.getFD () );
+    }
+    else if ( FD_IN_FDSET ( regIn.getFD () ) ) {
+        FD_CLR(regIn.getFD(), &this->fdSetsPtr[regIn.getType()]);
+    }
 }
 
 //
@@ -348,7 +555,7 @@ fdReg::fdReg (const SOCKET fdIn, const fdRegType typIn,
     fdRegId (fdIn,typIn), state (limbo), 
     onceOnly (onceOnlyIn), manager (managerIn)
 { 
-    if (!FD_IN_FDSET(fdIn)) {
+    if (!this->manager.fdAccepted(fdIn)) {
         fprintf (stderr, "%s: fd > FD_SETSIZE ignored\n", 
             __FILE__);
         return;
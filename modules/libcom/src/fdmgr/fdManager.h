@@ -65,11 +65,20 @@ private:
     fdRegType type;
 };
 
+struct epoll_event;
+
 //
 // fdManager
 //
 // file descriptor manager
 //
+// On Linux the file descriptors are watched with epoll, so the cost
+// of process() depends on the number of active file descriptors, and
+// file descriptors above FD_SETSIZE can be registered. Elsewhere, or
+// when built with FDMGR_USE_SELECT defined, or if the environment
+// variable EPICS_FDMGR_USE_SELECT is not empty when the fdManager is
+// created, select() is used.
+//
 class fdManager : public epicsTimerQueueNotify {
 public:
     //
@@ -100,10 +109,21 @@ private:
     // and nill otherwise
     //
     fdReg * pCBReg; 
+    //
+    // epoll instance, or -1 when select() is used
+    //
+    int epollFD;
+    struct epoll_event * pEpollEvents;
     void reschedule ();
     double quantum ();
     void installReg (fdReg &reg);
     void removeReg (fdReg &reg);
+    bool fdAccepted (const SOCKET fd) const;
+    void activate (fdReg &reg);
+    int waitSelect (double delay);
+    int waitEpoll (double delay);
+    void updateInterest (const SOCKET fd);
+    void abandonEpoll ();
     void lazyInitTimerQueue ();
     fdManager ( const fdManager & );
     fdManager & operator = ( const fdManager & );
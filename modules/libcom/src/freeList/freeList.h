@@ -20,6 +20,11 @@ extern "C" {
 #endif
 
 epicsShareFunc void epicsShareAPI freeListInitPvt(void **ppvt,int size,int nmalloc);
+/* Like freeListInitPvt(), but threads allocate from and free to caches
+ * holding up to ncache blocks each, which are refilled from and spilled
+ * to the shared list half at a time.
+ */
+epicsShareFunc void epicsShareAPI freeListInitCachedPvt(void **ppvt,int size,int nmalloc,int ncache);
 epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt);
 epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt);
 epicsShareFunc void epicsShareAPI freeListFree(void *pvt,void*pmem);
@@ -24,23 +24,102 @@
 
 #define epicsExportSharedSymbols
 #include "cantProceed.h"
+#include "epicsAtomic.h"
 #include "epicsMutex.h"
+#include "epicsSpin.h"
+#include "epicsThread.h"
 #include "freeList.h"
 #include "adjustment.h"
 
+/* Caches of a list, threads beyond this many share them */
+#define NCACHES 32
+
 typedef struct allocMem {
     struct allocMem	*next;
     void		*memory;
 }allocMem;
+
+/* Free blocks kept for the threads using one cache slot,
+ * padded so that no two caches share a cache line */
+typedef union {
+    struct {
+        epicsSpinId	lock;
+        void		*head;
+        size_t		count;
+    } c;
+    char pad[64];
+}FREELISTCACHE;
+
 typedef struct {
     int		size;
     int		nmalloc;
     void	*head;
     allocMem	*mallochead;
-    size_t	nBlocksAvailable;
+    size_t	nBlocksAvailable;	/* on head, not in caches */
     epicsMutexId lock;
+    int		ncache;			/* blocks per cache, 0 for none */
+    FREELISTCACHE *caches;
 }FREELISTPVT;
 
+static epicsThreadOnceId cacheSlotOnce = EPICS_THREAD_ONCE_INIT;
+static epicsThreadPrivateId cacheSlotId;
+static size_t cacheSlotNext;
+
+static void cacheSlotInit(void *junk)
+{
+    cacheSlotId = epicsThreadPrivateCreate();
+}
+
+/* The cache of the calling thread, slots are handed out in turn */
+static FREELISTCACHE *freeListCacheSelf(FREELISTPVT *pfl)
+{
+    size_t slot = (size_t)epicsThreadPrivateGet(cacheSlotId);
+
+    if (!slot) {
+        slot = epicsAtomicIncrSizeT(&cacheSlotNext);
+        epicsThreadPrivateSet(cacheSlotId, (void *)slot);
+    }
+    return &pfl->caches[(slot - 1) % NCACHES];
+}
+
+/* Add nmalloc blocks to the list, called with the lock held */
+static int freeListGrow(FREELISTPVT *pfl)
+{
+    void	*ptemp;
+    void	**ppnext;
+    allocMem	*pallocmem;
+    int		i;
+
+    /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
+     * The first sizeof(void*) bytes are used to store a pointer
+     * to the next free block.
+     *
+     * | RED | size0 ------ | RED | size1 | ... | RED |
+     * |     | next | ----- |
+     */
+    ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
+    if(ptemp==0) return 0;
+    pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
+    if(pallocmem==0) {
+        free(ptemp);
+        return 0;
+    }
+    pallocmem->memory = ptemp; /* real allocation */
+    ptemp = REDZONE + (char *) ptemp; /* skip first REDZONE */
+    if(pfl->mallochead)
+        pallocmem->next = pfl->mallochead;
+    pfl->mallochead = pallocmem;
+    for(i=0; i<pfl->nmalloc; i++) {
+        ppnext = ptemp;
+        VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, sizeof(void*));
+        *ppnext = pfl->head;
+        pfl->head = ptemp;
+        ptemp = ((char *)ptemp) + pfl->size+REDZONE;
+    }
+    pfl->nBlocksAvailable += pfl->nmalloc;
+    return 1;
+}
+
 epicsShareFunc void epicsShareAPI 
 	freeListInitPvt(void **ppvt,int size,int nmalloc)
 {
@@ -58,6 +137,107 @@ epicsShareFunc void epicsShareAPI
     return;
 }
 
+epicsShareFunc void epicsShareAPI
+	freeListInitCachedPvt(void **ppvt,int size,int nmalloc,int ncache)
+{
+    FREELISTPVT	*pfl;
+    int		i;
+
+    freeListInitPvt(ppvt, size, nmalloc);
+    if (ncache < 2) return;
+
+    epicsThreadOnce(&cacheSlotOnce, cacheSlotInit, NULL);
+    pfl = *ppvt;
+    pfl->ncache = ncache;
+    pfl->caches = callocMustSucceed(NCACHES, sizeof(FREELISTCACHE),
+        "freeListInitCachedPvt");
+    for (i = 0; i < NCACHES; i++)
+        pfl->caches[i].c.lock = epicsSpinMustCreate();
+}
+
+/* Take a block from the cache of the calling thread, when the cache is
+ * empty refill half of it from the list.  The spin lock is not held
+ * while taking the list lock or calling malloc().
+ */
+static void *freeListCacheMalloc(FREELISTPVT *pfl)
+{
+    FREELISTCACHE *pc = freeListCacheSelf(pfl);
+    void	*ptemp;
+    void	*pchain;
+    void	**ppnext;
+    size_t	n;
+
+    epicsSpinLock(pc->c.lock);
+    ptemp = pc->c.head;
+    if (ptemp) {
+        ppnext = ptemp;
+        pc->c.head = *ppnext;
+        epicsAtomicSetSizeT(&pc->c.count, pc->c.count - 1);
+        epicsSpinUnlock(pc->c.lock);
+        return ptemp;
+    }
+    epicsSpinUnlock(pc->c.lock);
+
+    epicsMutexMustLock(pfl->lock);
+    if (!pfl->head && !freeListGrow(pfl)) {
+        epicsMutexUnlock(pfl->lock);
+        return 0;
+    }
+    /* the first block is ours, the rest go into the cache */
+    ptemp = pfl->head;
+    ppnext = ptemp;
+    for (n = 1; n < (size_t)pfl->ncache / 2 && *ppnext; n++)
+        ppnext = *ppnext;
+    pfl->head = *ppnext;
+    *ppnext = NULL;
+    pfl->nBlocksAvailable -= n;
+    pchain = *(void **)ptemp;
+    epicsMutexUnlock(pfl->lock);
+
+    if (pchain) {
+        epicsSpinLock(pc->c.lock);
+        *ppnext = pc->c.head;
+        pc->c.head = pchain;
+        epicsAtomicSetSizeT(&pc->c.count, pc->c.count + n - 1);
+        epicsSpinUnlock(pc->c.lock);
+    }
+    return ptemp;
+}
+
+/* Put a block in the cache of the calling thread, when the cache is
+ * full move half of it back to the list.
+ */
+static void freeListCacheFree(FREELISTPVT *pfl, void *pmem)
+{
+    FREELISTCACHE *pc = freeListCacheSelf(pfl);
+    void	*pchain = NULL;
+    void	**ppnext = pmem;
+    size_t	n = 0;
+
+    epicsSpinLock(pc->c.lock);
+    *ppnext = pc->c.head;
+    pc->c.head = pmem;
+    if (pc->c.count + 1 < (size_t)pfl->ncache) {
+        epicsAtomicSetSizeT(&pc->c.count, pc->c.count + 1);
+    }
+    else {
+        pchain = pmem;
+        for (n = 1; n < (size_t)pfl->ncache / 2; n++)
+            ppnext = *ppnext;
+        pc->c.head = *ppnext;
+        epicsAtomicSetSizeT(&pc->c.count, pc->c.count + 1 - n);
+    }
+    epicsSpinUnlock(pc->c.lock);
+
+    if (pchain) {
+        epicsMutexMustLock(pfl->lock);
+        *ppnext = pfl->head;
+        pfl->head = pchain;
+        pfl->nBlocksAvailable += n;
+        epicsMutexUnlock(pfl->lock);
+    }
+}
+
 epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt)
 {
     FREELISTPVT *pfl = pvt;
@@ -80,49 +260,23 @@ epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt)
 #   else
     void	*ptemp;
     void	**ppnext;
-    allocMem	*pallocmem;
-    int		i;
 
-    epicsMutexMustLock(pfl->lock);
-    ptemp = pfl->head;
-    if(ptemp==0) {
-        /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
-         * The first sizeof(void*) bytes are used to store a pointer
-         * to the next free block.
-         *
-         * | RED | size0 ------ | RED | size1 | ... | RED |
-         * |     | next | ----- |
-         */
-        ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
-        if(ptemp==0) {
-            epicsMutexUnlock(pfl->lock);
-            return(0);
-        }
-        pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
-        if(pallocmem==0) {
+    if (pfl->caches) {
+        ptemp = freeListCacheMalloc(pfl);
+        if(ptemp==0) return(0);
+    }
+    else {
+        epicsMutexMustLock(pfl->lock);
+        if(pfl->head==0 && !freeListGrow(pfl)) {
             epicsMutexUnlock(pfl->lock);
-            free(ptemp);
             return(0);
         }
-        pallocmem->memory = ptemp; /* real allocation */
-        ptemp = REDZONE + (char *) ptemp; /* skip first REDZONE */
-        if(pfl->mallochead)
-            pallocmem->next = pfl->mallochead;
-        pfl->mallochead = pallocmem;
-        for(i=0; i<pfl->nmalloc; i++) {
-            ppnext = ptemp;
-            VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, sizeof(void*));
-            *ppnext = pfl->head;
-            pfl->head = ptemp;
-            ptemp = ((char *)ptemp) + pfl->size+REDZONE;
-        }
         ptemp = pfl->head;
-        pfl->nBlocksAvailable += pfl->nmalloc;
+        ppnext = pfl->head;
+        pfl->head = *ppnext;
+        pfl->nBlocksAvailable--;
+        epicsMutexUnlock(pfl->lock);
     }
-    ppnext = pfl->head;
-    pfl->head = *ppnext;
-    pfl->nBlocksAvailable--;
-    epicsMutexUnlock(pfl->lock);
     VALGRIND_MEMPOOL_FREE(pfl, ptemp);
     VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, pfl->size);
     return(ptemp);
@@ -141,6 +295,10 @@ epicsShareFunc void epicsShareAPI freeListFree(void *pvt,void*pmem)
     VALGRIND_MEMPOOL_FREE(pvt, pmem);
     VALGRIND_MEMPOOL_ALLOC(pvt, pmem, sizeof(void*));
 
+    if (pfl->caches) {
+        freeListCacheFree(pfl, pmem);
+        return;
+    }
     epicsMutexMustLock(pfl->lock);
     ppnext = pmem;
     *ppnext = pfl->head;
@@ -165,6 +323,13 @@ epicsShareFunc void epicsShareAPI freeListCleanup(void *pvt)
         free(phead);
         phead = pnext;
     }
+    if (pfl->caches) {
+        int i;
+
+        for (i = 0; i < NCACHES; i++)
+            epicsSpinDestroy(pfl->caches[i].c.lock);
+        free(pfl->caches);
+    }
     epicsMutexDestroy(pfl->lock);
     free(pvt);
 }
@@ -176,6 +341,12 @@ epicsShareFunc size_t epicsShareAPI freeListItemsAvail(void *pvt)
     epicsMutexMustLock(pfl->lock);
     nBlocksAvailable = pfl->nBlocksAvailable;
     epicsMutexUnlock(pfl->lock);
+    if (pfl->caches) {
+        int i;
+
+        for (i = 0; i < NCACHES; i++)
+            nBlocksAvailable += epicsAtomicGetSizeT(&pfl->caches[i].c.count);
+    }
     return nBlocksAvailable;
 }
 
@@ -9,13 +9,15 @@
 /*
  * Implementation of core macro substitution library (macLib)
  *
- * The implementation is fairly unsophisticated and linked lists are
- * used to store macro values. Typically there will will be only a
- * small number of macros and performance won't be a problem. Special
- * measures are taken to avoid unnecessary expansion of macros whose
- * definitions reference other macros. Whenever a macro is created,
- * modified or deleted, a "dirty" flag is set; this causes a full
- * expansion of all macros the next time a macro value is read
+ * Macro values are stored in a linked list in the order they were
+ * created, which gives the scoping rules, and are also chained into a
+ * hash table by name so that lookups don't have to search the list.
+ * Special measures are taken to avoid unnecessary expansion of macros
+ * whose definitions reference other macros. Whenever a macro is
+ * created, modified or deleted, a "dirty" flag is set; this causes a
+ * full expansion of all macros the next time a macro value is read.
+ * Values that contain no macro references can't change when other
+ * macros do, so they are expanded only once
  *
  * Original Author: William Lupton, W. M. Keck Observatory
  */
@@ -29,6 +31,7 @@
 #include "dbDefs.h"
 #include "errlog.h"
 #include "dbmf.h"
+#include "epicsString.h"
 #include "macLib.h"
 
 
@@ -39,6 +42,8 @@
  */
 typedef struct mac_entry {
     ELLNODE     node;           /* prev and next pointers */
+    struct mac_entry *hashNext; /* next entry in hash chain */
+    unsigned int hash;          /* hash of name */
     char        *name;          /* entry name */
     char        *type;          /* entry type */
     char        *rawval;        /* raw (unexpanded) value */
@@ -48,6 +53,7 @@ typedef struct mac_entry {
     int         visited;        /* ever been visited? */
     int         special;        /* special (internal) entry? */
     int         level;          /* scoping level */
+    int         literal;        /* value expanded, has no references? */
 } MAC_ENTRY;
 
 
@@ -59,9 +65,9 @@ typedef struct mac_entry {
 static MAC_ENTRY *first   ( MAC_HANDLE *handle );
 static MAC_ENTRY *last    ( MAC_HANDLE *handle );
 static MAC_ENTRY *next    ( MAC_ENTRY  *entry );
-static MAC_ENTRY *previous( MAC_ENTRY  *entry );
 
 static MAC_ENTRY *create( MAC_HANDLE *handle, const char *name, int special );
+static void       rehash( MAC_HANDLE *handle, unsigned int size );
 static MAC_ENTRY *lookup( MAC_HANDLE *handle, const char *name, int special );
 static char      *rawval( MAC_HANDLE *handle, MAC_ENTRY *entry, const char *value );
 static void       delete( MAC_HANDLE *handle, MAC_ENTRY *entry );
@@ -83,6 +89,12 @@ static char *Strdup( const char *string );
  */
 #define MAC_MAGIC 0xbadcafe     /* ...sells sub-standard coffee? */
 
+/*
+ * Initial number of hash table buckets (a power of 2); the table is
+ * doubled in size whenever it holds more entries than buckets
+ */
+#define MAC_HASH_SIZE 16
+
 /*
  * Flag bits
  */
@@ -126,6 +138,9 @@ epicsShareAPI macCreateHandle(
     handle->debug = 0;
     handle->flags = 0;
     ellInit( &handle->list );
+    handle->hash = NULL;
+    handle->hashSize = 0;
+    handle->count = 0;
 
     /* use environment variables if so specified */
     if (pairs && pairs[0] && !strcmp(pairs[0],"") && pairs[1] && !strcmp(pairs[1],"environ") && !pairs[3]) {
@@ -135,7 +150,7 @@ epicsShareAPI macCreateHandle(
         /* if supplied, load macro definitions */
         for ( ; pairs && pairs[0]; pairs += 2 ) {
             if ( macPutValue( handle, pairs[0], pairs[1] ) < 0 ) {
-                dbmfFree( handle );
+                macDeleteHandle( handle );
                 return -1;
             }
         }
@@ -378,6 +393,7 @@ epicsShareAPI macDeleteHandle(
         nextEntry = next( entry );
         delete( handle, entry );
     }
+    free( handle->hash );
 
     /* clear magic field and free context structure */
     handle->magic = 0;
@@ -529,14 +545,6 @@ static MAC_ENTRY *next( MAC_ENTRY *entry )
     return ( MAC_ENTRY * ) ellNext( ( ELLNODE * ) entry );
 }
 
-/*
- * Return pointer to previous macro entry (could be preprocessor macro)
- */
-static MAC_ENTRY *previous( MAC_ENTRY *entry )
-{
-    return ( MAC_ENTRY * ) ellPrevious( ( ELLNODE * ) entry );
-}
-
 /*
  * Create new macro entry (can assume it doesn't exist)
  */
@@ -560,28 +568,79 @@ static MAC_ENTRY *create( MAC_HANDLE *handle, const char *name, int special )
             entry->visited = FALSE;
             entry->special = special;
             entry->level   = handle->level;
+            entry->literal = FALSE;
+            entry->hash    = epicsStrHash( name, 0 );
 
             ellAdd( list, ( ELLNODE * ) entry );
+            handle->count++;
+
+            /* grow the hash table if necessary; on failure the old
+               table is kept, and is still correct if slower */
+            if ( handle->count > handle->hashSize )
+                rehash( handle, handle->hashSize ?
+                                handle->hashSize * 2 : MAC_HASH_SIZE );
+
+            /* newest entry goes first in its chain so scoping works */
+            if ( handle->hash != NULL ) {
+                MAC_ENTRY **pchain = &handle->hash[entry->hash &
+                                                   ( handle->hashSize - 1 )];
+                entry->hashNext = *pchain;
+                *pchain = entry;
+            }
+            else {
+                ellDelete( list, ( ELLNODE * ) entry );
+                handle->count--;
+                dbmfFree( entry->name );
+                dbmfFree( entry );
+                entry = NULL;
+            }
         }
     }
 
     return entry;
 }
 
+/*
+ * Replace the hash table with one of the given size and re-chain all
+ * entries other than the newest one, which create() chains itself.
+ * Entries are chained in list order so each chain stays newest first
+ */
+static void rehash( MAC_HANDLE *handle, unsigned int size )
+{
+    MAC_ENTRY **table = calloc( size, sizeof( MAC_ENTRY * ) );
+    MAC_ENTRY *entry, *newest = last( handle );
+
+    if ( table == NULL )
+        return;
+
+    for ( entry = first( handle ); entry != newest; entry = next( entry ) ) {
+        MAC_ENTRY **pchain = &table[entry->hash & ( size - 1 )];
+        entry->hashNext = *pchain;
+        *pchain = entry;
+    }
+
+    free( handle->hash );
+    handle->hash = table;
+    handle->hashSize = size;
+}
+
 /*
  * Look up macro entry with matching "special" attribute by name
  */
 static MAC_ENTRY *lookup( MAC_HANDLE *handle, const char *name, int special )
 {
-    MAC_ENTRY *entry;
+    MAC_ENTRY *entry = NULL;
+    unsigned int hash = epicsStrHash( name, 0 );
 
     if ( handle->debug & 2 )
         printf( "lookup-> level = %d, name = %s, special = %d\n",
                 handle->level, name, special );
 
-    /* search backwards so scoping works */
-    for ( entry = last( handle ); entry != NULL; entry = previous( entry ) ) {
-        if ( entry->special != special )
+    /* chains are newest first so scoping works */
+    if ( handle->hash != NULL )
+        entry = handle->hash[hash & ( handle->hashSize - 1 )];
+    for ( ; entry != NULL; entry = entry->hashNext ) {
+        if ( entry->hash != hash || entry->special != special )
             continue;
         if ( strcmp( name, entry->name ) == 0 )
             break;
@@ -614,6 +673,7 @@ static char *rawval( MAC_HANDLE *handle, MAC_ENTRY *entry, const char *value )
     if ( entry->rawval != NULL )
         dbmfFree( entry->rawval );
     entry->rawval = Strdup( value );
+    entry->literal = FALSE;
 
     handle->dirty = TRUE;
 
@@ -627,8 +687,14 @@ static char *rawval( MAC_HANDLE *handle, MAC_ENTRY *entry, const char *value )
 static void delete( MAC_HANDLE *handle, MAC_ENTRY *entry )
 {
     ELLLIST *list = &handle->list;
+    MAC_ENTRY **pchain = &handle->hash[entry->hash & ( handle->hashSize - 1 )];
+
+    while ( *pchain != entry )
+        pchain = &( *pchain )->hashNext;
+    *pchain = entry->hashNext;
 
     ellDelete( list, ( ELLNODE * ) entry );
+    handle->count--;
 
     dbmfFree( entry->name );
     if ( entry->rawval != NULL )
@@ -654,6 +720,10 @@ static long expand( MAC_HANDLE *handle )
 
     for ( entry = first( handle ); entry != NULL; entry = next( entry ) ) {
 
+        /* values without references were expanded once already */
+        if ( entry->literal )
+            continue;
+
         if ( handle->debug & 2 )
             printf( "\nexpand %s = %s\n", entry->name,
                 entry->rawval ? entry->rawval : "" );
@@ -673,6 +743,8 @@ static long expand( MAC_HANDLE *handle )
         trans( handle, entry, 1, "", &rawval, &value, entry->value + MAC_SIZE );
         entry->length = value - entry->value;
         entry->value[MAC_SIZE] = '\0';
+        entry->literal = entry->rawval == NULL ||
+                         strchr( entry->rawval, '$' ) == NULL;
     }
 
     handle->dirty = FALSE;
@@ -870,6 +942,9 @@ static void refer ( MAC_HANDLE *handle, MAC_ENTRY *entry, int level,
                 /* copy the already-expanded value, merge any error status */
                 cpy2val( refentry->value, &v, valend );
                 entry->error = entry->error || refentry->error;
+            } else if ( refentry->literal && refentry->length < MAC_SIZE ) {
+                /* value can't have changed, and wasn't truncated */
+                cpy2val( refentry->value, &v, valend );
             } else {
                 /* translate raw value */
                 const char *rv = refentry->rawval;
@@ -41,6 +41,9 @@ typedef struct {
     int         debug;          /* debugging level */
     ELLLIST     list;           /* macro name / value list */
     int         flags;          /* operating mode flags */
+    struct mac_entry **hash;    /* hash table of list entries, by name */
+    unsigned int hashSize;      /* number of hash table buckets */
+    unsigned int count;         /* number of list entries */
 } MAC_HANDLE;
 
 /*
@@ -14,6 +14,7 @@
 
 #define epicsExportSharedSymbols
 #include "epicsTypes.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsMessageQueue.h"
@@ -57,13 +58,16 @@ typedef struct {
         TIMECURRENTFUN Time;
         TIMEEVENTFUN   Event;
     } getInt;
+    TIMECURRENTFUN getReentrant;
 } gtProvider;
 
 static struct {
     epicsMutexId    timeListLock;
     ELLLIST         timeProviders;
     gtProvider      *lastTimeProvider;
+    gtProvider      *fastTimeProvider;
     epicsTimeStamp  lastProvidedTime;
+    size_t          lastProvidedPacked;
 
     epicsMutexId    eventListLock;
     ELLLIST         eventProviders;
@@ -78,8 +82,68 @@ static epicsThreadOnceId onceId = EPICS_THREAD_ONCE_INIT;
 
 static const char * const tsfmt = "%Y-%m-%d %H:%M:%S.%09f";
 
+/* Where a size_t can hold a whole time stamp, epicsTimeGetCurrent()
+ * calls the highest priority provider without taking timeListLock if
+ * it was added with generalTimeAddReentrantCurrentProvider(), and keeps
+ * its result monotonic with a compare-and-swap on lastProvidedPacked
+ * (secPastEpoch in the upper half, nsec below). Elsewhere every call
+ * takes the lock and uses lastProvidedTime.
+ */
+#define GT_LOCK_FREE (sizeof(size_t) >= 2 * sizeof(epicsUInt32))
+
 /* Implementation */
 
+static size_t gtPack(const epicsTimeStamp *pts)
+{
+    /* Two shifts so 32-bit targets compile; GT_LOCK_FREE is 0 there */
+    return ((size_t)pts->secPastEpoch << 16 << 16) | pts->nsec;
+}
+
+static void gtUnpack(size_t packed, epicsTimeStamp *pts)
+{
+    pts->secPastEpoch = (epicsUInt32)(packed >> 16 >> 16);
+    pts->nsec = (epicsUInt32)packed;
+}
+
+/* Return *pts in *pDest if it is not older than the last time provided,
+ * otherwise return the last time provided, count an error and return 1.
+ * Without GT_LOCK_FREE the caller must hold timeListLock.
+ */
+static int gtRatchet(const epicsTimeStamp *pts, epicsTimeStamp *pDest)
+{
+    int key;
+
+    if (GT_LOCK_FREE) {
+        size_t next = gtPack(pts);
+        size_t last = epicsAtomicGetSizeT(&gtPvt.lastProvidedPacked);
+
+        while (next >= last) {
+            size_t prev = epicsAtomicCmpAndSwapSizeT(&gtPvt.lastProvidedPacked,
+                last, next);
+
+            if (prev == last) {
+                *pDest = *pts;
+                return 0;
+            }
+            last = prev;
+        }
+        gtUnpack(last, pDest);
+    }
+    else if (epicsTimeGreaterThanEqual(pts, &gtPvt.lastProvidedTime)) {
+        *pDest = *pts;
+        gtPvt.lastProvidedTime = *pts;
+        return 0;
+    }
+    else {
+        *pDest = gtPvt.lastProvidedTime;
+    }
+
+    key = epicsInterruptLock();
+    gtPvt.ErrorCounts++;
+    epicsInterruptUnlock(key);
+    return 1;
+}
+
 static void generalTime_InitOnce(void *dummy)
 {
     ellInit(&gtPvt.timeProviders);
@@ -148,11 +212,28 @@ int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
     int status = S_time_noProvider;
     epicsTimeStamp ts;
 
-    generalTime_Init();
-
     IFDEBUG(20)
         printf("epicsTimeGetCurrent()\n");
 
+    /* Fast path, only set once we are initialized */
+    ptp = (gtProvider *)epicsAtomicGetPtrT(
+        (EpicsAtomicPtrT *)&gtPvt.fastTimeProvider);
+    if (ptp && ptp->getReentrant(&ts) == epicsTimeOK) {
+        if (gtRatchet(&ts, pDest)) {
+            IFDEBUG(10) {
+                char last[40], buff[40];
+
+                epicsTimeToStrftime(last, sizeof(last), tsfmt, pDest);
+                epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
+                printf("eTGC provider '%s' returned older time\n"
+                    "    %s, using %s instead\n", ptp->name, buff, last);
+            }
+        }
+        return epicsTimeOK;
+    }
+
+    generalTime_Init();
+
     epicsMutexMustLock(gtPvt.timeListLock);
     for (ptp = (gtProvider *)ellFirst(&gtPvt.timeProviders);
          ptp; ptp = (gtProvider *)ellNext(&ptp->node)) {
@@ -160,33 +241,29 @@ int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
         status = ptp->get.Time(&ts);
         if (status == epicsTimeOK) {
             /* check time is monotonic */
-            if (epicsTimeGreaterThanEqual(&ts, &gtPvt.lastProvidedTime)) {
-                *pDest = ts;
-                gtPvt.lastProvidedTime = ts;
+            if (!gtRatchet(&ts, pDest)) {
                 gtPvt.lastTimeProvider = ptp;
-            } else {
-                int key;
+            } else IFDEBUG(10) {
+                char last[40], buff[40];
 
-                *pDest = gtPvt.lastProvidedTime;
-                key = epicsInterruptLock();
-                gtPvt.ErrorCounts++;
-                epicsInterruptUnlock(key);
-
-                IFDEBUG(10) {
-                    char last[40], buff[40];
-
-                    epicsTimeToStrftime(last, sizeof(last), tsfmt,
-                        &gtPvt.lastProvidedTime);
-                    epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
-                    printf("eTGC provider '%s' returned older time\n"
-                        "    %s, using %s instead\n", ptp->name, buff, last);
-                }
+                epicsTimeToStrftime(last, sizeof(last), tsfmt, pDest);
+                epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
+                printf("eTGC provider '%s' returned older time\n"
+                    "    %s, using %s instead\n", ptp->name, buff, last);
             }
             break;
         }
     }
     if (status)
         gtPvt.lastTimeProvider = NULL;
+
+    /* Skip the lock next time, unless a higher priority provider failed
+       or this one must not be called from several threads at once */
+    if (GT_LOCK_FREE)
+        epicsAtomicSetPtrT((EpicsAtomicPtrT *)&gtPvt.fastTimeProvider,
+            ptp && ptp->getReentrant &&
+            ptp == (gtProvider *)ellFirst(&gtPvt.timeProviders) ?
+                ptp : NULL);
     epicsMutexUnlock(gtPvt.timeListLock);
 
     IFDEBUG(20) {
@@ -407,6 +484,7 @@ int generalTimeRegisterEventProvider(const char *name, int priority,
     ptp->priority     = priority;
     ptp->get.Event    = getEvent;
     ptp->getInt.Event = NULL;
+    ptp->getReentrant = NULL;
 
     insertProvider(ptp, &gtPvt.eventProviders, gtPvt.eventListLock);
 
@@ -450,9 +528,13 @@ int generalTimeRegisterCurrentProvider(const char *name, int priority,
     ptp->priority    = priority;
     ptp->get.Time    = getTime;
     ptp->getInt.Time = NULL;
+    ptp->getReentrant = NULL;
 
     insertProvider(ptp, &gtPvt.timeProviders, gtPvt.timeListLock);
 
+    /* The new provider may outrank the one on the fast path */
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *)&gtPvt.fastTimeProvider, NULL);
+
     IFDEBUG(1)
         printf("Registered time provider '%s' at %d\n", name, priority);
 
@@ -475,6 +557,22 @@ int generalTimeAddIntCurrentProvider(const char *name, int priority,
     return epicsTimeOK;
 }
 
+int generalTimeAddReentrantCurrentProvider(const char *name, int priority,
+    TIMECURRENTFUN getTime)
+{
+    gtProvider *ptp = findProvider(&gtPvt.timeProviders, gtPvt.timeListLock,
+        name, priority);
+    if (ptp == NULL)
+        return S_time_noProvider;
+
+    ptp->getReentrant = getTime;
+
+    IFDEBUG(1)
+        printf("Time provider '%s' is reentrant\n", name);
+
+    return epicsTimeOK;
+}
+
 /* 
  * Provide an optional "last resort" provider for Event Time.
  * 
@@ -37,6 +37,14 @@ epicsShareFunc int generalTimeAddIntCurrentProvider(const char *name,
 epicsShareFunc int generalTimeAddIntEventProvider(const char *name,
     int priority, TIMEEVENTFUN getEvent);
 
+/* Providers registered above are only ever called one at a time. A
+ * provider whose routine may be called from several threads at once
+ * can add it here, and epicsTimeGetCurrent() will then call it without
+ * taking the provider list lock while it is the highest priority one.
+ */
+epicsShareFunc int generalTimeAddReentrantCurrentProvider(const char *name,
+    int priority, TIMECURRENTFUN getTime);
+
 epicsShareFunc int generalTimeGetExceptPriority(epicsTimeStamp *pDest,
     int *pPrio, int ignorePrio);
 
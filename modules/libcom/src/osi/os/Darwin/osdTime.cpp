@@ -46,6 +46,8 @@ static int timeRegister(void)
 
     generalTimeCurrentTpRegister("MachTime", \
         LAST_RESORT_PRIORITY, osdTimeGetCurrent);
+    generalTimeAddReentrantCurrentProvider("MachTime",
+        LAST_RESORT_PRIORITY, osdTimeGetCurrent);
 
     osdMonotonicInit();
     return 1;
@@ -105,6 +105,8 @@ static int timeRegister(void)
     pCurrentTime = new currentTime ();
 
     generalTimeCurrentTpRegister("PerfCounter", 150, osdTimeGetCurrent);
+    generalTimeAddReentrantCurrentProvider("PerfCounter", 150,
+        osdTimeGetCurrent);
 
     pCurrentTime->startPLL ();
 
@@ -28,8 +28,10 @@
 #else
     /* Some posix systems may not have CLOCK_REALTIME */
 
-    #define TIME_INIT generalTimeCurrentTpRegister("GetTimeOfDay", \
-        LAST_RESORT_PRIORITY, osdTimeGetCurrent)
+    #define TIME_INIT (generalTimeCurrentTpRegister("GetTimeOfDay", \
+        LAST_RESORT_PRIORITY, osdTimeGetCurrent), \
+        generalTimeAddReentrantCurrentProvider("GetTimeOfDay", \
+        LAST_RESORT_PRIORITY, osdTimeGetCurrent))
 
     extern "C" {
     static int osdTimeGetCurrent (epicsTimeStamp *pDest)
@@ -117,6 +117,8 @@ static void NTPTime_InitOnce(void *pprio)
 
     /* Finally register as a time provider */
     generalTimeRegisterCurrentProvider("NTP", *(int *)pprio, NTPTimeGetCurrent);
+    generalTimeAddReentrantCurrentProvider("NTP", *(int *)pprio,
+        NTPTimeGetCurrent);
 }
 
 void NTPTime_Init(int priority)
@@ -0,0 +1,157 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure calcPerform() against calcPerformCompiled() for some
+ * expressions typical of calc and calcout records, then
+ * calcPerformArray() against a loop over the elements of a waveform.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsTime.h"
+#include "postfix.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NLOOPS 1000000
+#define NELM 100000
+#define NARRAYS 20
+
+static const char * const exprs[] = {
+    "A+B",
+    "(A+B)/2",
+    "(A-B)/C*100",
+    "A*B+C*D+E*F",
+    "A>5?B:C",
+    "A<B?A:B",
+    "A&4?1:0",
+    "A>B?(A>C?A:C):(B>C?B:C)",
+    "MAX(A,B,C,D)",
+    "SIN(A*D2R)*B+C",
+    "A:=A+1;A>=10?0:A",
+};
+
+static void measure(const char *expr)
+{
+    double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+    char rpn[INFIX_TO_POSTFIX_SIZE(80)];
+    epicsTimeStamp start, stop;
+    calcProgram *prog;
+    double result = 0.0, tInterp, tCompiled;
+    short err;
+    unsigned i;
+
+    if (postfix(expr, rpn, &err)) {
+        testFail("postfix: %s in '%s'", calcErrorStr(err), expr);
+        return;
+    }
+    prog = calcCompile(rpn);
+    if (!testOk(prog != NULL, "calcCompile('%s')", expr))
+        return;
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NLOOPS; i++)
+        calcPerform(args, &result, rpn);
+    epicsTimeGetCurrent(&stop);
+    tInterp = epicsTimeDiffInSeconds(&stop, &start);
+
+    args[0] = 1.0;
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NLOOPS; i++)
+        calcPerformCompiled(args, &result, prog);
+    epicsTimeGetCurrent(&stop);
+    tCompiled = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%-26s %6.1f ns interpreted, %6.1f ns compiled (x%.2f)",
+             expr, tInterp * 1e9 / NLOOPS, tCompiled * 1e9 / NLOOPS,
+             tInterp / tCompiled);
+    calcProgramFree(prog);
+}
+
+static const char * const arrayExprs[] = {
+    "A+B",
+    "A*B+C",
+    "(A-B)/C*100",
+    "SQR(A*A+B*B)",
+    "A>B?A:B",
+    "A>50000?A:B",
+    "SIN(A*D2R)*B+C",
+};
+
+static void measureArray(const char *expr, double * const *pargs,
+    const epicsUInt32 *pcounts, double *presult)
+{
+    double args[CALCPERFORM_NARGS] = {0.0};
+    char rpn[INFIX_TO_POSTFIX_SIZE(80)];
+    epicsTimeStamp start, stop;
+    calcProgram *prog;
+    double tScalar, tArray;
+    short err;
+    unsigned i, k, n;
+
+    if (postfix(expr, rpn, &err)) {
+        testFail("postfix: %s in '%s'", calcErrorStr(err), expr);
+        return;
+    }
+    prog = calcCompile(rpn);
+    if (!prog) {
+        testFail("calcCompile('%s')", expr);
+        return;
+    }
+
+    epicsTimeGetCurrent(&start);
+    for (n = 0; n < NARRAYS; n++) {
+        for (i = 0; i < NELM; i++) {
+            for (k = 0; k < 3; k++)
+                args[k] = pargs[k][i];
+            calcPerformCompiled(args, &presult[i], prog);
+        }
+    }
+    epicsTimeGetCurrent(&stop);
+    tScalar = epicsTimeDiffInSeconds(&stop, &start);
+
+    epicsTimeGetCurrent(&start);
+    for (n = 0; n < NARRAYS; n++)
+        calcPerformArray(pargs, pcounts, presult, NELM, prog);
+    epicsTimeGetCurrent(&stop);
+    tArray = epicsTimeDiffInSeconds(&stop, &start);
+
+    testOk(1, "calcPerformArray('%s')", expr);
+    testDiag("%-26s %6.2f ns/element compiled, %6.2f ns/element array (x%.2f)",
+             expr, tScalar * 1e9 / NARRAYS / NELM,
+             tArray * 1e9 / NARRAYS / NELM, tScalar / tArray);
+    calcProgramFree(prog);
+}
+
+MAIN(epicsCalcPerform)
+{
+    double *arrays[CALCPERFORM_NARGS] = {NULL};
+    epicsUInt32 counts[CALCPERFORM_NARGS] = {0};
+    double *result;
+    unsigned i, k;
+
+    testPlan(NELEMENTS(exprs) + NELEMENTS(arrayExprs));
+    for (i = 0; i < NELEMENTS(exprs); i++)
+        measure(exprs[i]);
+
+    result = calloc(NELM, sizeof(double));
+    for (k = 0; k < 3; k++) {
+        counts[k] = NELM;
+        arrays[k] = malloc(NELM * sizeof(double));
+        for (i = 0; i < NELM; i++)
+            arrays[k][i] = (i * (k + 1)) % 100003 + 1.0;
+    }
+    for (i = 0; i < NELEMENTS(arrayExprs); i++)
+        measureArray(arrayExprs[i], arrays, counts, result);
+    for (k = 0; k < 3; k++)
+        free(arrays[k]);
+    free(result);
+    return testDone();
+}
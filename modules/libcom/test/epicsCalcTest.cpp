@@ -43,9 +43,68 @@ double doCalc(const char *expr) {
     return result;
 }
 
+long calcBoth(const char *expr, double *args, double *presult,
+    const char *rpn, bool *psame) {
+    /* calcPerform(), and check calcPerformCompiled() matches it exactly,
+     * and so does calcPerformArray() for every element when it applies.
+     * Odd numbered arguments are given as scalars, the others as arrays
+     * that span more than one block.
+     */
+    const epicsUInt32 nelm = 70;
+    double cargs[CALCPERFORM_NARGS];
+    double cresult = *presult;
+    double *arrays[CALCPERFORM_NARGS], *aresult;
+    epicsUInt32 counts[CALCPERFORM_NARGS];
+    calcProgram *prog = calcCompile(rpn);
+    unsigned long stores = 1;
+    long status, cstatus, astatus = 0;
+    epicsUInt32 i, k;
+
+    calcArgUsage(rpn, NULL, &stores);
+    aresult = (double *) malloc(nelm * sizeof(double));
+    for (k = 0; k < CALCPERFORM_NARGS; k++) {
+        counts[k] = k & 1 ? 1 : nelm;
+        arrays[k] = (double *) malloc(counts[k] * sizeof(double));
+        for (i = 0; i < counts[k]; i++)
+            arrays[k][i] = args[k];
+    }
+    for (i = 0; i < nelm; i++)
+        aresult[i] = *presult;
+
+    memcpy(cargs, args, sizeof(cargs));
+    status = calcPerform(args, presult, rpn);
+    cstatus = calcPerformCompiled(cargs, &cresult, prog);
+    if (!stores)
+        astatus = calcPerformArray(arrays, counts, aresult, nelm, prog);
+    calcProgramFree(prog);
+
+    *psame = prog && cstatus == status &&
+        memcmp(&cresult, presult, sizeof(double)) == 0 &&
+        memcmp(cargs, args, sizeof(cargs)) == 0;
+    if (!*psame)
+        testDiag("calcPerformCompiled: '%s' returned %ld and %g, not %ld and %g",
+                 expr, cstatus, cresult, status, *presult);
+
+    if (!stores && *psame) {
+        for (i = 0; i < nelm && !status; i++)
+            if (memcmp(&aresult[i], presult, sizeof(double)) != 0)
+                break;
+        *psame = astatus == status && (status || i == nelm);
+        if (!*psame)
+            testDiag("calcPerformArray: '%s' returned %ld and [%u] = %g, "
+                     "not %ld and %g", expr, astatus, i,
+                     aresult[i < nelm ? i : 0], status, *presult);
+    }
+
+    for (k = 0; k < CALCPERFORM_NARGS; k++)
+        free(arrays[k]);
+    free(aresult);
+    return status;
+}
+
 void testCalc(const char *expr, double expected) {
     /* Evaluate expression, test against expected result */
-    bool pass = false;
+    bool pass = false, same = false;
     double args[CALCPERFORM_NARGS] = {
         1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
     };
@@ -62,7 +121,7 @@ void testCalc(const char *expr, double expected) {
     if (postfix(expr, rpn, &err)) {
         testDiag("postfix: %s in expression '%s'", calcErrorStr(err), expr);
     } else
-        if (calcPerform(args, &result, rpn) && finite(result)) {
+        if (calcBoth(expr, args, &result, rpn, &same) && finite(result)) {
             testDiag("calcPerform: error evaluating '%s'", expr);
         }
 
@@ -73,7 +132,7 @@ void testCalc(const char *expr, double expected) {
     } else {
         pass = (result == expected);
     }
-    if (!testOk(pass, "%s", expr)) {
+    if (!testOk(pass && same, "%s", expr)) {
         testDiag("Expected result is %g, actually got %g", expected, result);
         calcExprDump(rpn);
     }
@@ -82,7 +141,7 @@ void testCalc(const char *expr, double expected) {
 
 void testUInt32Calc(const char *expr, epicsUInt32 expected) {
     /* Evaluate expression, test against expected result */
-    bool pass = false;
+    bool pass = false, same = false;
     double args[CALCPERFORM_NARGS] = {
         1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
     };
@@ -100,13 +159,13 @@ void testUInt32Calc(const char *expr, epicsUInt32 expected) {
     if (postfix(expr, rpn, &err)) {
         testDiag("postfix: %s in expression '%s'", calcErrorStr(err), expr);
     } else
-        if (calcPerform(args, &result, rpn) && finite(result)) {
+        if (calcBoth(expr, args, &result, rpn, &same) && finite(result)) {
             testDiag("calcPerform: error evaluating '%s'", expr);
         }
 
     uresult = (epicsUInt32) result;
     pass = (uresult == expected);
-    if (!testOk(pass, "%s", expr)) {
+    if (!testOk(pass && same, "%s", expr)) {
         testDiag("Expected result is 0x%x (%u), actually got 0x%x (%u)",
                  expected, expected, uresult, uresult);
         calcExprDump(rpn);
@@ -157,6 +216,53 @@ void testBadExpr(const char *expr, short expected_err) {
     free(rpn);
 }
 
+void testArrayCalc(const char *expr) {
+    /* Evaluate element-wise over arrays whose elements differ, so that
+     * conditionals go both ways within a block, against calcPerform()
+     * on each element. A is -50..149, B is 200 elements of 3, C has only
+     * 10 elements, and D is empty.
+     */
+    const epicsUInt32 nelm = 200;
+    double a[200], b[200], c[10], aresult[200];
+    double *arrays[CALCPERFORM_NARGS] = {a, b, c};
+    epicsUInt32 counts[CALCPERFORM_NARGS] = {nelm, nelm, 10, 0};
+    char *rpn = (char*)malloc(INFIX_TO_POSTFIX_SIZE(strlen(expr)+1));
+    calcProgram *prog = NULL;
+    short err;
+    bool pass = false;
+    epicsUInt32 i;
+
+    for (i = 0; i < nelm; i++) {
+        a[i] = i - 50.0;
+        b[i] = 3.0;
+        aresult[i] = 0.0;
+    }
+    for (i = 0; i < 10; i++)
+        c[i] = i * 1.5;
+
+    if (rpn && !postfix(expr, rpn, &err))
+        prog = calcCompile(rpn);
+    if (prog && !calcPerformArray(arrays, counts, aresult, nelm, prog)) {
+        for (i = 0; i < nelm; i++) {
+            double args[CALCPERFORM_NARGS] = {
+                a[i], b[i], c[i < 10 ? i : 9]
+            };
+            double result = 0.0;
+
+            if (calcPerform(args, &result, rpn) ||
+                memcmp(&result, &aresult[i], sizeof(double)) != 0) {
+                testDiag("Element %u is %g, expected %g",
+                         i, aresult[i], result);
+                break;
+            }
+        }
+        pass = i == nelm;
+    }
+    testOk(pass, "Array %s", expr);
+    calcProgramFree(prog);
+    free(rpn);
+}
+
 /* Test an expression that is also valid C code */
 #define testExpr(expr) testCalc(#expr, expr);
 
@@ -297,7 +403,7 @@ MAIN(epicsCalcTest)
     const double a=1.0, b=2.0, c=3.0, d=4.0, e=5.0, f=6.0,
 		 g=7.0, h=8.0, i=9.0, j=10.0, k=11.0, l=12.0;
     
-    testPlan(613);
+    testPlan(636);
 
     /* LITERAL_OPERAND elements */
     testExpr(0);
@@ -810,6 +916,20 @@ MAIN(epicsCalcTest)
     testExpr(0 ? 2 : 1 ? 3 : 4);
     testExpr(1 ? 2 : 0 ? 3 : 4);
     testExpr(1 ? 2 : 1 ? 3 : 4);
+    // Relationals and operands that calcCompile() fuses into conditionals
+    testExpr(a < b ? c : d);
+    testExpr(a > b ? c : d);
+    testExpr(a >= 1 ? b + 1 : c - 1);
+    testExpr(a <= 0.5 ? b : c * 2);
+    testExpr(a == 1 ? b == 2 ? 3 : 4 : 5);
+    testExpr(a != 1 ? 2 : b != 2 ? 3 : 4);
+    testExpr(a + (b > c ? d : e));
+    testExpr(a + (b < c ? d : e) * f);
+    testExpr((a < 2 ? b : c) + d);
+    testExpr((a > 2 ? b : c) - 1);
+    testExpr(a < b == 1 ? c : d);
+    testExpr(NaN < 1 ? 2 : 3);
+    testExpr(NaN != 1 ? 2 : 3);
     
     /* STORE_OPERATOR and EXPR_TERM elements*/
     testCalc("a := 0; a", 0);
@@ -987,6 +1107,18 @@ MAIN(epicsCalcTest)
     testUInt32Calc("-1431655766.1 << 0.1", 0xaaaaaaaau);
     testUInt32Calc("2863311530.1 << 0.1", 0xaaaaaaaau);
 
+    // Element-wise evaluation where elements take different paths
+    testArrayCalc("A*B+C-D");
+    testArrayCalc("A>0?A:-A");
+    testArrayCalc("A<B?A:B");
+    testArrayCalc("A>10?(A>100?1:2):(A<-10?3:4)");
+    testArrayCalc("A&4?C:VAL");
+    testArrayCalc("A>0?SQR(A):A<0?-SQR(-A):0");
+    testArrayCalc("A%B?A:B%0");
+    testArrayCalc("MAX(A,B,C)-MIN(A,C)");
+    testArrayCalc("ISNAN(LOG(A),C)||A>140");
+    testArrayCalc("A>0?A:A<0?-A:VAL");
+
     return testDone();
 }
 
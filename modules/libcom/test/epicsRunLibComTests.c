@@ -52,6 +52,7 @@ int ipAddrToAsciiTest(void);
 int macDefExpandTest(void);
 int macLibTest(void);
 int osiSockTest(void);
+int fdManagerTest(void);
 int ringBytesTest(void);
 int ringPointerTest(void);
 int taskwdTest(void);
@@ -106,6 +107,7 @@ void epicsRunLibComTests(void)
     runTest(macDefExpandTest);
     runTest(macLibTest);
     runTest(osiSockTest);
+    runTest(fdManagerTest);
     runTest(ringBytesTest);
     runTest(ringPointerTest);
     runTest(taskwdTest);
@@ -0,0 +1,96 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure epicsTimeGetCurrent() throughput with 1 to 16 threads
+ * calling it at once, and check that no thread ever sees time go
+ * backwards.
+ */
+
+#include "dbDefs.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "epicsGeneralTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NCALLS 1000000
+
+typedef struct {
+    unsigned long backwards;
+    epicsEventId start;
+    epicsEventId done;
+} caller;
+
+static void callerThread(void *raw)
+{
+    caller *pc = raw;
+    epicsTimeStamp last, now;
+    unsigned i;
+
+    epicsEventMustWait(pc->start);
+    epicsTimeGetCurrent(&last);
+    for (i = 0; i < NCALLS; i++) {
+        epicsTimeGetCurrent(&now);
+        if (epicsTimeLessThan(&now, &last))
+            pc->backwards++;
+        last = now;
+    }
+    epicsEventMustTrigger(pc->done);
+}
+
+static void measure(unsigned nthreads)
+{
+    caller cl[16];
+    epicsTimeStamp start, stop;
+    unsigned long backwards = 0;
+    double dt;
+    unsigned i;
+
+    for (i = 0; i < nthreads; i++) {
+        cl[i].backwards = 0;
+        cl[i].start = epicsEventMustCreate(epicsEventEmpty);
+        cl[i].done = epicsEventMustCreate(epicsEventEmpty);
+        epicsThreadMustCreate("timeCaller", epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              &callerThread, &cl[i]);
+    }
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < nthreads; i++)
+        epicsEventMustTrigger(cl[i].start);
+    for (i = 0; i < nthreads; i++)
+        epicsEventMustWait(cl[i].done);
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%2u threads: %.0f ns per call, %.2f M calls/s",
+             nthreads, dt * 1e9 / NCALLS, nthreads * NCALLS / dt / 1e6);
+
+    for (i = 0; i < nthreads; i++) {
+        backwards += cl[i].backwards;
+        epicsEventDestroy(cl[i].start);
+        epicsEventDestroy(cl[i].done);
+    }
+    testOk(backwards == 0, "%2u threads: time never went backwards",
+           nthreads);
+}
+
+MAIN(epicsTimePerform)
+{
+    static const unsigned nthreads[] = {1, 2, 4, 8, 16};
+    epicsTimeStamp now;
+    unsigned i;
+
+    testPlan(NELEMENTS(nthreads));
+
+    epicsTimeGetCurrent(&now);
+    testDiag("Current time provider \"%s\"",
+             generalTimeCurrentProviderName());
+    for (i = 0; i < NELEMENTS(nthreads); i++)
+        measure(nthreads[i]);
+    return testDone();
+}
@@ -0,0 +1,128 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure how fast fdManager::process() dispatches a few active UDP
+ * sockets among many idle ones, with select() and with epoll.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "envDefs.h"
+#include "epicsTime.h"
+#include "fdManager.h"
+#include "osiSock.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NACTIVE 10
+#define NROUNDS 2000
+
+class udpReader : public fdReg {
+public:
+    udpReader ( SOCKET fd, fdManager & mgr, unsigned & count ) :
+        fdReg ( fd, fdrRead, false, mgr ), nReceived ( count ) {}
+private:
+    unsigned & nReceived;
+    void callBack ()
+    {
+        char buf[16];
+        if ( recv ( this->getFD (), buf, sizeof ( buf ), 0 ) > 0 )
+            this->nReceived++;
+    }
+};
+
+static void measure ( unsigned nsock, bool useSelect )
+{
+    const char * mode = useSelect ? "select" : "epoll ";
+    SOCKET * socks = new SOCKET [nsock];
+    udpReader ** readers = new udpReader * [nsock];
+    osiSockAddr * addrs = new osiSockAddr [nsock];
+    unsigned nReceived = 0u, nSent = 0u;
+    unsigned i, n, round;
+
+    epicsEnvSet ( "EPICS_FDMGR_USE_SELECT", useSelect ? "YES" : "" );
+    fdManager * pMgr = new fdManager;
+
+    for ( n = 0u; n < nsock; n++ ) {
+        osiSocklen_t len = sizeof ( addrs[n] );
+
+        socks[n] = epicsSocketCreate ( AF_INET, SOCK_DGRAM, 0 );
+        if ( socks[n] == INVALID_SOCKET )
+            break;
+        memset ( & addrs[n], 0, sizeof ( addrs[n] ) );
+        addrs[n].ia.sin_family = AF_INET;
+        addrs[n].ia.sin_addr.s_addr = htonl ( INADDR_LOOPBACK );
+        addrs[n].ia.sin_port = 0;
+        if ( bind ( socks[n], & addrs[n].sa, sizeof ( addrs[n].ia ) ) ||
+                getsockname ( socks[n], & addrs[n].sa, & len ) ||
+                ( useSelect && ! FD_IN_FDSET ( socks[n] ) ) ) {
+            epicsSocketDestroy ( socks[n] );
+            break;
+        }
+        readers[n] = new udpReader ( socks[n], * pMgr, nReceived );
+    }
+    if ( n < nsock ) {
+        testSkip ( 1, "not enough sockets" );
+        testDiag ( "%s %5u sockets: could only create %u", mode, nsock, n );
+        nsock = n;
+        goto cleanup;
+    }
+
+    {
+        SOCKET sender = epicsSocketCreate ( AF_INET, SOCK_DGRAM, 0 );
+        epicsTime start = epicsTime::getCurrent ();
+
+        for ( round = 0u; round < NROUNDS; round++ ) {
+            unsigned loops = 0u;
+
+            for ( i = 0u; i < NACTIVE; i++ ) {
+                const osiSockAddr & addr =
+                    addrs[( round * 7919u + i * ( nsock / NACTIVE ) ) % nsock];
+                if ( sendto ( sender, "x", 1, 0, & addr.sa,
+                        sizeof ( addr.ia ) ) == 1 )
+                    nSent++;
+            }
+            while ( nReceived < nSent && loops++ < 1000u )
+                pMgr->process ( 0.1 );
+        }
+
+        double dt = epicsTime::getCurrent () - start;
+        testDiag ( "%s %5u sockets: %.1f us per round of %u datagrams",
+            mode, nsock, dt * 1e6 / NROUNDS, NACTIVE );
+        testOk ( nReceived == nSent, "%s %u sockets: %u of %u received",
+            mode, nsock, nReceived, nSent );
+        epicsSocketDestroy ( sender );
+    }
+
+cleanup:
+    for ( i = 0u; i < nsock; i++ ) {
+        delete readers[i];
+        epicsSocketDestroy ( socks[i] );
+    }
+    delete pMgr;
+    delete [] addrs;
+    delete [] readers;
+    delete [] socks;
+}
+
+MAIN ( fdManagerPerform )
+{
+    static const unsigned nsocks[] = { 10, 100, 900, 10000 };
+    const unsigned nsizes = sizeof ( nsocks ) / sizeof ( nsocks[0] );
+
+    testPlan ( 2 * nsizes );
+    osiSockAttach ();
+    for ( unsigned i = 0u; i < nsizes; i++ ) {
+        if ( FD_IN_FDSET ( nsocks[i] ) )
+            measure ( nsocks[i], true );
+        else
+            testSkip ( 1, "select() can't watch this many sockets" );
+        measure ( nsocks[i], false );
+    }
+    osiSockRelease ();
+    return testDone ();
+}
@@ -0,0 +1,119 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * A socket registered with fdManager only for fdrException whose peer
+ * resets the connection must not leave fdManager::process() returning
+ * at once on every pass.
+ */
+
+#include <cstring>
+
+#include "envDefs.h"
+#include "epicsTime.h"
+#include "fdManager.h"
+#include "osiSock.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+class exceptionWatch : public fdReg {
+public:
+    exceptionWatch ( SOCKET fd, fdManager & mgr, unsigned & count ) :
+        fdReg ( fd, fdrException, true, mgr ), nCalls ( count ) {}
+private:
+    unsigned & nCalls;
+    void callBack ()
+    {
+        this->nCalls++;
+    }
+};
+
+// a connected pair of TCP sockets on the loopback interface
+static bool connectPair ( SOCKET & client, SOCKET & server )
+{
+    osiSockAddr addr;
+    osiSocklen_t len = sizeof ( addr );
+    SOCKET listener = epicsSocketCreate ( AF_INET, SOCK_STREAM, 0 );
+    bool ok = false;
+
+    client = server = INVALID_SOCKET;
+    if ( listener == INVALID_SOCKET )
+        return false;
+    memset ( & addr, 0, sizeof ( addr ) );
+    addr.ia.sin_family = AF_INET;
+    addr.ia.sin_addr.s_addr = htonl ( INADDR_LOOPBACK );
+    addr.ia.sin_port = 0;
+    if ( bind ( listener, & addr.sa, sizeof ( addr.ia ) ) == 0 &&
+            listen ( listener, 1 ) == 0 &&
+            getsockname ( listener, & addr.sa, & len ) == 0 ) {
+        client = epicsSocketCreate ( AF_INET, SOCK_STREAM, 0 );
+        if ( client != INVALID_SOCKET &&
+                connect ( client, & addr.sa, sizeof ( addr.ia ) ) == 0 ) {
+            len = sizeof ( addr );
+            server = epicsSocketAccept ( listener, & addr.sa, & len );
+            ok = server != INVALID_SOCKET;
+        }
+    }
+    epicsSocketDestroy ( listener );
+    if ( ! ok && client != INVALID_SOCKET )
+        epicsSocketDestroy ( client );
+    return ok;
+}
+
+static void testPeerReset ( bool useSelect )
+{
+    const char * mode = useSelect ? "select" : "default";
+    SOCKET client, server;
+    unsigned nCalls = 0u;
+    struct linger lng;
+
+    testDiag ( "Peer reset of an exception-only socket, %s mode", mode );
+
+    epicsEnvSet ( "EPICS_FDMGR_USE_SELECT", useSelect ? "YES" : "" );
+    fdManager * pMgr = new fdManager;
+
+    if ( ! connectPair ( client, server ) ) {
+        testAbort ( "Failed to connect a pair of TCP sockets" );
+    }
+    new exceptionWatch ( server, * pMgr, nCalls );
+
+    // an abortive close resets the connection
+    lng.l_onoff = 1;
+    lng.l_linger = 0;
+    setsockopt ( client, SOL_SOCKET, SO_LINGER,
+        reinterpret_cast < char * > ( & lng ), sizeof ( lng ) );
+    epicsSocketDestroy ( client );
+
+    pMgr->process ( 0.5 );
+#if defined ( __linux__ ) && ! defined ( FDMGR_USE_SELECT )
+    // select() only reports out of band data as an exception
+    if ( ! useSelect ) {
+        testOk ( nCalls == 1u, "callBack() ran %u times for the reset",
+            nCalls );
+    }
+    else
+#endif
+    {
+        testOk ( nCalls == 0u, "callBack() ran %u times", nCalls );
+    }
+
+    epicsTime start = epicsTime::getCurrent ();
+    pMgr->process ( 0.2 );
+    pMgr->process ( 0.2 );
+    double elapsed = epicsTime::getCurrent () - start;
+    testOk ( elapsed > 0.3, "process() waited %.3f s of 0.4 s", elapsed );
+
+    delete pMgr;
+    epicsSocketDestroy ( server );
+}
+
+MAIN(fdManagerTest)
+{
+    testPlan ( 4 );
+    testPeerReset ( false );
+    testPeerReset ( true );
+    epicsEnvSet ( "EPICS_FDMGR_USE_SELECT", "" );
+    return testDone ();
+}
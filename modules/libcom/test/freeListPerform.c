@@ -0,0 +1,127 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure freeListMalloc()/freeListFree() throughput with 1 to 16
+ * threads, with and without the per-thread caches.  Each thread tags
+ * the blocks it holds to check that no block is handed out twice, and
+ * every block must be back on the list at the end.
+ */
+
+#include <string.h>
+
+#include "dbDefs.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "freeList.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NITER 1000000
+#define NHELD 16
+#define NCACHE 32
+#define NMALLOC 256
+
+typedef struct {
+    void *pfl;
+    epicsEventId start;
+    epicsEventId done;
+    int shared;             /* blocks found in use by someone else */
+} worker;
+
+static void workerThread(void *raw)
+{
+    worker *pw = raw;
+    void *held[NHELD];
+    unsigned i, j;
+
+    memset(held, 0, sizeof(held));
+    epicsEventMustWait(pw->start);
+    for (i = 0; i < NITER / NHELD; i++) {
+        for (j = 0; j < NHELD; j++) {
+            held[j] = freeListMalloc(pw->pfl);
+            *(worker **)held[j] = pw;
+        }
+        /* a block held twice by this thread was tagged with j */
+        if (i == 0) {
+            for (j = 0; j < NHELD; j++)
+                *(unsigned *)((worker **)held[j] + 1) = j;
+            for (j = 0; j < NHELD; j++)
+                if (*(unsigned *)((worker **)held[j] + 1) != j)
+                    pw->shared++;
+        }
+        for (j = 0; j < NHELD; j++) {
+            if (*(worker **)held[j] != pw)
+                pw->shared++;
+            freeListFree(pw->pfl, held[j]);
+        }
+    }
+    epicsEventMustTrigger(pw->done);
+}
+
+static void measure(int ncache, unsigned nthreads)
+{
+    worker wk[16];
+    epicsTimeStamp start, stop;
+    void *pfl;
+    double dt;
+    size_t avail;
+    int shared = 0;
+    unsigned i;
+
+    if (ncache)
+        freeListInitCachedPvt(&pfl, 64, NMALLOC, ncache);
+    else
+        freeListInitPvt(&pfl, 64, NMALLOC);
+
+    for (i = 0; i < nthreads; i++) {
+        wk[i].pfl = pfl;
+        wk[i].shared = 0;
+        wk[i].start = epicsEventMustCreate(epicsEventEmpty);
+        wk[i].done = epicsEventMustCreate(epicsEventEmpty);
+        epicsThreadMustCreate("freeList", epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              &workerThread, &wk[i]);
+    }
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < nthreads; i++)
+        epicsEventMustTrigger(wk[i].start);
+    for (i = 0; i < nthreads; i++)
+        epicsEventMustWait(wk[i].done);
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testDiag("%s, %2u threads: %.0f ns per malloc+free, %.2f M pairs/s",
+             ncache ? "cached  " : "uncached", nthreads,
+             dt * 1e9 / NITER, nthreads * NITER / dt / 1e6);
+
+    for (i = 0; i < nthreads; i++) {
+        shared += wk[i].shared;
+        epicsEventDestroy(wk[i].start);
+        epicsEventDestroy(wk[i].done);
+    }
+    testOk(shared == 0, "%d blocks were handed out while in use", shared);
+
+    /* the list only grows NMALLOC blocks at a time */
+    avail = freeListItemsAvail(pfl);
+    testOk(avail > 0 && avail % NMALLOC == 0,
+           "All blocks returned, %lu available", (unsigned long)avail);
+    freeListCleanup(pfl);
+}
+
+MAIN(freeListPerform)
+{
+    static const unsigned nthreads[] = {1, 2, 4, 8, 16};
+    unsigned i;
+
+    testPlan(4 * NELEMENTS(nthreads));
+    for (i = 0; i < NELEMENTS(nthreads); i++) {
+        measure(0, nthreads[i]);
+        measure(NCACHE, nthreads[i]);
+    }
+    return testDone();
+}
@@ -0,0 +1,79 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure macLib the way a large substitution file uses it: global
+ * macros, then for each row a scope holding many macros, several
+ * strings expanded, and the scope popped again.
+ */
+
+#include <stdio.h>
+
+#include "dbDefs.h"
+#include "epicsTime.h"
+#include "macLib.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NGLOBAL 20
+#define NROWS 2000
+#define NEXPAND 20
+
+static void measure(unsigned nmacros)
+{
+    epicsTimeStamp start, stop;
+    MAC_HANDLE *handle;
+    char name[32], value[64], src[128], dest[MAC_SIZE + 1];
+    double dt;
+    unsigned row, i;
+    long ok = 1;
+
+    epicsTimeGetCurrent(&start);
+
+    macCreateHandle(&handle, NULL);
+    for (i = 0; i < NGLOBAL; i++) {
+        sprintf(name, "G%u", i);
+        sprintf(value, "global%u", i);
+        macPutValue(handle, name, value);
+    }
+
+    for (row = 0; row < NROWS; row++) {
+        macPushScope(handle);
+        for (i = 0; i < nmacros; i++) {
+            sprintf(name, "M%u", i);
+            /* one in eight values refers to another macro */
+            if (i % 8 == 7)
+                sprintf(value, "$(G%u):$(M%u)", i % NGLOBAL, i - 1);
+            else
+                sprintf(value, "row%u_value%u", row, i);
+            macPutValue(handle, name, value);
+        }
+        for (i = 0; i < NEXPAND; i++) {
+            unsigned m = (i * 7) % nmacros;
+
+            sprintf(src, "$(G%u):$(M%u)-$(M%u)", i % NGLOBAL, m, nmacros - 1 - m);
+            ok &= macExpandString(handle, src, dest, sizeof(dest)) > 0;
+        }
+        macPopScope(handle);
+    }
+    macDeleteHandle(handle);
+
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    testOk(ok, "%3u macros per row: %.2f us per row", nmacros,
+           dt * 1e6 / NROWS);
+}
+
+MAIN(macLibPerform)
+{
+    static const unsigned nmacros[] = {10, 50, 100, 200};
+    unsigned i;
+
+    testPlan(NELEMENTS(nmacros));
+    for (i = 0; i < NELEMENTS(nmacros); i++)
+        measure(nmacros[i]);
+    return testDone();
+}